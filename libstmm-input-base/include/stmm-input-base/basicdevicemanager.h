@@ -22,6 +22,7 @@
 #define STMI_BASIC_DEVICE_MANAGER_H
 
 #include "childdevicemanager.h"
+#include "private-callifprogram.h"
 
 #include <stmm-input/capability.h>
 #include <stmm-input/devicemanager.h>
@@ -30,8 +31,9 @@
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
-#include <list>
+#include <deque>
 #include <limits>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -50,7 +52,17 @@ class BasicDeviceManager : public ChildDeviceManager
 public:
 	shared_ptr<Device> getDevice(int32_t nDeviceId) const noexcept override;
 
+	/** The ids of the devices with a capability class.
+	 * For the device capability classes passed to the constructor the result
+	 * is maintained by addDevice() and removeDevice(), which assume that
+	 * the capabilities of a device don't change while it is added.
+	 * @param oCapabilityClass The capability class.
+	 * @return The device ids, sorted in ascending order.
+	 */
 	std::vector<int32_t> getDevicesWithCapabilityClass(const Capability::Class& oCapabilityClass) const noexcept override;
+	/** The ids of all the devices.
+	 * @return The device ids, sorted in ascending order.
+	 */
 	std::vector<int32_t> getDevices() const noexcept override;
 
 	std::vector<Capability::Class> getCapabilityClasses() const noexcept override;
@@ -103,6 +115,7 @@ protected:
 	 * Subclasses of BasicDeviceManager should call this when adding a device.
 	 * If the device couldn't be added (for example because it already is)
 	 * `false` is returned.
+	 * The ancestor device managers are told through notifyDeviceAdded().
 	 * @param refDevice The device to be added. Cannot be null.
 	 * @return Whether the device could be added.
 	 */
@@ -111,6 +124,7 @@ protected:
 	 * Subclasses of BasicDeviceManager should call this when removing a device.
 	 * If the device couldn't be removed (for example because it isn't present)
 	 * `false` is returned.
+	 * The ancestor device managers are told through notifyDeviceRemoved().
 	 * @param refDevice The device to be removed. Cannot be null.
 	 * @return Whether the device could be removed.
 	 */
@@ -131,13 +145,28 @@ protected:
 	virtual void finalizeListener(ListenerData& oListenerData) noexcept = 0;
 	/** Returns the listeners data pointers.
 	 * The returned value prevents the data pointed to by the elements
-	 * of the list to be deleted while the std::shared_ptr is held.
+	 * of the vector to be deleted or reused while the std::shared_ptr is held.
 	 * This also means that BasicDeviceManager subclasses shouldn't store the shared_ptr
-	 * because it would prevent deletion of unused ListenerData objects.
-	 * @return The reference counted pointer to the list.
+	 * because it would prevent the reclamation of unused ListenerData objects.
+	 *
+	 * The listeners are in the order they were added. Listeners added while a
+	 * listener vector is in use (ex. from within a listener callback) are only
+	 * included the next time this function is called with no vector in use.
+	 * @return The reference counted pointer to the vector.
 	 */
-	shared_ptr< const std::list< ListenerData* > > getListeners() noexcept;
+	shared_ptr< const std::vector< ListenerData* > > getListeners() noexcept;
+	/** Returns the listeners data pointers that can receive events of a class.
+	 * The returned vector only contains the listeners whose simplified callif
+	 * for the event class isn't CallIfFalse, in the order they were added.
+	 *
+	 * The same restrictions as for getListeners() apply.
+	 * @param nClassTypeIdx The index of the class. @see getEventClassIndex(const Event::Class&) const
+	 * @return The reference counted pointer to the vector.
+	 */
+	shared_ptr< const std::vector< ListenerData* > > getListeners(int32_t nClassTypeIdx) noexcept;
 	/** Returns the index of the event class in the array passed to the constructor.
+	 * The lookup is done with the registered index of the class (Event::Class::getIndex())
+	 * and therefore doesn't involve any comparison of types.
 	 * The index can be used by
 	 * ListenerData::handleEventCallIf(int32_t, const shared_ptr<Event>&, const shared_ptr<const Accessor>&) const
 	 * for faster access to the simplified callif expression for the event class.
@@ -147,6 +176,18 @@ protected:
 	 * @return Index or -1 if not supported event class.
 	 */
 	int32_t getEventClassIndex(const Event::Class& oEventClass) const noexcept;
+	/** Whether an event class is enabled.
+	 * Same as isEventClassEnabled(const Event::Class&) but only tests a bit
+	 * of a mask and can therefore be used for each event sent.
+	 * @param nClassTypeIdx The index of the class. @see getEventClassIndex(const Event::Class&) const
+	 * @return Whether the event class is enabled.
+	 */
+	inline bool isEventClassIndexEnabled(int32_t nClassTypeIdx) const noexcept
+	{
+		assert((nClassTypeIdx >= 0) && (nClassTypeIdx < static_cast<int32_t>(m_aEventClasses.size())));
+		const uint64_t nMask = m_aEventClassEnabledMask[nClassTypeIdx / 64].load(std::memory_order_relaxed);
+		return ((nMask >> (nClassTypeIdx % 64)) & 1) != 0;
+	}
 	/** Calls overloaded ListenerExtraData::reset() for each listener. */
 	void resetExtraDataOfAllListeners() noexcept;
 	/** Base class to store extra listener data.
@@ -180,6 +221,8 @@ protected:
 		, m_bListenerRemoving(false)
 		, m_nAddedTimeStamp(std::numeric_limits<decltype(m_nAddedTimeStamp)>::max())
 		, m_p0EventListener(nullptr)
+		, m_nSlot(-1)
+		, m_nGeneration(0)
 		{
 		}
 		/** Send event to the listener with callif evaluation.
@@ -240,9 +283,12 @@ protected:
 		shared_ptr<CallIf> m_refCallIf; // The callif without simplification
 		// One callif for each registered event class type supported by this device manager
 		std::vector< shared_ptr<CallIf> > m_aCallIfEventClass; // Size: m_p1Owner->m_aEventClass.size(), Value: "refSimplifiedCallIf"
+		// The compiled m_aCallIfEventClass, references the nodes of the simplified callifs
+		std::vector< Private::CallIfProgram > m_aCallIfProgram; // Size: m_p1Owner->m_aEventClass.size()
 		weak_ptr<EventListener> m_refEventListener;
-		EventListener* m_p0EventListener; // Useful in case the weak ptr becomes null.
-		std::list< ListenerData* >::iterator m_itListeners; // "pointer" to element within list *m_refListeners
+		EventListener* m_p0EventListener; // Useful in case the weak ptr becomes null. If null the slot is free.
+		int32_t m_nSlot; // Index into m_p1Owner->m_oListenersData
+		uint32_t m_nGeneration; // Incremented each time the slot is freed
 	private:
 		ListenerData& operator=(const ListenerData& oSource) = delete;
 		ListenerData(const ListenerData& oSource) = delete;
@@ -250,35 +296,69 @@ protected:
 	/** Returns a unique time stamp.
 	 * Allows to order events without relying on microseconds which isn't precise
 	 * enough. The returned stamp increases after each call.
+	 *
+	 * The counter is shared by all the device managers of the process and
+	 * this function can be called from any thread. The stamps are unique also
+	 * across threads and a stamp that happens-before another (for example
+	 * because it was passed through an EventQueue or a mutex) is smaller.
 	 * @return The unique timestamp (> 0).
 	 */
 	static uint64_t getUniqueTimeStamp() noexcept
 	{
-		const auto nTimeStamp = ++s_nUniqueTimeStamp;
+		// A single atomic has a total modification order consistent with
+		// happens-before, relaxed is therefore enough
+		const auto nTimeStamp = s_nUniqueTimeStamp.fetch_add(1, std::memory_order_relaxed) + 1;
 		assert(nTimeStamp > 0);
 		return nTimeStamp;
 	}
 private:
 	void maybeRemoveDataOfRemovedListeners() noexcept;
+	ListenerData* findListenerData(const EventListener* p0EventListener) noexcept;
+	void addToListeners(ListenerData& oListenerData) noexcept;
+	void addPendingListeners() noexcept;
+	void freeSlot(ListenerData& oListenerData) noexcept;
 
 private:
 	const std::vector<Capability::Class> m_aCapabitityClasses;
 	const std::vector<Capability::Class> m_aDeviceCapabitityClasses;
 	const std::vector<Event::Class> m_aEventClasses;
+	// Size: max Event::Class::getIndex() of m_aEventClasses + 1, Value: index into m_aEventClasses or -1
+	std::vector<int32_t> m_aEventClassIndex;
 
-	std::vector<bool> m_aEventClassEnabled; // Size: m_aEventClass.size()
+	// Bit nIdx % 64 of element nIdx / 64 tells whether m_aEventClasses[nIdx] is enabled.
+	// Atomic so that it can be read from other threads.
+	std::vector< std::atomic<uint64_t> > m_aEventClassEnabledMask; // Size: (m_aEventClasses.size() + 63) / 64
 
 	// All added devices
 	std::unordered_map<int32_t, shared_ptr<Device> > m_oDevices; // Key: device id, Value: Device
+	// The ids of the added devices that have the capability class m_aDeviceCapabitityClasses[nIdx]
+	std::vector< std::vector<int32_t> > m_aCapabilityClassDevices; // Size: m_aDeviceCapabitityClasses.size(), Value: sorted device ids
 
-	std::list< ListenerData > m_oListenersData;
-	// This shared_ptr that prevents the elements in m_oListenersData to be removed
-	// while in use, that is when the reference count of m_refListeners is > 1
-	// The list is actually the same as m_oListenersData, but its elements are pointers
-	// into m_oListenersData elements.
-	// Motivation for two lists: getListeners() can return the const list of pointers without
-	// the ListenerData objects themselves being constant.
-	shared_ptr< std::list< ListenerData* > > m_refListeners;
+	// The listener slots. A deque so that the elements don't move when it grows.
+	// The slots of removed listeners are reused, see m_aFreeSlots.
+	std::deque< ListenerData > m_oListenersData;
+	std::vector< int32_t > m_aFreeSlots; // Value: index into m_oListenersData
+	// The slots of the removed listeners waiting to be freed
+	std::vector< int32_t > m_aRemovedSlots; // Value: index into m_oListenersData
+	struct SlotRef
+	{
+		int32_t m_nSlot;
+		uint32_t m_nGeneration; // Must match the ListenerData's for the reference to be valid
+	};
+	// Key: the listener, Value: the slot of the listener
+	std::unordered_map< const EventListener*, SlotRef > m_oListenerSlots;
+	// Pointers into m_oListenersData elements in the order they were added.
+	// The vector and the vectors in m_aClassListeners can only be modified (and
+	// the slots of removed listeners reused) when m_refListeners.use_count() == 1,
+	// that is when no one is iterating over them.
+	// getListeners() and getListeners(int32_t) return shared_ptrs that share
+	// the ownership of m_refListeners.
+	shared_ptr< std::vector< ListenerData* > > m_refListeners;
+	// For each supported event class the pointers into m_oListenersData elements
+	// whose callif for the class isn't CallIfFalse.
+	std::vector< std::vector< ListenerData* > > m_aClassListeners; // Size: m_aEventClasses.size()
+	// The listeners added while the vectors couldn't be modified
+	std::vector< ListenerData* > m_aPendingListeners;
 	// Invariants:
 	// - If more ListenersData objects have the same m_p0EventListener, only one or none
 	//   can have (m_bListenerWasRemoved == false)
@@ -289,8 +369,8 @@ private:
 	// Tells whether one or more ListenerData were marked as removed
 	bool m_bListenerListDirty;
 
-	// Since this class isn't thread safe no need to declare it as atomic
-	static uint64_t s_nUniqueTimeStamp;
+	// Shared by all device managers, which might run in different threads
+	static std::atomic<uint64_t> s_nUniqueTimeStamp;
 private:
 	BasicDeviceManager() = delete;
 	BasicDeviceManager(const BasicDeviceManager& oSource) = delete;
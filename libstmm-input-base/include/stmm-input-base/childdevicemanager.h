@@ -70,11 +70,38 @@ public:
 	 * @return This object as ParentDeviceManager or null if not a parent.
 	 */
 	shared_ptr<ParentDeviceManager> getAsParent() noexcept;
+	/** Whether the ancestors are told about the devices added and removed.
+	 * See setNotifiesDeviceChanges(). A parent returns true only if
+	 * all its descendants notify their device changes.
+	 * @return Whether the device changes are notified.
+	 */
+	bool isNotifyingDeviceChanges() const noexcept { return m_bNotifiesDeviceChanges; }
 protected:
 	/** Constructor.
 	 */
 	ChildDeviceManager() noexcept;
 
+	/** Tells the ancestors that a device was added to this device manager.
+	 * The parents use it to route getDevice() directly to this instance.
+	 * Subclasses that called setNotifiesDeviceChanges() must call this whenever they
+	 * add a device (BasicDeviceManager::addDevice() does).
+	 * @param nDeviceId The id of the added device.
+	 */
+	void notifyDeviceAdded(int32_t nDeviceId) noexcept;
+	/** Tells the ancestors that a device was removed from this device manager.
+	 * Subclasses that called setNotifiesDeviceChanges() must call this whenever they
+	 * remove a device (BasicDeviceManager::removeDevice() does).
+	 * @param nDeviceId The id of the removed device.
+	 */
+	void notifyDeviceRemoved(int32_t nDeviceId) noexcept;
+	/** Declares that this instance calls notifyDeviceAdded() and notifyDeviceRemoved().
+	 * Must be called from the constructor of subclasses that aren't a ParentDeviceManager.
+	 * The parents then answer getDevice() and getDevices() from their routing table,
+	 * otherwise they have to ask this instance each time.
+	 * BasicDeviceManager calls it.
+	 */
+	void setNotifiesDeviceChanges() noexcept { m_bNotifiesDeviceChanges = true; }
+
 private:
 	friend class ParentDeviceManager;
 	ChildDeviceManager(bool bIsParent) noexcept;
@@ -88,6 +115,9 @@ private:
 	weak_ptr<ParentDeviceManager> m_refWeakRoot;
 	bool m_bImRoot; // If true m_refWeakRoot and m_refWeakParent are null.
 	bool m_bImParent;
+	// Whether the ancestors are told about all the devices added and removed
+	// by this instance or, if a parent, by all its descendants
+	bool m_bNotifiesDeviceChanges;
 private:
 	ChildDeviceManager(const ChildDeviceManager& oSource) = delete;
 	ChildDeviceManager& operator=(const ChildDeviceManager& oSource) = delete;
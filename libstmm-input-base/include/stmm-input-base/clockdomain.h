@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   clockdomain.h
+ */
+
+#ifndef STMI_CLOCK_DOMAIN_H
+#define STMI_CLOCK_DOMAIN_H
+
+#include <cstdint>
+
+namespace stmi
+{
+
+/** Maps the time stamps of a device clock onto the library's timeline.
+ * The device time stamps are in milliseconds and wrap around after 2^32
+ * milliseconds (ex. GdkEvent::time or js_event::time). The returned times are
+ * in microseconds in the clock domain of DeviceManager::getNowTimeMicroseconds().
+ *
+ * The offset between the two clocks is estimated as the smallest observed
+ * difference between the current time and the device time, since an event
+ * is always received after it happened. The current time is only sampled
+ * every s_nSyncEveryTimes calls and when the device time advanced more than
+ * s_nSyncAfterUsec since the last sample, not for each event.
+ * If the device clock is slower than the library's, the offset grows
+ * by at most s_nMaxDriftUsec at each sample, so that a stalled main loop
+ * doesn't move the estimate. If the difference exceeds s_nResetAfterUsec
+ * (ex. the device clock was reset) the estimate starts over.
+ *
+ * The returned times never decrease.
+ * An instance of this class is not thread safe.
+ */
+class ClockDomain
+{
+public:
+	ClockDomain() noexcept;
+	/** Maps a device time stamp.
+	 * The value 0 (ex. GDK_CURRENT_TIME) is mapped to the current time.
+	 * @param nDeviceTimeMsec The device time in milliseconds.
+	 * @return The time in microseconds.
+	 */
+	int64_t getTimeUsec(uint32_t nDeviceTimeMsec) noexcept;
+	/** Maps a device time stamp given the current time.
+	 * The current time is always used to correct the estimate.
+	 * @param nDeviceTimeMsec The device time in milliseconds.
+	 * @param nNowUsec The current time as returned by DeviceManager::getNowTimeMicroseconds().
+	 * @return The time in microseconds.
+	 */
+	int64_t getTimeUsec(uint32_t nDeviceTimeMsec, int64_t nNowUsec) noexcept;
+	/** Forgets the estimate.
+	 * The next call to getTimeUsec() starts over.
+	 */
+	void reset() noexcept;
+
+	static constexpr int32_t s_nSyncEveryTimes = 16;
+	static constexpr int64_t s_nSyncAfterUsec = 500000;
+	static constexpr int64_t s_nMaxDriftUsec = 100;
+	static constexpr int64_t s_nResetAfterUsec = 10000000;
+private:
+	// Updates m_nDeviceUsec, returns whether the offset should be re-estimated
+	bool unwrap(uint32_t nDeviceTimeMsec) noexcept;
+	void sync(int64_t nNowUsec) noexcept;
+	int64_t calcTimeUsec() noexcept;
+private:
+	bool m_bInitialized;
+	uint32_t m_nLastDeviceMsec;
+	int64_t m_nDeviceUsec; // The unwrapped device time of the last call
+	int64_t m_nOffsetUsec; // Library time minus device time
+	int64_t m_nLastSyncDeviceUsec;
+	int32_t m_nSinceSync;
+	int64_t m_nLastTimeUsec; // The last returned value
+};
+
+} // namespace stmi
+
+#endif /* STMI_CLOCK_DOMAIN_H */
@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventbatcher.h
+ */
+
+#ifndef STMI_EVENT_BATCHER_H
+#define STMI_EVENT_BATCHER_H
+
+#include <stmm-input/devicemanager.h>
+#include <stmm-input/event.h>
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+
+namespace stmi
+{
+
+using std::shared_ptr;
+
+/** Batch listener callback function.
+ * The first parameter points to the first of the contiguous events,
+ * the second is the number of events (&gt; 0).
+ * The events are in the order they were received.
+ * @see EventBatcher.
+ */
+using BatchEventListener = std::function<void(const shared_ptr<Event>* p0Events, int32_t nTotEvents) noexcept>;
+
+/** Accumulates events and delivers them in batches.
+ * The listener returned by getEventListener() can be added to any
+ * device manager with DeviceManager::addEventListener(). Instead of calling
+ * a function for each event and listener, the accumulated events are passed
+ * to the batch listener once, when flush() is called.
+ *
+ * Example: to receive the events once per frame
+ *
+ *     auto refBatcher = std::make_shared<stmi::EventBatcher>(refBatchListener);
+ *     refDeviceManager->addEventListener(refBatcher->getEventListener(), refCallIf);
+ *     ...
+ *     // in the frame's update function
+ *     refBatcher->flush();
+ *
+ * Subclasses can override onFirstPendingEvent() to schedule the call to flush().
+ *
+ * The listener is removed from the device managers when the instance
+ * is destroyed (since they only hold a weak reference to it).
+ * Note that the events are held until delivered, which means device managers
+ * that recycle events have to create new ones.
+ */
+class EventBatcher
+{
+public:
+	/** Constructor.
+	 * @param refBatchListener The batch listener. Cannot be null.
+	 */
+	explicit EventBatcher(const shared_ptr<BatchEventListener>& refBatchListener) noexcept;
+	virtual ~EventBatcher() noexcept = default;
+	/** The listener that accumulates the events.
+	 * @return The listener. Not null.
+	 */
+	const shared_ptr<EventListener>& getEventListener() const noexcept { return m_refEventListener; }
+	/** The number of accumulated events not yet delivered.
+	 * @return The number of events.
+	 */
+	int32_t getTotPendingEvents() const noexcept { return static_cast<int32_t>(m_aPendingEvents.size()); }
+	/** Delivers the accumulated events to the batch listener.
+	 * If there are no accumulated events the batch listener isn't called.
+	 * Events received while the batch listener is called are delivered
+	 * by the next flush. Calling this function from within the batch
+	 * listener has no effect.
+	 */
+	void flush() noexcept;
+protected:
+	/** Called when an event is accumulated and there were no pending events.
+	 * The default implementation does nothing.
+	 */
+	virtual void onFirstPendingEvent() noexcept {}
+private:
+	void onEvent(const shared_ptr<Event>& refEvent) noexcept;
+private:
+	shared_ptr<BatchEventListener> m_refBatchListener;
+	shared_ptr<EventListener> m_refEventListener;
+	std::vector< shared_ptr<Event> > m_aPendingEvents;
+	// The events being delivered, kept as a member to reuse its capacity
+	std::vector< shared_ptr<Event> > m_aDeliveringEvents;
+	bool m_bFlushing;
+private:
+	EventBatcher(const EventBatcher& oSource) = delete;
+	EventBatcher& operator=(const EventBatcher& oSource) = delete;
+};
+
+} // namespace stmi
+
+#endif /* STMI_EVENT_BATCHER_H */
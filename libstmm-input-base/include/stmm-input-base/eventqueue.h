@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventqueue.h
+ */
+
+#ifndef STMI_EVENT_QUEUE_H
+#define STMI_EVENT_QUEUE_H
+
+#include "spscring.h"
+
+#include <stmm-input/devicemanager.h>
+#include <stmm-input/event.h>
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+
+namespace stmi
+{
+
+using std::shared_ptr;
+
+/** Bounded lock-free queue of events for another thread.
+ * The listener returned by getEventListener() can be added to any device
+ * manager with DeviceManager::addEventListener(). It pushes the events it
+ * receives into a ring buffer from which another thread (ex. a simulation)
+ * can pop them with pop() or drain().
+ *
+ * There must be exactly one producer thread, the one the device managers
+ * send events from (for gtk-dm the thread of the Gtk main loop), and one
+ * consumer thread. Both push and pop are wait-free.
+ *
+ * If the queue is full, the event is dropped and counted (see getTotDroppedEvents()),
+ * since the producer must not be blocked.
+ *
+ * The queue holds a reference to the events until they are popped, therefore
+ * device managers that recycle events don't reuse them while queued.
+ * The consumer thread releases the events it pops. Events must not be modified
+ * by the consumer.
+ */
+class EventQueue final
+{
+public:
+	/** Constructor.
+	 * @param nMinCapacity The minimum number of events the queue can hold. Must be &gt; 0.
+	 *                     The capacity is rounded up to a power of 2.
+	 */
+	explicit EventQueue(int32_t nMinCapacity) noexcept;
+	/** The listener that pushes the events into the queue.
+	 * @return The listener. Not null.
+	 */
+	const shared_ptr<EventListener>& getEventListener() const noexcept { return m_refEventListener; }
+	/** The maximum number of events the queue can hold.
+	 * @return The capacity. Is a power of 2.
+	 */
+	int32_t getCapacity() const noexcept { return m_oRing.getCapacity(); }
+	/** Pushes an event.
+	 * Must only be called by the producer thread.
+	 * @param refEvent The event. Cannot be null.
+	 * @return Whether the event was pushed, `false` if the queue was full.
+	 */
+	inline bool push(const shared_ptr<Event>& refEvent) noexcept
+	{
+		assert(refEvent);
+		// the slot is empty: the consumer moved the event out
+		if (!m_oRing.push(refEvent)) {
+			m_nTotDropped.fetch_add(1, std::memory_order_relaxed);
+			return false; //----------------------------------------------------
+		}
+		return true;
+	}
+	/** Pops the oldest event.
+	 * Must only be called by the consumer thread.
+	 * @param refEvent [output] The popped event. Unchanged if the queue was empty.
+	 * @return Whether an event was popped.
+	 */
+	inline bool pop(shared_ptr<Event>& refEvent) noexcept
+	{
+		// leaves the slot empty so that the producer doesn't release the event
+		return m_oRing.pop(refEvent);
+	}
+	/** Pops all the events currently in the queue.
+	 * Must only be called by the consumer thread.
+	 * Events pushed while draining are left in the queue.
+	 * @param aEvents [output] The vector the popped events are appended to.
+	 * @return The number of popped events.
+	 */
+	int32_t drain(std::vector< shared_ptr<Event> >& aEvents) noexcept { return m_oRing.drain(aEvents); }
+	/** Whether the queue is empty.
+	 * If called by a thread other than the consumer, the result might already be stale.
+	 * @return Whether empty.
+	 */
+	bool isEmpty() const noexcept { return m_oRing.isEmpty(); }
+	/** The number of events dropped because the queue was full.
+	 * Can be called by any thread.
+	 * @return The number of dropped events.
+	 */
+	int64_t getTotDroppedEvents() const noexcept { return m_nTotDropped.load(std::memory_order_relaxed); }
+private:
+	SpscRing< shared_ptr<Event> > m_oRing;
+	shared_ptr<EventListener> m_refEventListener;
+	std::atomic<int64_t> m_nTotDropped; // Written by the producer
+private:
+	EventQueue(const EventQueue& oSource) = delete;
+	EventQueue& operator=(const EventQueue& oSource) = delete;
+};
+
+} // namespace stmi
+
+#endif /* STMI_EVENT_QUEUE_H */
@@ -29,6 +29,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace stmi { class Accessor; }
@@ -41,11 +42,23 @@ namespace stmi
 ////////////////////////////////////////////////////////////////////////////////
 /** Device manager container class.
  * The contained device managers (the children) must be subclasses of ChildDeviceManager.
+ *
+ * The parent keeps a table mapping each device id to the (non parent) descendant
+ * that owns the device. It is kept current by ChildDeviceManager::notifyDeviceAdded()
+ * and ChildDeviceManager::notifyDeviceRemoved(). The device manager capabilities of the
+ * descendants, which don't change after construction, are also mapped by id in init().
+ *
+ * Children that didn't call ChildDeviceManager::setNotifiesDeviceChanges()
+ * (ex. not derived from BasicDeviceManager) aren't in the routing table: device ids
+ * that aren't found in the table are looked up by asking them directly and their
+ * devices are merged each time getDevices() is called.
  */
 class ParentDeviceManager : public ChildDeviceManager
 {
 public:
 	/** Return the device with the given id.
+	 * The device manager that owns the device is looked up in the routing table.
+	 * If not found the children that don't notify their devices are asked.
 	 * @param nDeviceId The device id.
 	 * @return The device or null if not found.
 	 */
@@ -58,24 +71,70 @@ public:
 	 */
 	shared_ptr<Capability> getCapability(const Capability::Class& oClass) const noexcept override;
 	/** Get a device manager capability by id.
-	 * Queries its children.
+	 * The device manager that owns the capability is looked up in the routing table.
 	 * @param nCapabilityId The id.
 	 * @return The device manager capability or null if not found.
 	 */
 	shared_ptr<Capability> getCapability(int32_t nCapabilityId) const noexcept override;
-	/** The union of the device manager capability classes of all the children. */
+	/** The union of the device manager capability classes of all the children.
+	 * Returns a copy of getCapabilityClassesSnapshot().
+	 */
 	std::vector<Capability::Class> getCapabilityClasses() const noexcept override;
-	/** The union of the device capability classes of all the children's devices. */
+	/** The union of the device capability classes of all the children's devices.
+	 * Returns a copy of getDeviceCapabilityClassesSnapshot().
+	 */
 	std::vector<Capability::Class> getDeviceCapabilityClasses() const noexcept override;
-	/** The union of the event types of all the children. */
+	/** The union of the event types of all the children.
+	 * Returns a copy of getEventClassesSnapshot().
+	 */
 	std::vector<Event::Class> getEventClasses() const noexcept override;
 
-	/** The union of the devices of all the children with a given capability class. */
+	/** The union of the devices of all the children with a given capability class.
+	 * The sorted sets of the children are merged in linear time.
+	 * @return The device ids, sorted in ascending order.
+	 */
 	std::vector<int32_t> getDevicesWithCapabilityClass(const Capability::Class& oCapabilityClass) const noexcept override;
 
-	/** The union of the devices of all the children. */
+	/** The union of the devices of all the children.
+	 * Returns a copy of getDevicesSnapshot().
+	 * @return The device ids, sorted in ascending order.
+	 */
 	std::vector<int32_t> getDevices() const noexcept override;
 
+	/** The union of the device manager capability classes of all the children.
+	 * The set is calculated once in init() since the classes of a device manager don't change.
+	 * @return The shared capability classes. Cannot be null.
+	 */
+	shared_ptr<const std::vector<Capability::Class>> getCapabilityClassesSnapshot() const noexcept
+	{
+		return m_refCapabilityClasses;
+	}
+	/** The union of the device capability classes of all the children's devices.
+	 * The set is calculated once in init() since the classes of a device manager don't change.
+	 * @return The shared device capability classes. Cannot be null.
+	 */
+	shared_ptr<const std::vector<Capability::Class>> getDeviceCapabilityClassesSnapshot() const noexcept
+	{
+		return m_refDeviceCapabilityClasses;
+	}
+	/** The union of the event types of all the children.
+	 * The set is calculated once in init() since the classes of a device manager don't change.
+	 * @return The shared event classes. Cannot be null.
+	 */
+	shared_ptr<const std::vector<Event::Class>> getEventClassesSnapshot() const noexcept
+	{
+		return m_refEventClasses;
+	}
+	/** The union of the devices of all the children.
+	 * The set is cached until a device is added to or removed from a descendant.
+	 * A returned snapshot is never modified: callers can keep it and compare
+	 * it (the pointer) to a new one to know whether the devices have changed.
+	 * If a child doesn't notify its devices (see ChildDeviceManager::setNotifiesDeviceChanges())
+	 * the set isn't cached and a new snapshot is returned by each call.
+	 * @return The shared device ids, sorted in ascending order. Cannot be null.
+	 */
+	shared_ptr<const std::vector<int32_t>> getDevicesSnapshot() const noexcept;
+
 	/** Tells whether an event class is enabled in at least one of the children. */
 	bool isEventClassEnabled(const Event::Class& oEventClass) const noexcept override;
 	/** Calls the function for all the children. */
@@ -130,9 +189,55 @@ protected:
 	void removeChildren() noexcept
 	{
 		m_aChildDeviceManagers.clear();
+		m_aUnnotifyingChildren.clear();
+		m_oDeviceRoutes.clear();
+		m_oCapabilityRoutes.clear();
+		m_refCapabilityClasses = std::make_shared<const std::vector<Capability::Class>>();
+		m_refDeviceCapabilityClasses = std::make_shared<const std::vector<Capability::Class>>();
+		m_refEventClasses = std::make_shared<const std::vector<Event::Class>>();
+		m_refDevices.reset();
 	}
+	/** Called when a device was added to a descendant.
+	 * See ChildDeviceManager::notifyDeviceAdded().
+	 * The default implementation adds the device to the routing table and
+	 * tells the parent. Subclasses can override it to defer the update
+	 * (for example to another thread) but must eventually call this implementation
+	 * from the thread of the parent.
+	 * @param nDeviceId The id of the added device.
+	 * @param p0Owner The descendant (not a parent) that owns the device. Cannot be null.
+	 */
+	virtual void onDescendantDeviceAdded(int32_t nDeviceId, ChildDeviceManager* p0Owner) noexcept;
+	/** Called when a device was removed from a descendant.
+	 * See onDescendantDeviceAdded().
+	 * @param nDeviceId The id of the removed device.
+	 */
+	virtual void onDescendantDeviceRemoved(int32_t nDeviceId) noexcept;
+	/** The device manager the ancestors should route the ids owned by a descendant to.
+	 * By default the ancestors call the owner directly. A subclass that
+	 * has to intercept the calls to its descendants can return itself.
+	 * @param p0Owner The descendant that owns a device or capability. Cannot be null.
+	 * @return The device manager to route to. Cannot be null.
+	 */
+	virtual ChildDeviceManager* getRouteTarget(ChildDeviceManager* p0Owner) noexcept
+	{
+		return p0Owner;
+	}
+private:
+	friend class ChildDeviceManager;
+	void addRoutesOfChild(ChildDeviceManager* p0Child) noexcept;
 private:
 	std::vector< shared_ptr<ChildDeviceManager> > m_aChildDeviceManagers;
+	// The children whose devices (or those of their descendants) might not be in m_oDeviceRoutes
+	std::vector<ChildDeviceManager*> m_aUnnotifyingChildren;
+	// Key: device id, Value: the non parent descendant that owns the device
+	std::unordered_map<int32_t, ChildDeviceManager*> m_oDeviceRoutes;
+	// Key: device manager capability id, Value: the non parent descendant that owns the capability
+	std::unordered_map<int32_t, ChildDeviceManager*> m_oCapabilityRoutes;
+	shared_ptr<const std::vector<Capability::Class>> m_refCapabilityClasses;
+	shared_ptr<const std::vector<Capability::Class>> m_refDeviceCapabilityClasses;
+	shared_ptr<const std::vector<Event::Class>> m_refEventClasses;
+	// Null if it has to be recalculated
+	shared_ptr<const std::vector<int32_t>> m_refDevices;
 private:
 	ParentDeviceManager(const ParentDeviceManager& oSource) = delete;
 	ParentDeviceManager& operator=(const ParentDeviceManager& oSource) = delete;
@@ -0,0 +1,272 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   private-callifprogram.h
+ */
+
+#ifndef STMI_PRIVATE_CALLIF_PROGRAM_H
+#define STMI_PRIVATE_CALLIF_PROGRAM_H
+
+#include <stmm-input/accessor.h>
+#include <stmm-input/capability.h>
+#include <stmm-input/device.h>
+#include <stmm-input/devicemanager.h>
+#include <stmm-input/event.h>
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+
+namespace stmi
+{
+
+namespace Private
+{
+
+/* * A callif expression flattened into an array of instructions.
+ * The instructions are evaluated by a single loop without virtual calls,
+ * except for callifs that cannot be compiled (ex. CallIfFuction), which are
+ * called through CallIf::operator().
+ *
+ * The program keeps raw pointers to the compiled callif tree's nodes and accessors,
+ * therefore the owner must keep a reference to the callif for the lifetime
+ * of the program.
+ *
+ * The result of the last test is held in a boolean register. Conditional jumps
+ * implement the short-circuit evaluation of CallIfAnd and CallIfOr.
+ * An empty program evaluates to `true`.
+ */
+class CallIfProgram final
+{
+public:
+	enum OPCODE : int32_t
+	{
+		OP_FALSE = 0 /* * Register = false. */
+		, OP_TRUE = 1 /* * Register = true. */
+		, OP_NOT = 2 /* * Register = !Register. */
+		, OP_JUMP_IF_FALSE = 3 /* * If !Register jump to m_nArg. */
+		, OP_JUMP_IF_TRUE = 4 /* * If Register jump to m_nArg. */
+		, OP_ACCESSOR = 5 /* * CallIfAccessor, m_p0Arg is the const Accessor* (can be null). */
+		, OP_DEVICE_ID = 6 /* * CallIfDeviceId, m_nArg is the device id (can be -1). */
+		, OP_CAPABILITY_ID = 7 /* * CallIfCapabilityId, m_nArg is the capability id. */
+		, OP_CAPABILITY_CLASS = 8 /* * CallIfCapabilityClass, m_p0Arg is the const Capability::Class*. */
+		, OP_DEVICE_MANAGER_CAPABILITY = 9 /* * CallIfDeviceManagerCapability. */
+		, OP_EVENT_CLASS = 10 /* * CallIfEventClass, m_nArg is the event class index. */
+		, OP_XY_EVENT = 11 /* * CallIfXYEvent. */
+		, OP_CALLIF = 12 /* * Any other callif, m_p0Arg is the const CallIf*. */
+	};
+	struct Instr
+	{
+		OPCODE m_eOp;
+		int32_t m_nArg;
+		const void* m_p0Arg;
+	};
+	/* * Constructs an empty program that always evaluates to `true`. */
+	CallIfProgram() noexcept
+	: m_bHasCallIfInstrs(false)
+	{
+	}
+	/* * Constructs a program from its instructions.
+	 * @see CallIfCompiler::compile()
+	 */
+	explicit CallIfProgram(std::vector<Instr>&& aInstrs) noexcept
+	: m_aInstrs(std::move(aInstrs))
+	, m_bHasCallIfInstrs(false)
+	{
+		for (const Instr& oInstr : m_aInstrs) {
+			if (oInstr.m_eOp == OP_CALLIF) {
+				m_bHasCallIfInstrs = true;
+				break; // for
+			}
+		}
+	}
+	/* * Whether the program evaluates to `true` for all events. */
+	inline bool isAlwaysTrue() const noexcept
+	{
+		return m_aInstrs.empty();
+	}
+	/* * Whether the program evaluates to `false` for all events. */
+	inline bool isAlwaysFalse() const noexcept
+	{
+		return (m_aInstrs.size() == 1) && (m_aInstrs[0].m_eOp == OP_FALSE);
+	}
+	/* * The instructions. */
+	inline const std::vector<Instr>& getInstrs() const noexcept
+	{
+		return m_aInstrs;
+	}
+	/* * Whether the program contains callifs that have to be called through CallIf::operator().
+	 * If `false` eval(const Event&) can be used.
+	 */
+	inline bool hasCallIfInstrs() const noexcept
+	{
+		return m_bHasCallIfInstrs;
+	}
+	/* * Evaluate the program.
+	 * @param refEvent The event. Cannot be null.
+	 * @return Whether the event satisfies the compiled callif.
+	 */
+	inline bool eval(const shared_ptr<Event>& refEvent) const noexcept
+	{
+		assert(refEvent);
+		return evalCommon(*refEvent, &refEvent);
+	}
+	/* * Evaluate the program without a shared_ptr to the event.
+	 * Does no reference counting if the event has the capability data cached
+	 * (see Event::hasCapabilityData()).
+	 * Can only be called if hasCallIfInstrs() is `false`.
+	 * @param oEvent The event.
+	 * @return Whether the event satisfies the compiled callif.
+	 */
+	inline bool eval(const Event& oEvent) const noexcept
+	{
+		assert(!m_bHasCallIfInstrs);
+		return evalCommon(oEvent, nullptr);
+	}
+private:
+	bool evalCommon(const Event& oEvent, const shared_ptr<Event>* p0RefEvent) const noexcept
+	{
+		const int32_t nTotInstrs = static_cast<int32_t>(m_aInstrs.size());
+		const Instr* p0Instrs = m_aInstrs.data();
+		bool bRes = true;
+		int32_t nPC = 0;
+		while (nPC < nTotInstrs) {
+			const Instr& oInstr = p0Instrs[nPC];
+			switch (oInstr.m_eOp) {
+			case OP_FALSE:
+				bRes = false;
+				break;
+			case OP_TRUE:
+				bRes = true;
+				break;
+			case OP_NOT:
+				bRes = !bRes;
+				break;
+			case OP_JUMP_IF_FALSE:
+				if (!bRes) {
+					nPC = oInstr.m_nArg;
+					continue; // while
+				}
+				break;
+			case OP_JUMP_IF_TRUE:
+				if (bRes) {
+					nPC = oInstr.m_nArg;
+					continue; // while
+				}
+				break;
+			case OP_ACCESSOR:
+				bRes = evalAccessor(oEvent, static_cast<const Accessor*>(oInstr.m_p0Arg));
+				break;
+			case OP_DEVICE_ID:
+				bRes = evalDeviceId(oEvent, oInstr.m_nArg);
+				break;
+			case OP_CAPABILITY_ID:
+				bRes = (oEvent.getCapabilityId() == oInstr.m_nArg);
+				break;
+			case OP_CAPABILITY_CLASS:
+				bRes = evalCapabilityClass(oEvent, *static_cast<const Capability::Class*>(oInstr.m_p0Arg));
+				break;
+			case OP_DEVICE_MANAGER_CAPABILITY:
+				bRes = evalDeviceManagerCapability(oEvent);
+				break;
+			case OP_EVENT_CLASS:
+				bRes = (oEvent.getEventClass().getIndex() == oInstr.m_nArg);
+				break;
+			case OP_XY_EVENT:
+				bRes = oEvent.getEventClass().isXYEvent();
+				break;
+			case OP_CALLIF:
+				assert(p0RefEvent != nullptr);
+				bRes = (*static_cast<const CallIf*>(oInstr.m_p0Arg))(*p0RefEvent);
+				break;
+			default:
+				assert(false);
+				break;
+			}
+			++nPC;
+		}
+		return bRes;
+	}
+	static inline bool evalAccessor(const Event& oEvent, const Accessor* p0Accessor) noexcept
+	{
+		const Accessor* p0OtherAccessor = oEvent.getAccessor().get();
+		const bool bMemberNull = (p0Accessor == nullptr);
+		const bool bOtherNull = (p0OtherAccessor == nullptr);
+		if (bOtherNull || bMemberNull) {
+			// if both null, it's a match!
+			return (bMemberNull == bOtherNull);
+		}
+		return ((*p0Accessor) == (*p0OtherAccessor));
+	}
+	static inline bool evalDeviceId(const Event& oEvent, int32_t nDeviceId) noexcept
+	{
+		if (oEvent.hasCapabilityData()) {
+			const int32_t nEventDeviceId = oEvent.getDeviceId();
+			if (nDeviceId < 0) {
+				return (nEventDeviceId < 0); //---------------------------------
+			}
+			return (nEventDeviceId == nDeviceId); //----------------------------
+		}
+		const shared_ptr<Capability> refCapability = oEvent.getCapability();
+		if (!refCapability) {
+			// capability was deleted
+			return false; //----------------------------------------------------
+		}
+		const shared_ptr<Device> refDevice = refCapability->getDevice();
+		const bool bDeviceIsNull = !refDevice;
+		if (nDeviceId < 0) {
+			return bDeviceIsNull; //--------------------------------------------
+		}
+		if (bDeviceIsNull) {
+			return false; //----------------------------------------------------
+		}
+		return (refDevice->getId() == nDeviceId);
+	}
+	static inline bool evalCapabilityClass(const Event& oEvent, const Capability::Class& oClass) noexcept
+	{
+		if (oEvent.hasCapabilityData()) {
+			return (oClass == oEvent.getCapabilityClass()); //------------------
+		}
+		const shared_ptr<Capability> refCapability = oEvent.getCapability();
+		if (!refCapability) {
+			return false;
+		}
+		return (oClass == refCapability->getCapabilityClass());
+	}
+	static inline bool evalDeviceManagerCapability(const Event& oEvent) noexcept
+	{
+		if (oEvent.hasCapabilityData()) {
+			return oEvent.getCapabilityClass().isDeviceManagerCapability(); //--
+		}
+		const shared_ptr<Capability> refCapability = oEvent.getCapability();
+		if (!refCapability) {
+			return false;
+		}
+		return refCapability->getCapabilityClass().isDeviceManagerCapability();
+	}
+private:
+	std::vector<Instr> m_aInstrs;
+	bool m_bHasCallIfInstrs;
+};
+
+} // namespace Private
+
+} // namespace stmi
+
+#endif /* STMI_PRIVATE_CALLIF_PROGRAM_H */
@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   spscring.h
+ */
+
+#ifndef STMI_SPSC_RING_H
+#define STMI_SPSC_RING_H
+
+#include <vector>
+#include <atomic>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+
+
+namespace stmi
+{
+
+/** Bounded lock-free single producer single consumer ring buffer.
+ * There must be exactly one producer thread, calling push() and getTotFree(),
+ * and one consumer thread, calling pop() and drain(). Both push and pop are wait-free.
+ *
+ * Popped values are moved out of their slot, so that for example
+ * a shared_ptr is released by the consumer, not by the producer.
+ */
+template <class T>
+class SpscRing final
+{
+public:
+	/** Constructor.
+	 * @param nMinCapacity The minimum number of values the ring can hold. Must be &gt; 0.
+	 *                     The capacity is rounded up to a power of 2.
+	 */
+	explicit SpscRing(int32_t nMinCapacity) noexcept
+	: m_nCapacity(calcCapacity(nMinCapacity))
+	, m_nMask(m_nCapacity - 1)
+	, m_aSlots(m_nCapacity)
+	, m_nHead(0)
+	, m_nTail(0)
+	{
+	}
+	/** The maximum number of values the ring can hold.
+	 * @return The capacity. Is a power of 2.
+	 */
+	int32_t getCapacity() const noexcept { return static_cast<int32_t>(m_nCapacity); }
+	/** Pushes a value.
+	 * Must only be called by the producer thread.
+	 * @param oValue The value.
+	 * @return Whether the value was pushed, `false` if the ring was full.
+	 */
+	inline bool push(const T& oValue) noexcept
+	{
+		const uint32_t nTail = m_nTail.load(std::memory_order_relaxed);
+		const uint32_t nHead = m_nHead.load(std::memory_order_acquire);
+		if (nTail - nHead >= m_nCapacity) {
+			return false; //----------------------------------------------------
+		}
+		m_aSlots[nTail & m_nMask] = oValue;
+		m_nTail.store(nTail + 1, std::memory_order_release);
+		return true;
+	}
+	/** Pushes a value by moving it.
+	 * Must only be called by the producer thread.
+	 * @param oValue The value. Only moved from if pushed.
+	 * @return Whether the value was pushed, `false` if the ring was full.
+	 */
+	inline bool push(T&& oValue) noexcept
+	{
+		const uint32_t nTail = m_nTail.load(std::memory_order_relaxed);
+		const uint32_t nHead = m_nHead.load(std::memory_order_acquire);
+		if (nTail - nHead >= m_nCapacity) {
+			return false; //----------------------------------------------------
+		}
+		m_aSlots[nTail & m_nMask] = std::move(oValue);
+		m_nTail.store(nTail + 1, std::memory_order_release);
+		return true;
+	}
+	/** The number of values that can be pushed before the ring is full.
+	 * Must only be called by the producer thread. The consumer can only increase it.
+	 * @return The number of free slots.
+	 */
+	inline int32_t getTotFree() const noexcept
+	{
+		const uint32_t nTail = m_nTail.load(std::memory_order_relaxed);
+		const uint32_t nHead = m_nHead.load(std::memory_order_acquire);
+		return static_cast<int32_t>(m_nCapacity - (nTail - nHead));
+	}
+	/** Pops the oldest value.
+	 * Must only be called by the consumer thread.
+	 * @param oValue [output] The popped value. Unchanged if the ring was empty.
+	 * @return Whether a value was popped.
+	 */
+	inline bool pop(T& oValue) noexcept
+	{
+		const uint32_t nHead = m_nHead.load(std::memory_order_relaxed);
+		const uint32_t nTail = m_nTail.load(std::memory_order_acquire);
+		if (nHead == nTail) {
+			return false; //----------------------------------------------------
+		}
+		oValue = std::move(m_aSlots[nHead & m_nMask]);
+		m_nHead.store(nHead + 1, std::memory_order_release);
+		return true;
+	}
+	/** Pops all the values currently in the ring.
+	 * Must only be called by the consumer thread.
+	 * Values pushed while draining are left in the ring.
+	 * @param aValues [output] The vector the popped values are appended to.
+	 * @return The number of popped values.
+	 */
+	int32_t drain(std::vector<T>& aValues) noexcept
+	{
+		const uint32_t nHead = m_nHead.load(std::memory_order_relaxed);
+		const uint32_t nTail = m_nTail.load(std::memory_order_acquire);
+		for (uint32_t nIdx = nHead; nIdx != nTail; ++nIdx) {
+			aValues.push_back(std::move(m_aSlots[nIdx & m_nMask]));
+		}
+		m_nHead.store(nTail, std::memory_order_release);
+		return static_cast<int32_t>(nTail - nHead);
+	}
+	/** Whether the ring is empty.
+	 * If called by a thread other than the consumer, the result might already be stale.
+	 * @return Whether empty.
+	 */
+	bool isEmpty() const noexcept
+	{
+		return (m_nHead.load(std::memory_order_acquire) == m_nTail.load(std::memory_order_acquire));
+	}
+private:
+	static uint32_t calcCapacity(int32_t nMinCapacity) noexcept
+	{
+		assert((nMinCapacity > 0) && (nMinCapacity <= (1 << 30)));
+		uint32_t nCapacity = 1;
+		while (nCapacity < static_cast<uint32_t>(nMinCapacity)) {
+			nCapacity <<= 1;
+		}
+		return nCapacity;
+	}
+private:
+	const uint32_t m_nCapacity;
+	const uint32_t m_nMask; // m_nCapacity - 1
+	std::vector<T> m_aSlots; // Size: m_nCapacity
+	// The padding keeps the indexes written by different threads in different cache lines
+	char m_aPad0[64];
+	std::atomic<uint32_t> m_nHead; // Written by the consumer: the next slot to pop
+	char m_aPad1[64];
+	std::atomic<uint32_t> m_nTail; // Written by the producer: the next slot to push
+	char m_aPad2[64];
+private:
+	SpscRing(const SpscRing& oSource) = delete;
+	SpscRing& operator=(const SpscRing& oSource) = delete;
+};
+
+} // namespace stmi
+
+#endif /* STMI_SPSC_RING_H */
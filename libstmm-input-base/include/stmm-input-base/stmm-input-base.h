@@ -26,8 +26,13 @@
 #include "basicdevice.h"
 #include "basicdevicemanager.h"
 #include "childdevicemanager.h"
+#include "clockdomain.h"
+#include "eventbatcher.h"
+#include "eventqueue.h"
 #include "parentdevicemanager.h"
+#include "spscring.h"
 #include "stmm-input-base-config.h"
+#include "threadedchilddevicemanager.h"
 
 #include <stmm-input/stmm-input.h>
 
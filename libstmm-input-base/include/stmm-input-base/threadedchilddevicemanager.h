@@ -0,0 +1,302 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   threadedchilddevicemanager.h
+ */
+
+#ifndef STMI_THREADED_CHILD_DEVICE_MANAGER_H
+#define STMI_THREADED_CHILD_DEVICE_MANAGER_H
+
+#include "parentdevicemanager.h"
+#include "spscring.h"
+
+#include <stmm-input/capability.h>
+#include <stmm-input/devicemanager.h>
+#include <stmm-input/event.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stmi { class Accessor; }
+namespace stmi { class Device; }
+
+namespace stmi
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/** Runs a child device manager in its own thread.
+ * The inner child device manager is created, driven and destroyed by a
+ * dedicated worker thread, so that it can poll its hardware without
+ * stalling the thread of the caller (the main thread, ex. the Gtk main loop).
+ * Several instances decode their events in parallel.
+ *
+ * The main thread never waits for the worker thread, except in addAccessor()
+ * and removeAccessor() which need the answer of the inner device manager.
+ * Adding and removing listeners and enabling event classes are posted to
+ * the worker thread, the queries are answered from data mirrored in the main thread.
+ *
+ * The events the inner device manager sends to the listeners and the devices
+ * it adds and removes are pushed, in the order they happened, into a lock-free
+ * single producer single consumer ring (see SpscRing) and the owner of
+ * the main thread is told through Init::m_oWakeup that it has to call
+ * dispatchEvents(). A Glib based application can for example emit
+ * a Glib::Dispatcher connected to dispatchEvents().
+ * When the ring is full the items go to an overflow vector protected by
+ * a mutex, until the main thread has emptied it. Nothing is ever dropped:
+ * neither the events (ex. key releases and those sent to finalize a removed
+ * listener) nor the device changes.
+ *
+ * dispatchEvents() sends the events interleaved across listeners in the order
+ * the inner device manager sent them, not grouped by listener. The devices
+ * are mirrored in the main thread, so that getDevice() and getDevices() don't
+ * need to access the inner device manager. Each device addition or removal is
+ * applied to the mirror at its position among the events: while the events sent
+ * before a removal are dispatched the device can still be retrieved.
+ *
+ * The inner device manager must call ChildDeviceManager::setNotifiesDeviceChanges()
+ * (BasicDeviceManager subclasses do).
+ *
+ * The device, capability and event objects are shared by both threads.
+ * Listeners (and any other code in the main thread) may only call:
+ * - the getters of the events (which are not modified once sent),
+ * - Device::getId(), Device::getName(), Device::getCapability(),
+ *   Device::getCapabilities() and Device::getCapabilityClasses(), which for
+ *   BasicDevice subclasses only read data that doesn't change after construction,
+ * - Capability::getId(), Capability::getClass() and Capability::getDevice().
+ *
+ * They must not call the functions that read state written by the worker thread:
+ * - the state getters of the capabilities (ex. JoystickCapability::isButtonPressed(),
+ *   JoystickCapability::getHatValue(), JoystickCapability::getAxisValue(),
+ *   JoystickCapability::getState()); the state has to be tracked from the events
+ *   or read in the worker thread with post(),
+ * - Device::getDeviceManager() and any function of the inner device manager
+ *   or of its descendants, including ChildDeviceManager::getParent() and
+ *   ChildDeviceManager::getRoot(); use this instance or its root instead.
+ *
+ * Apart from the functions explicitly marked otherwise, all functions must be
+ * called from the main thread.
+ */
+class ThreadedChildDeviceManager : public ParentDeviceManager
+{
+public:
+	/** Initialization data. */
+	struct Init
+	{
+		/** Creates the inner device manager. Called once in the worker thread.
+		 * Must not return null. Cannot be empty. */
+		std::function<shared_ptr<ChildDeviceManager>()> m_oCreate;
+		/** Drives the inner device manager, called repeatedly in the worker thread.
+		 * It can poll the hardware, but should block for at most a few milliseconds
+		 * since the functions posted to the worker thread are executed in between.
+		 * If empty the worker thread only executes the posted functions. */
+		std::function<void(ChildDeviceManager& oInner)> m_oIterate;
+		/** Called from the worker thread when dispatchEvents() should be called.
+		 * It is not called again until dispatchEvents() is. Must not block.
+		 * Cannot be empty. */
+		std::function<void()> m_oWakeup;
+		/** The minimum capacity of the lock-free ring. Default: 1024.
+		 * The items that don't fit go to the (slower) overflow vector. */
+		int32_t m_nQueueCapacity = 1024;
+	};
+	/** Creates an instance.
+	 * Starts the worker thread and waits for the inner device manager to be created.
+	 * @param oInit The initialization data.
+	 * @return The created device manager and an empty string or null and an error if creation failed.
+	 */
+	static std::pair<shared_ptr<ThreadedChildDeviceManager>, std::string> create(Init&& oInit) noexcept;
+	/** Stops and joins the worker thread.
+	 * The inner device manager is destroyed in the worker thread.
+	 */
+	virtual ~ThreadedChildDeviceManager() noexcept;
+
+	/** Sends the queued events to the listeners.
+	 * Must be called by the main thread after Init::m_oWakeup was called.
+	 * Device additions and removals are applied to the mirror at their
+	 * position among the events. Can be called recursively by a listener.
+	 * @return The number of events sent.
+	 */
+	int32_t dispatchEvents() noexcept;
+	/** Executes a function in the worker thread.
+	 * Returns immediately. Can be called from any thread.
+	 * The posted functions are executed in the order they were posted.
+	 * @param oFunc The function. Is passed the inner device manager. Cannot be empty.
+	 */
+	void post(std::function<void(ChildDeviceManager& oInner)>&& oFunc) noexcept;
+	/** The number of items that didn't fit in the ring since creation.
+	 * If often non zero, Init::m_nQueueCapacity should be increased.
+	 * @return The number of items that went through the overflow vector.
+	 */
+	int64_t getTotOverflowItems() const noexcept;
+
+	/** The device from the mirror of the devices of the inner device manager. */
+	shared_ptr<Device> getDevice(int32_t nDeviceId) const noexcept override;
+	/** The devices of the mirror that have the given capability class. */
+	std::vector<int32_t> getDevicesWithCapabilityClass(const Capability::Class& oCapabilityClass) const noexcept override;
+
+	/** Returns the device manager capability cached at creation. */
+	shared_ptr<Capability> getCapability(const Capability::Class& oClass) const noexcept override;
+	/** Returns the device manager capability cached at creation. */
+	shared_ptr<Capability> getCapability(int32_t nCapabilityId) const noexcept override;
+	/** Returns the device manager capabilities cached at creation. */
+	std::vector<shared_ptr<Capability>> getDeviceManagerCapabilities(const Capability::Class& oClass) const noexcept override;
+
+	/** Answered from the enabled classes mirrored in the main thread.
+	 * The classes are read from the inner device manager at creation and
+	 * then only changed through enableEventClass().
+	 */
+	bool isEventClassEnabled(const Event::Class& oEventClass) const noexcept override;
+	/** Enables the class in the mirror and posts the call to the worker thread. */
+	void enableEventClass(const Event::Class& oEventClass) noexcept override;
+
+	/** Executed in the worker thread, waits for the result. */
+	bool addAccessor(const shared_ptr<Accessor>& refAccessor) noexcept override;
+	/** Executed in the worker thread, waits for the result. */
+	bool removeAccessor(const shared_ptr<Accessor>& refAccessor) noexcept override;
+	/** Whether the accessor was successfully added with addAccessor() and not yet removed.
+	 * Answered from the main thread's mirror.
+	 */
+	bool hasAccessor(const shared_ptr<Accessor>& refAccessor) noexcept override;
+
+	/** Adds a listener.
+	 * The addition to the inner device manager is posted to the worker thread.
+	 * The listener is actually called by dispatchEvents().
+	 * @return Whether added, `false` if it already was.
+	 */
+	bool addEventListener(const shared_ptr<EventListener>& refEventListener, const shared_ptr<CallIf>& refCallIf) noexcept override;
+	/** Adds a listener.
+	 * See addEventListener(const shared_ptr<EventListener>&, const shared_ptr<CallIf>&).
+	 */
+	bool addEventListener(const shared_ptr<EventListener>& refEventListener) noexcept override;
+	/** Removes a listener.
+	 * The events already queued are dispatched (to all listeners) before
+	 * the listener is removed. The removal from the inner device manager
+	 * is posted to the worker thread. From then on the listener only receives,
+	 * through dispatchEvents(), the events sent to it because of bFinalize.
+	 * @return Whether removed, `false` if it wasn't added.
+	 */
+	bool removeEventListener(const shared_ptr<EventListener>& refEventListener, bool bFinalize) noexcept override;
+	/** Removes a listener.
+	 * See removeEventListener(const shared_ptr<EventListener>&, bool).
+	 */
+	bool removeEventListener(const shared_ptr<EventListener>& refEventListener) noexcept override;
+
+protected:
+	explicit ThreadedChildDeviceManager(Init&& oInit) noexcept;
+
+	/** Queued if called from the worker thread, applied by dispatchEvents() in order with the events. */
+	void onDescendantDeviceAdded(int32_t nDeviceId, ChildDeviceManager* p0Owner) noexcept override;
+	/** Queued if called from the worker thread, applied by dispatchEvents() in order with the events. */
+	void onDescendantDeviceRemoved(int32_t nDeviceId) noexcept override;
+	/** Returns this instance since the inner device manager must not be called directly. */
+	ChildDeviceManager* getRouteTarget(ChildDeviceManager* p0Owner) noexcept override;
+private:
+	std::string start() noexcept;
+	void run() noexcept;
+	// Executes the function in the worker thread and waits for it to complete
+	void runInWorker(const std::function<void(ChildDeviceManager& oInner)>& oFunc) const noexcept;
+	bool addListenerEntry(const shared_ptr<EventListener>& refEventListener, const shared_ptr<CallIf>& refCallIf
+							, bool bWithCallIf) noexcept;
+	void cacheCapabilities() noexcept;
+
+	enum LISTENER_STATE
+	{
+		LISTENER_STATE_ACTIVE = 0
+		, LISTENER_STATE_FINALIZING = 1 // Only receives the finalize events
+		, LISTENER_STATE_REMOVED = 2
+	};
+	struct ListenerEntry
+	{
+		weak_ptr<EventListener> m_refEventListener;
+		EventListener* m_p0EventListener; // Identifies the listener also if expired
+		shared_ptr<EventListener> m_refWorkerListener; // Added to the inner device manager, queues the events
+		LISTENER_STATE m_eState = LISTENER_STATE_ACTIVE; // Main thread only
+	};
+	struct QueuedItem
+	{
+		shared_ptr<ListenerEntry> m_refEntry; // Null if a device change
+		shared_ptr<Event> m_refEvent; // Null if a device change
+		bool m_bFinalize = false; // Whether the event was sent because the listener is being removed
+		int32_t m_nDeviceId = -1; // The added or removed device if a device change
+		shared_ptr<Device> m_refDevice; // Null if a device was removed
+		ChildDeviceManager* m_p0Owner = nullptr; // The owner of the added device
+	};
+	// Called by the worker thread
+	void pushItem(QueuedItem&& oItem) noexcept;
+	void maybeWakeup() noexcept;
+	// Called by the main thread
+	void popItems() noexcept;
+	int32_t sendQueuedItems() noexcept;
+	void applyDeviceChange(const QueuedItem& oItem) noexcept;
+	void removeEntry(const shared_ptr<ListenerEntry>& refEntry, bool bFinalize) noexcept;
+private:
+	Init m_oInit;
+	std::thread m_oThread;
+	std::thread::id m_oWorkerThreadId;
+	// Only accessed by the worker thread (except during create())
+	shared_ptr<ChildDeviceManager> m_refInner;
+	// Only accessed by the worker thread
+	bool m_bWorkerPushed; // Whether items were pushed since the last wakeup
+	ListenerEntry* m_p0WorkerFinalizingEntry; // The listener being removed with bFinalize or null
+
+	// The items from the worker thread to the main thread
+	SpscRing<QueuedItem> m_oRing;
+	// Set by the worker thread when it pushes to m_aOverflowItems, cleared by the main thread
+	// when it empties it. While set the worker thread doesn't push to the ring.
+	std::atomic<bool> m_bOverflowing;
+
+	// Protects the fields below
+	mutable std::mutex m_oMutex;
+	mutable std::condition_variable m_oWorkerCond; // Signaled when there is something for the worker thread
+	mutable std::condition_variable m_oDoneCond; // Signaled when marshalled functions were executed
+	mutable std::vector< std::function<void(ChildDeviceManager& oInner)> > m_aTasks;
+	mutable uint64_t m_nTotPostedTasks;
+	mutable uint64_t m_nTotDoneTasks;
+	bool m_bInnerCreated;
+	bool m_bStarted; // Set by create() after init(), the worker waits for it
+	bool m_bStopping;
+	// The items that didn't fit in m_oRing, in order
+	std::vector<QueuedItem> m_aOverflowItems;
+	int64_t m_nTotOverflowItems;
+
+	std::atomic<bool> m_bWakeupPending;
+
+	// Main thread only
+	std::vector< shared_ptr<ListenerEntry> > m_aListenerEntries;
+	// The items being dispatched, those before m_nNextDispatchItem were already sent
+	std::vector<QueuedItem> m_aDispatchItems;
+	size_t m_nNextDispatchItem;
+	std::unordered_map<int32_t, shared_ptr<Device>> m_oDevices; // The mirror
+	std::vector<Event::Class> m_aEnabledEventClasses; // The mirror
+	std::vector< shared_ptr<Accessor> > m_aAccessors; // The mirror
+	std::vector< std::pair<Capability::Class, std::vector< shared_ptr<Capability> > > > m_aCapabilities;
+private:
+	ThreadedChildDeviceManager(const ThreadedChildDeviceManager& oSource) = delete;
+	ThreadedChildDeviceManager& operator=(const ThreadedChildDeviceManager& oSource) = delete;
+};
+
+} // namespace stmi
+
+#endif /* STMI_THREADED_CHILD_DEVICE_MANAGER_H */
@@ -20,6 +20,7 @@
 
 #include "basicdevicemanager.h"
 
+#include "callifcompiler.h"
 #include "callifsimplifier.h"
 #include "utilbase.h"
 
@@ -39,7 +40,7 @@
 namespace stmi
 {
 
-uint64_t BasicDeviceManager::s_nUniqueTimeStamp = 0;
+std::atomic<uint64_t> BasicDeviceManager::s_nUniqueTimeStamp(0);
 
 BasicDeviceManager::BasicDeviceManager(const std::vector<Capability::Class>& aCapabitityClasses
 									 , const std::vector<Capability::Class>& aDeviceCapabitityClasses
@@ -49,12 +50,15 @@ BasicDeviceManager::BasicDeviceManager(const std::vector<Capability::Class>& aCa
 , m_aCapabitityClasses(aCapabitityClasses)
 , m_aDeviceCapabitityClasses(aDeviceCapabitityClasses)
 , m_aEventClasses(aEventClasses)
-, m_aEventClassEnabled(aEventClasses.size(), !bEnableEventClasses)
-, m_refListeners(std::make_shared< std::list< ListenerData* > >())
+, m_aEventClassEnabledMask((aEventClasses.size() + 63) / 64)
+, m_aCapabilityClassDevices(aDeviceCapabitityClasses.size())
+, m_refListeners(std::make_shared< std::vector< ListenerData* > >())
+, m_aClassListeners(aEventClasses.size())
 , m_nListenerListRecursing(0)
 , m_bListenerListDirty(false)
 {
 //std::cout << "BasicDeviceManager::BasicDeviceManager() " << reinterpret_cast<int64_t>(this) << '\n';
+	setNotifiesDeviceChanges();
 	// Make sure no class duplicates are passed
 	for (size_t nIdx = 0; nIdx < m_aCapabitityClasses.size(); ++nIdx) {
 		for (size_t nIdx2 = 0; nIdx2 < m_aCapabitityClasses.size(); ++nIdx2) {
@@ -79,12 +83,25 @@ BasicDeviceManager::BasicDeviceManager(const std::vector<Capability::Class>& aCa
 			}
 		}
 	}
+	const int32_t nTotEventClasses = static_cast<int32_t>(m_aEventClasses.size());
+	for (int32_t nIdx = 0; nIdx < nTotEventClasses; ++nIdx) {
+		const int32_t nRegisteredIdx = m_aEventClasses[nIdx].getIndex();
+		assert(nRegisteredIdx >= 0);
+		if (nRegisteredIdx >= static_cast<int32_t>(m_aEventClassIndex.size())) {
+			m_aEventClassIndex.resize(nRegisteredIdx + 1, -1);
+		}
+		m_aEventClassIndex[nRegisteredIdx] = nIdx;
+	}
+	std::vector<bool> aEventClassEnabled(nTotEventClasses, !bEnableEventClasses);
 	for (auto& oEventClass : aEnDisableEventClasses) {
-		for (size_t nIdx = 0; nIdx < m_aEventClasses.size(); ++nIdx) {
-			if (m_aEventClasses[nIdx] == oEventClass) {
-				m_aEventClassEnabled[nIdx] = bEnableEventClasses;
-				break; // for(nIdx)
-			}
+		const int32_t nIdx = getEventClassIndex(oEventClass);
+		if (nIdx >= 0) {
+			aEventClassEnabled[nIdx] = bEnableEventClasses;
+		}
+	}
+	for (int32_t nIdx = 0; nIdx < nTotEventClasses; ++nIdx) {
+		if (aEventClassEnabled[nIdx]) {
+			m_aEventClassEnabledMask[nIdx / 64].fetch_or(uint64_t{1} << (nIdx % 64), std::memory_order_relaxed);
 		}
 	}
 	#ifndef NDEBUG
@@ -114,53 +131,115 @@ std::vector<int32_t> BasicDeviceManager::getDevicesWithCapabilityClass(const Cap
 		// not registered
 		return aSet; //---------------------------------------------------------
 	}
+	const int32_t nTotDeviceCapabilityClasses = static_cast<int32_t>(m_aDeviceCapabitityClasses.size());
+	for (int32_t nIdx = 0; nIdx < nTotDeviceCapabilityClasses; ++nIdx) {
+		if (m_aDeviceCapabitityClasses[nIdx] == oCapabilityClass) {
+			return m_aCapabilityClassDevices[nIdx]; //--------------------------
+		}
+	}
+	// Not one of the declared classes
 	for (auto& oPair : m_oDevices) {
 		const int32_t nDeviceId = oPair.first;
 		const shared_ptr<Device>& refDevice = oPair.second;
 		shared_ptr<Capability> refCapability = refDevice->getCapability(oCapabilityClass);
 		if (refCapability) {
-			Util::addToVectorSet(aSet, nDeviceId);
+			aSet.push_back(nDeviceId);
 		}
 	}
+	std::sort(aSet.begin(), aSet.end());
 	return aSet;
 }
 std::vector<int32_t> BasicDeviceManager::getDevices() const noexcept
 {
 	std::vector<int32_t> aSet;
+	aSet.reserve(m_oDevices.size());
 	for (auto& oPair : m_oDevices) {
-		Util::addToVectorSet(aSet, oPair.first);
+		aSet.push_back(oPair.first);
 	}
+	std::sort(aSet.begin(), aSet.end());
 	return aSet;
 }
-shared_ptr< const std::list< BasicDeviceManager::ListenerData* > > BasicDeviceManager::getListeners() noexcept
+shared_ptr< const std::vector< BasicDeviceManager::ListenerData* > > BasicDeviceManager::getListeners() noexcept
 {
+	if ((!m_aPendingListeners.empty()) && (m_refListeners.use_count() == 1)) {
+		addPendingListeners();
+	}
 	return m_refListeners;
 }
+shared_ptr< const std::vector< BasicDeviceManager::ListenerData* > > BasicDeviceManager::getListeners(int32_t nClassTypeIdx) noexcept
+{
+	assert((nClassTypeIdx >= 0) && (nClassTypeIdx < static_cast<int32_t>(m_aClassListeners.size())));
+	if ((!m_aPendingListeners.empty()) && (m_refListeners.use_count() == 1)) {
+		addPendingListeners();
+	}
+	// aliasing constructor: holding the vector is the same as holding m_refListeners
+	return shared_ptr< const std::vector< ListenerData* > >(m_refListeners, &(m_aClassListeners[nClassTypeIdx]));
+}
+BasicDeviceManager::ListenerData* BasicDeviceManager::findListenerData(const EventListener* p0EventListener) noexcept
+{
+	auto itFind = m_oListenerSlots.find(p0EventListener);
+	if (itFind == m_oListenerSlots.end()) {
+		return nullptr; //------------------------------------------------------
+	}
+	const SlotRef& oSlotRef = itFind->second;
+	ListenerData& oListenerData = m_oListenersData[oSlotRef.m_nSlot];
+	if ((oListenerData.m_nGeneration != oSlotRef.m_nGeneration) || oListenerData.m_bListenerWasRemoved) {
+		// stale: the slot was reused or the listener was removed because
+		// its weak_ptr expired (the address might have been recycled)
+		m_oListenerSlots.erase(itFind);
+		return nullptr; //------------------------------------------------------
+	}
+	assert(oListenerData.m_p0EventListener == p0EventListener);
+	return &oListenerData;
+}
+void BasicDeviceManager::addToListeners(ListenerData& oListenerData) noexcept
+{
+	m_refListeners->push_back(&oListenerData);
+	const int32_t nTotEventClasses = static_cast<int32_t>(m_aClassListeners.size());
+	for (int32_t nClassIdx = 0; nClassIdx < nTotEventClasses; ++nClassIdx) {
+		if (!oListenerData.m_aCallIfProgram[nClassIdx].isAlwaysFalse()) {
+			m_aClassListeners[nClassIdx].push_back(&oListenerData);
+		}
+	}
+}
+void BasicDeviceManager::addPendingListeners() noexcept
+{
+	assert(m_refListeners.use_count() == 1);
+	for (ListenerData* p0ListenerData : m_aPendingListeners) {
+		if (!p0ListenerData->m_bListenerWasRemoved) {
+			addToListeners(*p0ListenerData);
+		}
+	}
+	m_aPendingListeners.clear();
+}
 bool BasicDeviceManager::addEventListener(const shared_ptr<EventListener>& refEventListener, const shared_ptr<CallIf>& refCallIf) noexcept
 {
 	assert(refEventListener);
 	auto p0EventListener = refEventListener.get();
-	auto itFind = std::find_if(m_oListenersData.begin(), m_oListenersData.end()
-			, [p0EventListener](const ListenerData& oListenerData) {
-				return ((oListenerData.m_p0EventListener == p0EventListener)
-					&& !oListenerData.m_bListenerWasRemoved);
-			});
-	if (itFind != m_oListenersData.end()) {
+	if (findListenerData(p0EventListener) != nullptr) {
 		// the listener was already added (and not removed)
 		return false; //--------------------------------------------------------
 	}
 	maybeRemoveDataOfRemovedListeners();
 
-	auto itListenerData = m_oListenersData.emplace(m_oListenersData.end());
-	ListenerData& oListenerData = *itListenerData;
-	auto itListeners = m_refListeners->emplace(m_refListeners->end(), &oListenerData);
+	int32_t nSlot;
+	if (m_aFreeSlots.empty()) {
+		nSlot = static_cast<int32_t>(m_oListenersData.size());
+		m_oListenersData.emplace_back();
+	} else {
+		nSlot = m_aFreeSlots.back();
+		m_aFreeSlots.pop_back();
+	}
+	ListenerData& oListenerData = m_oListenersData[nSlot];
+	assert(oListenerData.m_p0EventListener == nullptr);
+	m_oListenerSlots[p0EventListener] = SlotRef{nSlot, oListenerData.m_nGeneration};
 
 	oListenerData.m_p1Owner = this;
 	oListenerData.m_refEventListener = refEventListener;
 	oListenerData.m_nAddedTimeStamp = BasicDeviceManager::getUniqueTimeStamp();
 	oListenerData.m_refCallIf = refCallIf;
 	oListenerData.m_p0EventListener = p0EventListener;
-	oListenerData.m_itListeners = itListeners;
+	oListenerData.m_nSlot = nSlot;
 	const int32_t nTotEventClasses = static_cast<int32_t>(m_aEventClasses.size());
 	assert(oListenerData.m_aCallIfEventClass.empty());
 	oListenerData.m_aCallIfEventClass.resize(nTotEventClasses);
@@ -177,6 +256,17 @@ bool BasicDeviceManager::addEventListener(const shared_ptr<EventListener>& refEv
 			}
 		}
 	}
+	assert(oListenerData.m_aCallIfProgram.empty());
+	oListenerData.m_aCallIfProgram.reserve(nTotEventClasses);
+	for (const auto& refClassCallIf : oListenerData.m_aCallIfEventClass) {
+		oListenerData.m_aCallIfProgram.push_back(CallIfCompiler::compile(refClassCallIf));
+	}
+	if ((!m_aPendingListeners.empty()) || (m_refListeners.use_count() > 1)) {
+		// Someone is iterating over the listeners, postpone
+		m_aPendingListeners.push_back(&oListenerData);
+	} else {
+		addToListeners(oListenerData);
+	}
 	return true;
 }
 bool BasicDeviceManager::addEventListener(const shared_ptr<EventListener>& refEventListener) noexcept
@@ -188,18 +278,16 @@ bool BasicDeviceManager::removeEventListener(const shared_ptr<EventListener>& re
 	assert(refEventListener);
 	maybeRemoveDataOfRemovedListeners();
 	auto p0EventListener = refEventListener.get();
-	auto itFind = std::find_if(m_oListenersData.begin(), m_oListenersData.end()
-			, [p0EventListener](const ListenerData& oListenerData) {
-				return ((oListenerData.m_p0EventListener == p0EventListener)
-							&& !oListenerData.m_bListenerWasRemoved);
-			});
-	if (itFind == m_oListenersData.end()) {
+	ListenerData* p0ListenerData = findListenerData(p0EventListener);
+	if (p0ListenerData == nullptr) {
 		return false; //--------------------------------------------------------
 	}
-	ListenerData& oListenerData = *itFind;
+	ListenerData& oListenerData = *p0ListenerData;
+	m_oListenerSlots.erase(p0EventListener);
 	// mark as removed, so that re-adding of the listener is allowed in a
 	// finalize callback
 	oListenerData.m_bListenerWasRemoved = true;
+	m_aRemovedSlots.push_back(oListenerData.m_nSlot);
 	m_bListenerListDirty = true;
 	// finalize if requested
 	if (bFinalize) {
@@ -226,22 +314,46 @@ void BasicDeviceManager::maybeRemoveDataOfRemovedListeners() noexcept
 		return; //--------------------------------------------------------------
 	}
 	if (!(m_refListeners.use_count() == 1)) {
-		// Someone in the callback stack is iterating over the list
+		// Someone in the callback stack is iterating over the listeners
 		// do not remove!
 		return; //--------------------------------------------------------------
 	}
-	auto itListenerData = m_oListenersData.begin();
-	while (itListenerData != m_oListenersData.end()) {
-		if (itListenerData->m_bListenerWasRemoved) {
-			assert(!itListenerData->m_bListenerRemoving);
-			m_refListeners->erase(itListenerData->m_itListeners);
-			itListenerData = m_oListenersData.erase(itListenerData);
-		} else {
-			++itListenerData;
-		}
+	addPendingListeners();
+	const auto oIsRemoved = [](ListenerData* p0ListenerData)
+	{
+		return p0ListenerData->m_bListenerWasRemoved;
+	};
+	auto& aListeners = *m_refListeners;
+	aListeners.erase(std::remove_if(aListeners.begin(), aListeners.end(), oIsRemoved), aListeners.end());
+	for (auto& aClassListeners : m_aClassListeners) {
+		aClassListeners.erase(std::remove_if(aClassListeners.begin(), aClassListeners.end(), oIsRemoved), aClassListeners.end());
+	}
+	// No one can reference the removed listeners' data anymore
+	for (const int32_t nSlot : m_aRemovedSlots) {
+		freeSlot(m_oListenersData[nSlot]);
 	}
+	m_aRemovedSlots.clear();
 	m_bListenerListDirty = false;
 }
+void BasicDeviceManager::freeSlot(ListenerData& oListenerData) noexcept
+{
+	assert(oListenerData.m_bListenerWasRemoved && !oListenerData.m_bListenerRemoving);
+	assert(oListenerData.m_p0EventListener != nullptr);
+	auto itFind = m_oListenerSlots.find(oListenerData.m_p0EventListener);
+	if ((itFind != m_oListenerSlots.end()) && (itFind->second.m_nSlot == oListenerData.m_nSlot)) {
+		m_oListenerSlots.erase(itFind);
+	}
+	oListenerData.m_bListenerWasRemoved = false;
+	oListenerData.m_refExtraData.reset();
+	oListenerData.m_refCallIf.reset();
+	// keep the capacity for the next listener
+	oListenerData.m_aCallIfEventClass.clear();
+	oListenerData.m_aCallIfProgram.clear();
+	oListenerData.m_refEventListener.reset();
+	oListenerData.m_p0EventListener = nullptr;
+	++oListenerData.m_nGeneration;
+	m_aFreeSlots.push_back(oListenerData.m_nSlot);
+}
 void BasicDeviceManager::resetExtraDataOfAllListeners() noexcept
 {
 //std::cout << "BasicDeviceManager::resetExtraDataOfAllListeners" << '\n';
@@ -257,19 +369,24 @@ bool BasicDeviceManager::ListenerData::handleEventCommon(int32_t nClassTypeIdx,
 	if (m_bListenerWasRemoved && !m_bListenerRemoving) {
 		return false; //--------------------------------------------------------
 	}
-	auto refListener = m_refEventListener.lock();
-	if (refListener) {
-		++(m_p1Owner->m_nListenerListRecursing);
-//std::cout << "BasicDeviceManager::ListenerData::handleEventCommon   " << m_p1Owner->m_nListenerListRecursing << '\n';
-		if (nClassTypeIdx >= 0) {
-			auto& refCallIf = m_aCallIfEventClass[nClassTypeIdx];
-			if (refCallIf && !(*refCallIf)(refEvent)) {
+	if (nClassTypeIdx >= 0) {
+		// Filter before locking the listener: the compiled callif doesn't
+		// need any reference counting unless it contains custom callifs
+		const Private::CallIfProgram& oProgram = m_aCallIfProgram[nClassTypeIdx];
+		if (!oProgram.isAlwaysTrue()) {
+			++(m_p1Owner->m_nListenerListRecursing);
+			const bool bSend = (oProgram.hasCallIfInstrs() ? oProgram.eval(refEvent) : oProgram.eval(*refEvent));
+			--(m_p1Owner->m_nListenerListRecursing);
+			if (!bSend) {
 				// CallIf disallows sending of event to listener
-//std::cout << "BasicDeviceManager::ListenerData::handleEventCommon exit A  " << m_p1Owner->m_nListenerListRecursing << '\n';
-				--(m_p1Owner->m_nListenerListRecursing);
 				return false; //------------------------------------------------
 			}
 		}
+	}
+	auto refListener = m_refEventListener.lock();
+	if (refListener) {
+		++(m_p1Owner->m_nListenerListRecursing);
+//std::cout << "BasicDeviceManager::ListenerData::handleEventCommon   " << m_p1Owner->m_nListenerListRecursing << '\n';
 		// callback
 		(*refListener)(refEvent);
 //std::cout << "BasicDeviceManager::ListenerData::handleEventCommon exit B  " << m_p1Owner->m_nListenerListRecursing << '\n';
@@ -277,10 +394,13 @@ bool BasicDeviceManager::ListenerData::handleEventCommon(int32_t nClassTypeIdx,
 	} else {
 		// Can't remove this element right now, because the caller is
 		// probably iterating over the list.
-		// Should be done next time m_oListenersData list is accessed (getEventListeners, etc.).
+		// Should be done next time a listener is added or removed.
 		m_p1Owner->m_bListenerListDirty = true;
-		auto p0This = const_cast<ListenerData*>(this);
-		p0This->m_bListenerWasRemoved = true;
+		if (!m_bListenerWasRemoved) {
+			auto p0This = const_cast<ListenerData*>(this);
+			p0This->m_bListenerWasRemoved = true;
+			m_p1Owner->m_aRemovedSlots.push_back(m_nSlot);
+		}
 	}
 	return true;
 }
@@ -306,13 +426,11 @@ std::vector<Event::Class> BasicDeviceManager::getEventClasses() const noexcept
 }
 int32_t BasicDeviceManager::getEventClassIndex(const Event::Class& oEventClass) const noexcept
 {
-	const int32_t nTotEventClasses = static_cast<int32_t>(m_aEventClasses.size());
-	for (int32_t nIdx = 0; nIdx < nTotEventClasses; ++nIdx) {
-		if (m_aEventClasses[nIdx] == oEventClass) {
-			return nIdx;
-		}
+	const int32_t nRegisteredIdx = oEventClass.getIndex();
+	if ((nRegisteredIdx < 0) || (nRegisteredIdx >= static_cast<int32_t>(m_aEventClassIndex.size()))) {
+		return -1;
 	}
-	return -1;
+	return m_aEventClassIndex[nRegisteredIdx];
 }
 bool BasicDeviceManager::isEventClassEnabled(const Event::Class& oEventClass) const noexcept
 {
@@ -321,8 +439,7 @@ bool BasicDeviceManager::isEventClassEnabled(const Event::Class& oEventClass) co
 	if (nIdx < 0) {
 		return false;
 	}
-//std::cout << "            enabled=" << m_aEventClassEnabled[nIdx] << '\n';
-	return m_aEventClassEnabled[nIdx];
+	return isEventClassIndexEnabled(nIdx);
 }
 void BasicDeviceManager::enableEventClass(const Event::Class& oEventClass) noexcept
 {
@@ -330,7 +447,7 @@ void BasicDeviceManager::enableEventClass(const Event::Class& oEventClass) noexc
 	if (nIdx < 0) {
 		return;
 	}
-	m_aEventClassEnabled[nIdx] = true;
+	m_aEventClassEnabledMask[nIdx / 64].fetch_or(uint64_t{1} << (nIdx % 64), std::memory_order_relaxed);
 }
 bool BasicDeviceManager::addDevice(const shared_ptr<Device>& refDevice) noexcept
 {
@@ -342,6 +459,14 @@ bool BasicDeviceManager::addDevice(const shared_ptr<Device>& refDevice) noexcept
 		return false;
 	}
 	m_oDevices.insert(std::make_pair(nDeviceId, refDevice));
+	const int32_t nTotDeviceCapabilityClasses = static_cast<int32_t>(m_aDeviceCapabitityClasses.size());
+	for (int32_t nIdx = 0; nIdx < nTotDeviceCapabilityClasses; ++nIdx) {
+		if (refDevice->getCapability(m_aDeviceCapabitityClasses[nIdx])) {
+			auto& aDeviceIds = m_aCapabilityClassDevices[nIdx];
+			aDeviceIds.insert(std::lower_bound(aDeviceIds.begin(), aDeviceIds.end(), nDeviceId), nDeviceId);
+		}
+	}
+	notifyDeviceAdded(nDeviceId);
 	return true;
 }
 bool BasicDeviceManager::removeDevice(const shared_ptr<Device>& refDevice) noexcept
@@ -353,6 +478,13 @@ bool BasicDeviceManager::removeDevice(const shared_ptr<Device>& refDevice) noexc
 		return false;
 	}
 	m_oDevices.erase(itFind);
+	for (auto& aDeviceIds : m_aCapabilityClassDevices) {
+		auto itId = std::lower_bound(aDeviceIds.begin(), aDeviceIds.end(), nDeviceId);
+		if ((itId != aDeviceIds.end()) && (*itId == nDeviceId)) {
+			aDeviceIds.erase(itId);
+		}
+	}
+	notifyDeviceRemoved(nDeviceId);
 	return true;
 }
 
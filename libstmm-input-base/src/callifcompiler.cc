@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   callifcompiler.cc
+ */
+
+#include "callifcompiler.h"
+
+#include <stmm-input/callifs.h>
+
+#include <typeinfo>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+namespace stmi
+{
+
+namespace CallIfCompiler
+{
+
+using Program = Private::CallIfProgram;
+using Instr = Program::Instr;
+
+static void emit(std::vector<Instr>& aInstrs, const CallIf* p0CallIf) noexcept
+{
+	assert(p0CallIf != nullptr);
+	const CallIf& oCallIf = *p0CallIf;
+	const std::type_info& oCallIfType = typeid(oCallIf);
+	// Only exact type matches are compiled since non-final callifs
+	// might have been subclassed with a different operator().
+	if (oCallIfType == typeid(CallIfTrue)) {
+		aInstrs.push_back(Instr{Program::OP_TRUE, 0, nullptr});
+	} else if (oCallIfType == typeid(CallIfFalse)) {
+		aInstrs.push_back(Instr{Program::OP_FALSE, 0, nullptr});
+	} else if ((oCallIfType == typeid(CallIfAnd)) || (oCallIfType == typeid(CallIfOr))) {
+		const bool bAnd = (oCallIfType == typeid(CallIfAnd));
+		const CallIf* p0CallIf1;
+		const CallIf* p0CallIf2;
+		if (bAnd) {
+			auto p0AndF = static_cast<const CallIfAnd*>(p0CallIf);
+			p0CallIf1 = p0AndF->getCallIf1().get();
+			p0CallIf2 = p0AndF->getCallIf2().get();
+		} else {
+			auto p0OrF = static_cast<const CallIfOr*>(p0CallIf);
+			p0CallIf1 = p0OrF->getCallIf1().get();
+			p0CallIf2 = p0OrF->getCallIf2().get();
+		}
+		emit(aInstrs, p0CallIf1);
+		const int32_t nJumpIdx = static_cast<int32_t>(aInstrs.size());
+		aInstrs.push_back(Instr{(bAnd ? Program::OP_JUMP_IF_FALSE : Program::OP_JUMP_IF_TRUE), -1, nullptr});
+		emit(aInstrs, p0CallIf2);
+		// short-circuit: the register already holds the result
+		aInstrs[nJumpIdx].m_nArg = static_cast<int32_t>(aInstrs.size());
+	} else if (oCallIfType == typeid(CallIfNot)) {
+		auto p0NotF = static_cast<const CallIfNot*>(p0CallIf);
+		emit(aInstrs, p0NotF->getCallIf().get());
+		aInstrs.push_back(Instr{Program::OP_NOT, 0, nullptr});
+	} else if (oCallIfType == typeid(CallIfAccessor)) {
+		auto p0AccF = static_cast<const CallIfAccessor*>(p0CallIf);
+		aInstrs.push_back(Instr{Program::OP_ACCESSOR, 0, p0AccF->getAccessor().get()});
+	} else if (oCallIfType == typeid(CallIfDeviceId)) {
+		auto p0DevF = static_cast<const CallIfDeviceId*>(p0CallIf);
+		aInstrs.push_back(Instr{Program::OP_DEVICE_ID, p0DevF->getDeviceId(), nullptr});
+	} else if (oCallIfType == typeid(CallIfCapabilityId)) {
+		auto p0CapaF = static_cast<const CallIfCapabilityId*>(p0CallIf);
+		aInstrs.push_back(Instr{Program::OP_CAPABILITY_ID, p0CapaF->getCapabilityId(), nullptr});
+	} else if (oCallIfType == typeid(CallIfCapabilityClass)) {
+		auto p0CapaClassF = static_cast<const CallIfCapabilityClass*>(p0CallIf);
+		aInstrs.push_back(Instr{Program::OP_CAPABILITY_CLASS, 0, &(p0CapaClassF->getCapabilityClass())});
+	} else if (oCallIfType == typeid(CallIfDeviceManagerCapability)) {
+		aInstrs.push_back(Instr{Program::OP_DEVICE_MANAGER_CAPABILITY, 0, nullptr});
+	} else if (oCallIfType == typeid(CallIfEventClass)) {
+		auto p0ECF = static_cast<const CallIfEventClass*>(p0CallIf);
+		aInstrs.push_back(Instr{Program::OP_EVENT_CLASS, p0ECF->getClass().getIndex(), nullptr});
+	} else if (oCallIfType == typeid(CallIfXYEvent)) {
+		aInstrs.push_back(Instr{Program::OP_XY_EVENT, 0, nullptr});
+	} else {
+		// ex. CallIfFuction: fall back to virtual call
+		aInstrs.push_back(Instr{Program::OP_CALLIF, 0, p0CallIf});
+	}
+}
+
+Private::CallIfProgram compile(const shared_ptr<CallIf>& refCallIf) noexcept
+{
+	if (!refCallIf) {
+		return Program{}; //----------------------------------------------------
+	}
+	const CallIf& oCallIf = *refCallIf;
+	if (typeid(oCallIf) == typeid(CallIfTrue)) {
+		return Program{}; //----------------------------------------------------
+	}
+	std::vector<Instr> aInstrs;
+	emit(aInstrs, refCallIf.get());
+	return Program{std::move(aInstrs)};
+}
+
+} // namespace CallIfCompiler
+
+} // namespace stmi
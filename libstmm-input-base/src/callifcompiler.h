@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   callifcompiler.h
+ */
+
+#ifndef STMI_CALLIF_COMPILER_H
+#define STMI_CALLIF_COMPILER_H
+
+#include "private-callifprogram.h"
+
+#include <memory>
+
+namespace stmi { class CallIf; }
+
+namespace stmi
+{
+
+namespace CallIfCompiler
+{
+
+/* * Compile a (simplified) callif expression into a flat program.
+ * The returned program references the nodes of the callif tree, which
+ * must therefore outlive it.
+ * @param refCallIf The callif. If null the program always evaluates to true.
+ * @return The program.
+ */
+Private::CallIfProgram compile(const shared_ptr<CallIf>& refCallIf) noexcept;
+
+} // namespace CallIfCompiler
+
+} // namespace stmi
+
+#endif /* STMI_CALLIF_COMPILER_H */
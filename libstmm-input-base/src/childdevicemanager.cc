@@ -30,11 +30,13 @@ namespace stmi
 ChildDeviceManager::ChildDeviceManager() noexcept
 : m_bImRoot(true)
 , m_bImParent(false)
+, m_bNotifiesDeviceChanges(false)
 {
 }
 ChildDeviceManager::ChildDeviceManager(bool bIsParent) noexcept
 : m_bImRoot(true)
 , m_bImParent(bIsParent)
+, m_bNotifiesDeviceChanges(false)
 {
 }
 shared_ptr<ParentDeviceManager> ChildDeviceManager::getAsParent() const noexcept
@@ -110,6 +112,20 @@ shared_ptr<ParentDeviceManager> ChildDeviceManager::getRoot() noexcept
 	}
 	return refRoot;
 }
+void ChildDeviceManager::notifyDeviceAdded(int32_t nDeviceId) noexcept
+{
+	auto refParent = getParent();
+	if (refParent) {
+		refParent->onDescendantDeviceAdded(nDeviceId, this);
+	}
+}
+void ChildDeviceManager::notifyDeviceRemoved(int32_t nDeviceId) noexcept
+{
+	auto refParent = getParent();
+	if (refParent) {
+		refParent->onDescendantDeviceRemoved(nDeviceId);
+	}
+}
 shared_ptr<ParentDeviceManager> ChildDeviceManager::calcRoot() noexcept
 {
 	auto refParent = getParent();
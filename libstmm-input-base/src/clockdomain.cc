@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   clockdomain.cc
+ */
+
+#include "clockdomain.h"
+
+#include <stmm-input/devicemanager.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace stmi
+{
+
+constexpr int32_t ClockDomain::s_nSyncEveryTimes;
+constexpr int64_t ClockDomain::s_nSyncAfterUsec;
+constexpr int64_t ClockDomain::s_nMaxDriftUsec;
+constexpr int64_t ClockDomain::s_nResetAfterUsec;
+
+ClockDomain::ClockDomain() noexcept
+: m_bInitialized(false)
+, m_nLastDeviceMsec(0)
+, m_nDeviceUsec(0)
+, m_nOffsetUsec(0)
+, m_nLastSyncDeviceUsec(0)
+, m_nSinceSync(0)
+, m_nLastTimeUsec(std::numeric_limits<int64_t>::min())
+{
+}
+void ClockDomain::reset() noexcept
+{
+	m_bInitialized = false;
+	m_nSinceSync = 0;
+}
+int64_t ClockDomain::getTimeUsec(uint32_t nDeviceTimeMsec) noexcept
+{
+	if (nDeviceTimeMsec == 0) {
+		return std::max(m_nLastTimeUsec, DeviceManager::getNowTimeMicroseconds()); //--
+	}
+	if (unwrap(nDeviceTimeMsec)) {
+		sync(DeviceManager::getNowTimeMicroseconds());
+	}
+	return calcTimeUsec();
+}
+int64_t ClockDomain::getTimeUsec(uint32_t nDeviceTimeMsec, int64_t nNowUsec) noexcept
+{
+	if (nDeviceTimeMsec == 0) {
+		return std::max(m_nLastTimeUsec, nNowUsec); //--------------------------
+	}
+	unwrap(nDeviceTimeMsec);
+	sync(nNowUsec);
+	return calcTimeUsec();
+}
+bool ClockDomain::unwrap(uint32_t nDeviceTimeMsec) noexcept
+{
+	if (!m_bInitialized) {
+		m_nLastDeviceMsec = nDeviceTimeMsec;
+		m_nDeviceUsec = static_cast<int64_t>(nDeviceTimeMsec) * 1000;
+		return true; //---------------------------------------------------------
+	}
+	// modular arithmetic: also correct when the device time wraps around
+	const uint32_t nDeltaMsec = nDeviceTimeMsec - m_nLastDeviceMsec;
+	m_nLastDeviceMsec = nDeviceTimeMsec;
+	if (nDeltaMsec <= static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+		m_nDeviceUsec += static_cast<int64_t>(nDeltaMsec) * 1000;
+	} else {
+		// slightly older than the previous one
+		m_nDeviceUsec -= static_cast<int64_t>(static_cast<uint32_t>(0) - nDeltaMsec) * 1000;
+	}
+	++m_nSinceSync;
+	return (m_nSinceSync >= s_nSyncEveryTimes) || (m_nDeviceUsec - m_nLastSyncDeviceUsec >= s_nSyncAfterUsec);
+}
+void ClockDomain::sync(int64_t nNowUsec) noexcept
+{
+	const int64_t nSampleOffsetUsec = nNowUsec - m_nDeviceUsec;
+	if (!m_bInitialized) {
+		m_bInitialized = true;
+		m_nOffsetUsec = nSampleOffsetUsec;
+	} else if (nSampleOffsetUsec < m_nOffsetUsec) {
+		// received with less delay than ever
+		m_nOffsetUsec = nSampleOffsetUsec;
+	} else {
+		const int64_t nDiffUsec = nSampleOffsetUsec - m_nOffsetUsec;
+		if (nDiffUsec > s_nResetAfterUsec) {
+			m_nOffsetUsec = nSampleOffsetUsec;
+		} else {
+			m_nOffsetUsec += std::min(nDiffUsec, s_nMaxDriftUsec);
+		}
+	}
+	m_nLastSyncDeviceUsec = m_nDeviceUsec;
+	m_nSinceSync = 0;
+}
+int64_t ClockDomain::calcTimeUsec() noexcept
+{
+	m_nLastTimeUsec = std::max(m_nLastTimeUsec, m_nDeviceUsec + m_nOffsetUsec);
+	return m_nLastTimeUsec;
+}
+
+} // namespace stmi
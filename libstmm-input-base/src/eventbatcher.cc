@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventbatcher.cc
+ */
+
+#include "eventbatcher.h"
+
+#include <cassert>
+#include <utility>
+
+namespace stmi
+{
+
+EventBatcher::EventBatcher(const shared_ptr<BatchEventListener>& refBatchListener) noexcept
+: m_refBatchListener(refBatchListener)
+, m_refEventListener(std::make_shared<EventListener>(
+		[this](const shared_ptr<Event>& refEvent)
+		{
+			onEvent(refEvent);
+		}))
+, m_bFlushing(false)
+{
+	assert(m_refBatchListener && *m_refBatchListener);
+}
+void EventBatcher::onEvent(const shared_ptr<Event>& refEvent) noexcept
+{
+	const bool bWasEmpty = m_aPendingEvents.empty();
+	m_aPendingEvents.push_back(refEvent);
+	if (bWasEmpty) {
+		onFirstPendingEvent();
+	}
+}
+void EventBatcher::flush() noexcept
+{
+	if (m_bFlushing || m_aPendingEvents.empty()) {
+		return; //--------------------------------------------------------------
+	}
+	m_bFlushing = true;
+	assert(m_aDeliveringEvents.empty());
+	m_aDeliveringEvents.swap(m_aPendingEvents);
+	(*m_refBatchListener)(m_aDeliveringEvents.data(), static_cast<int32_t>(m_aDeliveringEvents.size()));
+	m_aDeliveringEvents.clear();
+	m_bFlushing = false;
+}
+
+} // namespace stmi
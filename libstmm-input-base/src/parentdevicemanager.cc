@@ -22,7 +22,9 @@
 
 #include "utilbase.h"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
 //#include <iostream>
 
 namespace stmi { class Accessor; }
@@ -33,6 +35,9 @@ namespace stmi
 
 ParentDeviceManager::ParentDeviceManager() noexcept
 : ChildDeviceManager(true)
+, m_refCapabilityClasses(std::make_shared<const std::vector<Capability::Class>>())
+, m_refDeviceCapabilityClasses(std::make_shared<const std::vector<Capability::Class>>())
+, m_refEventClasses(std::make_shared<const std::vector<Event::Class>>())
 {
 }
 void ParentDeviceManager::init(const std::vector< shared_ptr<ChildDeviceManager> >& aChildDeviceManager) noexcept
@@ -49,19 +54,83 @@ void ParentDeviceManager::init(const std::vector< shared_ptr<ChildDeviceManager>
 	for (auto& refCDM : aChildDeviceManager) {
 		assert(refCDM);
 		refCDM->setParent(refParentThis);
+		// the devices already added to the child didn't reach this instance
+		addRoutesOfChild(refCDM.get());
+		if (!refCDM->m_bNotifiesDeviceChanges) {
+			m_aUnnotifyingChildren.push_back(refCDM.get());
+		}
+	}
+	m_bNotifiesDeviceChanges = m_aUnnotifyingChildren.empty();
+	std::vector<Capability::Class> aCapabilityClasses;
+	std::vector<Capability::Class> aDeviceCapabilityClasses;
+	std::vector<Event::Class> aEventClasses;
+	for (auto& refCDM : m_aChildDeviceManagers) {
+		Util::addToVectorSet(aCapabilityClasses, refCDM->getCapabilityClasses());
+		Util::addToVectorSet(aDeviceCapabilityClasses, refCDM->getDeviceCapabilityClasses());
+		Util::addToVectorSet(aEventClasses, refCDM->getEventClasses());
+	}
+	m_refCapabilityClasses = std::make_shared<const std::vector<Capability::Class>>(std::move(aCapabilityClasses));
+	m_refDeviceCapabilityClasses = std::make_shared<const std::vector<Capability::Class>>(std::move(aDeviceCapabilityClasses));
+	m_refEventClasses = std::make_shared<const std::vector<Event::Class>>(std::move(aEventClasses));
+	m_refDevices.reset();
+}
+void ParentDeviceManager::addRoutesOfChild(ChildDeviceManager* p0Child) noexcept
+{
+	if (p0Child->isParent()) {
+		auto refChildParent = p0Child->getAsParent();
+		for (auto& oPair : refChildParent->m_oDeviceRoutes) {
+			m_oDeviceRoutes[oPair.first] = refChildParent->getRouteTarget(oPair.second);
+		}
+		for (auto& oPair : refChildParent->m_oCapabilityRoutes) {
+			m_oCapabilityRoutes[oPair.first] = refChildParent->getRouteTarget(oPair.second);
+		}
+		return; //--------------------------------------------------------------
+	}
+	for (const int32_t nDeviceId : p0Child->getDevices()) {
+		m_oDeviceRoutes[nDeviceId] = p0Child;
+	}
+	for (auto& oClass : p0Child->getCapabilityClasses()) {
+		auto refCapa = p0Child->getCapability(oClass);
+		if (refCapa) {
+			m_oCapabilityRoutes[refCapa->getId()] = p0Child;
+		}
+	}
+}
+void ParentDeviceManager::onDescendantDeviceAdded(int32_t nDeviceId, ChildDeviceManager* p0Owner) noexcept
+{
+	assert(p0Owner != nullptr);
+	m_oDeviceRoutes[nDeviceId] = p0Owner;
+	m_refDevices.reset();
+	auto refParent = getParent();
+	if (refParent) {
+		refParent->onDescendantDeviceAdded(nDeviceId, getRouteTarget(p0Owner));
+	}
+}
+void ParentDeviceManager::onDescendantDeviceRemoved(int32_t nDeviceId) noexcept
+{
+	m_oDeviceRoutes.erase(nDeviceId);
+	m_refDevices.reset();
+	auto refParent = getParent();
+	if (refParent) {
+		refParent->onDescendantDeviceRemoved(nDeviceId);
 	}
 }
 
 shared_ptr<Device> ParentDeviceManager::getDevice(int32_t nDeviceId) const noexcept
 {
-	shared_ptr<Device> refDevice;
-	for (auto& refCDM : m_aChildDeviceManagers) {
-		refDevice = refCDM->getDevice(nDeviceId);
-		if (refDevice) {
-			break; // for
+	auto itFind = m_oDeviceRoutes.find(nDeviceId);
+	if (itFind == m_oDeviceRoutes.end()) {
+		shared_ptr<Device> refDevice;
+		for (ChildDeviceManager* p0Child : m_aUnnotifyingChildren) {
+			refDevice = p0Child->getDevice(nDeviceId);
+			if (refDevice) {
+				break; // for
+			}
 		}
+		return refDevice; //----------------------------------------------------
 	}
-	return refDevice;
+	ChildDeviceManager* p0Owner = itFind->second;
+	return p0Owner->getDevice(nDeviceId);
 }
 shared_ptr<Capability> ParentDeviceManager::getCapability(const Capability::Class& oClass) const noexcept
 {
@@ -76,15 +145,12 @@ shared_ptr<Capability> ParentDeviceManager::getCapability(const Capability::Clas
 }
 shared_ptr<Capability> ParentDeviceManager::getCapability(int32_t nCapabilityId) const noexcept
 {
-	ParentDeviceManager* p0This = const_cast<ParentDeviceManager*>(this);
-	shared_ptr<Capability> refCapa;
-	for (shared_ptr<ChildDeviceManager>& refCDM : p0This->m_aChildDeviceManagers) {
-		refCapa = refCDM->getCapability(nCapabilityId);
-		if (refCapa) {
-			break; // for
-		}
+	auto itFind = m_oCapabilityRoutes.find(nCapabilityId);
+	if (itFind == m_oCapabilityRoutes.end()) {
+		return shared_ptr<Capability>{}; //-------------------------------------
 	}
-	return refCapa;
+	ChildDeviceManager* p0Owner = itFind->second;
+	return p0Owner->getCapability(nCapabilityId);
 }
 std::vector<shared_ptr<Capability>> ParentDeviceManager::getDeviceManagerCapabilities(const Capability::Class& oClass) const noexcept
 {
@@ -105,43 +171,60 @@ std::vector<shared_ptr<Capability>> ParentDeviceManager::getDeviceManagerCapabil
 
 std::vector<Capability::Class> ParentDeviceManager::getCapabilityClasses() const noexcept
 {
-	std::vector<Capability::Class> aSet;
-	for (auto& refCDM : m_aChildDeviceManagers) {
-		Util::addToVectorSet(aSet, refCDM->getCapabilityClasses());
-	}
-	return aSet;
+	return *m_refCapabilityClasses;
 }
 std::vector<Capability::Class> ParentDeviceManager::getDeviceCapabilityClasses() const noexcept
 {
-	std::vector<Capability::Class> aSet;
-	for (auto& refCDM : m_aChildDeviceManagers) {
-		Util::addToVectorSet(aSet, refCDM->getDeviceCapabilityClasses());
-	}
-	return aSet;
+	return *m_refDeviceCapabilityClasses;
 }
 std::vector<Event::Class> ParentDeviceManager::getEventClasses() const noexcept
 {
-	std::vector<Event::Class> aSet;
-	for (auto& refCDM : m_aChildDeviceManagers) {
-		Util::addToVectorSet(aSet, refCDM->getEventClasses());
-	}
-	return aSet;
+	return *m_refEventClasses;
 }
 std::vector<int32_t> ParentDeviceManager::getDevicesWithCapabilityClass(const Capability::Class& oCapabilityClass) const noexcept
 {
 	std::vector<int32_t> aSet;
+	std::vector<int32_t> aTmp;
 	for (auto& refCDM : m_aChildDeviceManagers) {
-		Util::addToVectorSet(aSet, refCDM->getDevicesWithCapabilityClass(oCapabilityClass));
+		auto aChildSet = refCDM->getDevicesWithCapabilityClass(oCapabilityClass);
+		if (!std::is_sorted(aChildSet.begin(), aChildSet.end())) {
+			// child not derived from BasicDeviceManager
+			std::sort(aChildSet.begin(), aChildSet.end());
+		}
+		Util::mergeToSortedVectorSet(aSet, aChildSet, aTmp);
 	}
 	return aSet;
 }
 std::vector<int32_t> ParentDeviceManager::getDevices() const noexcept
 {
-	std::vector<int32_t> aSet;
-	for (auto& refCDM : m_aChildDeviceManagers) {
-		Util::addToVectorSet(aSet, refCDM->getDevices());
+	return *getDevicesSnapshot();
+}
+shared_ptr<const std::vector<int32_t>> ParentDeviceManager::getDevicesSnapshot() const noexcept
+{
+	if (m_refDevices) {
+		return m_refDevices; //-------------------------------------------------
 	}
-	return aSet;
+	std::vector<int32_t> aDeviceIds;
+	aDeviceIds.reserve(m_oDeviceRoutes.size());
+	for (auto& oPair : m_oDeviceRoutes) {
+		aDeviceIds.push_back(oPair.first);
+	}
+	std::sort(aDeviceIds.begin(), aDeviceIds.end());
+	if (!m_aUnnotifyingChildren.empty()) {
+		// their devices can change without this instance knowing, don't cache
+		std::vector<int32_t> aTmp;
+		for (ChildDeviceManager* p0Child : m_aUnnotifyingChildren) {
+			auto aChildSet = p0Child->getDevices();
+			if (!std::is_sorted(aChildSet.begin(), aChildSet.end())) {
+				std::sort(aChildSet.begin(), aChildSet.end());
+			}
+			Util::mergeToSortedVectorSet(aDeviceIds, aChildSet, aTmp);
+		}
+		return std::make_shared<const std::vector<int32_t>>(std::move(aDeviceIds)); //
+	}
+	ParentDeviceManager* p0This = const_cast<ParentDeviceManager*>(this);
+	p0This->m_refDevices = std::make_shared<const std::vector<int32_t>>(std::move(aDeviceIds));
+	return m_refDevices;
 }
 bool ParentDeviceManager::isEventClassEnabled(const Event::Class& oEventClass) const noexcept
 {
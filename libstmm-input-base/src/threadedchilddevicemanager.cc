@@ -0,0 +1,533 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   threadedchilddevicemanager.cc
+ */
+
+#include "threadedchilddevicemanager.h"
+
+#include <stmm-input/device.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <system_error>
+//#include <iostream>
+
+namespace stmi
+{
+
+std::pair<shared_ptr<ThreadedChildDeviceManager>, std::string> ThreadedChildDeviceManager::create(Init&& oInit) noexcept
+{
+	assert(oInit.m_oCreate);
+	assert(oInit.m_oWakeup);
+	assert(oInit.m_nQueueCapacity > 0);
+	auto refThreaded = shared_ptr<ThreadedChildDeviceManager>(new ThreadedChildDeviceManager(std::move(oInit)));
+	const std::string sError = refThreaded->start();
+	if (!sError.empty()) {
+		return std::make_pair(shared_ptr<ThreadedChildDeviceManager>{}, sError); //
+	}
+	return std::make_pair(refThreaded, "");
+}
+ThreadedChildDeviceManager::ThreadedChildDeviceManager(Init&& oInit) noexcept
+: ParentDeviceManager()
+, m_oInit(std::move(oInit))
+, m_bWorkerPushed(false)
+, m_p0WorkerFinalizingEntry(nullptr)
+, m_oRing(m_oInit.m_nQueueCapacity)
+, m_bOverflowing(false)
+, m_nTotPostedTasks(0)
+, m_nTotDoneTasks(0)
+, m_bInnerCreated(false)
+, m_bStarted(false)
+, m_bStopping(false)
+, m_nTotOverflowItems(0)
+, m_bWakeupPending(false)
+, m_nNextDispatchItem(0)
+{
+}
+ThreadedChildDeviceManager::~ThreadedChildDeviceManager() noexcept
+{
+	// The worker thread must hold the last reference to the inner device manager
+	ParentDeviceManager::removeChildren();
+	if (m_oThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> oLock(m_oMutex);
+			m_bStopping = true;
+		}
+		m_oWorkerCond.notify_one();
+		m_oThread.join();
+	}
+}
+std::string ThreadedChildDeviceManager::start() noexcept
+{
+	try {
+		m_oThread = std::thread(&ThreadedChildDeviceManager::run, this);
+	} catch (const std::system_error& oErr) {
+		return std::string("ThreadedChildDeviceManager: couldn't start thread: ") + oErr.what(); //---
+	}
+	shared_ptr<ChildDeviceManager> refInner;
+	{
+		std::unique_lock<std::mutex> oLock(m_oMutex);
+		m_oDoneCond.wait(oLock, [&]() { return m_bInnerCreated; });
+		refInner = m_refInner;
+	}
+	if (!refInner) {
+		return "ThreadedChildDeviceManager: couldn't create the inner device manager"; //
+	}
+	if (!refInner->isNotifyingDeviceChanges()) {
+		// The mirror of the devices couldn't be kept current
+		{
+			std::lock_guard<std::mutex> oLock(m_oMutex);
+			m_bStopping = true;
+		}
+		m_oWorkerCond.notify_one();
+		return "ThreadedChildDeviceManager: the inner device manager doesn't notify its device changes"; //
+	}
+	// The worker thread waits for m_bStarted, the inner device manager can
+	// therefore be accessed from this thread
+	ParentDeviceManager::init({refInner});
+	cacheCapabilities();
+	for (const int32_t nDeviceId : *getDevicesSnapshot()) {
+		m_oDevices[nDeviceId] = refInner->getDevice(nDeviceId);
+	}
+	for (auto& oClass : *getEventClassesSnapshot()) {
+		if (refInner->isEventClassEnabled(oClass)) {
+			m_aEnabledEventClasses.push_back(oClass);
+		}
+	}
+	{
+		std::lock_guard<std::mutex> oLock(m_oMutex);
+		m_bStarted = true;
+	}
+	m_oWorkerCond.notify_one();
+	return "";
+}
+void ThreadedChildDeviceManager::cacheCapabilities() noexcept
+{
+	auto& refInner = m_refInner;
+	for (auto& oClass : *getCapabilityClassesSnapshot()) {
+		std::vector< shared_ptr<Capability> > aCapas;
+		if (refInner->isParent()) {
+			aCapas = refInner->getAsParent()->getDeviceManagerCapabilities(oClass);
+		} else {
+			auto refCapa = refInner->getCapability(oClass);
+			if (refCapa) {
+				aCapas.push_back(std::move(refCapa));
+			}
+		}
+		m_aCapabilities.emplace_back(oClass, std::move(aCapas));
+	}
+}
+void ThreadedChildDeviceManager::run() noexcept
+{
+	m_oWorkerThreadId = std::this_thread::get_id();
+	auto refInner = m_oInit.m_oCreate();
+	{
+		std::unique_lock<std::mutex> oLock(m_oMutex);
+		m_refInner = refInner;
+		m_bInnerCreated = true;
+		m_oDoneCond.notify_all();
+		m_oWorkerCond.wait(oLock, [&]() { return m_bStarted || m_bStopping; });
+	}
+	std::vector< std::function<void(ChildDeviceManager& oInner)> > aTasks;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> oLock(m_oMutex);
+			if (!m_oInit.m_oIterate) {
+				m_oWorkerCond.wait(oLock, [&]() { return m_bStopping || !m_aTasks.empty(); });
+			}
+			if (m_bStopping) {
+				break; // while
+			}
+			aTasks.swap(m_aTasks);
+		}
+		if (!aTasks.empty()) {
+			for (auto& oTask : aTasks) {
+				oTask(*refInner);
+			}
+			// before the caller of a marshalled function is released
+			maybeWakeup();
+			const auto nTotTasks = aTasks.size();
+			// the captured objects are released in this thread
+			aTasks.clear();
+			{
+				std::lock_guard<std::mutex> oLock(m_oMutex);
+				m_nTotDoneTasks += nTotTasks;
+			}
+			m_oDoneCond.notify_all();
+		}
+		if (m_oInit.m_oIterate) {
+			m_oInit.m_oIterate(*refInner);
+			maybeWakeup();
+		}
+	}
+	// destroy the inner device manager in this thread
+	refInner.reset();
+	m_refInner.reset();
+}
+void ThreadedChildDeviceManager::pushItem(QueuedItem&& oItem) noexcept
+{
+	m_bWorkerPushed = true;
+	// While the overflow vector isn't empty the ring must not be used
+	// or the main thread could pop the items out of order
+	if ((!m_bOverflowing.load(std::memory_order_acquire)) && m_oRing.push(std::move(oItem))) {
+		return; //--------------------------------------------------------------
+	}
+	std::lock_guard<std::mutex> oLock(m_oMutex);
+	m_aOverflowItems.push_back(std::move(oItem));
+	++m_nTotOverflowItems;
+	m_bOverflowing.store(true, std::memory_order_release);
+}
+void ThreadedChildDeviceManager::maybeWakeup() noexcept
+{
+	if (!m_bWorkerPushed) {
+		return; //--------------------------------------------------------------
+	}
+	m_bWorkerPushed = false;
+	if (!m_bWakeupPending.exchange(true)) {
+		m_oInit.m_oWakeup();
+	}
+}
+void ThreadedChildDeviceManager::runInWorker(const std::function<void(ChildDeviceManager& oInner)>& oFunc) const noexcept
+{
+	if (std::this_thread::get_id() == m_oWorkerThreadId) {
+		// ex. called by a function passed to post()
+		oFunc(*m_refInner);
+		return; //--------------------------------------------------------------
+	}
+	std::unique_lock<std::mutex> oLock(m_oMutex);
+	if (m_bStopping) {
+		return; //--------------------------------------------------------------
+	}
+	m_aTasks.push_back(oFunc);
+	const uint64_t nTicket = ++m_nTotPostedTasks;
+	m_oWorkerCond.notify_one();
+	m_oDoneCond.wait(oLock, [&]() { return m_nTotDoneTasks >= nTicket; });
+}
+void ThreadedChildDeviceManager::post(std::function<void(ChildDeviceManager& oInner)>&& oFunc) noexcept
+{
+	assert(oFunc);
+	{
+		std::lock_guard<std::mutex> oLock(m_oMutex);
+		if (m_bStopping) {
+			return; //----------------------------------------------------------
+		}
+		m_aTasks.push_back(std::move(oFunc));
+		++m_nTotPostedTasks;
+	}
+	m_oWorkerCond.notify_one();
+}
+int64_t ThreadedChildDeviceManager::getTotOverflowItems() const noexcept
+{
+	std::lock_guard<std::mutex> oLock(m_oMutex);
+	return m_nTotOverflowItems;
+}
+int32_t ThreadedChildDeviceManager::dispatchEvents() noexcept
+{
+	const int32_t nTotSent = sendQueuedItems();
+	// Remove the listeners that expired without receiving events
+	std::vector< shared_ptr<ListenerEntry> > aExpiredEntries;
+	for (auto& refEntry : m_aListenerEntries) {
+		if (refEntry->m_refEventListener.expired()) {
+			aExpiredEntries.push_back(refEntry);
+		}
+	}
+	for (auto& refEntry : aExpiredEntries) {
+		removeEntry(refEntry, false);
+	}
+	return nTotSent;
+}
+void ThreadedChildDeviceManager::popItems() noexcept
+{
+	// Cleared before looking at the queue: what the worker thread queues
+	// after this is either popped below or followed by another wakeup
+	m_bWakeupPending.store(false);
+	if (!m_bOverflowing.load(std::memory_order_acquire)) {
+		// The items pushed to the overflow vector after this are preceded
+		// by those in the ring and are popped by the next call
+		m_oRing.drain(m_aDispatchItems);
+		return; //--------------------------------------------------------------
+	}
+	// The worker thread can't push to the overflow vector while the ring is drained
+	std::lock_guard<std::mutex> oLock(m_oMutex);
+	m_oRing.drain(m_aDispatchItems);
+	m_aDispatchItems.insert(m_aDispatchItems.end(), std::make_move_iterator(m_aOverflowItems.begin())
+							, std::make_move_iterator(m_aOverflowItems.end()));
+	m_aOverflowItems.clear();
+	m_bOverflowing.store(false, std::memory_order_release);
+}
+int32_t ThreadedChildDeviceManager::sendQueuedItems() noexcept
+{
+	popItems();
+	int32_t nTotSent = 0;
+	// A listener might cause this function to be called recursively, which
+	// continues from the same position
+	while (m_nNextDispatchItem < m_aDispatchItems.size()) {
+		QueuedItem oItem = std::move(m_aDispatchItems[m_nNextDispatchItem]);
+		++m_nNextDispatchItem;
+		if (!oItem.m_refEntry) {
+			applyDeviceChange(oItem);
+			continue; // while
+		}
+		auto& refEntry = oItem.m_refEntry;
+		if (refEntry->m_eState == LISTENER_STATE_REMOVED) {
+			continue; // while
+		}
+		if ((refEntry->m_eState == LISTENER_STATE_FINALIZING) && !oItem.m_bFinalize) {
+			continue; // while
+		}
+		auto refListener = refEntry->m_refEventListener.lock();
+		if (!refListener) {
+			if (refEntry->m_eState == LISTENER_STATE_ACTIVE) {
+				removeEntry(refEntry, false);
+			}
+			continue; // while
+		}
+		(*refListener)(oItem.m_refEvent);
+		++nTotSent;
+	}
+	m_aDispatchItems.clear();
+	m_nNextDispatchItem = 0;
+	return nTotSent;
+}
+void ThreadedChildDeviceManager::applyDeviceChange(const QueuedItem& oItem) noexcept
+{
+	if (oItem.m_refDevice) {
+		m_oDevices[oItem.m_nDeviceId] = oItem.m_refDevice;
+		ParentDeviceManager::onDescendantDeviceAdded(oItem.m_nDeviceId, oItem.m_p0Owner);
+	} else {
+		m_oDevices.erase(oItem.m_nDeviceId);
+		ParentDeviceManager::onDescendantDeviceRemoved(oItem.m_nDeviceId);
+	}
+}
+void ThreadedChildDeviceManager::onDescendantDeviceAdded(int32_t nDeviceId, ChildDeviceManager* p0Owner) noexcept
+{
+	assert(p0Owner != nullptr);
+	auto refDevice = p0Owner->getDevice(nDeviceId);
+	assert(refDevice);
+	if (std::this_thread::get_id() != m_oWorkerThreadId) {
+		m_oDevices[nDeviceId] = refDevice;
+		ParentDeviceManager::onDescendantDeviceAdded(nDeviceId, p0Owner);
+		return; //--------------------------------------------------------------
+	}
+	QueuedItem oItem;
+	oItem.m_nDeviceId = nDeviceId;
+	oItem.m_refDevice = std::move(refDevice);
+	oItem.m_p0Owner = p0Owner;
+	pushItem(std::move(oItem));
+}
+void ThreadedChildDeviceManager::onDescendantDeviceRemoved(int32_t nDeviceId) noexcept
+{
+	if (std::this_thread::get_id() != m_oWorkerThreadId) {
+		m_oDevices.erase(nDeviceId);
+		ParentDeviceManager::onDescendantDeviceRemoved(nDeviceId);
+		return; //--------------------------------------------------------------
+	}
+	QueuedItem oItem;
+	oItem.m_nDeviceId = nDeviceId;
+	pushItem(std::move(oItem));
+}
+ChildDeviceManager* ThreadedChildDeviceManager::getRouteTarget(ChildDeviceManager* /*p0Owner*/) noexcept
+{
+	return this;
+}
+
+shared_ptr<Device> ThreadedChildDeviceManager::getDevice(int32_t nDeviceId) const noexcept
+{
+	auto itFind = m_oDevices.find(nDeviceId);
+	if (itFind == m_oDevices.end()) {
+		return shared_ptr<Device>{}; //-----------------------------------------
+	}
+	return itFind->second;
+}
+std::vector<int32_t> ThreadedChildDeviceManager::getDevicesWithCapabilityClass(const Capability::Class& oCapabilityClass) const noexcept
+{
+	std::vector<int32_t> aDeviceIds;
+	for (const int32_t nDeviceId : *getDevicesSnapshot()) {
+		auto itFind = m_oDevices.find(nDeviceId);
+		assert(itFind != m_oDevices.end());
+		if (itFind->second->getCapability(oCapabilityClass)) {
+			aDeviceIds.push_back(nDeviceId);
+		}
+	}
+	return aDeviceIds;
+}
+shared_ptr<Capability> ThreadedChildDeviceManager::getCapability(const Capability::Class& oClass) const noexcept
+{
+	for (auto& oPair : m_aCapabilities) {
+		if ((oPair.first == oClass) && !oPair.second.empty()) {
+			return oPair.second[0]; //------------------------------------------
+		}
+	}
+	return shared_ptr<Capability>{};
+}
+shared_ptr<Capability> ThreadedChildDeviceManager::getCapability(int32_t nCapabilityId) const noexcept
+{
+	for (auto& oPair : m_aCapabilities) {
+		for (auto& refCapa : oPair.second) {
+			if (refCapa->getId() == nCapabilityId) {
+				return refCapa; //----------------------------------------------
+			}
+		}
+	}
+	return shared_ptr<Capability>{};
+}
+std::vector<shared_ptr<Capability>> ThreadedChildDeviceManager::getDeviceManagerCapabilities(const Capability::Class& oClass) const noexcept
+{
+	for (auto& oPair : m_aCapabilities) {
+		if (oPair.first == oClass) {
+			return oPair.second; //---------------------------------------------
+		}
+	}
+	return std::vector<shared_ptr<Capability>>{};
+}
+bool ThreadedChildDeviceManager::isEventClassEnabled(const Event::Class& oEventClass) const noexcept
+{
+	return (std::find(m_aEnabledEventClasses.begin(), m_aEnabledEventClasses.end(), oEventClass) != m_aEnabledEventClasses.end());
+}
+void ThreadedChildDeviceManager::enableEventClass(const Event::Class& oEventClass) noexcept
+{
+	if (isEventClassEnabled(oEventClass)) {
+		return; //--------------------------------------------------------------
+	}
+	auto& aEventClasses = *getEventClassesSnapshot();
+	if (std::find(aEventClasses.begin(), aEventClasses.end(), oEventClass) == aEventClasses.end()) {
+		// not supported by the inner device manager
+		return; //--------------------------------------------------------------
+	}
+	m_aEnabledEventClasses.push_back(oEventClass);
+	post([oEventClass](ChildDeviceManager& oInner)
+	{
+		oInner.enableEventClass(oEventClass);
+	});
+}
+bool ThreadedChildDeviceManager::addAccessor(const shared_ptr<Accessor>& refAccessor) noexcept
+{
+	bool bAdded = false;
+	runInWorker([&](ChildDeviceManager& oInner)
+	{
+		bAdded = oInner.addAccessor(refAccessor);
+	});
+	if (bAdded && !hasAccessor(refAccessor)) {
+		m_aAccessors.push_back(refAccessor);
+	}
+	return bAdded;
+}
+bool ThreadedChildDeviceManager::removeAccessor(const shared_ptr<Accessor>& refAccessor) noexcept
+{
+	bool bRemoved = false;
+	runInWorker([&](ChildDeviceManager& oInner)
+	{
+		bRemoved = oInner.removeAccessor(refAccessor);
+	});
+	auto itFind = std::find(m_aAccessors.begin(), m_aAccessors.end(), refAccessor);
+	if (itFind != m_aAccessors.end()) {
+		m_aAccessors.erase(itFind);
+	}
+	return bRemoved;
+}
+bool ThreadedChildDeviceManager::hasAccessor(const shared_ptr<Accessor>& refAccessor) noexcept
+{
+	return (std::find(m_aAccessors.begin(), m_aAccessors.end(), refAccessor) != m_aAccessors.end());
+}
+bool ThreadedChildDeviceManager::addEventListener(const shared_ptr<EventListener>& refEventListener, const shared_ptr<CallIf>& refCallIf) noexcept
+{
+	return addListenerEntry(refEventListener, refCallIf, true);
+}
+bool ThreadedChildDeviceManager::addEventListener(const shared_ptr<EventListener>& refEventListener) noexcept
+{
+	return addListenerEntry(refEventListener, shared_ptr<CallIf>{}, false);
+}
+bool ThreadedChildDeviceManager::addListenerEntry(const shared_ptr<EventListener>& refEventListener
+												, const shared_ptr<CallIf>& refCallIf, bool bWithCallIf) noexcept
+{
+	assert(refEventListener);
+	EventListener* p0EventListener = refEventListener.get();
+	for (auto& refEntry : m_aListenerEntries) {
+		if (refEntry->m_p0EventListener == p0EventListener) {
+			// the listener was already added (and not removed)
+			return false; //----------------------------------------------------
+		}
+	}
+	auto refEntry = std::make_shared<ListenerEntry>();
+	refEntry->m_refEventListener = refEventListener;
+	refEntry->m_p0EventListener = p0EventListener;
+	// Called in the worker thread. The entry is weak because it owns the listener
+	weak_ptr<ListenerEntry> refWeakEntry = refEntry;
+	refEntry->m_refWorkerListener = std::make_shared<EventListener>([this, refWeakEntry](const shared_ptr<Event>& refEvent)
+	{
+		auto refEntry = refWeakEntry.lock();
+		if (!refEntry) {
+			return; //----------------------------------------------------------
+		}
+		QueuedItem oItem;
+		oItem.m_bFinalize = (refEntry.get() == m_p0WorkerFinalizingEntry);
+		oItem.m_refEntry = std::move(refEntry);
+		oItem.m_refEvent = refEvent;
+		pushItem(std::move(oItem));
+	});
+	m_aListenerEntries.push_back(refEntry);
+	post([refEntry, refCallIf, bWithCallIf](ChildDeviceManager& oInner)
+	{
+		if (bWithCallIf) {
+			oInner.addEventListener(refEntry->m_refWorkerListener, refCallIf);
+		} else {
+			oInner.addEventListener(refEntry->m_refWorkerListener);
+		}
+	});
+	return true;
+}
+bool ThreadedChildDeviceManager::removeEventListener(const shared_ptr<EventListener>& refEventListener, bool bFinalize) noexcept
+{
+	assert(refEventListener);
+	EventListener* p0EventListener = refEventListener.get();
+	auto itFind = std::find_if(m_aListenerEntries.begin(), m_aListenerEntries.end()
+								, [&](const shared_ptr<ListenerEntry>& refEntry)
+								{
+									return (refEntry->m_p0EventListener == p0EventListener);
+								});
+	if (itFind == m_aListenerEntries.end()) {
+		return false; //--------------------------------------------------------
+	}
+	auto refEntry = *itFind;
+	removeEntry(refEntry, bFinalize);
+	return true;
+}
+bool ThreadedChildDeviceManager::removeEventListener(const shared_ptr<EventListener>& refEventListener) noexcept
+{
+	return removeEventListener(refEventListener, false);
+}
+void ThreadedChildDeviceManager::removeEntry(const shared_ptr<ListenerEntry>& refEntry, bool bFinalize) noexcept
+{
+	// Send what was already queued, the events that follow are
+	// ignored by sendQueuedItems() unless sent because of bFinalize
+	sendQueuedItems();
+	refEntry->m_eState = (bFinalize ? LISTENER_STATE_FINALIZING : LISTENER_STATE_REMOVED);
+	auto itFind = std::find(m_aListenerEntries.begin(), m_aListenerEntries.end(), refEntry);
+	if (itFind != m_aListenerEntries.end()) {
+		m_aListenerEntries.erase(itFind);
+	}
+	post([this, refEntry, bFinalize](ChildDeviceManager& oInner)
+	{
+		m_p0WorkerFinalizingEntry = (bFinalize ? refEntry.get() : nullptr);
+		oInner.removeEventListener(refEntry->m_refWorkerListener, bFinalize);
+		m_p0WorkerFinalizingEntry = nullptr;
+	});
+}
+
+} // namespace stmi
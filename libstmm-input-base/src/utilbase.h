@@ -23,6 +23,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <iterator>
+
+#include <cassert>
 
 namespace stmi
 {
@@ -52,6 +55,30 @@ static void addToVectorSet(std::vector<T>& aSet, const T& oValue) noexcept
 	}
 }
 
+/* * Merge a sorted set "represented" by a vector into another.
+ * Both vectors must be sorted and without duplicates, the result is too.
+ * Linear in the size of the two sets.
+ * @param aSet The set to merge into.
+ * @param aChildSet The set to merge.
+ * @param aTmp Temporary buffer (to avoid reallocations when merging more sets).
+ */
+template <class T>
+static void mergeToSortedVectorSet(std::vector<T>& aSet, const std::vector<T>& aChildSet, std::vector<T>& aTmp) noexcept
+{
+	assert(std::is_sorted(aSet.begin(), aSet.end()));
+	assert(std::is_sorted(aChildSet.begin(), aChildSet.end()));
+	if (aChildSet.empty()) {
+		return; //--------------------------------------------------------------
+	}
+	if (aSet.empty()) {
+		aSet = aChildSet;
+		return; //--------------------------------------------------------------
+	}
+	aTmp.clear();
+	std::set_union(aSet.begin(), aSet.end(), aChildSet.begin(), aChildSet.end(), std::back_inserter(aTmp));
+	aSet.swap(aTmp);
+}
+
 } // namespace Util
 
 } // namespace stmi
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testCallIfProgram.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "callifcompiler.h"
+
+#include <stmm-input-fake/fakekeydevice.h>
+#include <stmm-input-fake/fakepointerdevice.h>
+
+#include "keyevent.h"
+#include "pointerevent.h"
+
+#include <stmm-input/callifs.h>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace testing
+{
+
+class CallIfProgramFixture
+{
+public:
+	CallIfProgramFixture()
+	{
+		m_refKeyDevice = std::make_shared<FakeKeyDevice>();
+		#ifndef NDEBUG
+		const bool bFound = 
+		#endif
+		m_refKeyDevice->getCapability(m_refKeyCapability);
+		assert(bFound);
+		m_refPointerDevice = std::make_shared<FakePointerDevice>();
+		#ifndef NDEBUG
+		const bool bFound2 = 
+		#endif
+		m_refPointerDevice->getCapability(m_refPointerCapability);
+		assert(bFound2);
+		const auto nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+		m_refKeyEvent = std::make_shared<KeyEvent>(nTimeUsec, Accessor::s_refEmptyAccessor, m_refKeyCapability, KeyEvent::KEY_PRESS, HK_U);
+		m_refPointerEvent = std::make_shared<PointerEvent>(nTimeUsec, Accessor::s_refEmptyAccessor, m_refPointerCapability
+															, 100.0, 200.0, PointerEvent::BUTTON_PRESS, 1, true, false);
+	}
+protected:
+	shared_ptr<Device> m_refKeyDevice;
+	shared_ptr<KeyCapability> m_refKeyCapability;
+	shared_ptr<Device> m_refPointerDevice;
+	shared_ptr<PointerCapability> m_refPointerCapability;
+	shared_ptr<Event> m_refKeyEvent;
+	shared_ptr<Event> m_refPointerEvent;
+};
+
+TEST_CASE_METHOD(CallIfProgramFixture, "TrueFalse")
+{
+	auto oNullProgram = CallIfCompiler::compile(shared_ptr<CallIf>{});
+	REQUIRE(oNullProgram.isAlwaysTrue());
+	REQUIRE(oNullProgram.eval(m_refKeyEvent));
+	auto oTrueProgram = CallIfCompiler::compile(CallIfTrue::getInstance());
+	REQUIRE(oTrueProgram.isAlwaysTrue());
+	auto oFalseProgram = CallIfCompiler::compile(CallIfFalse::getInstance());
+	REQUIRE(oFalseProgram.isAlwaysFalse());
+	REQUIRE_FALSE(oFalseProgram.eval(m_refKeyEvent));
+}
+
+TEST_CASE_METHOD(CallIfProgramFixture, "Leaves")
+{
+	auto refCIKeyDeviceId = std::make_shared<CallIfDeviceId>(m_refKeyDevice->getId());
+	auto refCIKeyCapabilityId = std::make_shared<CallIfCapabilityId>(m_refKeyCapability->getId());
+	auto refCIKeyCapabilityClass = std::make_shared<CallIfCapabilityClass>(KeyCapability::getClass());
+	auto refCIKeyEventClass = std::make_shared<CallIfEventClass>(KeyEvent::getClass());
+	auto refCIXYEvent = std::make_shared<CallIfXYEvent>();
+	auto refCIDMCapability = std::make_shared<CallIfDeviceManagerCapability>();
+	auto refCIAccessor = std::make_shared<CallIfAccessor>();
+	for (const auto& refCallIf : std::vector<shared_ptr<CallIf>>{refCIKeyDeviceId, refCIKeyCapabilityId
+																, refCIKeyCapabilityClass, refCIKeyEventClass
+																, refCIXYEvent, refCIDMCapability, refCIAccessor}) {
+		auto oProgram = CallIfCompiler::compile(refCallIf);
+		REQUIRE(oProgram.getInstrs().size() == 1);
+		REQUIRE(oProgram.getInstrs()[0].m_eOp != Private::CallIfProgram::OP_CALLIF);
+		REQUIRE(oProgram.eval(m_refKeyEvent) == (*refCallIf)(m_refKeyEvent));
+		REQUIRE(oProgram.eval(m_refPointerEvent) == (*refCallIf)(m_refPointerEvent));
+	}
+}
+
+TEST_CASE_METHOD(CallIfProgramFixture, "AndOrNot")
+{
+	auto refCIKeyEventClass = std::make_shared<CallIfEventClass>(KeyEvent::getClass());
+	auto refCIPointerDeviceId = std::make_shared<CallIfDeviceId>(m_refPointerDevice->getId());
+	auto refCIOr = std::make_shared<CallIfOr>(refCIKeyEventClass, refCIPointerDeviceId);
+	auto refCIAnd = std::make_shared<CallIfAnd>(refCIKeyEventClass, refCIPointerDeviceId);
+	auto refCINotOr = std::make_shared<CallIfNot>(refCIOr);
+	auto refCINotAnd = std::make_shared<CallIfNot>(refCIAnd);
+	auto refCINested = std::make_shared<CallIfOr>(refCINotAnd, std::make_shared<CallIfAnd>(refCIOr, refCINotOr));
+	for (const auto& refCallIf : std::vector<shared_ptr<CallIf>>{refCIOr, refCIAnd, refCINotOr, refCINotAnd, refCINested}) {
+		auto oProgram = CallIfCompiler::compile(refCallIf);
+		REQUIRE(oProgram.eval(m_refKeyEvent) == (*refCallIf)(m_refKeyEvent));
+		REQUIRE(oProgram.eval(m_refPointerEvent) == (*refCallIf)(m_refPointerEvent));
+	}
+}
+
+TEST_CASE_METHOD(CallIfProgramFixture, "ShortCircuit")
+{
+	int32_t nCalled = 0;
+	CallIfFuction::CallIfFunction oFunction = [&](const shared_ptr<const Event>& /*refEvent*/)
+	{
+		++nCalled;
+		return true;
+	};
+	auto refCIFunction = std::make_shared<CallIfFuction>(oFunction);
+	auto refCIKeyEventClass = std::make_shared<CallIfEventClass>(KeyEvent::getClass());
+	auto oAndProgram = CallIfCompiler::compile(std::make_shared<CallIfAnd>(refCIKeyEventClass, refCIFunction));
+	REQUIRE_FALSE(oAndProgram.eval(m_refPointerEvent));
+	REQUIRE(nCalled == 0);
+	REQUIRE(oAndProgram.eval(m_refKeyEvent));
+	REQUIRE(nCalled == 1);
+	auto oOrProgram = CallIfCompiler::compile(std::make_shared<CallIfOr>(refCIKeyEventClass, refCIFunction));
+	REQUIRE(oOrProgram.eval(m_refKeyEvent));
+	REQUIRE(nCalled == 1);
+	REQUIRE(oOrProgram.eval(m_refPointerEvent));
+	REQUIRE(nCalled == 2);
+}
+
+TEST_CASE_METHOD(CallIfProgramFixture, "CachedCapabilityData")
+{
+	REQUIRE(m_refKeyEvent->hasCapabilityData());
+	REQUIRE(m_refKeyEvent->getDeviceId() == m_refKeyDevice->getId());
+	REQUIRE(m_refKeyEvent->getCapabilityClass() == KeyCapability::getClass());
+	auto refCIKeyDevice = std::make_shared<CallIfAnd>(std::make_shared<CallIfDeviceId>(m_refKeyDevice->getId())
+													, std::make_shared<CallIfCapabilityClass>(KeyCapability::getClass()));
+	auto oProgram = CallIfCompiler::compile(refCIKeyDevice);
+	REQUIRE_FALSE(oProgram.hasCallIfInstrs());
+	const Event& oKeyEvent = *m_refKeyEvent;
+	const Event& oPointerEvent = *m_refPointerEvent;
+	REQUIRE(oProgram.eval(oKeyEvent));
+	REQUIRE_FALSE(oProgram.eval(oPointerEvent));
+	const auto nUseCount = m_refKeyEvent.use_count();
+	oProgram.eval(oKeyEvent);
+	REQUIRE(m_refKeyEvent.use_count() == nUseCount);
+}
+
+} // namespace testing
+
+} // namespace stmi
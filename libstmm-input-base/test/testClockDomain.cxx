@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testClockDomain.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "clockdomain.h"
+
+#include <stmm-input/devicemanager.h>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+TEST_CASE("testClockDomain, Offset")
+{
+	ClockDomain oClockDomain;
+	// 1 second device time received at 5 seconds
+	REQUIRE(oClockDomain.getTimeUsec(1000, 5000000) == 5000000);
+	// received with less delay: the offset shrinks
+	REQUIRE(oClockDomain.getTimeUsec(1010, 5009000) == 5009000);
+	// received with more delay (ex. main loop stall): the offset grows slowly
+	REQUIRE(oClockDomain.getTimeUsec(1020, 5050000) == 5019000 + ClockDomain::s_nMaxDriftUsec);
+	// device clock reset
+	REQUIRE(oClockDomain.getTimeUsec(1030, 5050000 + ClockDomain::s_nResetAfterUsec + 1000000)
+			== 5050000 + ClockDomain::s_nResetAfterUsec + 1000000);
+}
+
+TEST_CASE("testClockDomain, WrapAround")
+{
+	ClockDomain oClockDomain;
+	REQUIRE(oClockDomain.getTimeUsec(0xFFFFFFF0u, 7000000) == 7000000);
+	// 32 milliseconds later
+	REQUIRE(oClockDomain.getTimeUsec(0x00000010u, 7032000) == 7032000);
+	// 8 milliseconds earlier than the previous: the returned times never decrease
+	REQUIRE(oClockDomain.getTimeUsec(0x00000008u, 7040000) == 7032000);
+}
+
+TEST_CASE("testClockDomain, CurrentTime")
+{
+	ClockDomain oClockDomain;
+	REQUIRE(oClockDomain.getTimeUsec(0, 123) == 123);
+	const int64_t nTimeUsec = oClockDomain.getTimeUsec(1000);
+	REQUIRE(nTimeUsec <= DeviceManager::getNowTimeMicroseconds());
+	// without sampling the current time
+	REQUIRE(oClockDomain.getTimeUsec(1001) == nTimeUsec + 1000);
+}
+
+} // namespace testing
+
+} // namespace stmi
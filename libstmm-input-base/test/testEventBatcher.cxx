@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testEventBatcher.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "eventbatcher.h"
+
+#include <stmm-input-fake/fakekeydevice.h>
+
+#include "keyevent.h"
+
+namespace stmi
+{
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace testing
+{
+
+class EventBatcherFixture
+{
+public:
+	EventBatcherFixture()
+	{
+		m_refKeyDevice = std::make_shared<FakeKeyDevice>();
+		#ifndef NDEBUG
+		const bool bFound = 
+		#endif
+		m_refKeyDevice->getCapability(m_refKeyCapability);
+		assert(bFound);
+		m_refBatchListener = std::make_shared<BatchEventListener>(
+				[&](const shared_ptr<Event>* p0Events, int32_t nTotEvents)
+				{
+					m_aBatchSizes.push_back(nTotEvents);
+					for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+						m_aReceivedEvents.push_back(p0Events[nIdx]);
+					}
+				});
+	}
+	shared_ptr<Event> createKeyEvent(HARDWARE_KEY eKey)
+	{
+		const auto nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+		return std::make_shared<KeyEvent>(nTimeUsec, Accessor::s_refEmptyAccessor, m_refKeyCapability, KeyEvent::KEY_PRESS, eKey);
+	}
+protected:
+	shared_ptr<Device> m_refKeyDevice;
+	shared_ptr<KeyCapability> m_refKeyCapability;
+	shared_ptr<BatchEventListener> m_refBatchListener;
+	std::vector<int32_t> m_aBatchSizes;
+	std::vector< shared_ptr<Event> > m_aReceivedEvents;
+};
+
+TEST_CASE_METHOD(EventBatcherFixture, "FlushDeliversInOrder")
+{
+	EventBatcher oBatcher(m_refBatchListener);
+	oBatcher.flush();
+	REQUIRE(m_aBatchSizes.empty());
+
+	auto refEvent1 = createKeyEvent(HK_A);
+	auto refEvent2 = createKeyEvent(HK_B);
+	auto refEvent3 = createKeyEvent(HK_C);
+	const EventListener& oListener = *oBatcher.getEventListener();
+	oListener(refEvent1);
+	oListener(refEvent2);
+	REQUIRE(oBatcher.getTotPendingEvents() == 2);
+	REQUIRE(m_aReceivedEvents.empty());
+
+	oBatcher.flush();
+	REQUIRE(oBatcher.getTotPendingEvents() == 0);
+	REQUIRE(m_aBatchSizes == std::vector<int32_t>{2});
+	REQUIRE(m_aReceivedEvents.size() == 2);
+	REQUIRE(m_aReceivedEvents[0] == refEvent1);
+	REQUIRE(m_aReceivedEvents[1] == refEvent2);
+
+	oListener(refEvent3);
+	oBatcher.flush();
+	oBatcher.flush();
+	REQUIRE(m_aBatchSizes == (std::vector<int32_t>{2, 1}));
+	REQUIRE(m_aReceivedEvents.back() == refEvent3);
+}
+
+class FirstPendingEventBatcher : public EventBatcher
+{
+public:
+	explicit FirstPendingEventBatcher(const shared_ptr<BatchEventListener>& refBatchListener)
+	: EventBatcher(refBatchListener)
+	, m_nTotFirstPending(0)
+	{
+	}
+	int32_t m_nTotFirstPending;
+protected:
+	void onFirstPendingEvent() noexcept override
+	{
+		++m_nTotFirstPending;
+	}
+};
+
+TEST_CASE_METHOD(EventBatcherFixture, "FirstPendingEvent")
+{
+	FirstPendingEventBatcher oBatcher(m_refBatchListener);
+	const EventListener& oListener = *oBatcher.getEventListener();
+	oListener(createKeyEvent(HK_A));
+	oListener(createKeyEvent(HK_B));
+	REQUIRE(oBatcher.m_nTotFirstPending == 1);
+	oBatcher.flush();
+	oListener(createKeyEvent(HK_C));
+	REQUIRE(oBatcher.m_nTotFirstPending == 2);
+}
+
+} // namespace testing
+
+} // namespace stmi
@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testEventQueue.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "eventqueue.h"
+
+#include <stmm-input-fake/fakekeydevice.h>
+
+#include "keyevent.h"
+
+#include <thread>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace testing
+{
+
+class EventQueueFixture
+{
+public:
+	EventQueueFixture()
+	{
+		m_refKeyDevice = std::make_shared<FakeKeyDevice>();
+		#ifndef NDEBUG
+		const bool bFound = 
+		#endif
+		m_refKeyDevice->getCapability(m_refKeyCapability);
+		assert(bFound);
+	}
+	shared_ptr<Event> createKeyEvent(int64_t nTimeUsec)
+	{
+		return std::make_shared<KeyEvent>(nTimeUsec, Accessor::s_refEmptyAccessor, m_refKeyCapability, KeyEvent::KEY_PRESS, HK_A);
+	}
+protected:
+	shared_ptr<Device> m_refKeyDevice;
+	shared_ptr<KeyCapability> m_refKeyCapability;
+};
+
+TEST_CASE_METHOD(EventQueueFixture, "PushPopDrain")
+{
+	EventQueue oQueue(3);
+	REQUIRE(oQueue.getCapacity() == 4);
+	REQUIRE(oQueue.isEmpty());
+	shared_ptr<Event> refEvent;
+	REQUIRE_FALSE(oQueue.pop(refEvent));
+	REQUIRE_FALSE(refEvent);
+
+	const EventListener& oListener = *oQueue.getEventListener();
+	for (int64_t nTimeUsec = 0; nTimeUsec < 5; ++nTimeUsec) {
+		oListener(createKeyEvent(nTimeUsec));
+	}
+	REQUIRE(oQueue.getTotDroppedEvents() == 1);
+	REQUIRE(oQueue.pop(refEvent));
+	REQUIRE(refEvent->getTimeUsec() == 0);
+	REQUIRE(refEvent.use_count() == 1);
+
+	REQUIRE(oQueue.push(createKeyEvent(5)));
+	std::vector< shared_ptr<Event> > aEvents;
+	REQUIRE(oQueue.drain(aEvents) == 4);
+	REQUIRE(oQueue.isEmpty());
+	REQUIRE(aEvents.size() == 4);
+	// the event with time 4 was dropped
+	REQUIRE(aEvents[0]->getTimeUsec() == 1);
+	REQUIRE(aEvents[1]->getTimeUsec() == 2);
+	REQUIRE(aEvents[2]->getTimeUsec() == 3);
+	REQUIRE(aEvents[3]->getTimeUsec() == 5);
+	REQUIRE(oQueue.drain(aEvents) == 0);
+}
+
+TEST_CASE_METHOD(EventQueueFixture, "ProducerConsumer")
+{
+	EventQueue oQueue(64);
+	const int64_t nTotEvents = 20000;
+	std::vector< shared_ptr<Event> > aEvents;
+	for (int64_t nTimeUsec = 0; nTimeUsec < nTotEvents; ++nTimeUsec) {
+		aEvents.push_back(createKeyEvent(nTimeUsec));
+	}
+	bool bInOrder = true;
+	std::thread oConsumer([&]()
+	{
+		int64_t nExpected = 0;
+		shared_ptr<Event> refEvent;
+		while (nExpected < nTotEvents) {
+			if (!oQueue.pop(refEvent)) {
+				std::this_thread::yield();
+				continue; // while
+			}
+			if (refEvent->getTimeUsec() != nExpected) {
+				bInOrder = false;
+			}
+			++nExpected;
+		}
+	});
+	for (auto& refEvent : aEvents) {
+		while (!oQueue.push(refEvent)) {
+			std::this_thread::yield();
+		}
+	}
+	oConsumer.join();
+	REQUIRE(bInOrder);
+	REQUIRE(oQueue.isEmpty());
+}
+
+} // namespace testing
+
+} // namespace stmi
@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testSpscRing.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "spscring.h"
+
+#include <memory>
+#include <thread>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+TEST_CASE("SpscRing, PushPopDrain")
+{
+	SpscRing<int32_t> oRing(5);
+	REQUIRE(oRing.getCapacity() == 8);
+	REQUIRE(oRing.isEmpty());
+	REQUIRE(oRing.getTotFree() == 8);
+	int32_t nValue = -1;
+	REQUIRE_FALSE(oRing.pop(nValue));
+	REQUIRE(nValue == -1);
+
+	for (int32_t nCount = 0; nCount < 8; ++nCount) {
+		REQUIRE(oRing.push(nCount));
+	}
+	REQUIRE(oRing.getTotFree() == 0);
+	REQUIRE_FALSE(oRing.push(8));
+	REQUIRE(oRing.pop(nValue));
+	REQUIRE(nValue == 0);
+	REQUIRE(oRing.getTotFree() == 1);
+	REQUIRE(oRing.push(8));
+
+	std::vector<int32_t> aValues;
+	REQUIRE(oRing.drain(aValues) == 8);
+	REQUIRE(aValues == (std::vector<int32_t>{1, 2, 3, 4, 5, 6, 7, 8}));
+	REQUIRE(oRing.isEmpty());
+	REQUIRE(oRing.getTotFree() == 8);
+	REQUIRE(oRing.drain(aValues) == 0);
+}
+
+TEST_CASE("SpscRing, PopMovesOut")
+{
+	SpscRing< std::shared_ptr<int32_t> > oRing(2);
+	auto refValue = std::make_shared<int32_t>(7);
+	REQUIRE(oRing.push(refValue));
+	REQUIRE(refValue.use_count() == 2);
+	std::shared_ptr<int32_t> refPopped;
+	REQUIRE(oRing.pop(refPopped));
+	REQUIRE(refValue.use_count() == 2);
+	refPopped.reset();
+	// the ring doesn't keep a reference
+	REQUIRE(refValue.use_count() == 1);
+}
+
+TEST_CASE("SpscRing, PushMovesInOnlyIfNotFull")
+{
+	SpscRing< std::shared_ptr<int32_t> > oRing(1);
+	auto refValue = std::make_shared<int32_t>(7);
+	auto refMoved = refValue;
+	REQUIRE(oRing.push(std::move(refMoved)));
+	REQUIRE_FALSE(refMoved);
+	REQUIRE(refValue.use_count() == 2);
+	auto refOther = std::make_shared<int32_t>(8);
+	REQUIRE_FALSE(oRing.push(std::move(refOther)));
+	// not moved from, can be pushed elsewhere
+	REQUIRE(refOther);
+	REQUIRE(*refOther == 8);
+}
+
+TEST_CASE("SpscRing, ProducerConsumer")
+{
+	struct Value
+	{
+		int32_t m_nId;
+		int64_t m_nSeq;
+	};
+	SpscRing<Value> oRing(64);
+	const int64_t nTotValues = 100000;
+	bool bInOrder = true;
+	std::thread oConsumer([&]()
+	{
+		int64_t nExpected = 0;
+		Value oValue;
+		while (nExpected < nTotValues) {
+			if (!oRing.pop(oValue)) {
+				std::this_thread::yield();
+				continue; // while
+			}
+			if ((oValue.m_nSeq != nExpected) || (oValue.m_nId != static_cast<int32_t>(nExpected % 7))) {
+				bInOrder = false;
+			}
+			++nExpected;
+		}
+	});
+	for (int64_t nSeq = 0; nSeq < nTotValues; ++nSeq) {
+		while (!oRing.push(Value{static_cast<int32_t>(nSeq % 7), nSeq})) {
+			std::this_thread::yield();
+		}
+	}
+	oConsumer.join();
+	REQUIRE(bInOrder);
+	REQUIRE(oRing.isEmpty());
+}
+
+} // namespace testing
+
+} // namespace stmi
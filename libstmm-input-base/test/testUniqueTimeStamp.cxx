@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testUniqueTimeStamp.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "basicdevicemanager.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+// Never instantiated, just gives access to the protected static function
+class TimeStamper : public BasicDeviceManager
+{
+public:
+	using BasicDeviceManager::getUniqueTimeStamp;
+};
+
+TEST_CASE("testUniqueTimeStamp, Increasing")
+{
+	const uint64_t nStamp1 = TimeStamper::getUniqueTimeStamp();
+	const uint64_t nStamp2 = TimeStamper::getUniqueTimeStamp();
+	REQUIRE(nStamp1 > 0);
+	REQUIRE(nStamp2 > nStamp1);
+}
+
+TEST_CASE("testUniqueTimeStamp, UniqueAcrossThreads")
+{
+	constexpr int32_t nTotThreads = 4;
+	constexpr int32_t nTotStamps = 20000;
+	std::vector< std::vector<uint64_t> > aThreadStamps(nTotThreads);
+	std::vector<std::thread> aThreads;
+	for (int32_t nThread = 0; nThread < nTotThreads; ++nThread) {
+		auto& aStamps = aThreadStamps[nThread];
+		aStamps.reserve(nTotStamps);
+		aThreads.emplace_back([&aStamps]()
+		{
+			for (int32_t nCount = 0; nCount < nTotStamps; ++nCount) {
+				aStamps.push_back(TimeStamper::getUniqueTimeStamp());
+			}
+		});
+	}
+	for (auto& oThread : aThreads) {
+		oThread.join();
+	}
+	// joined threads happen-before this one
+	const uint64_t nAfterStamp = TimeStamper::getUniqueTimeStamp();
+
+	std::vector<uint64_t> aAllStamps;
+	for (auto& aStamps : aThreadStamps) {
+		REQUIRE(aStamps.size() == static_cast<size_t>(nTotStamps));
+		REQUIRE(std::is_sorted(aStamps.begin(), aStamps.end()));
+		aAllStamps.insert(aAllStamps.end(), aStamps.begin(), aStamps.end());
+	}
+	std::sort(aAllStamps.begin(), aAllStamps.end());
+	REQUIRE(std::adjacent_find(aAllStamps.begin(), aAllStamps.end()) == aAllStamps.end());
+	REQUIRE(aAllStamps.back() < nAfterStamp);
+}
+
+} // namespace testing
+
+} // namespace stmi
@@ -136,14 +136,15 @@ public:
 
 	int32_t simulateEvent(const shared_ptr<Event>& refEvent) noexcept
 	{
-		if (!isEventClassEnabled(refEvent->getEventClass())) {
+		const int32_t nClassIdx = getEventClassIndex(refEvent->getEventClass());
+		if ((nClassIdx < 0) || !isEventClassIndexEnabled(nClassIdx)) {
 //std::cout << "Tst99DeviceManager::simulateTst99Event()  refEvent->getEventClass()=" << refEvent->getEventClass().getId() << '\n';
 			return -1;
 		}
 		int32_t nTotSent = 0;
-		auto refListeners = getListeners();
+		auto refListeners = getListeners(nClassIdx);
 		for (ListenerData* p0ListenerData : *refListeners) {
-			const bool bSent = p0ListenerData->handleEventCallIf(-1, refEvent);
+			const bool bSent = p0ListenerData->handleEventCallIf(nClassIdx, refEvent);
 			if (bSent) {
 				++nTotSent;
 			}
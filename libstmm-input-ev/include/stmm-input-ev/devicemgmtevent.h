@@ -108,7 +108,7 @@ protected:
 	inline void setDeviceMgmtCapability(const shared_ptr<DeviceMgmtCapability>& refDeviceMgmtCapability) noexcept
 	{
 		assert(refDeviceMgmtCapability);
-		setCapabilityId(refDeviceMgmtCapability->getId());
+		setCapability(*refDeviceMgmtCapability);
 		m_refDeviceMgmtCapability = refDeviceMgmtCapability;
 	}
 private:
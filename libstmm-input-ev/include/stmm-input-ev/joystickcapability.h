@@ -25,6 +25,8 @@
 #include <stmm-input/capability.h>
 
 #include <algorithm>
+#include <array>
+#include <bitset>
 #include <vector>
 #include <cstdint>
 
@@ -214,6 +216,38 @@ public:
 		auto& aAxes = getAxes();
 		return std::binary_search(aAxes.begin(), aAxes.end(), eAxis);
 	}
+	/** The number of values from the minimal to the maximal BUTTON, undefined values included. */
+	static constexpr int32_t s_nButtonRange = BUTTON_GEAR_UP - BUTTON_TRIGGER + 1;
+	/** The number of values from the minimal to the maximal AXIS, undefined values included. */
+	static constexpr int32_t s_nAxisRange = AXIS_TILT_Y - AXIS_X + 1;
+	/** The state of all the buttons, hats and axes of a device.
+	 * See getState(). An instance can be reused for many calls
+	 * without allocating memory (as long as the number of hats doesn't grow).
+	 */
+	struct State
+	{
+		/** Bit `eButton - BUTTON_TRIGGER` is set if the button is pressed. */
+		std::bitset<s_nButtonRange> m_oButtonPressed;
+		/** Index: `eAxis - AXIS_X`, Value: the axis value or 0 if not supported. */
+		std::array<int32_t, s_nAxisRange> m_aAxisValue;
+		/** Size: getTotHats(), Value: the hat value. */
+		std::vector<HAT_VALUE> m_aHatValue;
+
+		/** Whether a button is pressed.
+		 * @param eButton The button. Must be valid.
+		 */
+		bool isButtonPressed(JoystickCapability::BUTTON eButton) const noexcept
+		{
+			return m_oButtonPressed[eButton - BUTTON_TRIGGER];
+		}
+		/** The value of an axis.
+		 * @param eAxis The axis. Must be valid.
+		 */
+		int32_t getAxisValue(JoystickCapability::AXIS eAxis) const noexcept
+		{
+			return m_aAxisValue[eAxis - AXIS_X];
+		}
+	};
 	/** Whether a device implementing this capability has the given button. */
 	virtual bool getHasButton(JoystickCapability::BUTTON eButton) const noexcept = 0;
 	/** The number of hats the device implementing this capability has. */
@@ -231,6 +265,13 @@ public:
 	 * If the axis is not supported 0 is returned.
 	 */
 	virtual int32_t getAxisValue(JoystickCapability::AXIS eAxis) const noexcept = 0;
+	/** Copies the state of all the buttons, hats and axes at once.
+	 * The default implementation calls isButtonPressed(), getHatValue() and
+	 * getAxisValue() for each button, hat and axis. Subclasses can copy
+	 * their state more efficiently.
+	 * @param oState [output] The state.
+	 */
+	virtual void getState(State& oState) const noexcept;
 
 	//TODO Here could insert force feedback methods??? Or in a separate Capability
 	//
@@ -84,6 +84,10 @@ public:
 	 * @return The new value. Cannot be JoystickCapability::HAT_VALUE_NOT_SET.
 	 */
 	inline JoystickCapability::HAT_VALUE getValue() const noexcept { return m_eValue; }
+	/** The previous value of the hat.
+	 * @return The previous value or JoystickCapability::HAT_VALUE_NOT_SET if key simulation is disabled.
+	 */
+	inline JoystickCapability::HAT_VALUE getPreviousValue() const noexcept { return m_ePreviousValue; }
 	/** The value of the hat in unary coordinates.
 	 * Examples:
 	 * - JoystickCapability::HAT_CENTER corresponds to pair (X=0, Y=0).
@@ -110,7 +114,7 @@ public:
 	// from Event class
 	shared_ptr<Capability> getCapability() const noexcept override { return m_refJoystickCapability.lock(); }
 	/** The first of one or more simulated keys.
-	 * @see JoystickHatEvent::getAsKeys()
+	 * @see JoystickHatEvent::fillAsKeys()
 	 */
 	bool getAsKey(HARDWARE_KEY& eKey, AS_KEY_INPUT_TYPE& eType, bool& bMoreThanOne) const noexcept override;
 	/** The generated simulated keys.
@@ -128,8 +132,10 @@ public:
 	 * Example 3: A (physically very unlikely) hat `0` transition from HAT_LEFTUP to HAT_RIGHTDOWN
 	 * simulates the keys
 	 * `{ {HK_UP, AS_KEY_RELEASE}, {HK_LEFT, AS_KEY_RELEASE}, {HK_DOWN, AS_KEY_PRESS}, {HK_RIGHT, AS_KEY_PRESS} }`
+	 *
+	 * Event::getAsKeys() returns the same keys in a vector.
 	 */
-	std::vector< std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE> > getAsKeys() const noexcept override;
+	void fillAsKeys(AsKeys& oAsKeys) const noexcept override;
 	//
 	static const char* const s_sClassId;
 	static const Event::Class& getClass() noexcept
@@ -173,7 +179,7 @@ protected:
 	inline void setJoystickCapability(const shared_ptr<JoystickCapability>& refJoystickCapability) noexcept
 	{
 		assert(refJoystickCapability);
-		setCapabilityId(refJoystickCapability->getId());
+		setCapability(*refJoystickCapability);
 		m_refJoystickCapability = refJoystickCapability;
 	}
 private:
@@ -256,7 +262,7 @@ protected:
 	inline void setJoystickCapability(const shared_ptr<JoystickCapability>& refJoystickCapability) noexcept
 	{
 		assert(refJoystickCapability);
-		setCapabilityId(refJoystickCapability->getId());
+		setCapability(*refJoystickCapability);
 		m_refJoystickCapability = refJoystickCapability;
 	}
 private:
@@ -340,7 +346,7 @@ protected:
 	inline void setJoystickCapability(const shared_ptr<JoystickCapability>& refJoystickCapability) noexcept
 	{
 		assert(refJoystickCapability);
-		setCapabilityId(refJoystickCapability->getId());
+		setCapability(*refJoystickCapability);
 		m_refJoystickCapability = refJoystickCapability;
 	}
 private:
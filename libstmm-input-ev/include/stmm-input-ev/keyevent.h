@@ -107,7 +107,7 @@ protected:
 	inline void setKeyCapability(const shared_ptr<KeyCapability>& refKeyCapability) noexcept
 	{
 		assert(refKeyCapability);
-		setCapabilityId(refKeyCapability->getId());
+		setCapability(*refKeyCapability);
 		m_refKeyCapability = refKeyCapability;
 	}
 private:
@@ -56,6 +56,13 @@ public:
 		, POINTER_HOVER = 4 /**< Pointer is hovered (while no button is pressed). */
 		, BUTTON_RELEASE_CANCEL = 5 /**< A button release is canceled. */
 	};
+	/** A position of the pointer in the motion history. */
+	struct MotionSample
+	{
+		int64_t m_nTimeUsec; /**< The time of the sample in microseconds. */
+		double m_fX; /**< The X position of the pointer. */
+		double m_fY; /**< The Y position of the pointer. */
+	};
 	/** Constructor.
 	 * When moving or hovering the pointer, the passed button must be `-1`.
 	 *
@@ -85,6 +92,19 @@ public:
 	 * @return The capability or null if the capability was deleted.
 	 */
 	inline shared_ptr<PointerCapability> getPointerCapability() const noexcept { return m_refPointerCapability.lock(); }
+	/** The motion history of a coalesced POINTER_MOVE or POINTER_HOVER.
+	 * Device managers that coalesce the pointer motions send one event with
+	 * the latest position instead of one for each motion. The positions
+	 * of all the coalesced motions are available here, in chronological order,
+	 * for listeners that need them (ex. drawing tools). The last sample is
+	 * the position of the event.
+	 * @return The samples or empty if the event wasn't coalesced.
+	 */
+	inline const std::vector<MotionSample>& getMotionHistory() const noexcept { return m_aMotionHistory; }
+	/** Translates the position and the motion history. */
+	void translateXY(double fDX, double fDY) noexcept override;
+	/** Scales the position and the motion history. */
+	void scaleXY(double fSX, double fSY) noexcept override;
 	//
 	shared_ptr<Capability> getCapability() const noexcept override { return m_refPointerCapability.lock(); }
 	/** If not hovering or moving returns the simulated keystroke.
@@ -132,13 +152,40 @@ protected:
 	inline void setPointerCapability(const shared_ptr<PointerCapability>& refPointerCapability) noexcept
 	{
 		assert(refPointerCapability);
-		setCapabilityId(refPointerCapability->getId());
+		setCapability(*refPointerCapability);
 		m_refPointerCapability = refPointerCapability;
 	}
+	/** Sets the motion history.
+	 * The buffer of the history is reused: doesn't allocate if the number of samples
+	 * doesn't exceed the capacity (see reserveMotionHistory()).
+	 * @param aMotionHistory The samples in chronological order.
+	 */
+	inline void setMotionHistory(const std::vector<MotionSample>& aMotionHistory) noexcept
+	{
+		m_aMotionHistory.assign(aMotionHistory.begin(), aMotionHistory.end());
+	}
+	/** Clears the motion history.
+	 * The buffer is kept.
+	 */
+	inline void clearMotionHistory() noexcept
+	{
+		m_aMotionHistory.clear();
+	}
+	/** Allocates the buffer of the motion history.
+	 * Recycled events should call this once with the maximum number of samples
+	 * they will be set, so that setMotionHistory() never allocates.
+	 * @param nCapacity The number of samples. Must be &gt;= 0.
+	 */
+	inline void reserveMotionHistory(int32_t nCapacity) noexcept
+	{
+		assert(nCapacity >= 0);
+		m_aMotionHistory.reserve(static_cast<std::size_t>(nCapacity));
+	}
 private:
 	POINTER_INPUT_TYPE m_eType;
 	int32_t m_nButton;
 	weak_ptr<PointerCapability> m_refPointerCapability;
+	std::vector<MotionSample> m_aMotionHistory;
 	//
 	static RegisterClass<PointerEvent> s_oInstall;
 private:
@@ -182,7 +229,7 @@ public:
 	//
 	shared_ptr<Capability> getCapability() const noexcept override { return m_refPointerCapability.lock(); }
 	/** The first (press) of two simulated key actions (press and release).
-	 * To get both actions call getAsKeys().
+	 * To get both actions call fillAsKeys() or getAsKeys().
 	 * The simulated keys are stmi::HK_SCROLLUP, stmi::HK_SCROLLDOWN,
 	 * stmi::HK_X_SCROLL_LEFT, stmi::HK_X_SCROLL_RIGHT.
 	 * @param eKey The key that is simulated by this event.
@@ -197,10 +244,11 @@ public:
 	 * - PointerScrollEvent::SCROLL_LEFT simulates key stmi::HK_X_SCROLL_LEFT.
 	 * - PointerScrollEvent::SCROLL_RIGHT simulates key stmi::HK_X_SCROLL_RIGHT.
 	 *
-	 * The returned vector is `vector{ pair(key, AS_KEY_PRESS), pair(key, AS_KEY_RELEASE) }`.
-	 * @return A press and a release of the simulated key.
+	 * The filled keys are `{ pair(key, AS_KEY_PRESS), pair(key, AS_KEY_RELEASE) }`.
+	 * Event::getAsKeys() returns the same keys in a vector.
+	 * @param oAsKeys Is cleared and filled with a press and a release of the simulated key.
 	 */
-	std::vector< std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE> > getAsKeys() const noexcept override;
+	void fillAsKeys(AsKeys& oAsKeys) const noexcept override;
 	//
 	static const char* const s_sClassId;
 	static const Event::Class& getClass() noexcept
@@ -221,7 +269,7 @@ protected:
 	inline void setPointerCapability(const shared_ptr<PointerCapability>& refPointerCapability) noexcept
 	{
 		assert(refPointerCapability);
-		setCapabilityId(refPointerCapability->getId());
+		setCapability(*refPointerCapability);
 		m_refPointerCapability = refPointerCapability;
 	}
 private:
@@ -30,6 +30,7 @@
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace stmi { class Accessor; }
 namespace stmi { class Capability; }
@@ -108,7 +109,7 @@ protected:
 	inline void setTouchCapability(const shared_ptr<TouchCapability>& refTouchCapability) noexcept
 	{
 		assert(refTouchCapability);
-		setCapabilityId(refTouchCapability->getId());
+		setCapability(*refTouchCapability);
 		m_refTouchCapability = refTouchCapability;
 	}
 private:
@@ -121,6 +122,100 @@ private:
 	TouchEvent() = delete;
 };
 
+/** Event carrying the state of all the contacts of a touch capability.
+ * Instead of one TouchEvent per contact change, one event is sent per touch frame
+ * (all the changes happened at the same time or, depending on the device manager,
+ * within the same main loop iteration).
+ *
+ * The contacts are stored in parallel arrays of the same size: the i-th contact
+ * has finger id getFingerIds()[i], position (getXs()[i], getYs()[i]) and type
+ * getTypes()[i]. The type is TouchEvent::TOUCH_BEGIN if the contact started
+ * within the frame, TouchEvent::TOUCH_UPDATE if it is still active and
+ * TouchEvent::TOUCH_END or TouchEvent::TOUCH_CANCEL if it ended within the frame.
+ * Ended contacts are not part of the following frames.
+ *
+ * XYEvent::getX() and XYEvent::getY() return the centroid of the contacts.
+ * The grab type is always XYEvent::XY_HOVER since the event doesn't represent
+ * a single grab.
+ *
+ * Note that the reference to the capability that generated this event is weak.
+ */
+class TouchFrameEvent : public XYEvent
+{
+public:
+	/** Constructor.
+	 * The arrays must have the same size.
+	 * @param nTimeUsec Time from epoch in microseconds.
+	 * @param refAccessor The accessor used to generate the event. Can be null.
+	 * @param refTouchCapability The capability that generated this event. Cannot be null.
+	 * @param aFingerIds The finger ids of the contacts.
+	 * @param aXs The X positions of the contacts.
+	 * @param aYs The Y positions of the contacts.
+	 * @param aTypes The types of the contacts.
+	 */
+	TouchFrameEvent(int64_t nTimeUsec, const shared_ptr<Accessor>& refAccessor
+					, const shared_ptr<TouchCapability>& refTouchCapability
+					, const std::vector<int64_t>& aFingerIds, const std::vector<double>& aXs
+					, const std::vector<double>& aYs, const std::vector<TouchEvent::TOUCH_INPUT_TYPE>& aTypes) noexcept;
+	/** The number of contacts in the frame. */
+	inline int32_t getTotContacts() const noexcept { return static_cast<int32_t>(m_aFingerIds.size()); }
+	/** The finger ids of the contacts. */
+	inline const std::vector<int64_t>& getFingerIds() const noexcept { return m_aFingerIds; }
+	/** The X positions of the contacts. */
+	inline const std::vector<double>& getXs() const noexcept { return m_aXs; }
+	/** The Y positions of the contacts. */
+	inline const std::vector<double>& getYs() const noexcept { return m_aYs; }
+	/** The types of the contacts. */
+	inline const std::vector<TouchEvent::TOUCH_INPUT_TYPE>& getTypes() const noexcept { return m_aTypes; }
+	/** The touch capability that generated the event.
+	 * @return The capability or null if the capability was deleted.
+	 */
+	inline shared_ptr<TouchCapability> getTouchCapability() const noexcept { return m_refTouchCapability.lock(); }
+	//
+	shared_ptr<Capability> getCapability() const noexcept override { return m_refTouchCapability.lock(); }
+	/** Translates the centroid and the contacts. */
+	void translateXY(double fDX, double fDY) noexcept override;
+	/** Scales the centroid and the contacts. */
+	void scaleXY(double fSX, double fSY) noexcept override;
+	//
+	static const char* const s_sClassId;
+	static const Event::Class& getClass() noexcept
+	{
+		static const Event::Class s_oTouchFrameClass = s_oInstall.getEventClass();
+		return s_oTouchFrameClass;
+	}
+protected:
+	/** Sets the contacts.
+	 * The arrays must have the same size. The buffers of the event are reused.
+	 * Also sets the centroid.
+	 * @param aFingerIds The finger ids of the contacts.
+	 * @param aXs The X positions of the contacts.
+	 * @param aYs The Y positions of the contacts.
+	 * @param aTypes The types of the contacts.
+	 */
+	void setContacts(const std::vector<int64_t>& aFingerIds, const std::vector<double>& aXs
+					, const std::vector<double>& aYs, const std::vector<TouchEvent::TOUCH_INPUT_TYPE>& aTypes) noexcept;
+	/** Sets the capability.
+	 * @param refTouchCapability The capability that generated this event. Cannot be null.
+	 */
+	inline void setTouchCapability(const shared_ptr<TouchCapability>& refTouchCapability) noexcept
+	{
+		assert(refTouchCapability);
+		setCapability(*refTouchCapability);
+		m_refTouchCapability = refTouchCapability;
+	}
+private:
+	std::vector<int64_t> m_aFingerIds;
+	std::vector<double> m_aXs;
+	std::vector<double> m_aYs;
+	std::vector<TouchEvent::TOUCH_INPUT_TYPE> m_aTypes;
+	weak_ptr<TouchCapability> m_refTouchCapability;
+	//
+	static RegisterClass<TouchFrameEvent> s_oInstall;
+private:
+	TouchFrameEvent() = delete;
+};
+
 } // namespace stmi
 
 #endif /* STMI_TOUCH_EVENT_H */
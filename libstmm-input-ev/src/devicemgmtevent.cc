@@ -35,6 +35,9 @@ DeviceMgmtEvent::DeviceMgmtEvent(int64_t nTimeUsec, const shared_ptr<DeviceMgmtC
 , m_eDeviceMgmtType(eDeviceMgmtType)
 , m_refDeviceMgmtCapability(refDeviceMgmtCapability)
 {
+	if (refDeviceMgmtCapability) {
+		setCapability(*refDeviceMgmtCapability);
+	}
 	assert(refDeviceMgmtCapability);
 	assert(refDevice);
 	assert((eDeviceMgmtType >= DEVICE_MGMT_ADDED) && (eDeviceMgmtType <= DEVICE_MGMT_CHANGED));
@@ -25,6 +25,27 @@ namespace stmi
 {
 
 const char* const JoystickCapability::s_sClassId = "stmi::Joystick";
+constexpr int32_t JoystickCapability::s_nButtonRange;
+constexpr int32_t JoystickCapability::s_nAxisRange;
 Capability::RegisterClass<JoystickCapability> JoystickCapability::s_oInstall(s_sClassId);
 
+void JoystickCapability::getState(State& oState) const noexcept
+{
+	oState.m_oButtonPressed.reset();
+	for (const BUTTON eButton : getButtons()) {
+		if (isButtonPressed(eButton)) {
+			oState.m_oButtonPressed[eButton - BUTTON_TRIGGER] = true;
+		}
+	}
+	oState.m_aAxisValue.fill(0);
+	for (const AXIS eAxis : getAxes()) {
+		oState.m_aAxisValue[eAxis - AXIS_X] = getAxisValue(eAxis);
+	}
+	const int32_t nTotHats = getTotHats();
+	oState.m_aHatValue.resize(nTotHats);
+	for (int32_t nHat = 0; nHat < nTotHats; ++nHat) {
+		oState.m_aHatValue[nHat] = getHatValue(nHat);
+	}
+}
+
 } // namespace stmi
@@ -39,6 +39,9 @@ JoystickHatEvent::JoystickHatEvent(int64_t nTimeUsec, const shared_ptr<Accessor>
 , m_bCancel(eValue == JoystickCapability::HAT_CENTER_CANCEL)
 , m_refJoystickCapability(refJoystickCapability)
 {
+	if (refJoystickCapability) {
+		setCapability(*refJoystickCapability);
+	}
 	assert(refJoystickCapability);
 	assert(JoystickCapability::isValidHatValue(eValue));
 	assert((ePreviousValue == JoystickCapability::HAT_VALUE_NOT_SET) || JoystickCapability::isValidHatValue(ePreviousValue));
@@ -56,17 +59,19 @@ bool JoystickHatEvent::getAsKey(HARDWARE_KEY& eKey, AS_KEY_INPUT_TYPE& eType, bo
 	if ((m_eValue == m_ePreviousValue) || (m_ePreviousValue == JoystickCapability::HAT_VALUE_NOT_SET) || (m_nHat >= s_nHatsWithKeys)) {
 		return false;
 	}
-	auto aKeys = getAsKeys();
-	eKey = aKeys[0].first;
-	eType = aKeys[0].second;
-	bMoreThanOne = (aKeys.size() > 1);
+	AsKeys oAsKeys;
+	fillAsKeys(oAsKeys);
+	eKey = oAsKeys[0].first;
+	eType = oAsKeys[0].second;
+	bMoreThanOne = (oAsKeys.size() > 1);
 	return true;
 }
-std::vector< std::pair<HARDWARE_KEY, Event::AS_KEY_INPUT_TYPE> > JoystickHatEvent::getAsKeys() const noexcept
+void JoystickHatEvent::fillAsKeys(AsKeys& oAsKeys) const noexcept
 {
+	oAsKeys.clear();
 	if ((m_eValue == m_ePreviousValue) || (m_ePreviousValue == JoystickCapability::HAT_VALUE_NOT_SET)
 					|| (m_nHat >= s_nHatsWithKeys)) {
-		return {}; //-----------------------------------------------------------
+		return; //--------------------------------------------------------------
 	}
 	const bool bUp = ((m_eValue & JoystickCapability::HAT_UP) != 0);
 	const bool bDown = ((m_eValue & JoystickCapability::HAT_DOWN) != 0);
@@ -83,6 +88,7 @@ std::vector< std::pair<HARDWARE_KEY, Event::AS_KEY_INPUT_TYPE> > JoystickHatEven
 	const int32_t nLeft = 2;
 	const int32_t nRight = 3;
 	static_assert(s_nHatsWithKeys == 4,"");
+	static_assert(AsKeys::s_nMaxKeys >= 4,"");
 	static const HARDWARE_KEY s_aHatDirKey[s_nHatsWithKeys][4] = {
 		{ HK_UP, HK_DOWN, HK_LEFT, HK_RIGHT }
 		, { HK_BTN_DPAD_UP, HK_BTN_DPAD_DOWN, HK_BTN_DPAD_LEFT, HK_BTN_DPAD_RIGHT }
@@ -93,28 +99,26 @@ std::vector< std::pair<HARDWARE_KEY, Event::AS_KEY_INPUT_TYPE> > JoystickHatEven
 	auto& aDir = s_aHatDirKey[m_nHat];
 
 	const Event::AS_KEY_INPUT_TYPE eReleaseType = (m_bCancel ? AS_KEY_RELEASE_CANCEL : AS_KEY_RELEASE);
-	std::vector< std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE> > aKeys;
 	if (bPrevUp && !bUp) {
-		aKeys.emplace_back(aDir[nUp], eReleaseType);
+		oAsKeys.add(aDir[nUp], eReleaseType);
 	} else if (bPrevDown && !bDown) {
-		aKeys.emplace_back(aDir[nDown], eReleaseType);
+		oAsKeys.add(aDir[nDown], eReleaseType);
 	}
 	if (bPrevLeft && !bLeft) {
-		aKeys.emplace_back(aDir[nLeft], eReleaseType);
+		oAsKeys.add(aDir[nLeft], eReleaseType);
 	} else if (bPrevRight && !bRight) {
-		aKeys.emplace_back(aDir[nRight], eReleaseType);
+		oAsKeys.add(aDir[nRight], eReleaseType);
 	}
 	if (bUp && !bPrevUp) {
-		aKeys.emplace_back(aDir[nUp], AS_KEY_PRESS);
+		oAsKeys.add(aDir[nUp], AS_KEY_PRESS);
 	} else if (bDown && !bPrevDown) {
-		aKeys.emplace_back(aDir[nDown], AS_KEY_PRESS);
+		oAsKeys.add(aDir[nDown], AS_KEY_PRESS);
 	}
 	if (bLeft && !bPrevLeft) {
-		aKeys.emplace_back(aDir[nLeft], AS_KEY_PRESS);
+		oAsKeys.add(aDir[nLeft], AS_KEY_PRESS);
 	} else if (bRight && !bPrevRight) {
-		aKeys.emplace_back(aDir[nRight], AS_KEY_PRESS);
+		oAsKeys.add(aDir[nRight], AS_KEY_PRESS);
 	}
-	return aKeys;
 }
 
 
@@ -130,6 +134,9 @@ JoystickButtonEvent::JoystickButtonEvent(int64_t nTimeUsec, const shared_ptr<Acc
 , m_eType(eType)
 , m_refJoystickCapability(refJoystickCapability)
 {
+	if (refJoystickCapability) {
+		setCapability(*refJoystickCapability);
+	}
 	assert((eType >= BUTTON_PRESS) && (eType <= BUTTON_RELEASE_CANCEL));
 	assert(JoystickCapability::isValidButton(eButton));
 	assert(refJoystickCapability);
@@ -154,6 +161,9 @@ JoystickAxisEvent::JoystickAxisEvent(int64_t nTimeUsec, const shared_ptr<Accesso
 , m_nValue(nValue)
 , m_refJoystickCapability(refJoystickCapability)
 {
+	if (refJoystickCapability) {
+		setCapability(*refJoystickCapability);
+	}
 	assert(refJoystickCapability);
 	assert((nValue >= -32767) && (nValue <= 32767));
 	assert(JoystickCapability::isValidAxis(eAxis));
@@ -37,6 +37,9 @@ KeyEvent::KeyEvent(int64_t nTimeUsec, const shared_ptr<Accessor>& refAccessor
 , m_eKey(eKey)
 , m_refKeyCapability(refKeyCapability)
 {
+	if (refKeyCapability) {
+		setCapability(*refKeyCapability);
+	}
 	assert((eType >= KEY_PRESS) || (eType <= KEY_RELEASE_CANCEL));
 	assert(eKey >= 0);
 	assert(refKeyCapability);
@@ -45,6 +45,9 @@ PointerEvent::PointerEvent(int64_t nTimeUsec, const shared_ptr<Accessor>& refAcc
 , m_nButton(nButton)
 , m_refPointerCapability(refPointerCapability)
 {
+	if (refPointerCapability) {
+		setCapability(*refPointerCapability);
+	}
 	setPointer(eType, nButton, bAnyButtonPressed, bWasAnyButtonPressed);
 }
 bool PointerEvent::getAsKey(HARDWARE_KEY& eKey, AS_KEY_INPUT_TYPE& eType, bool& bMoreThanOne) const noexcept
@@ -73,6 +76,22 @@ bool PointerEvent::getAsKey(HARDWARE_KEY& eKey, AS_KEY_INPUT_TYPE& eType, bool&
 	bMoreThanOne = false;
 	return true;
 }
+void PointerEvent::translateXY(double fDX, double fDY) noexcept
+{
+	XYEvent::translateXY(fDX, fDY);
+	for (auto& oSample : m_aMotionHistory) {
+		oSample.m_fX += fDX;
+		oSample.m_fY += fDY;
+	}
+}
+void PointerEvent::scaleXY(double fSX, double fSY) noexcept
+{
+	XYEvent::scaleXY(fSX, fSY);
+	for (auto& oSample : m_aMotionHistory) {
+		oSample.m_fX *= fSX;
+		oSample.m_fY *= fSY;
+	}
+}
 
 void PointerEvent::setPointer(POINTER_INPUT_TYPE eType, int32_t nButton, bool bAnyButtonPressed, bool bWasAnyButtonPressed) noexcept
 {
@@ -142,6 +161,9 @@ PointerScrollEvent::PointerScrollEvent(int64_t nTimeUsec, const shared_ptr<Acces
 , m_eScrollDir(eScrollDir)
 , m_refPointerCapability(refPointerCapability)
 {
+	if (refPointerCapability) {
+		setCapability(*refPointerCapability);
+	}
 //std::cout << "PointerScrollEvent::PointerScrollEvent   eScrollDir=" << m_eScrollDir << "  fX=" << fX << " fY=" << fY << std::endl;
 	setPointerScroll(eScrollDir, bAnyButtonPressed);
 }
@@ -158,16 +180,18 @@ bool PointerScrollEvent::getAsKey(HARDWARE_KEY& eKey, AS_KEY_INPUT_TYPE& eType,
 	bMoreThanOne = true;
 	return true;
 }
-std::vector< std::pair<HARDWARE_KEY, Event::AS_KEY_INPUT_TYPE> > PointerScrollEvent::getAsKeys() const noexcept
+void PointerScrollEvent::fillAsKeys(AsKeys& oAsKeys) const noexcept
 {
+	oAsKeys.clear();
 	HARDWARE_KEY eKey;
 	AS_KEY_INPUT_TYPE eType;
 	bool bMoreThanOne = false;
 	const bool bOk = getAsKey(eKey, eType, bMoreThanOne);
 	if (!bOk) {
-		return {}; //-----------------------------------------------------------
+		return; //--------------------------------------------------------------
 	}
-	return { std::make_pair(eKey, Event::AS_KEY_PRESS), std::make_pair(eKey, Event::AS_KEY_RELEASE) };
+	oAsKeys.add(eKey, Event::AS_KEY_PRESS);
+	oAsKeys.add(eKey, Event::AS_KEY_RELEASE);
 }
 
 void PointerScrollEvent::setPointerScroll(POINTER_SCROLL_DIR eScrollDir, bool bAnyButtonPressed) noexcept
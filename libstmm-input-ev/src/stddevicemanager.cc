@@ -92,7 +92,7 @@ shared_ptr<DeviceMgmtCapability> StdDeviceManager::getDeviceMgmtCapability() noe
 }
 void StdDeviceManager::sendDeviceMgmtToListeners(const DeviceMgmtEvent::DEVICE_MGMT_TYPE& eMgmtType, const shared_ptr<Device>& refDevice) noexcept
 {
-	if (!isEventClassEnabled(Event::Class{typeid(DeviceMgmtEvent)})) {
+	if ((m_nClassIdxDeviceMgmtEvent < 0) || !isEventClassIndexEnabled(m_nClassIdxDeviceMgmtEvent)) {
 		return;
 	}
 	shared_ptr<Capability> refCapa = getCapability(DeviceMgmtCapability::getClass());
@@ -102,7 +102,7 @@ void StdDeviceManager::sendDeviceMgmtToListeners(const DeviceMgmtEvent::DEVICE_M
 	const int64_t nTimeUsec = DeviceManager::getNowTimeMicroseconds();
 	//
 	shared_ptr<DeviceMgmtEvent> refEvent = std::make_shared<DeviceMgmtEvent>(nTimeUsec, refMgmtCapa, eMgmtType, refDevice);
-	auto refListeners = getListeners();
+	auto refListeners = getListeners(m_nClassIdxDeviceMgmtEvent);
 	for (auto& p0ListenerData : *refListeners) {
 		p0ListenerData->handleEventCallIf(m_nClassIdxDeviceMgmtEvent, refEvent);
 	}
@@ -38,7 +38,72 @@ TouchEvent::TouchEvent(int64_t nTimeUsec, const shared_ptr<Accessor>& refAccesso
 , m_nFingerId(nFingerId)
 , m_refTouchCapability(refTouchCapability)
 {
+	if (refTouchCapability) {
+		setCapability(*refTouchCapability);
+	}
 	setTypeAndFinger(eType, nFingerId);
 }
 
+const char* const TouchFrameEvent::s_sClassId = "stmi::Touch:TouchFrameEvent";
+Event::RegisterClass<TouchFrameEvent> TouchFrameEvent::s_oInstall(s_sClassId);
+
+TouchFrameEvent::TouchFrameEvent(int64_t nTimeUsec, const shared_ptr<Accessor>& refAccessor
+								, const shared_ptr<TouchCapability>& refTouchCapability
+								, const std::vector<int64_t>& aFingerIds, const std::vector<double>& aXs
+								, const std::vector<double>& aYs, const std::vector<TouchEvent::TOUCH_INPUT_TYPE>& aTypes) noexcept
+: XYEvent(s_oInstall.getEventClass(), nTimeUsec, (refTouchCapability ? refTouchCapability->getId() : -1)
+		, refAccessor, 0.0, 0.0, XY_HOVER, -1)
+, m_refTouchCapability(refTouchCapability)
+{
+	if (refTouchCapability) {
+		setCapability(*refTouchCapability);
+	}
+	setContacts(aFingerIds, aXs, aYs, aTypes);
+}
+void TouchFrameEvent::setContacts(const std::vector<int64_t>& aFingerIds, const std::vector<double>& aXs
+								, const std::vector<double>& aYs, const std::vector<TouchEvent::TOUCH_INPUT_TYPE>& aTypes) noexcept
+{
+	assert(aXs.size() == aFingerIds.size());
+	assert(aYs.size() == aFingerIds.size());
+	assert(aTypes.size() == aFingerIds.size());
+	m_aFingerIds.assign(aFingerIds.begin(), aFingerIds.end());
+	m_aXs.assign(aXs.begin(), aXs.end());
+	m_aYs.assign(aYs.begin(), aYs.end());
+	m_aTypes.assign(aTypes.begin(), aTypes.end());
+	double fSumX = 0.0;
+	double fSumY = 0.0;
+	const int32_t nTotContacts = getTotContacts();
+	for (int32_t nIdx = 0; nIdx < nTotContacts; ++nIdx) {
+		fSumX += m_aXs[nIdx];
+		fSumY += m_aYs[nIdx];
+	}
+	if (nTotContacts > 0) {
+		setX(fSumX / nTotContacts);
+		setY(fSumY / nTotContacts);
+	} else {
+		setX(0.0);
+		setY(0.0);
+	}
+}
+void TouchFrameEvent::translateXY(double fDX, double fDY) noexcept
+{
+	XYEvent::translateXY(fDX, fDY);
+	for (auto& fX : m_aXs) {
+		fX += fDX;
+	}
+	for (auto& fY : m_aYs) {
+		fY += fDY;
+	}
+}
+void TouchFrameEvent::scaleXY(double fSX, double fSY) noexcept
+{
+	XYEvent::scaleXY(fSX, fSY);
+	for (auto& fX : m_aXs) {
+		fX *= fSX;
+	}
+	for (auto& fY : m_aYs) {
+		fY *= fSY;
+	}
+}
+
 } // namespace stmi
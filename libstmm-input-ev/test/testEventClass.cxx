@@ -90,6 +90,25 @@ TEST_CASE("testEventClass, EventIsXYEvent")
 	REQUIRE(Event::getEventClassIdClass(TouchEvent::s_sClassId).isXYEvent());
 }
 
+TEST_CASE("testEventClass, EventClassIndex")
+{
+	REQUIRE(Event::Class().getIndex() == -1);
+	const std::vector<Event::Class> aClasses{DeviceMgmtEvent::getClass(), JoystickHatEvent::getClass()
+											, JoystickButtonEvent::getClass(), JoystickAxisEvent::getClass()
+											, KeyEvent::getClass(), PointerEvent::getClass()
+											, PointerScrollEvent::getClass(), TouchEvent::getClass()};
+	for (const auto& oClass : aClasses) {
+		REQUIRE(oClass.getIndex() >= 0);
+		REQUIRE(oClass.getIndex() < Event::getTotRegisteredClassIndexes());
+		REQUIRE(Event::Class(oClass.getTypeInfo()).getIndex() == oClass.getIndex());
+		REQUIRE(Event::getEventClassIdClass(oClass.getId()).getIndex() == oClass.getIndex());
+		for (const auto& oOtherClass : aClasses) {
+			REQUIRE((oClass == oOtherClass) == (oClass.getIndex() == oOtherClass.getIndex()));
+			REQUIRE((oClass == oOtherClass) == (oClass.getTypeInfo() == oOtherClass.getTypeInfo()));
+		}
+	}
+}
+
 } // namespace testing
 
 } // namespace stmi
@@ -34,6 +34,39 @@ using std::weak_ptr;
 namespace testing
 {
 
+class TestJoystickCapability : public JoystickCapability
+{
+public:
+	shared_ptr<Device> getDevice() const noexcept override
+	{
+		return shared_ptr<Device>{};
+	}
+	bool getHasButton(JoystickCapability::BUTTON eButton) const noexcept override
+	{
+		return (eButton == BUTTON_A) || (eButton == BUTTON_GEAR_UP);
+	}
+	int32_t getTotHats() const noexcept override
+	{
+		return 2;
+	}
+	bool getHasAxis(JoystickCapability::AXIS eAxis) const noexcept override
+	{
+		return (eAxis == AXIS_X) || (eAxis == AXIS_TILT_Y);
+	}
+	bool isButtonPressed(JoystickCapability::BUTTON eButton) const noexcept override
+	{
+		return (eButton == BUTTON_GEAR_UP);
+	}
+	HAT_VALUE getHatValue(int32_t nHat) const noexcept override
+	{
+		return ((nHat == 1) ? HAT_LEFTUP : HAT_CENTER);
+	}
+	int32_t getAxisValue(JoystickCapability::AXIS eAxis) const noexcept override
+	{
+		return ((eAxis == AXIS_X) ? -123 : ((eAxis == AXIS_TILT_Y) ? 32767 : 0));
+	}
+};
+
 class JoystickCapabilityClassFixture
 {
 public:
@@ -95,6 +128,25 @@ TEST_CASE_METHOD(JoystickCapabilityClassFixture, "AxesFirstAndLastExist")
 	REQUIRE_FALSE(stmi::JoystickCapability::isValidAxis(static_cast<stmi::JoystickCapability::AXIS>(-77)));
 }
 
+TEST_CASE_METHOD(JoystickCapabilityClassFixture, "GetState")
+{
+	TestJoystickCapability oCapa;
+	JoystickCapability::State oState;
+	oState.m_oButtonPressed.set();
+	oState.m_aHatValue.resize(5, JoystickCapability::HAT_DOWN);
+	oCapa.getState(oState);
+	REQUIRE(oState.m_oButtonPressed.count() == 1);
+	REQUIRE(oState.isButtonPressed(JoystickCapability::BUTTON_GEAR_UP));
+	REQUIRE_FALSE(oState.isButtonPressed(JoystickCapability::BUTTON_A));
+	REQUIRE_FALSE(oState.isButtonPressed(JoystickCapability::BUTTON_TRIGGER));
+	REQUIRE(oState.getAxisValue(JoystickCapability::AXIS_X) == -123);
+	REQUIRE(oState.getAxisValue(JoystickCapability::AXIS_TILT_Y) == 32767);
+	REQUIRE(oState.getAxisValue(JoystickCapability::AXIS_Y) == 0);
+	REQUIRE(oState.m_aHatValue.size() == 2);
+	REQUIRE(oState.m_aHatValue[0] == JoystickCapability::HAT_CENTER);
+	REQUIRE(oState.m_aHatValue[1] == JoystickCapability::HAT_LEFTUP);
+}
+
 } // namespace testing
 
 } // namespace stmi
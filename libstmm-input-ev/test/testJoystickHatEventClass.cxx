@@ -155,6 +155,15 @@ TEST_CASE_METHOD(JoystickHatEventClassFixture, "TransitionsDistTwo")
 		REQUIRE(aAsKeys[1].second ==  Event::AS_KEY_PRESS);
 		//
 		REQUIRE( (aAsKeys[0].first != aAsKeys[1].first) );
+		//
+		Event::AsKeys oAsKeys;
+		oJoystickHatEvent.fillAsKeys(oAsKeys);
+		REQUIRE(oAsKeys.size() == 2);
+		int32_t nIdx = 0;
+		for (const auto& oPair : oAsKeys) {
+			REQUIRE(oPair == aAsKeys[nIdx]);
+			++nIdx;
+		}
 	}
 	{
 		const JoystickCapability::HAT_VALUE eValue = JoystickCapability::HAT_RIGHTDOWN;
@@ -263,6 +263,55 @@ TEST_CASE_METHOD(PointerEventClassFixture, "ScaleXY")
 	}
 	//REQUIRE(false); //just to check
 }
+TEST_CASE_METHOD(PointerEventClassFixture, "MotionHistory")
+{
+	class HistoryPointerEvent : public PointerEvent
+	{
+	public:
+		using PointerEvent::PointerEvent;
+		using PointerEvent::setMotionHistory;
+		using PointerEvent::clearMotionHistory;
+		using PointerEvent::reserveMotionHistory;
+	};
+	auto nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+	{
+		HistoryPointerEvent oPointerEvent(nTimeUsec, Accessor::s_refEmptyAccessor, m_refPointerCapability, 30.0, 40.0
+					, PointerEvent::POINTER_HOVER, PointerEvent::s_nNoButton, false, false);
+		REQUIRE(oPointerEvent.getMotionHistory().empty());
+		const std::vector<PointerEvent::MotionSample> aSamples{{nTimeUsec - 2000, 10.0, 20.0}, {nTimeUsec, 30.0, 40.0}};
+		oPointerEvent.setMotionHistory(aSamples);
+		REQUIRE(oPointerEvent.getMotionHistory().size() == 2);
+		REQUIRE(oPointerEvent.getMotionHistory()[0].m_nTimeUsec == nTimeUsec - 2000);
+		oPointerEvent.translateXY(1.0, -1.0);
+		oPointerEvent.scaleXY(2.0, 0.5);
+		REQUIRE(oPointerEvent.getX() == 62.0);
+		REQUIRE(oPointerEvent.getY() == 19.5);
+		REQUIRE(oPointerEvent.getMotionHistory()[0].m_fX == 22.0);
+		REQUIRE(oPointerEvent.getMotionHistory()[0].m_fY == 9.5);
+		REQUIRE(oPointerEvent.getMotionHistory()[1].m_fX == 62.0);
+		REQUIRE(oPointerEvent.getMotionHistory()[1].m_fY == 19.5);
+		oPointerEvent.clearMotionHistory();
+		REQUIRE(oPointerEvent.getMotionHistory().empty());
+	}
+	{
+		HistoryPointerEvent oPointerEvent(nTimeUsec, Accessor::s_refEmptyAccessor, m_refPointerCapability, 30.0, 40.0
+					, PointerEvent::POINTER_HOVER, PointerEvent::s_nNoButton, false, false);
+		oPointerEvent.reserveMotionHistory(4);
+		const PointerEvent::MotionSample* p0Buffer = oPointerEvent.getMotionHistory().data();
+		REQUIRE(oPointerEvent.getMotionHistory().capacity() == 4);
+		// setting and clearing within the capacity reuses the buffer
+		const std::vector<PointerEvent::MotionSample> aSamples{{nTimeUsec - 3000, 0.0, 0.0}, {nTimeUsec - 2000, 10.0, 20.0}
+																, {nTimeUsec - 1000, 20.0, 30.0}, {nTimeUsec, 30.0, 40.0}};
+		oPointerEvent.setMotionHistory(aSamples);
+		REQUIRE(oPointerEvent.getMotionHistory().size() == 4);
+		REQUIRE(oPointerEvent.getMotionHistory().data() == p0Buffer);
+		oPointerEvent.clearMotionHistory();
+		oPointerEvent.setMotionHistory(std::vector<PointerEvent::MotionSample>{aSamples.begin() + 2, aSamples.end()});
+		REQUIRE(oPointerEvent.getMotionHistory().size() == 2);
+		REQUIRE(oPointerEvent.getMotionHistory()[0].m_nTimeUsec == nTimeUsec - 1000);
+		REQUIRE(oPointerEvent.getMotionHistory().data() == p0Buffer);
+	}
+}
 
 } // namespace testing
 
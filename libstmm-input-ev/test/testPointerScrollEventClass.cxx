@@ -89,6 +89,12 @@ TEST_CASE_METHOD(PointerScrollEventClassFixture, "ConstructEvent")
 	REQUIRE(aAsKeys[0].second ==  Event::AS_KEY_PRESS);
 	REQUIRE(aAsKeys[1].first == HK_SCROLLUP);
 	REQUIRE(aAsKeys[1].second ==  Event::AS_KEY_RELEASE);
+	Event::AsKeys oAsKeys;
+	oAsKeys.add(HK_T, Event::AS_KEY_PRESS); // cleared by fillAsKeys
+	oPointerScrollEvent.fillAsKeys(oAsKeys);
+	REQUIRE(oAsKeys.size() == 2);
+	REQUIRE(oAsKeys[0] == aAsKeys[0]);
+	REQUIRE(oAsKeys[1] == aAsKeys[1]);
 	//REQUIRE(false); //just to check
 }
 
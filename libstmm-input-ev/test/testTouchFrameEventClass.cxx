@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testTouchFrameEventClass.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include <stmm-input-fake/faketouchdevice.h>
+#include "touchevent.h"
+
+namespace stmi
+{
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace testing
+{
+
+class TouchFrameEventClassFixture
+{
+public:
+	TouchFrameEventClassFixture()
+	{
+		m_refTouchDevice = std::make_shared<FakeTouchDevice>();
+		#ifndef NDEBUG
+		const bool bFound = 
+		#endif
+		m_refTouchDevice->getCapability(m_refTouchCapability);
+		assert(bFound);
+	}
+public:
+	shared_ptr<Device> m_refTouchDevice;
+	shared_ptr<TouchCapability> m_refTouchCapability;
+};
+
+TEST_CASE_METHOD(TouchFrameEventClassFixture, "ConstructEvent")
+{
+	auto nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+	TouchFrameEvent oFrameEvent(nTimeUsec, Accessor::s_refEmptyAccessor, m_refTouchCapability
+								, {11, 22, 33}, {10.0, 20.0, 60.0}, {-5.0, 5.0, 30.0}
+								, {TouchEvent::TOUCH_BEGIN, TouchEvent::TOUCH_UPDATE, TouchEvent::TOUCH_END});
+	REQUIRE(TouchFrameEvent::getClass() == typeid(TouchFrameEvent));
+	REQUIRE(oFrameEvent.getEventClass() == typeid(TouchFrameEvent));
+	REQUIRE(oFrameEvent.getEventClass().isXYEvent());
+	REQUIRE(oFrameEvent.getTimeUsec() == nTimeUsec);
+	REQUIRE(oFrameEvent.getAccessor() == Accessor::s_refEmptyAccessor);
+	REQUIRE(oFrameEvent.getTouchCapability() == m_refTouchCapability);
+	REQUIRE(oFrameEvent.getCapability() == m_refTouchCapability);
+	REQUIRE(oFrameEvent.getTotContacts() == 3);
+	REQUIRE(oFrameEvent.getFingerIds() == std::vector<int64_t>{11, 22, 33});
+	REQUIRE(oFrameEvent.getXs() == std::vector<double>{10.0, 20.0, 60.0});
+	REQUIRE(oFrameEvent.getYs() == std::vector<double>{-5.0, 5.0, 30.0});
+	REQUIRE(oFrameEvent.getTypes()[0] == TouchEvent::TOUCH_BEGIN);
+	REQUIRE(oFrameEvent.getTypes()[1] == TouchEvent::TOUCH_UPDATE);
+	REQUIRE(oFrameEvent.getTypes()[2] == TouchEvent::TOUCH_END);
+	// the centroid
+	REQUIRE(oFrameEvent.getX() == 30.0);
+	REQUIRE(oFrameEvent.getY() == 10.0);
+	REQUIRE(oFrameEvent.getXYGrabType() == XYEvent::XY_HOVER);
+	REQUIRE_FALSE(oFrameEvent.getIsModified());
+	//
+	auto aAsKeys = oFrameEvent.getAsKeys();
+	REQUIRE(aAsKeys.size() == 0);
+}
+TEST_CASE_METHOD(TouchFrameEventClassFixture, "NoContacts")
+{
+	auto nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+	TouchFrameEvent oFrameEvent(nTimeUsec, Accessor::s_refEmptyAccessor, m_refTouchCapability
+								, {}, {}, {}, {});
+	REQUIRE(oFrameEvent.getTotContacts() == 0);
+	REQUIRE(oFrameEvent.getX() == 0.0);
+	REQUIRE(oFrameEvent.getY() == 0.0);
+}
+TEST_CASE_METHOD(TouchFrameEventClassFixture, "TranslateAndScaleXY")
+{
+	auto nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+	TouchFrameEvent oFrameEvent(nTimeUsec, Accessor::s_refEmptyAccessor, m_refTouchCapability
+								, {11, 22}, {10.0, 20.0}, {-5.0, 5.0}
+								, {TouchEvent::TOUCH_UPDATE, TouchEvent::TOUCH_UPDATE});
+	oFrameEvent.translateXY(1.0, 2.0);
+	REQUIRE(oFrameEvent.getIsModified());
+	REQUIRE(oFrameEvent.getXs() == std::vector<double>{11.0, 21.0});
+	REQUIRE(oFrameEvent.getYs() == std::vector<double>{-3.0, 7.0});
+	oFrameEvent.scaleXY(2.0, 0.5);
+	REQUIRE(oFrameEvent.getXs() == std::vector<double>{22.0, 42.0});
+	REQUIRE(oFrameEvent.getYs() == std::vector<double>{-1.5, 3.5});
+	REQUIRE(oFrameEvent.getX() == 32.0);
+	REQUIRE(oFrameEvent.getY() == 1.0);
+}
+
+} // namespace testing
+
+} // namespace stmi
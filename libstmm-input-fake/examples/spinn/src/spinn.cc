@@ -31,8 +31,9 @@ void Spinn::handleAllEvents(const shared_ptr<stmi::Event>& refEvent)
 {
 	auto p0Event = refEvent.get();
 	auto nOldValue = m_nValue;
-	auto aKeys = p0Event->getAsKeys();
-	for (auto& oPair : aKeys) {
+	stmi::Event::AsKeys oAsKeys;
+	p0Event->fillAsKeys(oAsKeys);
+	for (auto& oPair : oAsKeys) {
 		const stmi::Event::AS_KEY_INPUT_TYPE eAsType = oPair.second;
 		if (eAsType == stmi::Event::AS_KEY_PRESS) {
 			const stmi::HARDWARE_KEY eAsKey = oPair.first;
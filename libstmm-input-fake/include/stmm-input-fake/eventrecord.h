@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventrecord.h
+ */
+
+#ifndef STMI_TESTING_EVENT_RECORD_H
+#define STMI_TESTING_EVENT_RECORD_H
+
+#include <type_traits>
+#include <cstdint>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+/** The header of an event recording file.
+ * An event recording file is this header followed by EventRecord instances.
+ * All values are in host byte order.
+ */
+struct EventRecordFileHeader
+{
+	char m_aMagic[8]; /**< Must be s_aMagic. */
+	uint32_t m_nVersion; /**< The format version. Must be s_nVersion. */
+	uint32_t m_nRecordSize; /**< The size of EventRecord in bytes. */
+
+	static constexpr char s_aMagic[8] = {'S', 'T', 'M', 'I', 'E', 'V', 'R', 'C'};
+	static constexpr uint32_t s_nVersion = 1;
+};
+
+/** A recorded event.
+ * The records have a fixed size so that they can be accessed directly
+ * in a memory mapped file.
+ */
+struct EventRecord
+{
+	enum RECORD_TYPE : uint8_t
+	{
+		RECORD_TYPE_KEY = 1 /**< KeyEvent. */
+		, RECORD_TYPE_POINTER = 2 /**< PointerEvent. */
+		, RECORD_TYPE_POINTER_SCROLL = 3 /**< PointerScrollEvent. */
+		, RECORD_TYPE_TOUCH = 4 /**< TouchEvent. */
+		, RECORD_TYPE_JOYSTICK_BUTTON = 5 /**< JoystickButtonEvent. */
+		, RECORD_TYPE_JOYSTICK_HAT = 6 /**< JoystickHatEvent. */
+		, RECORD_TYPE_JOYSTICK_AXIS = 7 /**< JoystickAxisEvent. */
+		, RECORD_TYPE_DEVICE_MGMT = 8 /**< DeviceMgmtEvent. */
+	};
+	/** The capability classes of the device of a DeviceMgmtEvent.
+	 */
+	enum DEVICE_CAPA : int32_t
+	{
+		DEVICE_CAPA_KEY = 1 /**< KeyCapability. */
+		, DEVICE_CAPA_POINTER = 2 /**< PointerCapability. */
+		, DEVICE_CAPA_TOUCH = 4 /**< TouchCapability. */
+		, DEVICE_CAPA_JOYSTICK = 8 /**< JoystickCapability. */
+	};
+	int64_t m_nTimeUsec; /**< The time of the event. */
+	int32_t m_nDeviceId; /**< The id of the device in the recorded session or -1. */
+	RECORD_TYPE m_eType; /**< The type of the record. */
+	uint8_t m_nSubType; /**< The input type of the event, the scroll direction or the device management type. */
+	uint8_t m_nFlags; /**< Pointer: 1 if any button pressed, 2 if any button was pressed. */
+	uint8_t m_nReserved; /**< Always 0. */
+	int32_t m_nArg0; /**< The key, button, hat, axis, or for DeviceMgmtEvent the DEVICE_CAPA bits. */
+	int32_t m_nArg1; /**< The pointer button, hat value or axis value. */
+	int64_t m_nArg2; /**< The touch finger id or the previous hat value. */
+	double m_fX; /**< The X coordinate of XYEvent subclasses. */
+	double m_fY; /**< The Y coordinate of XYEvent subclasses. */
+
+	static constexpr uint8_t s_nFlagAnyButtonPressed = 1;
+	static constexpr uint8_t s_nFlagWasAnyButtonPressed = 2;
+};
+
+static_assert(sizeof(EventRecordFileHeader) == 16, "");
+static_assert(sizeof(EventRecord) == 48, "");
+static_assert(std::is_trivially_copyable<EventRecord>::value, "");
+
+} // namespace testing
+
+} // namespace stmi
+
+#endif /* STMI_TESTING_EVENT_RECORD_H */
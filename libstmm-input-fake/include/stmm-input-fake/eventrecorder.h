@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventrecorder.h
+ */
+
+#ifndef STMI_TESTING_EVENT_RECORDER_H
+#define STMI_TESTING_EVENT_RECORDER_H
+
+#include "eventrecord.h"
+
+#include <stmm-input/devicemanager.h>
+#include <stmm-input/event.h>
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <utility>
+
+#include <stdint.h>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+
+namespace testing
+{
+
+/** Records the events of libstmm-input-ev to a binary file.
+ * The listener returned by getEventListener() can be added to any device manager.
+ * Each KeyEvent, PointerEvent, PointerScrollEvent, TouchEvent, JoystickButtonEvent,
+ * JoystickHatEvent, JoystickAxisEvent and DeviceMgmtEvent is converted to an
+ * EventRecord and buffered. The buffer is written to the file when full,
+ * when flush() is called and when the recorder is destroyed.
+ * Recording an event doesn't allocate memory.
+ *
+ * Events of other classes are skipped.
+ * @see EventReplayer
+ */
+class EventRecorder final
+{
+public:
+	/** Creates a recorder.
+	 * The file is created or truncated.
+	 * @param sFilePath The path of the file.
+	 * @return The recorder and an empty string or null and the error string.
+	 */
+	static std::pair<shared_ptr<EventRecorder>, std::string> create(const std::string& sFilePath) noexcept;
+	/** Writes the buffered records and closes the file.
+	 */
+	~EventRecorder() noexcept;
+	/** The listener that records the events.
+	 * @return The listener. Not null.
+	 */
+	const shared_ptr<EventListener>& getEventListener() const noexcept { return m_refEventListener; }
+	/** Writes the buffered records to the file.
+	 * @return Whether the records could be written.
+	 */
+	bool flush() noexcept;
+	/** The number of recorded events.
+	 * @return The number of events.
+	 */
+	int64_t getTotRecorded() const noexcept { return m_nTotRecorded; }
+	/** The number of events that weren't recorded because of their class.
+	 * @return The number of events.
+	 */
+	int64_t getTotSkipped() const noexcept { return m_nTotSkipped; }
+private:
+	explicit EventRecorder(int32_t nFD) noexcept;
+	void onEvent(const shared_ptr<Event>& refEvent) noexcept;
+	bool fillRecord(const Event& oEvent, EventRecord& oRecord) noexcept;
+	bool writeAll(const void* p0Data, int64_t nSize) noexcept;
+private:
+	int32_t m_nFD;
+	shared_ptr<EventListener> m_refEventListener;
+	std::vector<EventRecord> m_aBuffer; // Size: s_nBufferRecords
+	int32_t m_nTotBuffered;
+	int64_t m_nTotRecorded;
+	int64_t m_nTotSkipped;
+	bool m_bWriteError;
+
+	static constexpr int32_t s_nBufferRecords = 1024;
+private:
+	EventRecorder(const EventRecorder& oSource) = delete;
+	EventRecorder& operator=(const EventRecorder& oSource) = delete;
+};
+
+} // namespace testing
+
+} // namespace stmi
+
+#endif /* STMI_TESTING_EVENT_RECORDER_H */
@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventreplayer.h
+ */
+
+#ifndef STMI_TESTING_EVENT_REPLAYER_H
+#define STMI_TESTING_EVENT_REPLAYER_H
+
+#include "eventrecord.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <stdint.h>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+
+namespace testing
+{
+
+class FakeDeviceManager;
+
+/** Replays a file written by EventRecorder through a FakeDeviceManager.
+ * The file is memory mapped and the records are read in place.
+ *
+ * For each device of the recorded session fake devices are added to the
+ * device manager, one for each of its capability classes (ex. a pointer device
+ * with touch capability becomes a FakePointerDevice and a FakeTouchDevice).
+ * They are added either when the DeviceMgmtEvent of type DEVICE_MGMT_ADDED
+ * is replayed or when the first event of the device is replayed
+ * if the recording was started after the device was added.
+ *
+ * The replayed events have the recorded time stamps and a null accessor.
+ * The device management events are generated by the fake device manager
+ * and therefore have the current time.
+ *
+ * Records with an unknown type or with fields that are not valid for their
+ * type (ex. of a corrupt file) are skipped and counted, see getTotInvalid().
+ */
+class EventReplayer final
+{
+public:
+	/** Creates a replayer.
+	 * @param sFilePath The path of the file written by EventRecorder.
+	 * @param refFakeDM The device manager the events are sent through. Cannot be null.
+	 * @return The replayer and an empty string or null and the error string.
+	 */
+	static std::pair<shared_ptr<EventReplayer>, std::string> create(const std::string& sFilePath
+																	, const shared_ptr<FakeDeviceManager>& refFakeDM) noexcept;
+	/** Unmaps the file.
+	 */
+	~EventReplayer() noexcept;
+	/** The number of records in the file.
+	 * @return The number of records.
+	 */
+	int64_t getTotRecords() const noexcept { return m_nTotRecords; }
+	/** The index of the next record to replay.
+	 * @return The index. Is &gt;= 0 and &lt;= getTotRecords().
+	 */
+	int64_t getPosition() const noexcept { return m_nPosition; }
+	/** Sets the position to the first record.
+	 */
+	void rewind() noexcept { m_nPosition = 0; }
+	/** The number of records skipped because they were not valid.
+	 * Is not reset by rewind().
+	 * @return The number of invalid records.
+	 */
+	int64_t getTotInvalid() const noexcept { return m_nTotInvalid; }
+	/** Replays records from the current position.
+	 * @param bOriginalTiming Whether to wait between events as long as in the recorded session.
+	 *                        If `false` the events are replayed as fast as possible.
+	 * @param nMaxRecords The maximum number of records to replay or -1 for all remaining.
+	 * @return The number of replayed records, invalid records included.
+	 */
+	int64_t replay(bool bOriginalTiming, int64_t nMaxRecords) noexcept;
+	/** Replays all remaining records.
+	 * @param bOriginalTiming Whether to wait between events as long as in the recorded session.
+	 * @return The number of replayed records.
+	 */
+	int64_t replay(bool bOriginalTiming) noexcept { return replay(bOriginalTiming, -1); }
+private:
+	EventReplayer(const shared_ptr<FakeDeviceManager>& refFakeDM
+				, const void* p0Mapped, int64_t nMappedSize, int64_t nTotRecords) noexcept;
+	static bool isValidRecord(const EventRecord& oRecord) noexcept;
+	void replayRecord(const EventRecord& oRecord) noexcept;
+	void replayDeviceMgmt(const EventRecord& oRecord) noexcept;
+	// Returns the fake device id or -1 if the device manager has no device for the capability
+	int32_t getFakeDeviceId(int32_t nRecordedDeviceId, EventRecord::DEVICE_CAPA eCapa) noexcept;
+	void addFakeDevices(int32_t nRecordedDeviceId, int32_t nCapas) noexcept;
+private:
+	shared_ptr<FakeDeviceManager> m_refFakeDM;
+	const void* m_p0Mapped;
+	int64_t m_nMappedSize;
+	const EventRecord* m_p0Records;
+	int64_t m_nTotRecords;
+	int64_t m_nPosition;
+	int64_t m_nTotInvalid;
+	struct FakeDevices
+	{
+		int32_t m_nKeyDeviceId = -1;
+		int32_t m_nPointerDeviceId = -1;
+		int32_t m_nTouchDeviceId = -1;
+		int32_t m_nJoystickDeviceId = -1;
+	};
+	std::unordered_map<int32_t, FakeDevices> m_oFakeDevices; // Key: recorded device id
+private:
+	EventReplayer(const EventReplayer& oSource) = delete;
+	EventReplayer& operator=(const EventReplayer& oSource) = delete;
+};
+
+} // namespace testing
+
+} // namespace stmi
+
+#endif /* STMI_TESTING_EVENT_REPLAYER_H */
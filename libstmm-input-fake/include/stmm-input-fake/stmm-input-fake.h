@@ -23,6 +23,9 @@
 
 /* This file includes all headers of the stmm-input-fake library. */
 
+#include "eventrecord.h"
+#include "eventrecorder.h"
+#include "eventreplayer.h"
 #include "fakedevice.h"
 #include "fakedevicemanager.h"
 #include "fakejoystickdevice.h"
@@ -0,0 +1,242 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventrecorder.cc
+ */
+
+#include "eventrecorder.h"
+
+#include <stmm-input-ev/devicemgmtevent.h>
+#include <stmm-input-ev/joystickevent.h>
+#include <stmm-input-ev/keyevent.h>
+#include <stmm-input-ev/pointerevent.h>
+#include <stmm-input-ev/touchevent.h>
+#include <stmm-input/capability.h>
+#include <stmm-input/device.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+constexpr char EventRecordFileHeader::s_aMagic[8];
+constexpr uint32_t EventRecordFileHeader::s_nVersion;
+constexpr uint8_t EventRecord::s_nFlagAnyButtonPressed;
+constexpr uint8_t EventRecord::s_nFlagWasAnyButtonPressed;
+constexpr int32_t EventRecorder::s_nBufferRecords;
+
+std::pair<shared_ptr<EventRecorder>, std::string> EventRecorder::create(const std::string& sFilePath) noexcept
+{
+	const int32_t nFD = ::open(sFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (nFD < 0) {
+		return std::make_pair(shared_ptr<EventRecorder>{}, std::string("Couldn't open file ") + sFilePath
+															+ ": " + std::strerror(errno)); //--
+	}
+	shared_ptr<EventRecorder> refRecorder(new EventRecorder(nFD));
+	EventRecordFileHeader oHeader;
+	std::memcpy(oHeader.m_aMagic, EventRecordFileHeader::s_aMagic, sizeof(oHeader.m_aMagic));
+	oHeader.m_nVersion = EventRecordFileHeader::s_nVersion;
+	oHeader.m_nRecordSize = sizeof(EventRecord);
+	if (!refRecorder->writeAll(&oHeader, sizeof(oHeader))) {
+		return std::make_pair(shared_ptr<EventRecorder>{}, std::string("Couldn't write file ") + sFilePath); //--
+	}
+	return std::make_pair(refRecorder, std::string{});
+}
+EventRecorder::EventRecorder(int32_t nFD) noexcept
+: m_nFD(nFD)
+, m_refEventListener(std::make_shared<EventListener>(
+		[this](const shared_ptr<Event>& refEvent)
+		{
+			onEvent(refEvent);
+		}))
+, m_aBuffer(s_nBufferRecords)
+, m_nTotBuffered(0)
+, m_nTotRecorded(0)
+, m_nTotSkipped(0)
+, m_bWriteError(false)
+{
+	assert(m_nFD >= 0);
+}
+EventRecorder::~EventRecorder() noexcept
+{
+	flush();
+	::close(m_nFD);
+}
+bool EventRecorder::flush() noexcept
+{
+	if (m_nTotBuffered > 0) {
+		const bool bOk = writeAll(m_aBuffer.data(), static_cast<int64_t>(m_nTotBuffered) * sizeof(EventRecord));
+		m_nTotBuffered = 0;
+		if (!bOk) {
+			m_bWriteError = true;
+		}
+	}
+	return !m_bWriteError;
+}
+bool EventRecorder::writeAll(const void* p0Data, int64_t nSize) noexcept
+{
+	const char* p0Cur = static_cast<const char*>(p0Data);
+	while (nSize > 0) {
+		const auto nWritten = ::write(m_nFD, p0Cur, nSize);
+		if (nWritten < 0) {
+			if (errno == EINTR) {
+				continue; // while
+			}
+			return false; //----------------------------------------------------
+		}
+		p0Cur += nWritten;
+		nSize -= nWritten;
+	}
+	return true;
+}
+void EventRecorder::onEvent(const shared_ptr<Event>& refEvent) noexcept
+{
+	EventRecord& oRecord = m_aBuffer[m_nTotBuffered];
+	if (!fillRecord(*refEvent, oRecord)) {
+		++m_nTotSkipped;
+		return; //--------------------------------------------------------------
+	}
+	++m_nTotRecorded;
+	++m_nTotBuffered;
+	if (m_nTotBuffered == s_nBufferRecords) {
+		flush();
+	}
+}
+static int32_t getEventDeviceId(const Event& oEvent) noexcept
+{
+	if (oEvent.hasCapabilityData()) {
+		return oEvent.getDeviceId(); //-----------------------------------------
+	}
+	const shared_ptr<Capability> refCapability = oEvent.getCapability();
+	if (!refCapability) {
+		return -1; //-----------------------------------------------------------
+	}
+	const shared_ptr<Device> refDevice = refCapability->getDevice();
+	if (!refDevice) {
+		return -1; //-----------------------------------------------------------
+	}
+	return refDevice->getId();
+}
+static int32_t getDeviceCapas(const Device& oDevice) noexcept
+{
+	int32_t nCapas = 0;
+	if (oDevice.getCapability(KeyCapability::getClass())) {
+		nCapas |= EventRecord::DEVICE_CAPA_KEY;
+	}
+	if (oDevice.getCapability(PointerCapability::getClass())) {
+		nCapas |= EventRecord::DEVICE_CAPA_POINTER;
+	}
+	if (oDevice.getCapability(TouchCapability::getClass())) {
+		nCapas |= EventRecord::DEVICE_CAPA_TOUCH;
+	}
+	if (oDevice.getCapability(JoystickCapability::getClass())) {
+		nCapas |= EventRecord::DEVICE_CAPA_JOYSTICK;
+	}
+	return nCapas;
+}
+
+bool EventRecorder::fillRecord(const Event& oEvent, EventRecord& oRecord) noexcept
+{
+	oRecord.m_nTimeUsec = oEvent.getTimeUsec();
+	oRecord.m_nDeviceId = -1;
+	oRecord.m_nSubType = 0;
+	oRecord.m_nFlags = 0;
+	oRecord.m_nReserved = 0;
+	oRecord.m_nArg0 = 0;
+	oRecord.m_nArg1 = 0;
+	oRecord.m_nArg2 = 0;
+	oRecord.m_fX = 0.0;
+	oRecord.m_fY = 0.0;
+	const Event::Class& oClass = oEvent.getEventClass();
+	if (oClass == DeviceMgmtEvent::getClass()) {
+		const auto& oMgmtEvent = static_cast<const DeviceMgmtEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_DEVICE_MGMT;
+		oRecord.m_nSubType = static_cast<uint8_t>(oMgmtEvent.getDeviceMgmtType());
+		const shared_ptr<Device> refDevice = oMgmtEvent.getDevice();
+		if (refDevice) {
+			oRecord.m_nDeviceId = refDevice->getId();
+			oRecord.m_nArg0 = getDeviceCapas(*refDevice);
+		}
+		return true; //---------------------------------------------------------
+	}
+	oRecord.m_nDeviceId = getEventDeviceId(oEvent);
+	if (oClass == KeyEvent::getClass()) {
+		const auto& oKeyEvent = static_cast<const KeyEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_KEY;
+		oRecord.m_nSubType = static_cast<uint8_t>(oKeyEvent.getType());
+		oRecord.m_nArg0 = static_cast<int32_t>(oKeyEvent.getKey());
+	} else if (oClass == PointerEvent::getClass()) {
+		const auto& oPointerEvent = static_cast<const PointerEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_POINTER;
+		oRecord.m_nSubType = static_cast<uint8_t>(oPointerEvent.getType());
+		oRecord.m_nArg1 = oPointerEvent.getButton();
+		// the button states can be derived from the grab type, see PointerEvent::setPointer()
+		const XYEvent::XY_GRAB_INPUT_TYPE eGrabType = oPointerEvent.getXYGrabType();
+		const bool bAnyButtonPressed = (eGrabType == XYEvent::XY_GRAB) || (eGrabType == XYEvent::XY_MOVE);
+		const bool bWasAnyButtonPressed = (eGrabType != XYEvent::XY_GRAB) && (eGrabType != XYEvent::XY_HOVER);
+		oRecord.m_nFlags = (bAnyButtonPressed ? EventRecord::s_nFlagAnyButtonPressed : 0)
+							| (bWasAnyButtonPressed ? EventRecord::s_nFlagWasAnyButtonPressed : 0);
+		oRecord.m_fX = oPointerEvent.getX();
+		oRecord.m_fY = oPointerEvent.getY();
+	} else if (oClass == PointerScrollEvent::getClass()) {
+		const auto& oScrollEvent = static_cast<const PointerScrollEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_POINTER_SCROLL;
+		oRecord.m_nSubType = static_cast<uint8_t>(oScrollEvent.getScrollDir());
+		const bool bAnyButtonPressed = (oScrollEvent.getXYGrabType() == XYEvent::XY_MOVE);
+		oRecord.m_nFlags = (bAnyButtonPressed ? EventRecord::s_nFlagAnyButtonPressed : 0);
+		oRecord.m_fX = oScrollEvent.getX();
+		oRecord.m_fY = oScrollEvent.getY();
+	} else if (oClass == TouchEvent::getClass()) {
+		const auto& oTouchEvent = static_cast<const TouchEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_TOUCH;
+		oRecord.m_nSubType = static_cast<uint8_t>(oTouchEvent.getType());
+		oRecord.m_nArg2 = oTouchEvent.getFingerId();
+		oRecord.m_fX = oTouchEvent.getX();
+		oRecord.m_fY = oTouchEvent.getY();
+	} else if (oClass == JoystickButtonEvent::getClass()) {
+		const auto& oButtonEvent = static_cast<const JoystickButtonEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_JOYSTICK_BUTTON;
+		oRecord.m_nSubType = static_cast<uint8_t>(oButtonEvent.getType());
+		oRecord.m_nArg0 = static_cast<int32_t>(oButtonEvent.getButton());
+	} else if (oClass == JoystickHatEvent::getClass()) {
+		const auto& oHatEvent = static_cast<const JoystickHatEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_JOYSTICK_HAT;
+		oRecord.m_nArg0 = oHatEvent.getHat();
+		oRecord.m_nArg1 = static_cast<int32_t>(oHatEvent.getValue());
+		oRecord.m_nArg2 = static_cast<int64_t>(oHatEvent.getPreviousValue());
+	} else if (oClass == JoystickAxisEvent::getClass()) {
+		const auto& oAxisEvent = static_cast<const JoystickAxisEvent&>(oEvent);
+		oRecord.m_eType = EventRecord::RECORD_TYPE_JOYSTICK_AXIS;
+		oRecord.m_nArg0 = static_cast<int32_t>(oAxisEvent.getAxis());
+		oRecord.m_nArg1 = oAxisEvent.getValue();
+	} else {
+		return false; //--------------------------------------------------------
+	}
+	return true;
+}
+
+} // namespace testing
+
+} // namespace stmi
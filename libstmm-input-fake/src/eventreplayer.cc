@@ -0,0 +1,365 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   eventreplayer.cc
+ */
+
+#include "eventreplayer.h"
+
+#include "fakedevicemanager.h"
+#include "fakejoystickdevice.h"
+#include "fakekeydevice.h"
+#include "fakepointerdevice.h"
+#include "faketouchdevice.h"
+
+#include <stmm-input-ev/devicemgmtevent.h>
+#include <stmm-input-ev/joystickevent.h>
+#include <stmm-input-ev/keyevent.h>
+#include <stmm-input-ev/pointerevent.h>
+#include <stmm-input-ev/touchevent.h>
+#include <stmm-input/device.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+std::pair<shared_ptr<EventReplayer>, std::string> EventReplayer::create(const std::string& sFilePath
+																		, const shared_ptr<FakeDeviceManager>& refFakeDM) noexcept
+{
+	assert(refFakeDM);
+	const int32_t nFD = ::open(sFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (nFD < 0) {
+		return std::make_pair(shared_ptr<EventReplayer>{}, std::string("Couldn't open file ") + sFilePath
+															+ ": " + std::strerror(errno)); //--
+	}
+	struct stat oStat;
+	if (::fstat(nFD, &oStat) != 0) {
+		::close(nFD);
+		return std::make_pair(shared_ptr<EventReplayer>{}, std::string("Couldn't stat file ") + sFilePath); //--
+	}
+	const int64_t nSize = oStat.st_size;
+	if (nSize < static_cast<int64_t>(sizeof(EventRecordFileHeader))) {
+		::close(nFD);
+		return std::make_pair(shared_ptr<EventReplayer>{}, std::string("File too short ") + sFilePath); //--
+	}
+	void* p0Mapped = ::mmap(nullptr, nSize, PROT_READ, MAP_PRIVATE, nFD, 0);
+	// the mapping stays valid after closing the file
+	::close(nFD);
+	if (p0Mapped == MAP_FAILED) {
+		return std::make_pair(shared_ptr<EventReplayer>{}, std::string("Couldn't map file ") + sFilePath); //--
+	}
+	const auto& oHeader = *static_cast<const EventRecordFileHeader*>(p0Mapped);
+	std::string sError;
+	if (std::memcmp(oHeader.m_aMagic, EventRecordFileHeader::s_aMagic, sizeof(oHeader.m_aMagic)) != 0) {
+		sError = "Not an event recording file ";
+	} else if (oHeader.m_nVersion != EventRecordFileHeader::s_nVersion) {
+		sError = "Unsupported event recording version in file ";
+	} else if (oHeader.m_nRecordSize != sizeof(EventRecord)) {
+		sError = "Wrong record size in file ";
+	}
+	if (!sError.empty()) {
+		::munmap(p0Mapped, nSize);
+		return std::make_pair(shared_ptr<EventReplayer>{}, sError + sFilePath); //--
+	}
+	// an incomplete last record is ignored
+	const int64_t nTotRecords = (nSize - static_cast<int64_t>(sizeof(EventRecordFileHeader))) / sizeof(EventRecord);
+	::madvise(p0Mapped, nSize, MADV_SEQUENTIAL);
+	shared_ptr<EventReplayer> refReplayer(new EventReplayer(refFakeDM, p0Mapped, nSize, nTotRecords));
+	return std::make_pair(refReplayer, std::string{});
+}
+EventReplayer::EventReplayer(const shared_ptr<FakeDeviceManager>& refFakeDM
+							, const void* p0Mapped, int64_t nMappedSize, int64_t nTotRecords) noexcept
+: m_refFakeDM(refFakeDM)
+, m_p0Mapped(p0Mapped)
+, m_nMappedSize(nMappedSize)
+, m_p0Records(reinterpret_cast<const EventRecord*>(static_cast<const char*>(p0Mapped) + sizeof(EventRecordFileHeader)))
+, m_nTotRecords(nTotRecords)
+, m_nPosition(0)
+, m_nTotInvalid(0)
+{
+}
+EventReplayer::~EventReplayer() noexcept
+{
+	::munmap(const_cast<void*>(m_p0Mapped), m_nMappedSize);
+}
+int64_t EventReplayer::replay(bool bOriginalTiming, int64_t nMaxRecords) noexcept
+{
+	const int64_t nLastPosition = ((nMaxRecords < 0) || (nMaxRecords > m_nTotRecords - m_nPosition))
+									? m_nTotRecords : m_nPosition + nMaxRecords;
+	if (m_nPosition >= nLastPosition) {
+		return 0; //------------------------------------------------------------
+	}
+	const int64_t nFirstPosition = m_nPosition;
+	const auto oStartTime = std::chrono::steady_clock::now();
+	const int64_t nFirstTimeUsec = m_p0Records[m_nPosition].m_nTimeUsec;
+	for ( ; m_nPosition < nLastPosition; ++m_nPosition) {
+		const EventRecord& oRecord = m_p0Records[m_nPosition];
+		if (bOriginalTiming) {
+			const int64_t nDeltaUsec = oRecord.m_nTimeUsec - nFirstTimeUsec;
+			if (nDeltaUsec > 0) {
+				std::this_thread::sleep_until(oStartTime + std::chrono::microseconds(nDeltaUsec));
+			}
+		}
+		replayRecord(oRecord);
+	}
+	return nLastPosition - nFirstPosition;
+}
+bool EventReplayer::isValidRecord(const EventRecord& oRecord) noexcept
+{
+	// The event constructors assert their parameters: check what the file contains
+	const int32_t nSubType = oRecord.m_nSubType;
+	switch (oRecord.m_eType) {
+	case EventRecord::RECORD_TYPE_KEY:
+	{
+		return (nSubType >= KeyEvent::KEY_PRESS) && (nSubType <= KeyEvent::KEY_RELEASE_CANCEL)
+				&& HardwareKeys::isValid(static_cast<HARDWARE_KEY>(oRecord.m_nArg0));
+	}
+	case EventRecord::RECORD_TYPE_POINTER:
+	{
+		const bool bAnyButtonPressed = ((oRecord.m_nFlags & EventRecord::s_nFlagAnyButtonPressed) != 0);
+		const bool bWasAnyButtonPressed = ((oRecord.m_nFlags & EventRecord::s_nFlagWasAnyButtonPressed) != 0);
+		const int32_t nButton = oRecord.m_nArg1;
+		switch (nSubType) {
+		case PointerEvent::BUTTON_PRESS: return (nButton >= PointerEvent::s_nFirstButton) && (bAnyButtonPressed || !bWasAnyButtonPressed);
+		case PointerEvent::BUTTON_RELEASE: // fallthrough
+		case PointerEvent::BUTTON_RELEASE_CANCEL: return (nButton >= PointerEvent::s_nFirstButton) && bWasAnyButtonPressed;
+		case PointerEvent::POINTER_MOVE: return (nButton == PointerEvent::s_nNoButton) && bAnyButtonPressed && bWasAnyButtonPressed;
+		case PointerEvent::POINTER_HOVER: return (nButton == PointerEvent::s_nNoButton) && !bAnyButtonPressed && !bWasAnyButtonPressed;
+		default: return false;
+		}
+	}
+	case EventRecord::RECORD_TYPE_POINTER_SCROLL:
+	{
+		return (nSubType >= PointerScrollEvent::SCROLL_UP) && (nSubType <= PointerScrollEvent::SCROLL_RIGHT);
+	}
+	case EventRecord::RECORD_TYPE_TOUCH:
+	{
+		return (nSubType >= TouchEvent::TOUCH_BEGIN) && (nSubType <= TouchEvent::TOUCH_CANCEL);
+	}
+	case EventRecord::RECORD_TYPE_JOYSTICK_BUTTON:
+	{
+		return ((nSubType == JoystickButtonEvent::BUTTON_PRESS) || (nSubType == JoystickButtonEvent::BUTTON_RELEASE)
+					|| (nSubType == JoystickButtonEvent::BUTTON_RELEASE_CANCEL))
+				&& JoystickCapability::isValidButton(static_cast<JoystickCapability::BUTTON>(oRecord.m_nArg0));
+	}
+	case EventRecord::RECORD_TYPE_JOYSTICK_HAT:
+	{
+		const int64_t nPreviousValue = oRecord.m_nArg2;
+		const bool bValidPrevious = (nPreviousValue == JoystickCapability::HAT_VALUE_NOT_SET)
+									|| ((nPreviousValue != JoystickCapability::HAT_CENTER_CANCEL)
+										&& (nPreviousValue >= std::numeric_limits<int32_t>::min())
+										&& (nPreviousValue <= std::numeric_limits<int32_t>::max())
+										&& JoystickCapability::isValidHatValue(static_cast<JoystickCapability::HAT_VALUE>(nPreviousValue)));
+		return (oRecord.m_nArg0 >= 0) && bValidPrevious
+				&& JoystickCapability::isValidHatValue(static_cast<JoystickCapability::HAT_VALUE>(oRecord.m_nArg1));
+	}
+	case EventRecord::RECORD_TYPE_JOYSTICK_AXIS:
+	{
+		return (oRecord.m_nArg1 >= -32767) && (oRecord.m_nArg1 <= 32767)
+				&& JoystickCapability::isValidAxis(static_cast<JoystickCapability::AXIS>(oRecord.m_nArg0));
+	}
+	case EventRecord::RECORD_TYPE_DEVICE_MGMT:
+	{
+		return (nSubType >= DeviceMgmtEvent::DEVICE_MGMT_ADDED) && (nSubType <= DeviceMgmtEvent::DEVICE_MGMT_CHANGED);
+	}
+	default:
+	{
+		return false;
+	}
+	}
+}
+void EventReplayer::replayRecord(const EventRecord& oRecord) noexcept
+{
+	if (!isValidRecord(oRecord)) {
+		++m_nTotInvalid;
+		return; //--------------------------------------------------------------
+	}
+	if (oRecord.m_eType == EventRecord::RECORD_TYPE_DEVICE_MGMT) {
+		replayDeviceMgmt(oRecord);
+		return; //--------------------------------------------------------------
+	}
+	const int64_t nTimeUsec = oRecord.m_nTimeUsec;
+	shared_ptr<Event> refEvent;
+	switch (oRecord.m_eType) {
+	case EventRecord::RECORD_TYPE_KEY:
+	{
+		shared_ptr<Device> refDevice = m_refFakeDM->getDevice(getFakeDeviceId(oRecord.m_nDeviceId, EventRecord::DEVICE_CAPA_KEY));
+		shared_ptr<KeyCapability> refCapability;
+		if (refDevice && refDevice->getCapability(refCapability)) {
+			refEvent = std::make_shared<KeyEvent>(nTimeUsec, shared_ptr<Accessor>{}, refCapability
+												, static_cast<KeyEvent::KEY_INPUT_TYPE>(oRecord.m_nSubType)
+												, static_cast<HARDWARE_KEY>(oRecord.m_nArg0));
+		}
+	}
+	break;
+	case EventRecord::RECORD_TYPE_POINTER:
+	{
+		shared_ptr<Device> refDevice = m_refFakeDM->getDevice(getFakeDeviceId(oRecord.m_nDeviceId, EventRecord::DEVICE_CAPA_POINTER));
+		shared_ptr<PointerCapability> refCapability;
+		if (refDevice && refDevice->getCapability(refCapability)) {
+			refEvent = std::make_shared<PointerEvent>(nTimeUsec, shared_ptr<Accessor>{}, refCapability
+													, oRecord.m_fX, oRecord.m_fY
+													, static_cast<PointerEvent::POINTER_INPUT_TYPE>(oRecord.m_nSubType), oRecord.m_nArg1
+													, (oRecord.m_nFlags & EventRecord::s_nFlagAnyButtonPressed) != 0
+													, (oRecord.m_nFlags & EventRecord::s_nFlagWasAnyButtonPressed) != 0);
+		}
+	}
+	break;
+	case EventRecord::RECORD_TYPE_POINTER_SCROLL:
+	{
+		shared_ptr<Device> refDevice = m_refFakeDM->getDevice(getFakeDeviceId(oRecord.m_nDeviceId, EventRecord::DEVICE_CAPA_POINTER));
+		shared_ptr<PointerCapability> refCapability;
+		if (refDevice && refDevice->getCapability(refCapability)) {
+			refEvent = std::make_shared<PointerScrollEvent>(nTimeUsec, shared_ptr<Accessor>{}, refCapability
+															, static_cast<PointerScrollEvent::POINTER_SCROLL_DIR>(oRecord.m_nSubType)
+															, oRecord.m_fX, oRecord.m_fY
+															, (oRecord.m_nFlags & EventRecord::s_nFlagAnyButtonPressed) != 0);
+		}
+	}
+	break;
+	case EventRecord::RECORD_TYPE_TOUCH:
+	{
+		shared_ptr<Device> refDevice = m_refFakeDM->getDevice(getFakeDeviceId(oRecord.m_nDeviceId, EventRecord::DEVICE_CAPA_TOUCH));
+		shared_ptr<TouchCapability> refCapability;
+		if (refDevice && refDevice->getCapability(refCapability)) {
+			refEvent = std::make_shared<TouchEvent>(nTimeUsec, shared_ptr<Accessor>{}, refCapability
+													, static_cast<TouchEvent::TOUCH_INPUT_TYPE>(oRecord.m_nSubType)
+													, oRecord.m_fX, oRecord.m_fY, oRecord.m_nArg2);
+		}
+	}
+	break;
+	case EventRecord::RECORD_TYPE_JOYSTICK_BUTTON:
+	{
+		shared_ptr<Device> refDevice = m_refFakeDM->getDevice(getFakeDeviceId(oRecord.m_nDeviceId, EventRecord::DEVICE_CAPA_JOYSTICK));
+		shared_ptr<JoystickCapability> refCapability;
+		if (refDevice && refDevice->getCapability(refCapability)) {
+			refEvent = std::make_shared<JoystickButtonEvent>(nTimeUsec, shared_ptr<Accessor>{}, refCapability
+															, static_cast<JoystickButtonEvent::BUTTON_INPUT_TYPE>(oRecord.m_nSubType)
+															, static_cast<JoystickCapability::BUTTON>(oRecord.m_nArg0));
+		}
+	}
+	break;
+	case EventRecord::RECORD_TYPE_JOYSTICK_HAT:
+	{
+		shared_ptr<Device> refDevice = m_refFakeDM->getDevice(getFakeDeviceId(oRecord.m_nDeviceId, EventRecord::DEVICE_CAPA_JOYSTICK));
+		shared_ptr<JoystickCapability> refCapability;
+		if (refDevice && refDevice->getCapability(refCapability)) {
+			refEvent = std::make_shared<JoystickHatEvent>(nTimeUsec, shared_ptr<Accessor>{}, refCapability, oRecord.m_nArg0
+														, static_cast<JoystickCapability::HAT_VALUE>(oRecord.m_nArg1)
+														, static_cast<JoystickCapability::HAT_VALUE>(oRecord.m_nArg2));
+		}
+	}
+	break;
+	case EventRecord::RECORD_TYPE_JOYSTICK_AXIS:
+	{
+		shared_ptr<Device> refDevice = m_refFakeDM->getDevice(getFakeDeviceId(oRecord.m_nDeviceId, EventRecord::DEVICE_CAPA_JOYSTICK));
+		shared_ptr<JoystickCapability> refCapability;
+		if (refDevice && refDevice->getCapability(refCapability)) {
+			refEvent = std::make_shared<JoystickAxisEvent>(nTimeUsec, shared_ptr<Accessor>{}, refCapability
+														, static_cast<JoystickCapability::AXIS>(oRecord.m_nArg0), oRecord.m_nArg1);
+		}
+	}
+	break;
+	default:
+	{
+		assert(false);
+	}
+	break;
+	}
+	if (refEvent) {
+		m_refFakeDM->simulateEvent(refEvent);
+	}
+}
+void EventReplayer::replayDeviceMgmt(const EventRecord& oRecord) noexcept
+{
+	const int32_t nRecordedDeviceId = oRecord.m_nDeviceId;
+	if (nRecordedDeviceId < 0) {
+		return; //--------------------------------------------------------------
+	}
+	const auto eMgmtType = static_cast<DeviceMgmtEvent::DEVICE_MGMT_TYPE>(oRecord.m_nSubType);
+	if (eMgmtType == DeviceMgmtEvent::DEVICE_MGMT_ADDED) {
+		addFakeDevices(nRecordedDeviceId, oRecord.m_nArg0);
+		return; //--------------------------------------------------------------
+	}
+	auto itFind = m_oFakeDevices.find(nRecordedDeviceId);
+	if (itFind == m_oFakeDevices.end()) {
+		return; //--------------------------------------------------------------
+	}
+	const FakeDevices& oFakeDevices = itFind->second;
+	for (const int32_t nFakeDeviceId : {oFakeDevices.m_nKeyDeviceId, oFakeDevices.m_nPointerDeviceId
+										, oFakeDevices.m_nTouchDeviceId, oFakeDevices.m_nJoystickDeviceId}) {
+		if (nFakeDeviceId < 0) {
+			continue; // for
+		}
+		if (eMgmtType == DeviceMgmtEvent::DEVICE_MGMT_REMOVED) {
+			m_refFakeDM->simulateRemoveDevice(nFakeDeviceId);
+		} else {
+			m_refFakeDM->simulateChangedDevice(nFakeDeviceId);
+		}
+	}
+	if (eMgmtType == DeviceMgmtEvent::DEVICE_MGMT_REMOVED) {
+		m_oFakeDevices.erase(itFind);
+	}
+}
+void EventReplayer::addFakeDevices(int32_t nRecordedDeviceId, int32_t nCapas) noexcept
+{
+	FakeDevices& oFakeDevices = m_oFakeDevices[nRecordedDeviceId];
+	if (((nCapas & EventRecord::DEVICE_CAPA_KEY) != 0) && (oFakeDevices.m_nKeyDeviceId < 0)) {
+		oFakeDevices.m_nKeyDeviceId = m_refFakeDM->simulateNewDevice<FakeKeyDevice>();
+	}
+	if (((nCapas & EventRecord::DEVICE_CAPA_POINTER) != 0) && (oFakeDevices.m_nPointerDeviceId < 0)) {
+		oFakeDevices.m_nPointerDeviceId = m_refFakeDM->simulateNewDevice<FakePointerDevice>();
+	}
+	if (((nCapas & EventRecord::DEVICE_CAPA_TOUCH) != 0) && (oFakeDevices.m_nTouchDeviceId < 0)) {
+		oFakeDevices.m_nTouchDeviceId = m_refFakeDM->simulateNewDevice<FakeTouchDevice>();
+	}
+	if (((nCapas & EventRecord::DEVICE_CAPA_JOYSTICK) != 0) && (oFakeDevices.m_nJoystickDeviceId < 0)) {
+		oFakeDevices.m_nJoystickDeviceId = m_refFakeDM->simulateNewDevice<FakeJoystickDevice>();
+	}
+}
+int32_t EventReplayer::getFakeDeviceId(int32_t nRecordedDeviceId, EventRecord::DEVICE_CAPA eCapa) noexcept
+{
+	addFakeDevices(nRecordedDeviceId, eCapa);
+	const FakeDevices& oFakeDevices = m_oFakeDevices[nRecordedDeviceId];
+	switch (eCapa) {
+	case EventRecord::DEVICE_CAPA_KEY: return oFakeDevices.m_nKeyDeviceId;
+	case EventRecord::DEVICE_CAPA_POINTER: return oFakeDevices.m_nPointerDeviceId;
+	case EventRecord::DEVICE_CAPA_TOUCH: return oFakeDevices.m_nTouchDeviceId;
+	case EventRecord::DEVICE_CAPA_JOYSTICK: return oFakeDevices.m_nJoystickDeviceId;
+	default: break;
+	}
+	assert(false);
+	return -1;
+}
+
+} // namespace testing
+
+} // namespace stmi
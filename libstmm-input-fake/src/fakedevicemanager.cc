@@ -77,13 +77,14 @@ bool FakeDeviceManager::simulateChangedDevice(int32_t nDeviceId) noexcept
 }
 int32_t FakeDeviceManager::simulateEvent(const shared_ptr<Event>& refEvent) noexcept
 {
-	if (!isEventClassEnabled(refEvent->getEventClass())) {
+	const int32_t nClassIdx = getEventClassIndex(refEvent->getEventClass());
+	if ((nClassIdx < 0) || !isEventClassIndexEnabled(nClassIdx)) {
 		return -1;
 	}
 	int32_t nTotSent = 0;
-	auto refListeners = getListeners();
+	auto refListeners = getListeners(nClassIdx);
 	for (ListenerData* p0ListenerData : *refListeners) {
-		const bool bSent = p0ListenerData->handleEventCallIf(-1, refEvent);
+		const bool bSent = p0ListenerData->handleEventCallIf(nClassIdx, refEvent);
 		if (bSent) {
 			++nTotSent;
 		}
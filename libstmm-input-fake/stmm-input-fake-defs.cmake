@@ -19,11 +19,11 @@
 #   MAJOR is CURRENT interface
 #   MINOR is REVISION (implementation of interface)
 #   AGE is always 0
-set(STMM_INPUT_FAKE_MAJOR_VERSION 0)
-set(STMM_INPUT_FAKE_MINOR_VERSION 16) # !-U-!
+set(STMM_INPUT_FAKE_MAJOR_VERSION 1)
+set(STMM_INPUT_FAKE_MINOR_VERSION 0) # !-U-!
 set(STMM_INPUT_FAKE_VERSION "${STMM_INPUT_FAKE_MAJOR_VERSION}.${STMM_INPUT_FAKE_MINOR_VERSION}.0")
 
-set(STMM_INPUT_FAKE_REQ_STMM_INPUT_EV_VERSION "0.16") # !-U-!
+set(STMM_INPUT_FAKE_REQ_STMM_INPUT_EV_VERSION "1.0") # !-U-!
 
 include("${PROJECT_SOURCE_DIR}/../libstmm-input-ev/stmm-input-ev-defs.cmake")
 
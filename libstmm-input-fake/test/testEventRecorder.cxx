@@ -0,0 +1,239 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testEventRecorder.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "eventrecorder.h"
+#include "eventreplayer.h"
+#include "fakedevicemanager.h"
+#include "fakekeydevice.h"
+#include "fakepointerdevice.h"
+#include "fakejoystickdevice.h"
+
+#include <stmm-input-ev/devicemgmtevent.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+
+namespace testing
+{
+
+// Removes the file also if a test fails
+class TempFile
+{
+public:
+	explicit TempFile(const std::string& sName)
+	: m_sFilePath("/tmp/stmi-testEventRecorder-" + sName + "-" + std::to_string(::getpid()) + ".rec")
+	{
+	}
+	~TempFile()
+	{
+		std::remove(m_sFilePath.c_str());
+	}
+	const std::string& getPath() const { return m_sFilePath; }
+private:
+	std::string m_sFilePath;
+};
+
+TEST_CASE("testEventRecorder, RecordAndReplay")
+{
+	const TempFile oTempFile("RecordAndReplay");
+	const std::string& sFilePath = oTempFile.getPath();
+
+	auto refSourceDM = std::make_shared<FakeDeviceManager>();
+	const int32_t nKeyDevId = refSourceDM->simulateNewDevice<FakeKeyDevice>();
+	{
+		auto oPairRecorder = EventRecorder::create(sFilePath);
+		auto& refRecorder = oPairRecorder.first;
+		REQUIRE(refRecorder);
+		REQUIRE(oPairRecorder.second.empty());
+		REQUIRE(refSourceDM->addEventListener(refRecorder->getEventListener()));
+
+		const int32_t nPointerDevId = refSourceDM->simulateNewDevice<FakePointerDevice>();
+		const int32_t nJoystickDevId = refSourceDM->simulateNewDevice<FakeJoystickDevice>();
+		refSourceDM->simulateKeyEvent(nKeyDevId, KeyEvent::KEY_PRESS, HK_A);
+		refSourceDM->simulateKeyEvent(nKeyDevId, KeyEvent::KEY_RELEASE, HK_A);
+		refSourceDM->simulatePointerEvent(nPointerDevId, 10.5, 20.5, PointerEvent::BUTTON_PRESS, 1, true, false);
+		refSourceDM->simulatePointerEvent(nPointerDevId, 11.5, 21.5, PointerEvent::POINTER_MOVE, PointerEvent::s_nNoButton, true, true);
+		refSourceDM->simulatePointerEvent(nPointerDevId, 12.5, 22.5, PointerEvent::BUTTON_RELEASE, 1, false, true);
+		refSourceDM->simulatePointerScrollEvent(nPointerDevId, PointerScrollEvent::SCROLL_LEFT, 3, 4, false);
+		refSourceDM->simulateJoystickButtonEvent(nJoystickDevId, JoystickButtonEvent::BUTTON_PRESS, JoystickCapability::BUTTON_A);
+		refSourceDM->simulateJoystickHatEvent(nJoystickDevId, 0, JoystickCapability::HAT_UP, JoystickCapability::HAT_CENTER);
+		refSourceDM->simulateJoystickAxisEvent(nJoystickDevId, JoystickCapability::AXIS_X, -12345);
+		refSourceDM->simulateRemoveDevice(nPointerDevId);
+
+		REQUIRE(refRecorder->getTotRecorded() == 12);
+		REQUIRE(refRecorder->getTotSkipped() == 0);
+	}
+
+	auto refTargetDM = std::make_shared<FakeDeviceManager>();
+	std::vector<shared_ptr<Event>> aReceived;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		aReceived.push_back(refEvent);
+	});
+	REQUIRE(refTargetDM->addEventListener(refListener));
+
+	auto oPairReplayer = EventReplayer::create(sFilePath, refTargetDM);
+	auto& refReplayer = oPairReplayer.first;
+	REQUIRE(refReplayer);
+	REQUIRE(refReplayer->getTotRecords() == 12);
+
+	REQUIRE(refReplayer->replay(false, 2) == 2);
+	REQUIRE(refReplayer->getPosition() == 2);
+	REQUIRE(aReceived.size() == 2);
+	REQUIRE(refReplayer->replay(false) == 10);
+	REQUIRE(refReplayer->getPosition() == 12);
+	REQUIRE(refReplayer->replay(false) == 0);
+
+	// The key device was added before the recording started:
+	// it is added when its first event is replayed
+	std::vector<Event::Class> aExpectedClasses{DeviceMgmtEvent::getClass(), DeviceMgmtEvent::getClass()
+											, DeviceMgmtEvent::getClass(), KeyEvent::getClass(), KeyEvent::getClass()
+											, PointerEvent::getClass(), PointerEvent::getClass(), PointerEvent::getClass()
+											, PointerScrollEvent::getClass(), JoystickButtonEvent::getClass()
+											, JoystickHatEvent::getClass(), JoystickAxisEvent::getClass()
+											, DeviceMgmtEvent::getClass()};
+	REQUIRE(aReceived.size() == aExpectedClasses.size());
+	for (std::size_t nIdx = 0; nIdx < aReceived.size(); ++nIdx) {
+		REQUIRE(aReceived[nIdx]->getEventClass() == aExpectedClasses[nIdx]);
+	}
+
+	auto p0KeyEv = static_cast<KeyEvent*>(aReceived[4].get());
+	REQUIRE(p0KeyEv->getType() == KeyEvent::KEY_RELEASE);
+	REQUIRE(p0KeyEv->getKey() == HK_A);
+
+	auto p0PointerEv = static_cast<PointerEvent*>(aReceived[6].get());
+	REQUIRE(p0PointerEv->getType() == PointerEvent::POINTER_MOVE);
+	REQUIRE(p0PointerEv->getX() == 11.5);
+	REQUIRE(p0PointerEv->getY() == 21.5);
+	REQUIRE(p0PointerEv->getXYGrabType() == XYEvent::XY_MOVE);
+
+	auto p0ScrollEv = static_cast<PointerScrollEvent*>(aReceived[8].get());
+	REQUIRE(p0ScrollEv->getScrollDir() == PointerScrollEvent::SCROLL_LEFT);
+
+	auto p0HatEv = static_cast<JoystickHatEvent*>(aReceived[10].get());
+	REQUIRE(p0HatEv->getHat() == 0);
+	REQUIRE(p0HatEv->getValue() == JoystickCapability::HAT_UP);
+	REQUIRE(p0HatEv->getPreviousValue() == JoystickCapability::HAT_CENTER);
+
+	auto p0AxisEv = static_cast<JoystickAxisEvent*>(aReceived[11].get());
+	REQUIRE(p0AxisEv->getAxis() == JoystickCapability::AXIS_X);
+	REQUIRE(p0AxisEv->getValue() == -12345);
+
+	auto p0MgmtEv = static_cast<DeviceMgmtEvent*>(aReceived[12].get());
+	REQUIRE(p0MgmtEv->getDeviceMgmtType() == DeviceMgmtEvent::DEVICE_MGMT_REMOVED);
+	REQUIRE(refTargetDM->getDevices().size() == 2);
+	REQUIRE(refReplayer->getTotInvalid() == 0);
+}
+
+TEST_CASE("testEventRecorder, InvalidRecords")
+{
+	const TempFile oTempFile("InvalidRecords");
+	const std::string& sFilePath = oTempFile.getPath();
+
+	std::vector<EventRecord> aRecords;
+	auto addRecord = [&](EventRecord::RECORD_TYPE eType, int32_t nSubType, int32_t nArg0, int32_t nArg1, int64_t nArg2, uint8_t nFlags)
+	{
+		EventRecord oRecord;
+		std::memset(&oRecord, 0, sizeof(oRecord));
+		oRecord.m_nTimeUsec = 1000 + static_cast<int64_t>(aRecords.size());
+		oRecord.m_nDeviceId = 7;
+		oRecord.m_eType = eType;
+		oRecord.m_nSubType = static_cast<uint8_t>(nSubType);
+		oRecord.m_nFlags = nFlags;
+		oRecord.m_nArg0 = nArg0;
+		oRecord.m_nArg1 = nArg1;
+		oRecord.m_nArg2 = nArg2;
+		aRecords.push_back(oRecord);
+	};
+	addRecord(EventRecord::RECORD_TYPE_DEVICE_MGMT, DeviceMgmtEvent::DEVICE_MGMT_ADDED
+			, EventRecord::DEVICE_CAPA_KEY | EventRecord::DEVICE_CAPA_POINTER | EventRecord::DEVICE_CAPA_JOYSTICK, 0, 0, 0);
+	// invalid
+	addRecord(EventRecord::RECORD_TYPE_KEY, 77, HK_A, 0, 0, 0);
+	addRecord(EventRecord::RECORD_TYPE_KEY, KeyEvent::KEY_PRESS, -5, 0, 0, 0);
+	addRecord(EventRecord::RECORD_TYPE_POINTER, PointerEvent::POINTER_MOVE, 0, PointerEvent::s_nNoButton, 0, 0);
+	addRecord(EventRecord::RECORD_TYPE_POINTER, PointerEvent::BUTTON_PRESS, 0, 0, 0, EventRecord::s_nFlagAnyButtonPressed);
+	addRecord(EventRecord::RECORD_TYPE_POINTER_SCROLL, 99, 0, 0, 0, 0);
+	addRecord(EventRecord::RECORD_TYPE_JOYSTICK_BUTTON, JoystickButtonEvent::BUTTON_PRESS, 12345, 0, 0, 0);
+	addRecord(EventRecord::RECORD_TYPE_JOYSTICK_HAT, 0, 0, 77, JoystickCapability::HAT_CENTER, 0);
+	addRecord(EventRecord::RECORD_TYPE_JOYSTICK_HAT, 0, 0, JoystickCapability::HAT_UP, 1LL << 40, 0);
+	addRecord(EventRecord::RECORD_TYPE_JOYSTICK_AXIS, 0, 9999, 0, 0, 0);
+	addRecord(EventRecord::RECORD_TYPE_JOYSTICK_AXIS, 0, JoystickCapability::AXIS_X, 40000, 0, 0);
+	addRecord(static_cast<EventRecord::RECORD_TYPE>(99), 0, 0, 0, 0, 0);
+	addRecord(EventRecord::RECORD_TYPE_DEVICE_MGMT, 0, 0, 0, 0, 0);
+	// valid
+	addRecord(EventRecord::RECORD_TYPE_KEY, KeyEvent::KEY_PRESS, HK_B, 0, 0, 0);
+	{
+		std::ofstream oFile(sFilePath, std::ios::binary | std::ios::trunc);
+		EventRecordFileHeader oHeader;
+		std::memcpy(oHeader.m_aMagic, EventRecordFileHeader::s_aMagic, sizeof(oHeader.m_aMagic));
+		oHeader.m_nVersion = EventRecordFileHeader::s_nVersion;
+		oHeader.m_nRecordSize = sizeof(EventRecord);
+		oFile.write(reinterpret_cast<const char*>(&oHeader), sizeof(oHeader));
+		oFile.write(reinterpret_cast<const char*>(aRecords.data()), sizeof(EventRecord) * aRecords.size());
+		// a truncated record at the end is ignored
+		oFile.write(reinterpret_cast<const char*>(aRecords.data()), sizeof(EventRecord) / 2);
+		REQUIRE(oFile.good());
+	}
+
+	auto refTargetDM = std::make_shared<FakeDeviceManager>();
+	std::vector<shared_ptr<Event>> aReceived;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		aReceived.push_back(refEvent);
+	});
+	REQUIRE(refTargetDM->addEventListener(refListener));
+
+	auto oPairReplayer = EventReplayer::create(sFilePath, refTargetDM);
+	auto& refReplayer = oPairReplayer.first;
+	REQUIRE(refReplayer);
+	REQUIRE(refReplayer->getTotRecords() == static_cast<int64_t>(aRecords.size()));
+	REQUIRE(refReplayer->replay(false) == static_cast<int64_t>(aRecords.size()));
+	REQUIRE(refReplayer->getTotInvalid() == static_cast<int64_t>(aRecords.size()) - 2);
+
+	// The added key, pointer and joystick devices and the valid key event
+	REQUIRE(aReceived.size() == 4);
+	REQUIRE(aReceived.back()->getEventClass() == KeyEvent::getClass());
+	REQUIRE(static_cast<KeyEvent*>(aReceived.back().get())->getKey() == HK_B);
+}
+
+TEST_CASE("testEventRecorder, BadFile")
+{
+	auto refTargetDM = std::make_shared<FakeDeviceManager>();
+	auto oPairReplayer = EventReplayer::create("/tmp/stmi-testEventRecorder-does-not-exist.rec", refTargetDM);
+	REQUIRE_FALSE(oPairReplayer.first);
+	REQUIRE_FALSE(oPairReplayer.second.empty());
+}
+
+} // namespace testing
+
+} // namespace stmi
@@ -31,6 +31,7 @@
 
 #include <stmm-input/callifs.h>
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -101,6 +102,32 @@ TEST_CASE_METHOD(FakeDMFixture, "RemoveDevice")
 	REQUIRE(aDeviceIds.size() == 0);
 }
 
+TEST_CASE_METHOD(FakeDMFixture, "DevicesWithCapabilityClass")
+{
+	const int32_t nKeyDevId1 = m_refAllEvDM->simulateNewDevice<FakeKeyDevice>();
+	const int32_t nPointerDevId = m_refAllEvDM->simulateNewDevice<FakePointerDevice>();
+	const int32_t nKeyDevId2 = m_refAllEvDM->simulateNewDevice<FakeKeyDevice>();
+	const int32_t nTouchDevId = m_refAllEvDM->simulateNewDevice<FakeTouchDevice>();
+
+	auto aDeviceIds = m_refAllEvDM->getDevices();
+	REQUIRE(aDeviceIds.size() == 4);
+	REQUIRE(std::is_sorted(aDeviceIds.begin(), aDeviceIds.end()));
+
+	auto aKeyDevIds = m_refAllEvDM->getDevicesWithCapabilityClass(KeyCapability::getClass());
+	REQUIRE(aKeyDevIds.size() == 2);
+	REQUIRE(aKeyDevIds[0] == std::min(nKeyDevId1, nKeyDevId2));
+	REQUIRE(aKeyDevIds[1] == std::max(nKeyDevId1, nKeyDevId2));
+	auto aPointerDevIds = m_refAllEvDM->getDevicesWithCapabilityClass(PointerCapability::getClass());
+	REQUIRE(aPointerDevIds == std::vector<int32_t>{nPointerDevId});
+	auto aTouchDevIds = m_refAllEvDM->getDevicesWithCapabilityClass(TouchCapability::getClass());
+	REQUIRE(aTouchDevIds == std::vector<int32_t>{nTouchDevId});
+
+	REQUIRE(m_refAllEvDM->simulateRemoveDevice(nKeyDevId1));
+	aKeyDevIds = m_refAllEvDM->getDevicesWithCapabilityClass(KeyCapability::getClass());
+	REQUIRE(aKeyDevIds == std::vector<int32_t>{nKeyDevId2});
+	REQUIRE(m_refAllEvDM->getDevicesWithCapabilityClass(JoystickCapability::getClass()).empty());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 TEST_CASE_METHOD(FakeDMOneListenerFixture, "SendKeyEventToListeners")
 {
@@ -132,6 +159,102 @@ TEST_CASE_METHOD(FakeDMOneListenerFixture, "SendKeyEventToListeners")
 	REQUIRE(aReceivedEvents2.size() == 0);
 }
 
+TEST_CASE("EnableEventClasses")
+{
+	auto refFakeDM = std::make_shared<FakeDeviceManager>(true, std::vector<Event::Class>{KeyEvent::getClass()});
+	REQUIRE(refFakeDM->isEventClassEnabled(KeyEvent::getClass()));
+	REQUIRE_FALSE(refFakeDM->isEventClassEnabled(PointerEvent::getClass()));
+
+	std::vector<shared_ptr<stmi::Event> > aReceivedEvents;
+	auto refListener = std::make_shared<stmi::EventListener>(
+			[&](const shared_ptr<stmi::Event>& refEvent)
+			{
+				aReceivedEvents.emplace_back(refEvent);
+			});
+	const bool bListenerAdded = refFakeDM->addEventListener(refListener);
+	REQUIRE(bListenerAdded);
+
+	const int32_t nPointerDevId = refFakeDM->simulateNewDevice<FakePointerDevice>();
+	REQUIRE(refFakeDM->simulatePointerEvent(nPointerDevId, 10, 10, PointerEvent::BUTTON_PRESS, 1, true, false) == -1);
+	REQUIRE(aReceivedEvents.empty());
+
+	refFakeDM->enableEventClass(PointerEvent::getClass());
+	REQUIRE(refFakeDM->isEventClassEnabled(PointerEvent::getClass()));
+	REQUIRE(refFakeDM->simulatePointerEvent(nPointerDevId, 10, 10, PointerEvent::BUTTON_PRESS, 1, true, false) == 1);
+	REQUIRE(aReceivedEvents.size() == 1);
+}
+
+TEST_CASE_METHOD(FakeDMFixture, "AddListenerWithinCallback")
+{
+	const int32_t nKeyDevId = m_refAllEvDM->simulateNewDevice<FakeKeyDevice>();
+
+	std::vector<shared_ptr<stmi::Event> > aReceivedEvents2;
+	auto refListener2 = std::make_shared<stmi::EventListener>(
+			[&](const shared_ptr<stmi::Event>& refEvent)
+			{
+				aReceivedEvents2.emplace_back(refEvent);
+			});
+	std::vector<shared_ptr<stmi::Event> > aReceivedEvents;
+	auto refListener = std::make_shared<stmi::EventListener>(
+			[&](const shared_ptr<stmi::Event>& refEvent)
+			{
+				aReceivedEvents.emplace_back(refEvent);
+				m_refAllEvDM->addEventListener(refListener2, std::make_shared<stmi::CallIfEventClass>(stmi::KeyEvent::getClass()));
+			});
+	const bool bListenerAdded = m_refAllEvDM->addEventListener(refListener, std::make_shared<stmi::CallIfEventClass>(stmi::KeyEvent::getClass()));
+	REQUIRE(bListenerAdded);
+
+	int32_t nTotSent = m_refAllEvDM->simulateKeyEvent(nKeyDevId, KeyEvent::KEY_PRESS, HK_A);
+	REQUIRE(nTotSent == 1);
+	REQUIRE(aReceivedEvents.size() == 1);
+	REQUIRE(aReceivedEvents2.size() == 0);
+
+	nTotSent = m_refAllEvDM->simulateKeyEvent(nKeyDevId, KeyEvent::KEY_RELEASE, HK_A);
+	REQUIRE(nTotSent == 2);
+	REQUIRE(aReceivedEvents.size() == 2);
+	REQUIRE(aReceivedEvents2.size() == 1);
+}
+
+TEST_CASE_METHOD(FakeDMFixture, "AddRemoveListenersReuse")
+{
+	const int32_t nKeyDevId = m_refAllEvDM->simulateNewDevice<FakeKeyDevice>();
+
+	std::vector<int32_t> aReceived(4, 0);
+	std::vector<shared_ptr<stmi::EventListener>> aListeners;
+	for (int32_t nIdx = 0; nIdx < 4; ++nIdx) {
+		aListeners.push_back(std::make_shared<stmi::EventListener>(
+				[&aReceived, nIdx](const shared_ptr<stmi::Event>& /*refEvent*/)
+				{
+					++aReceived[nIdx];
+				}));
+	}
+	auto refCIKey = std::make_shared<stmi::CallIfEventClass>(stmi::KeyEvent::getClass());
+	REQUIRE(m_refAllEvDM->addEventListener(aListeners[0], refCIKey));
+	REQUIRE(m_refAllEvDM->addEventListener(aListeners[1], refCIKey));
+	REQUIRE(m_refAllEvDM->addEventListener(aListeners[2], refCIKey));
+	REQUIRE_FALSE(m_refAllEvDM->addEventListener(aListeners[1], refCIKey));
+
+	REQUIRE(m_refAllEvDM->removeEventListener(aListeners[1]));
+	REQUIRE_FALSE(m_refAllEvDM->removeEventListener(aListeners[1]));
+	// reuses the slot of the removed listener
+	REQUIRE(m_refAllEvDM->addEventListener(aListeners[3], refCIKey));
+
+	int32_t nTotSent = m_refAllEvDM->simulateKeyEvent(nKeyDevId, KeyEvent::KEY_PRESS, HK_A);
+	REQUIRE(nTotSent == 3);
+	REQUIRE(aReceived == std::vector<int32_t>{1, 0, 1, 1});
+
+	// re-adding a removed listener is allowed
+	REQUIRE(m_refAllEvDM->addEventListener(aListeners[1], refCIKey));
+	// a listener that was deleted without being removed
+	aListeners[0].reset();
+	nTotSent = m_refAllEvDM->simulateKeyEvent(nKeyDevId, KeyEvent::KEY_RELEASE, HK_A);
+	REQUIRE(nTotSent == 4);
+	REQUIRE(aReceived == std::vector<int32_t>{1, 1, 2, 2});
+	nTotSent = m_refAllEvDM->simulateKeyEvent(nKeyDevId, KeyEvent::KEY_PRESS, HK_A);
+	REQUIRE(nTotSent == 3);
+	REQUIRE(aReceived == std::vector<int32_t>{1, 2, 3, 3});
+}
+
 TEST_CASE_METHOD(FakeDMOneListenerFixture, "SendPointerEventToListener")
 {
 	const int32_t nPointerDevId = m_refAllEvDM->simulateNewDevice<FakePointerDevice>();
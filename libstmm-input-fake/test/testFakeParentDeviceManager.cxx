@@ -0,0 +1,222 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testFakeParentDeviceManager.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "fakedevicemanager.h"
+#include "fakekeydevice.h"
+#include "fakepointerdevice.h"
+
+#include <stmm-input-base/parentdevicemanager.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace testing
+{
+
+class FakeParentDeviceManager : public ParentDeviceManager
+{
+public:
+	static shared_ptr<FakeParentDeviceManager> create(const std::vector< shared_ptr<ChildDeviceManager> >& aChildDeviceManager) noexcept
+	{
+		auto refDM = shared_ptr<FakeParentDeviceManager>(new FakeParentDeviceManager());
+		refDM->init(aChildDeviceManager);
+		return refDM;
+	}
+protected:
+	FakeParentDeviceManager() noexcept = default;
+};
+
+// A child device manager that doesn't notify its device changes (ex. a third party plugin)
+class UnnotifyingDeviceManager : public ChildDeviceManager
+{
+public:
+	explicit UnnotifyingDeviceManager(const shared_ptr<FakeDeviceManager>& refFakeDM) noexcept
+	: m_refFakeDM(refFakeDM)
+	{
+	}
+	shared_ptr<Device> getDevice(int32_t nDeviceId) const noexcept override { return m_refFakeDM->getDevice(nDeviceId); }
+	std::vector<Capability::Class> getCapabilityClasses() const noexcept override { return m_refFakeDM->getCapabilityClasses(); }
+	std::vector<Capability::Class> getDeviceCapabilityClasses() const noexcept override { return m_refFakeDM->getDeviceCapabilityClasses(); }
+	shared_ptr<Capability> getCapability(const Capability::Class& oClass) const noexcept override { return m_refFakeDM->getCapability(oClass); }
+	shared_ptr<Capability> getCapability(int32_t nCapabilityId) const noexcept override { return m_refFakeDM->getCapability(nCapabilityId); }
+	std::vector<Event::Class> getEventClasses() const noexcept override { return m_refFakeDM->getEventClasses(); }
+	std::vector<int32_t> getDevicesWithCapabilityClass(const Capability::Class& oCapabilityClass) const noexcept override
+	{
+		return m_refFakeDM->getDevicesWithCapabilityClass(oCapabilityClass);
+	}
+	std::vector<int32_t> getDevices() const noexcept override
+	{
+		// not sorted
+		auto aDeviceIds = m_refFakeDM->getDevices();
+		std::reverse(aDeviceIds.begin(), aDeviceIds.end());
+		return aDeviceIds;
+	}
+	bool isEventClassEnabled(const Event::Class& oEventClass) const noexcept override { return m_refFakeDM->isEventClassEnabled(oEventClass); }
+	void enableEventClass(const Event::Class& oEventClass) noexcept override { m_refFakeDM->enableEventClass(oEventClass); }
+	bool addAccessor(const shared_ptr<Accessor>& refAccessor) noexcept override { return m_refFakeDM->addAccessor(refAccessor); }
+	bool removeAccessor(const shared_ptr<Accessor>& refAccessor) noexcept override { return m_refFakeDM->removeAccessor(refAccessor); }
+	bool hasAccessor(const shared_ptr<Accessor>& refAccessor) noexcept override { return m_refFakeDM->hasAccessor(refAccessor); }
+	bool addEventListener(const shared_ptr<EventListener>& refEventListener) noexcept override
+	{
+		return m_refFakeDM->addEventListener(refEventListener);
+	}
+	bool addEventListener(const shared_ptr<EventListener>& refEventListener, const shared_ptr<CallIf>& refCallIf) noexcept override
+	{
+		return m_refFakeDM->addEventListener(refEventListener, refCallIf);
+	}
+	bool removeEventListener(const shared_ptr<EventListener>& refEventListener, bool bFinalize) noexcept override
+	{
+		return m_refFakeDM->removeEventListener(refEventListener, bFinalize);
+	}
+	bool removeEventListener(const shared_ptr<EventListener>& refEventListener) noexcept override
+	{
+		return m_refFakeDM->removeEventListener(refEventListener);
+	}
+private:
+	shared_ptr<FakeDeviceManager> m_refFakeDM;
+};
+
+TEST_CASE("testFakeParentDeviceManager, RoutesDevices")
+{
+	auto refFakeDM1 = std::make_shared<FakeDeviceManager>();
+	auto refFakeDM2 = std::make_shared<FakeDeviceManager>();
+	auto refFakeDM3 = std::make_shared<FakeDeviceManager>();
+	// added before the parents are created
+	const int32_t nKeyDevId1 = refFakeDM1->simulateNewDevice<FakeKeyDevice>();
+	const int32_t nKeyDevId2 = refFakeDM2->simulateNewDevice<FakeKeyDevice>();
+
+	auto refInnerDM = FakeParentDeviceManager::create({refFakeDM2, refFakeDM3});
+	auto refRootDM = FakeParentDeviceManager::create({refFakeDM1, refInnerDM});
+
+	REQUIRE(refRootDM->getDevice(nKeyDevId1) == refFakeDM1->getDevice(nKeyDevId1));
+	REQUIRE(refRootDM->getDevice(nKeyDevId2) == refFakeDM2->getDevice(nKeyDevId2));
+	REQUIRE(refInnerDM->getDevice(nKeyDevId2) == refFakeDM2->getDevice(nKeyDevId2));
+	REQUIRE_FALSE(refInnerDM->getDevice(nKeyDevId1));
+
+	// added after the parents are created
+	const int32_t nPointerDevId3 = refFakeDM3->simulateNewDevice<FakePointerDevice>();
+	auto refDevice3 = refRootDM->getDevice(nPointerDevId3);
+	REQUIRE(refDevice3);
+	REQUIRE(refDevice3 == refFakeDM3->getDevice(nPointerDevId3));
+	REQUIRE(refInnerDM->getDevice(nPointerDevId3) == refDevice3);
+	REQUIRE(refRootDM->getDevices().size() == 3);
+
+	REQUIRE(refFakeDM3->simulateRemoveDevice(nPointerDevId3));
+	REQUIRE_FALSE(refRootDM->getDevice(nPointerDevId3));
+	REQUIRE_FALSE(refInnerDM->getDevice(nPointerDevId3));
+	REQUIRE(refFakeDM1->simulateRemoveDevice(nKeyDevId1));
+	REQUIRE_FALSE(refRootDM->getDevice(nKeyDevId1));
+	REQUIRE(refRootDM->getDevice(nKeyDevId2));
+	REQUIRE(refRootDM->getDevices().size() == 1);
+}
+
+TEST_CASE("testFakeParentDeviceManager, RoutesCapabilities")
+{
+	auto refFakeDM1 = std::make_shared<FakeDeviceManager>();
+	auto refFakeDM2 = std::make_shared<FakeDeviceManager>();
+	auto refInnerDM = FakeParentDeviceManager::create({refFakeDM2});
+	auto refRootDM = FakeParentDeviceManager::create({refFakeDM1, refInnerDM});
+
+	auto refCapa1 = refFakeDM1->getCapability(DeviceMgmtCapability::getClass());
+	auto refCapa2 = refFakeDM2->getCapability(DeviceMgmtCapability::getClass());
+	REQUIRE(refCapa1);
+	REQUIRE(refCapa2);
+	REQUIRE(refRootDM->getCapability(refCapa1->getId()) == refCapa1);
+	REQUIRE(refRootDM->getCapability(refCapa2->getId()) == refCapa2);
+	REQUIRE(refInnerDM->getCapability(refCapa2->getId()) == refCapa2);
+	REQUIRE_FALSE(refInnerDM->getCapability(refCapa1->getId()));
+}
+
+TEST_CASE("testFakeParentDeviceManager, Snapshots")
+{
+	auto refFakeDM1 = std::make_shared<FakeDeviceManager>();
+	auto refFakeDM2 = std::make_shared<FakeDeviceManager>();
+	auto refRootDM = FakeParentDeviceManager::create({refFakeDM1, refFakeDM2});
+
+	auto refEventClasses = refRootDM->getEventClassesSnapshot();
+	REQUIRE(refEventClasses);
+	REQUIRE(*refEventClasses == refFakeDM1->getEventClasses());
+	REQUIRE(refRootDM->getEventClassesSnapshot() == refEventClasses);
+	REQUIRE(*refRootDM->getDeviceCapabilityClassesSnapshot() == refFakeDM1->getDeviceCapabilityClasses());
+	REQUIRE(*refRootDM->getCapabilityClassesSnapshot() == refFakeDM1->getCapabilityClasses());
+
+	auto refDevices = refRootDM->getDevicesSnapshot();
+	REQUIRE(refDevices);
+	REQUIRE(refDevices->empty());
+	REQUIRE(refRootDM->getDevicesSnapshot() == refDevices);
+
+	const int32_t nKeyDevId = refFakeDM2->simulateNewDevice<FakeKeyDevice>();
+	const int32_t nPointerDevId = refFakeDM1->simulateNewDevice<FakePointerDevice>();
+	auto refNewDevices = refRootDM->getDevicesSnapshot();
+	REQUIRE(refNewDevices != refDevices);
+	REQUIRE(refDevices->empty());
+	REQUIRE(*refNewDevices == std::vector<int32_t>{std::min(nKeyDevId, nPointerDevId), std::max(nKeyDevId, nPointerDevId)});
+	REQUIRE(refRootDM->getDevices() == *refNewDevices);
+
+	REQUIRE(refFakeDM2->simulateRemoveDevice(nKeyDevId));
+	REQUIRE(*refRootDM->getDevicesSnapshot() == std::vector<int32_t>{nPointerDevId});
+}
+
+TEST_CASE("testFakeParentDeviceManager, UnnotifyingChild")
+{
+	auto refFakeDM1 = std::make_shared<FakeDeviceManager>();
+	auto refFakeDM2 = std::make_shared<FakeDeviceManager>();
+	auto refUnnotifyingDM = std::make_shared<UnnotifyingDeviceManager>(refFakeDM2);
+	const int32_t nKeyDevId1 = refFakeDM1->simulateNewDevice<FakeKeyDevice>();
+	const int32_t nKeyDevId2 = refFakeDM2->simulateNewDevice<FakeKeyDevice>();
+
+	auto refInnerDM = FakeParentDeviceManager::create({refUnnotifyingDM});
+	auto refRootDM = FakeParentDeviceManager::create({refFakeDM1, refInnerDM});
+
+	REQUIRE(refRootDM->getDevice(nKeyDevId1) == refFakeDM1->getDevice(nKeyDevId1));
+	REQUIRE(refRootDM->getDevice(nKeyDevId2) == refFakeDM2->getDevice(nKeyDevId2));
+
+	// added after the parents are created, the parents weren't told
+	const int32_t nPointerDevId3 = refFakeDM2->simulateNewDevice<FakePointerDevice>();
+	const int32_t nPointerDevId4 = refFakeDM2->simulateNewDevice<FakePointerDevice>();
+	auto refDevice3 = refRootDM->getDevice(nPointerDevId3);
+	REQUIRE(refDevice3);
+	REQUIRE(refDevice3 == refFakeDM2->getDevice(nPointerDevId3));
+	REQUIRE(refInnerDM->getDevice(nPointerDevId3) == refDevice3);
+	std::vector<int32_t> aDeviceIds{nKeyDevId1, nKeyDevId2, nPointerDevId3, nPointerDevId4};
+	std::sort(aDeviceIds.begin(), aDeviceIds.end());
+	REQUIRE(refRootDM->getDevices() == aDeviceIds);
+
+	auto refDevices = refRootDM->getDevicesSnapshot();
+	REQUIRE(refFakeDM2->simulateRemoveDevice(nPointerDevId3));
+	REQUIRE_FALSE(refRootDM->getDevice(nPointerDevId3));
+	REQUIRE_FALSE(refInnerDM->getDevice(nPointerDevId3));
+	REQUIRE(refDevices->size() == 4);
+	REQUIRE(refRootDM->getDevicesSnapshot()->size() == 3);
+	REQUIRE(refInnerDM->getDevices().size() == 2);
+}
+
+} // namespace testing
+
+} // namespace stmi
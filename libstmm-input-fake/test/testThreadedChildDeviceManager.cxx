@@ -0,0 +1,464 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testThreadedChildDeviceManager.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "fakedevicemanager.h"
+#include "fakekeydevice.h"
+
+#include <stmm-input-base/threadedchilddevicemanager.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace testing
+{
+
+class ThreadedParentDeviceManager : public ParentDeviceManager
+{
+public:
+	static shared_ptr<ThreadedParentDeviceManager> create(const std::vector< shared_ptr<ChildDeviceManager> >& aChildDeviceManager) noexcept
+	{
+		auto refDM = shared_ptr<ThreadedParentDeviceManager>(new ThreadedParentDeviceManager());
+		refDM->init(aChildDeviceManager);
+		return refDM;
+	}
+protected:
+	ThreadedParentDeviceManager() noexcept = default;
+};
+
+// Sends a KEY_RELEASE_CANCEL for each device to the listeners removed with bFinalize
+class FinalizingFakeDeviceManager : public FakeDeviceManager
+{
+protected:
+	void finalizeListener(ListenerData& oListenerData) noexcept override
+	{
+		const int64_t nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+		for (const int32_t nDeviceId : getDevices()) {
+			shared_ptr<KeyCapability> refKeyCapability;
+			if (!getDevice(nDeviceId)->getCapability(refKeyCapability)) {
+				continue; // for
+			}
+			shared_ptr<Event> refEvent = std::make_shared<KeyEvent>(nTimeUsec, shared_ptr<Accessor>{}, refKeyCapability
+																	, KeyEvent::KEY_RELEASE_CANCEL, HK_A);
+			oListenerData.handleEventCallIf(-1, refEvent);
+		}
+	}
+};
+
+class ThreadedDMFixture
+{
+public:
+	ThreadedDMFixture()
+	: ThreadedDMFixture(ThreadedChildDeviceManager::Init{}.m_nQueueCapacity)
+	{
+	}
+protected:
+	explicit ThreadedDMFixture(int32_t nQueueCapacity)
+	{
+		ThreadedChildDeviceManager::Init oInit;
+		oInit.m_oCreate = [&]()
+		{
+			m_oInnerThreadId = std::this_thread::get_id();
+			return std::make_shared<FinalizingFakeDeviceManager>();
+		};
+		oInit.m_oWakeup = [&]()
+		{
+			{
+				std::lock_guard<std::mutex> oLock(m_oWakeupMutex);
+				m_bWokenUp = true;
+			}
+			m_oWakeupCond.notify_one();
+		};
+		oInit.m_nQueueCapacity = nQueueCapacity;
+		auto oPair = ThreadedChildDeviceManager::create(std::move(oInit));
+		m_refThreadedDM = oPair.first;
+		assert(m_refThreadedDM);
+		m_refRootDM = ThreadedParentDeviceManager::create({m_refThreadedDM});
+	}
+public:
+	// Returns false if timed out
+	bool waitWakeup()
+	{
+		std::unique_lock<std::mutex> oLock(m_oWakeupMutex);
+		const bool bWokenUp = m_oWakeupCond.wait_for(oLock, std::chrono::seconds(10), [&]() { return m_bWokenUp; });
+		m_bWokenUp = false;
+		return bWokenUp;
+	}
+protected:
+	std::thread::id m_oInnerThreadId;
+	std::mutex m_oWakeupMutex;
+	std::condition_variable m_oWakeupCond;
+	bool m_bWokenUp = false;
+	shared_ptr<ThreadedChildDeviceManager> m_refThreadedDM;
+	shared_ptr<ThreadedParentDeviceManager> m_refRootDM;
+};
+
+class SmallQueueDMFixture : public ThreadedDMFixture
+{
+public:
+	SmallQueueDMFixture()
+	: ThreadedDMFixture(16)
+	{
+	}
+};
+
+TEST_CASE_METHOD(ThreadedDMFixture, "CreatedInWorkerThread")
+{
+	REQUIRE(m_oInnerThreadId != std::this_thread::get_id());
+	REQUIRE(m_refThreadedDM->getDevices().empty());
+	REQUIRE(m_refThreadedDM->isEventClassEnabled(KeyEvent::getClass()));
+	auto refCapa = m_refThreadedDM->getCapability(DeviceMgmtCapability::getClass());
+	REQUIRE(refCapa);
+	REQUIRE(m_refThreadedDM->getCapability(refCapa->getId()) == refCapa);
+	REQUIRE(m_refRootDM->getCapability(refCapa->getId()) == refCapa);
+}
+
+TEST_CASE_METHOD(ThreadedDMFixture, "EventsDispatchedInMainThread")
+{
+	std::vector< shared_ptr<Event> > aReceivedEvents;
+	bool bAllInMainThread = true;
+	const auto oMainThreadId = std::this_thread::get_id();
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		bAllInMainThread = bAllInMainThread && (std::this_thread::get_id() == oMainThreadId);
+		aReceivedEvents.push_back(refEvent);
+	});
+	REQUIRE(m_refRootDM->addEventListener(refListener));
+	REQUIRE_FALSE(m_refThreadedDM->addEventListener(refListener));
+
+	std::atomic<int32_t> nKeyDevId(-1);
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		const int32_t nId = oFakeDM.simulateNewDevice<FakeKeyDevice>();
+		oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_PRESS, HK_A);
+		nKeyDevId = nId;
+	});
+	REQUIRE(waitWakeup());
+	// Not yet applied
+	REQUIRE(m_refRootDM->getDevices().empty());
+	REQUIRE(m_refThreadedDM->dispatchEvents() == 2);
+	REQUIRE(bAllInMainThread);
+	REQUIRE(aReceivedEvents.size() == 2);
+	REQUIRE(aReceivedEvents[0]->getEventClass() == DeviceMgmtEvent::getClass());
+	REQUIRE(aReceivedEvents[1]->getEventClass() == KeyEvent::getClass());
+
+	const int32_t nId = nKeyDevId;
+	auto refDevice = m_refRootDM->getDevice(nId);
+	REQUIRE(refDevice);
+	REQUIRE(refDevice->getId() == nId);
+	REQUIRE(m_refThreadedDM->getDevice(nId) == refDevice);
+	REQUIRE(m_refRootDM->getDevices() == std::vector<int32_t>{nId});
+	REQUIRE(m_refThreadedDM->getDevicesWithCapabilityClass(KeyCapability::getClass()) == std::vector<int32_t>{nId});
+	REQUIRE(m_refThreadedDM->getDevicesWithCapabilityClass(PointerCapability::getClass()).empty());
+
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		oFakeDM.simulateRemoveDevice(nId);
+	});
+	REQUIRE(waitWakeup());
+	m_refThreadedDM->dispatchEvents();
+	REQUIRE_FALSE(m_refRootDM->getDevice(nId));
+	REQUIRE(m_refRootDM->getDevices().empty());
+
+	REQUIRE(m_refRootDM->removeEventListener(refListener));
+	REQUIRE_FALSE(m_refThreadedDM->removeEventListener(refListener));
+}
+
+TEST_CASE_METHOD(ThreadedDMFixture, "RemoveListenerSendsQueuedEvents")
+{
+	int32_t nTotReceived = 0;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& /*refEvent*/)
+	{
+		++nTotReceived;
+	});
+	REQUIRE(m_refThreadedDM->addEventListener(refListener));
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		oFakeDM.simulateNewDevice<FakeKeyDevice>();
+	});
+	REQUIRE(waitWakeup());
+	// the queued event is sent before the listener is removed
+	REQUIRE(m_refThreadedDM->removeEventListener(refListener));
+	REQUIRE(nTotReceived == 1);
+}
+
+TEST_CASE_METHOD(ThreadedDMFixture, "DeviceChangesAppliedInOrder")
+{
+	// For each event whether its device could be retrieved when it was received
+	std::vector< std::pair<Event::Class, bool> > aReceived;
+	// Keeps the device alive after it is removed
+	shared_ptr<Device> refAddedDevice;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		if (!refAddedDevice) {
+			REQUIRE(refEvent->getEventClass() == DeviceMgmtEvent::getClass());
+			refAddedDevice = static_cast<DeviceMgmtEvent*>(refEvent.get())->getDevice();
+			REQUIRE(refAddedDevice);
+		}
+		const bool bFound = static_cast<bool>(m_refRootDM->getDevice(refAddedDevice->getId()));
+		aReceived.emplace_back(refEvent->getEventClass(), bFound);
+	});
+	REQUIRE(m_refRootDM->addEventListener(refListener));
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		const int32_t nId = oFakeDM.simulateNewDevice<FakeKeyDevice>();
+		oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_PRESS, HK_A);
+		oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_RELEASE, HK_A);
+		oFakeDM.simulateRemoveDevice(nId);
+	});
+	REQUIRE(waitWakeup());
+	REQUIRE(m_refThreadedDM->dispatchEvents() == 4);
+	REQUIRE(aReceived.size() == 4);
+	REQUIRE(aReceived[0] == std::make_pair(DeviceMgmtEvent::getClass(), true));
+	REQUIRE(aReceived[1] == std::make_pair(KeyEvent::getClass(), true));
+	REQUIRE(aReceived[2] == std::make_pair(KeyEvent::getClass(), true));
+	REQUIRE(aReceived[3] == std::make_pair(DeviceMgmtEvent::getClass(), false));
+	REQUIRE(m_refRootDM->getDevices().empty());
+}
+
+TEST_CASE_METHOD(ThreadedDMFixture, "EventsInterleavedAcrossListeners")
+{
+	std::vector< std::pair<int32_t, Event::Class> > aReceived;
+	auto refListener1 = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		aReceived.emplace_back(1, refEvent->getEventClass());
+	});
+	auto refListener2 = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		aReceived.emplace_back(2, refEvent->getEventClass());
+	});
+	REQUIRE(m_refThreadedDM->addEventListener(refListener1));
+	REQUIRE(m_refThreadedDM->addEventListener(refListener2));
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		const int32_t nId = oFakeDM.simulateNewDevice<FakeKeyDevice>();
+		oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_PRESS, HK_A);
+	});
+	REQUIRE(waitWakeup());
+	REQUIRE(m_refThreadedDM->dispatchEvents() == 4);
+	REQUIRE(aReceived.size() == 4);
+	REQUIRE(aReceived[0] == std::make_pair(1, DeviceMgmtEvent::getClass()));
+	REQUIRE(aReceived[1] == std::make_pair(2, DeviceMgmtEvent::getClass()));
+	REQUIRE(aReceived[2] == std::make_pair(1, KeyEvent::getClass()));
+	REQUIRE(aReceived[3] == std::make_pair(2, KeyEvent::getClass()));
+}
+
+TEST_CASE_METHOD(ThreadedDMFixture, "NoEventDropped")
+{
+	constexpr int32_t nTotPresses = 5000;
+	int32_t nTotReleases = 0;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		if (refEvent->getEventClass() == KeyEvent::getClass()) {
+			auto p0KeyEvent = static_cast<KeyEvent*>(refEvent.get());
+			if (p0KeyEvent->getType() == KeyEvent::KEY_RELEASE) {
+				++nTotReleases;
+			}
+		}
+	});
+	REQUIRE(m_refThreadedDM->addEventListener(refListener));
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		const int32_t nId = oFakeDM.simulateNewDevice<FakeKeyDevice>();
+		for (int32_t nCount = 0; nCount < nTotPresses; ++nCount) {
+			oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_PRESS, HK_A);
+			oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_RELEASE, HK_A);
+		}
+	});
+	REQUIRE(waitWakeup());
+	REQUIRE(m_refThreadedDM->dispatchEvents() == 1 + 2 * nTotPresses);
+	REQUIRE(nTotReleases == nTotPresses);
+}
+
+TEST_CASE_METHOD(SmallQueueDMFixture, "OverflowKeepsOrder")
+{
+	constexpr int32_t nTotDevices = 20;
+	constexpr int32_t nTotPresses = 50;
+	std::vector<int32_t> aAddedDeviceIds;
+	int32_t nTotPressesInOrder = 0;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		if (refEvent->getEventClass() == DeviceMgmtEvent::getClass()) {
+			auto p0MgmtEvent = static_cast<DeviceMgmtEvent*>(refEvent.get());
+			const int32_t nId = p0MgmtEvent->getDevice()->getId();
+			// the device mirror was updated in the same position
+			REQUIRE(m_refRootDM->getDevice(nId));
+			aAddedDeviceIds.push_back(nId);
+			return; //----------------------------------------------------------
+		}
+		auto p0KeyEvent = static_cast<KeyEvent*>(refEvent.get());
+		const int32_t nId = p0KeyEvent->getKeyCapability()->getDevice()->getId();
+		// the presses of a device follow its added event
+		if ((!aAddedDeviceIds.empty()) && (aAddedDeviceIds.back() == nId)) {
+			++nTotPressesInOrder;
+		}
+	});
+	REQUIRE(m_refThreadedDM->addEventListener(refListener));
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		for (int32_t nDevice = 0; nDevice < nTotDevices; ++nDevice) {
+			const int32_t nId = oFakeDM.simulateNewDevice<FakeKeyDevice>();
+			for (int32_t nCount = 0; nCount < nTotPresses; ++nCount) {
+				oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_PRESS, HK_A);
+			}
+		}
+	});
+	REQUIRE(waitWakeup());
+	REQUIRE(m_refThreadedDM->dispatchEvents() == nTotDevices * (1 + nTotPresses));
+	REQUIRE(m_refThreadedDM->getTotOverflowItems() > 0);
+	REQUIRE(aAddedDeviceIds.size() == static_cast<size_t>(nTotDevices));
+	REQUIRE(nTotPressesInOrder == nTotDevices * nTotPresses);
+	REQUIRE(m_refRootDM->getDevices().size() == static_cast<size_t>(nTotDevices));
+
+	// the ring is used again once the overflow was popped
+	const int64_t nTotOverflowItems = m_refThreadedDM->getTotOverflowItems();
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		oFakeDM.simulateNewDevice<FakeKeyDevice>();
+	});
+	REQUIRE(waitWakeup());
+	REQUIRE(m_refThreadedDM->dispatchEvents() == 1);
+	REQUIRE(m_refThreadedDM->getTotOverflowItems() == nTotOverflowItems);
+}
+
+TEST_CASE_METHOD(ThreadedDMFixture, "RemoveListenerWithFinalize")
+{
+	std::vector<KeyEvent::KEY_INPUT_TYPE> aReceivedTypes;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		if (refEvent->getEventClass() == KeyEvent::getClass()) {
+			aReceivedTypes.push_back(static_cast<KeyEvent*>(refEvent.get())->getType());
+		}
+	});
+	REQUIRE(m_refThreadedDM->addEventListener(refListener));
+	m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+	{
+		auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+		const int32_t nId = oFakeDM.simulateNewDevice<FakeKeyDevice>();
+		oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_PRESS, HK_A);
+	});
+	REQUIRE(waitWakeup());
+	REQUIRE(m_refThreadedDM->removeEventListener(refListener, true));
+	REQUIRE(aReceivedTypes == std::vector<KeyEvent::KEY_INPUT_TYPE>{KeyEvent::KEY_PRESS});
+	// the finalize event is sent by the worker thread through the queue
+	while (aReceivedTypes.size() < 2) {
+		REQUIRE(waitWakeup());
+		m_refThreadedDM->dispatchEvents();
+	}
+	REQUIRE(aReceivedTypes == (std::vector<KeyEvent::KEY_INPUT_TYPE>{KeyEvent::KEY_PRESS, KeyEvent::KEY_RELEASE_CANCEL}));
+	REQUIRE_FALSE(m_refThreadedDM->removeEventListener(refListener));
+}
+
+TEST_CASE_METHOD(ThreadedDMFixture, "QueriesDontWaitForWorker")
+{
+	std::mutex oBusyMutex;
+	std::unique_lock<std::mutex> oBusyLock(oBusyMutex);
+	// keeps the worker thread busy until released
+	m_refThreadedDM->post([&](ChildDeviceManager& /*oInner*/)
+	{
+		std::lock_guard<std::mutex> oLock(oBusyMutex);
+	});
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& /*refEvent*/)
+	{
+	});
+	// Would dead lock if any waited for the worker thread
+	REQUIRE(m_refThreadedDM->isEventClassEnabled(KeyEvent::getClass()));
+	REQUIRE_FALSE(m_refThreadedDM->hasAccessor(shared_ptr<Accessor>{}));
+	REQUIRE(m_refThreadedDM->getDevicesWithCapabilityClass(KeyCapability::getClass()).empty());
+	REQUIRE(m_refThreadedDM->addEventListener(refListener));
+	REQUIRE_FALSE(m_refThreadedDM->addEventListener(refListener));
+	REQUIRE(m_refThreadedDM->removeEventListener(refListener));
+	oBusyLock.unlock();
+}
+
+// Meant to be run also with BUILD_WITH_SANITIZE_THREAD: the listener only
+// calls the functions that are allowed in the main thread
+TEST_CASE_METHOD(ThreadedDMFixture, "ConcurrentWorkerAndListener")
+{
+	constexpr int32_t nTotRounds = 200;
+	int32_t nTotEvents = 0;
+	int32_t nTotKeyEvents = 0;
+	int32_t nTotFoundDevices = 0;
+	auto refListener = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		++nTotEvents;
+		if (refEvent->getEventClass() != KeyEvent::getClass()) {
+			return; //----------------------------------------------------------
+		}
+		auto p0KeyEvent = static_cast<KeyEvent*>(refEvent.get());
+		++nTotKeyEvents;
+		auto refCapa = p0KeyEvent->getKeyCapability();
+		REQUIRE(refCapa);
+		auto refDevice = refCapa->getDevice();
+		REQUIRE(refDevice);
+		REQUIRE(refDevice->getCapability(KeyCapability::getClass()) == refCapa);
+		REQUIRE_FALSE(refDevice->getName().empty());
+		if (m_refRootDM->getDevice(refDevice->getId()) == refDevice) {
+			++nTotFoundDevices;
+		}
+		REQUIRE(p0KeyEvent->getKey() == HK_A);
+	});
+	REQUIRE(m_refRootDM->addEventListener(refListener));
+	for (int32_t nRound = 0; nRound < nTotRounds; ++nRound) {
+		m_refThreadedDM->post([&](ChildDeviceManager& oInner)
+		{
+			auto& oFakeDM = static_cast<FakeDeviceManager&>(oInner);
+			const int32_t nId = oFakeDM.simulateNewDevice<FakeKeyDevice>();
+			oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_PRESS, HK_A);
+			oFakeDM.simulateKeyEvent(nId, KeyEvent::KEY_RELEASE, HK_A);
+			oFakeDM.simulateRemoveDevice(nId);
+		});
+		// dispatch while the worker thread is adding and removing devices
+		m_refThreadedDM->dispatchEvents();
+	}
+	// each round sends added, press, release and removed
+	while (nTotEvents < 4 * nTotRounds) {
+		REQUIRE(waitWakeup());
+		m_refThreadedDM->dispatchEvents();
+	}
+	REQUIRE(nTotEvents == 4 * nTotRounds);
+	REQUIRE(nTotKeyEvents == 2 * nTotRounds);
+	REQUIRE(nTotFoundDevices == 2 * nTotRounds);
+	REQUIRE(m_refRootDM->getDevices().empty());
+}
+
+} // namespace testing
+
+} // namespace stmi
@@ -27,6 +27,8 @@
 
 #include <stmm-input-base/parentdevicemanager.h>
 
+#include "jsdevicefiles.h"
+
 #include <gtkmm.h>
 
 #include <memory>
@@ -50,13 +52,15 @@ using std::weak_ptr;
  *
  * Currently the following devices are supported:
  *    - master keyboard, pointer and touch.
- *    - joysticks mapped to files "/dev/input/jsN".
+ *    - joysticks mapped to files "/dev/input/jsN" or, if JsDeviceFiles::setEvdev()
+ *      is used, joysticks and gamepads mapped to files "/dev/input/eventN".
  *    - any device loaded by the plugin device manager.
  *
  * The supported events types are:
  *    - stmi::KeyEvent
  *    - stmi::PointerEvent and stmi::PointerScrollEvent
- *    - stmi::TouchEvent
+ *    - stmi::TouchEvent and stmi::TouchFrameEvent (the latter repeats the contacts of the
+ *      former grouped by frame, listeners can select one of them with a stmi::CallIf)
  *    - stmi::JoystickHatEvent, stmi::JoystickButtonEvent and JoystickAxisEvent
  *    - stmi::DeviceMgmtEvent
  *
@@ -92,6 +96,18 @@ public:
 	 *
 	 * Note: the plugins device manager might have been excluded for the build
 	 * (libstmm-input-dl is not present) in which case these fields are unused.
+	 *
+	 * m_oJsDeviceFiles configures the joystick devices (interface, axis filters, etc.).
+	 * If it contains no files the default numbered files are used.
+	 *
+	 * If m_bCoalescePointerMotion is `true` the pointer motions received during a
+	 * main loop iteration are sent as one stmi::PointerEvent (POINTER_MOVE or POINTER_HOVER)
+	 * with the latest position, once all pending gdk events have been processed
+	 * (and before the next frame is drawn). The intermediate positions are
+	 * available through PointerEvent::getMotionHistory(), which holds at most
+	 * the latest 64 samples (older ones are dropped).
+	 * Button, scroll and touch events first send the pending motion so that
+	 * the order of the events is preserved.
 	 */
 	struct Init
 	{
@@ -107,6 +123,8 @@ public:
 		std::vector<std::string> m_aGroups; /**< The group names the plug-ins must belong to in order to be loaded. */
 		std::string m_sAppName; /**< The application name. Can be empty. */
 		bool m_bVerbose = false; /**< If true more output can be expected. Default: false. */
+		JsDeviceFiles m_oJsDeviceFiles; /**< The joystick device files and options. Default: the default files. */
+		bool m_bCoalescePointerMotion = false; /**< Whether pointer motions are coalesced. Default: false. */
 	};
 	/** Creates a device manager.
 	 * Before this call Gtk has to be already initialized (ex. with Gtk::Application::create()).
@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   gtkeventbatcher.h
+ */
+
+#ifndef STMI_GTK_EVENT_BATCHER_H
+#define STMI_GTK_EVENT_BATCHER_H
+
+#include <stmm-input-base/eventbatcher.h>
+
+#include <gtkmm.h>
+
+#include <memory>
+
+
+namespace stmi
+{
+
+using std::shared_ptr;
+
+/** Event batcher flushed by the Gtk main loop.
+ * If constructed with a frame clock, the accumulated events are delivered
+ * in the update phase of the clock's next frame, otherwise once per main
+ * loop iteration from an idle callback with priority higher than redrawing.
+ *
+ * Example: to receive the events of GtkDeviceManager once per frame
+ *
+ *     m_refBatcher = std::make_shared<stmi::GtkEventBatcher>(refBatchListener, refWindow->get_frame_clock());
+ *     refGtkDeviceManager->addEventListener(m_refBatcher->getEventListener());
+ *
+ * Must be used from the thread of the Gtk main loop.
+ */
+class GtkEventBatcher : public EventBatcher
+{
+public:
+	/** Constructor flushing once per main loop iteration.
+	 * @param refBatchListener The batch listener. Cannot be null.
+	 */
+	explicit GtkEventBatcher(const shared_ptr<BatchEventListener>& refBatchListener) noexcept;
+	/** Constructor flushing once per frame.
+	 * @param refBatchListener The batch listener. Cannot be null.
+	 * @param refFrameClock The frame clock. Cannot be null.
+	 */
+	GtkEventBatcher(const shared_ptr<BatchEventListener>& refBatchListener
+					, const Glib::RefPtr<Gdk::FrameClock>& refFrameClock) noexcept;
+	~GtkEventBatcher() noexcept;
+protected:
+	void onFirstPendingEvent() noexcept override;
+private:
+	bool onIdle() noexcept;
+	void onFrameClockUpdate() noexcept;
+private:
+	Glib::RefPtr<Gdk::FrameClock> m_refFrameClock;
+	sigc::connection m_oIdleConn;
+	sigc::connection m_oUpdateConn;
+private:
+	GtkEventBatcher(const GtkEventBatcher& oSource) = delete;
+	GtkEventBatcher& operator=(const GtkEventBatcher& oSource) = delete;
+};
+
+} // namespace stmi
+
+#endif /* STMI_GTK_EVENT_BATCHER_H */
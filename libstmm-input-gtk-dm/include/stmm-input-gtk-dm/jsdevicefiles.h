@@ -18,8 +18,13 @@
  * File:   jsdevicefiles.h
  */
 
+#include <stmm-input-ev/joystickcapability.h>
+
 #include <vector>
 #include <string>
+#include <utility>
+
+#include <stdint.h>
 
 #ifndef STMI_JS_DEVICE_FILES_H
 #define STMI_JS_DEVICE_FILES_H
@@ -28,10 +33,31 @@ namespace stmi
 {
 
 /** Joystick device files initialization class for GtkDeviceManager.
+ * By default the files are expected to implement the legacy
+ * &lt;linux/joystick.h&gt; interface ("/dev/input/jsN"). If setEvdev() is
+ * called with `true` they are expected to implement the evdev
+ * &lt;linux/input.h&gt; interface instead ("/dev/input/eventN").
  */
 class JsDeviceFiles
 {
 public:
+	/** Filter for the values of a joystick axis.
+	 * Noisy sticks can generate thousands of useless JoystickAxisEvent per second.
+	 * Values within m_nDeadZone from the center are sent as 0.
+	 * A change is only sent if it differs at least m_nMinDelta from the last sent
+	 * value (the return to 0 is always sent).
+	 * If m_nMaxRate is positive, at most m_nMaxRate events per second are sent
+	 * for the axis: the changes within the interval are coalesced and only the
+	 * latest value is sent at its end.
+	 *
+	 * Axis values are in the range [-32767, 32767].
+	 */
+	struct AxisFilter
+	{
+		int32_t m_nDeadZone = 0; /**< Values within this distance from 0 are sent as 0. Default: 0. */
+		int32_t m_nMinDelta = 0; /**< The minimum change of value that is sent. Default: 0 (all changes). */
+		int32_t m_nMaxRate = 0; /**< The maximum events per second, 0 means unlimited. Default: 0. */
+	};
 	/** Adds a single device file.
 	 * Example: "/dev/input/js7" or "/dev/special/joystick"
 	 * @param sPathName Absolute path filename.
@@ -58,12 +84,97 @@ public:
 		}
 		m_aPathBaseName.push_back(sPathBaseName);
 	}
+	/** Sets whether the device files implement the evdev interface.
+	 * The evdev interface groups the changes of a device into frames
+	 * terminated by SYN_REPORT, which are delivered as a whole, and provides
+	 * the kernel time stamps of the events.
+	 *
+	 * If no file is added the default numbered files are "/dev/input/event"
+	 * (only devices that look like joysticks or gamepads are used) instead of "/dev/input/js".
+	 * @param bEvdev Whether evdev should be used. The default is `false`.
+	 */
+	void setEvdev(bool bEvdev) noexcept
+	{
+		m_bEvdev = bEvdev;
+	}
+	/** Sets whether the device files are read by a dedicated thread.
+	 * By default the device files are polled by the Gtk main loop, which means
+	 * that the latency of the joystick events depends on what else (rendering,
+	 * layout, ...) the main loop is doing. If set to `true` a thread waits for
+	 * the devices to become readable and reads the events as soon as they arrive,
+	 * the main loop is then woken up to send them to the listeners.
+	 * Listeners are still called from the Gtk main loop.
+	 *
+	 * Currently only used with the &lt;linux/joystick.h&gt; interface (ignored if isEvdev()).
+	 * @param bInputThread Whether the input thread should be used. The default is `false`.
+	 */
+	void setInputThread(bool bInputThread) noexcept
+	{
+		m_bInputThread = bInputThread;
+	}
+	/** Sets whether axis changes read together are coalesced.
+	 * If `true` and the events read at once from a device contain more than one
+	 * change of the same axis only the latest is sent to the listeners as a
+	 * JoystickAxisEvent. Hats are not affected.
+	 *
+	 * Currently only used with the &lt;linux/joystick.h&gt; interface (evdev frames
+	 * already only send the latest value of an axis).
+	 * @param bCoalesceAxes Whether axis changes should be coalesced. The default is `false`.
+	 */
+	void setCoalesceAxes(bool bCoalesceAxes) noexcept
+	{
+		m_bCoalesceAxes = bCoalesceAxes;
+	}
+	/** Sets the filter for all the axes of all the devices.
+	 * Axes with a filter set with setAxisFilter(JoystickCapability::AXIS, const AxisFilter&)
+	 * use that instead. Hats are not filtered.
+	 * @param oAxisFilter The filter.
+	 */
+	void setAxisFilter(const AxisFilter& oAxisFilter) noexcept
+	{
+		m_oAxisFilter = oAxisFilter;
+	}
+	/** Sets the filter for an axis of all the devices.
+	 * @param eAxis The axis.
+	 * @param oAxisFilter The filter.
+	 */
+	void setAxisFilter(JoystickCapability::AXIS eAxis, const AxisFilter& oAxisFilter) noexcept
+	{
+		for (auto& oPair : m_aAxisFilters) {
+			if (oPair.first == eAxis) {
+				oPair.second = oAxisFilter;
+				return; //------------------------------------------------------
+			}
+		}
+		m_aAxisFilters.emplace_back(eAxis, oAxisFilter);
+	}
+	/** The filter of an axis.
+	 * @param eAxis The axis.
+	 * @return The filter set for the axis or the filter for all axes.
+	 */
+	const AxisFilter& getAxisFilter(JoystickCapability::AXIS eAxis) const noexcept
+	{
+		for (auto& oPair : m_aAxisFilters) {
+			if (oPair.first == eAxis) {
+				return oPair.second; //-----------------------------------------
+			}
+		}
+		return m_oAxisFilter;
+	}
 	inline const std::vector<std::string>& getFiles() const noexcept { return m_aPathName; }
 	inline const std::vector<std::string>& getBaseNrFiles() const noexcept { return m_aPathBaseName; }
+	inline bool isEvdev() const noexcept { return m_bEvdev; }
+	inline bool isInputThread() const noexcept { return m_bInputThread; }
+	inline bool isCoalesceAxes() const noexcept { return m_bCoalesceAxes; }
 private:
 	//friend class stmi::Private::Js::GtkBackend;
 	std::vector<std::string> m_aPathName;
 	std::vector<std::string> m_aPathBaseName;
+	bool m_bEvdev = false;
+	bool m_bInputThread = false;
+	bool m_bCoalesceAxes = false;
+	AxisFilter m_oAxisFilter;
+	std::vector< std::pair<JoystickCapability::AXIS, AxisFilter> > m_aAxisFilters;
 };
 
 } // namespace stmi
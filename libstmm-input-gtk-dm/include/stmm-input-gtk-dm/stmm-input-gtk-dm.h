@@ -24,6 +24,7 @@
 /* This file includes all headers of the stmm-input-gtk-dm library. */
 
 #include "gtkdevicemanager.h"
+#include "gtkeventbatcher.h"
 #include "jsdevicefiles.h"
 
 #include "stmm-input-gtk-dm-config.h"
@@ -46,7 +46,8 @@ std::pair<shared_ptr<GtkDeviceManager>, std::string> GtkDeviceManager::create(co
 	{
 		auto oPairMDM = MasGtkDeviceManager::create(oInit.m_bEnableEventClasses, oInit.m_aEnDisableEventClasses, oInit.m_eKeyRepeatMode
 												, (oInit.m_refGdkConverter ? oInit.m_refGdkConverter : GdkKeyConverterEvDev::getConverter())
-												, (oInit.m_refDisplay ? oInit.m_refDisplay->get_device_manager() : Glib::RefPtr<Gdk::DeviceManager>{}));
+												, (oInit.m_refDisplay ? oInit.m_refDisplay->get_device_manager() : Glib::RefPtr<Gdk::DeviceManager>{})
+												, oInit.m_bCoalescePointerMotion);
 		auto& sError = oPairMDM.second;
 		if (! sError.empty()) {
 			if (oInit.m_bVerbose) {
@@ -87,9 +88,8 @@ std::pair<shared_ptr<GtkDeviceManager>, std::string> GtkDeviceManager::create(co
 	}
 	#endif //NOT STMI_OMIT_PLUGINS
 	{
-		JsDeviceFiles oDeviceFiles;
-		oDeviceFiles.addBaseNrFiles("/dev/input/js");
-		auto oPairJDM = JsGtkDeviceManager::create(oInit.m_bEnableEventClasses, oInit.m_aEnDisableEventClasses, oDeviceFiles);
+		// If no files are given the backend uses the default ones
+		auto oPairJDM = JsGtkDeviceManager::create(oInit.m_bEnableEventClasses, oInit.m_aEnDisableEventClasses, oInit.m_oJsDeviceFiles);
 		auto& sError = oPairJDM.second;
 		if (sError.empty()) {
 			auto& refJDM = oPairJDM.first;
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   gtkeventbatcher.cc
+ */
+
+#include "gtkeventbatcher.h"
+
+#include <cassert>
+
+namespace stmi
+{
+
+GtkEventBatcher::GtkEventBatcher(const shared_ptr<BatchEventListener>& refBatchListener) noexcept
+: EventBatcher(refBatchListener)
+{
+}
+GtkEventBatcher::GtkEventBatcher(const shared_ptr<BatchEventListener>& refBatchListener
+								, const Glib::RefPtr<Gdk::FrameClock>& refFrameClock) noexcept
+: EventBatcher(refBatchListener)
+, m_refFrameClock(refFrameClock)
+{
+	assert(m_refFrameClock);
+	m_oUpdateConn = m_refFrameClock->signal_update().connect(sigc::mem_fun(*this, &GtkEventBatcher::onFrameClockUpdate));
+}
+GtkEventBatcher::~GtkEventBatcher() noexcept
+{
+	m_oIdleConn.disconnect();
+	m_oUpdateConn.disconnect();
+}
+void GtkEventBatcher::onFirstPendingEvent() noexcept
+{
+	if (m_refFrameClock) {
+		m_refFrameClock->request_phase(Gdk::FRAME_CLOCK_PHASE_UPDATE);
+	} else if (!m_oIdleConn.connected()) {
+		// Redrawing has priority Glib::PRIORITY_HIGH_IDLE + 20
+		m_oIdleConn = Glib::signal_idle().connect(sigc::mem_fun(*this, &GtkEventBatcher::onIdle), Glib::PRIORITY_HIGH_IDLE);
+	}
+}
+bool GtkEventBatcher::onIdle() noexcept
+{
+	flush();
+	// Events received while flushing didn't reschedule since the idle source
+	// was still connected: keep it for the next main loop iteration
+	return (getTotPendingEvents() > 0);
+}
+void GtkEventBatcher::onFrameClockUpdate() noexcept
+{
+	flush();
+}
+
+} // namespace stmi
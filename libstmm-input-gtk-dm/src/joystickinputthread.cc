@@ -0,0 +1,260 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   joystickinputthread.cc
+ */
+
+#include "joystickinputthread.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <system_error>
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+namespace stmi
+{
+
+namespace Private
+{
+namespace Js
+{
+
+constexpr int32_t JoystickInputThread::s_nDefaultCapacity;
+
+JoystickInputThread::JoystickInputThread(int32_t nMinCapacity) noexcept
+: m_nEpollFD(-1)
+, m_nWakeupFD(-1)
+, m_nStopFD(-1)
+, m_nSpaceFD(-1)
+, m_bStop(false)
+, m_bWaitingForSpace(false)
+, m_oRing(nMinCapacity)
+{
+}
+JoystickInputThread::~JoystickInputThread() noexcept
+{
+	if (m_oThread.joinable()) {
+		m_bStop = true;
+		const uint64_t nOne = 1;
+		const auto nRet = ::write(m_nStopFD, &nOne, sizeof nOne);
+		(void)nRet;
+		m_oThread.join();
+	}
+	for (int32_t nFD : {m_nSpaceFD, m_nStopFD, m_nWakeupFD, m_nEpollFD}) {
+		if (nFD >= 0) {
+			::close(nFD);
+		}
+	}
+}
+std::string JoystickInputThread::start() noexcept
+{
+	assert(!m_oThread.joinable());
+	m_nEpollFD = ::epoll_create1(EPOLL_CLOEXEC);
+	if (m_nEpollFD < 0) {
+		return "JsGtkDeviceManager: couldn't create epoll instance"; //---------
+	}
+	m_nWakeupFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	m_nStopFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	m_nSpaceFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((m_nWakeupFD < 0) || (m_nStopFD < 0) || (m_nSpaceFD < 0)) {
+		return "JsGtkDeviceManager: couldn't create eventfd"; //----------------
+	}
+	struct ::epoll_event oEpollEvent;
+	oEpollEvent.events = EPOLLIN;
+	oEpollEvent.data.fd = m_nStopFD;
+	if (::epoll_ctl(m_nEpollFD, EPOLL_CTL_ADD, m_nStopFD, &oEpollEvent) < 0) {
+		return "JsGtkDeviceManager: couldn't add eventfd to epoll"; //----------
+	}
+	try {
+		m_oThread = std::thread(&JoystickInputThread::run, this);
+	} catch (const std::system_error& oErr) {
+		return std::string("JsGtkDeviceManager: couldn't start input thread: ") + oErr.what(); //---
+	}
+	return "";
+}
+bool JoystickInputThread::addFD(int32_t nFD, int32_t nDeviceId) noexcept
+{
+	std::lock_guard<std::mutex> oLock(m_oFDsMutex);
+	struct ::epoll_event oEpollEvent;
+	oEpollEvent.events = EPOLLIN;
+	oEpollEvent.data.fd = nFD;
+	if (::epoll_ctl(m_nEpollFD, EPOLL_CTL_ADD, nFD, &oEpollEvent) < 0) {
+		return false; //--------------------------------------------------------
+	}
+	m_oFDs[nFD] = nDeviceId;
+	return true;
+}
+void JoystickInputThread::removeFD(int32_t nFD) noexcept
+{
+	std::lock_guard<std::mutex> oLock(m_oFDsMutex);
+	auto itFind = m_oFDs.find(nFD);
+	if (itFind == m_oFDs.end()) {
+		// already removed by the thread because of an error
+		return; //--------------------------------------------------------------
+	}
+	::epoll_ctl(m_nEpollFD, EPOLL_CTL_DEL, nFD, nullptr);
+	m_oFDs.erase(itFind);
+}
+void JoystickInputThread::clearWakeup() noexcept
+{
+	uint64_t nValue;
+	const auto nRet = ::read(m_nWakeupFD, &nValue, sizeof nValue);
+	(void)nRet;
+}
+void JoystickInputThread::endPop() noexcept
+{
+	// Pairs with the fence in waitForSpace(): either the thread sees
+	// the popped slots or this sees the flag
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!m_bWaitingForSpace.load(std::memory_order_relaxed)) {
+		return; //--------------------------------------------------------------
+	}
+	if (!m_bWaitingForSpace.exchange(false)) {
+		return; //--------------------------------------------------------------
+	}
+	const uint64_t nOne = 1;
+	const auto nRet = ::write(m_nSpaceFD, &nOne, sizeof nOne);
+	(void)nRet;
+}
+void JoystickInputThread::wakeup() noexcept
+{
+	const uint64_t nOne = 1;
+	const auto nRet = ::write(m_nWakeupFD, &nOne, sizeof nOne);
+	(void)nRet;
+}
+bool JoystickInputThread::waitForSpace() noexcept
+{
+	m_bWaitingForSpace.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_oRing.getTotFree() > 0) {
+		// popped meanwhile
+		m_bWaitingForSpace.store(false, std::memory_order_relaxed);
+		return true; //---------------------------------------------------------
+	}
+	// The joystick file descriptors are not polled: they stay readable
+	struct ::pollfd aPollFDs[2];
+	aPollFDs[0].fd = m_nStopFD;
+	aPollFDs[0].events = POLLIN;
+	aPollFDs[1].fd = m_nSpaceFD;
+	aPollFDs[1].events = POLLIN;
+	while (!m_bStop) {
+		const int32_t nRet = ::poll(aPollFDs, 2, -1);
+		if (nRet < 0) {
+			if (errno == EINTR) {
+				continue; // while
+			}
+			return false; //----------------------------------------------------
+		}
+		if ((aPollFDs[0].revents & POLLIN) != 0) {
+			return false; //----------------------------------------------------
+		}
+		if ((aPollFDs[1].revents & POLLIN) != 0) {
+			uint64_t nValue;
+			const auto nReadRet = ::read(m_nSpaceFD, &nValue, sizeof nValue);
+			(void)nReadRet;
+			return true; //-----------------------------------------------------
+		}
+	}
+	return false;
+}
+void JoystickInputThread::run() noexcept
+{
+	constexpr int32_t nMaxEpollEvents = 16;
+	struct ::epoll_event aEpollEvents[nMaxEpollEvents];
+	bool bFull = false;
+	while (!m_bStop) {
+		if (bFull) {
+			// The events are left in the kernel buffers until the consumer pops some
+			if (!waitForSpace()) {
+				break; // while
+			}
+			bFull = false;
+		}
+		const int32_t nTotReady = ::epoll_wait(m_nEpollFD, aEpollEvents, nMaxEpollEvents, -1);
+		if (nTotReady < 0) {
+			if (errno == EINTR) {
+				continue; // while
+			}
+			break; // while
+		}
+		int32_t nTotPushed = 0;
+		{
+			std::lock_guard<std::mutex> oLock(m_oFDsMutex);
+			for (int32_t nIdx = 0; nIdx < nTotReady; ++nIdx) {
+				const struct ::epoll_event& oEpollEvent = aEpollEvents[nIdx];
+				const int32_t nFD = oEpollEvent.data.fd;
+				if (nFD == m_nStopFD) {
+					return; //--------------------------------------------------
+				}
+				auto itFind = m_oFDs.find(nFD);
+				if (itFind == m_oFDs.end()) {
+					// removed by the main thread after epoll_wait returned
+					continue; // for
+				}
+				const int32_t nDeviceId = itFind->second;
+				const bool bReadable = ((oEpollEvent.events & EPOLLIN) != 0);
+				if (bReadable && !readFD(nFD, nDeviceId, nTotPushed, bFull)) {
+					// device gone: stop polling it, the main thread removes it
+					// when the inotify source tells the file was deleted
+					::epoll_ctl(m_nEpollFD, EPOLL_CTL_DEL, nFD, nullptr);
+					m_oFDs.erase(itFind);
+				} else if ((!bReadable) && ((oEpollEvent.events & (EPOLLERR | EPOLLHUP)) != 0)) {
+					::epoll_ctl(m_nEpollFD, EPOLL_CTL_DEL, nFD, nullptr);
+					m_oFDs.erase(itFind);
+				}
+			}
+		}
+		if (nTotPushed > 0) {
+			wakeup();
+		}
+	}
+}
+bool JoystickInputThread::readFD(int32_t nFD, int32_t nDeviceId, int32_t& nTotPushed, bool& bFull) noexcept
+{
+	constexpr int32_t nMaxReadEvents = 32;
+	const int32_t nMaxEvents = std::min(nMaxReadEvents, m_oRing.getTotFree());
+	if (nMaxEvents == 0) {
+		bFull = true;
+		return true; //---------------------------------------------------------
+	}
+	struct ::js_event aJoyEvents[nMaxReadEvents];
+	const auto nReadBytes = ::read(nFD, aJoyEvents, sizeof(struct ::js_event) * nMaxEvents);
+	if (nReadBytes < 0) {
+		return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)); //---
+	}
+	const int32_t nTotEvents = static_cast<int32_t>(nReadBytes / sizeof(struct ::js_event));
+	for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+		#ifndef NDEBUG
+		const bool bPushed =
+		#endif
+		m_oRing.push(JoystickThreadEvent{nDeviceId, aJoyEvents[nIdx]});
+		assert(bPushed);
+	}
+	nTotPushed += nTotEvents;
+	return true;
+}
+
+} // namespace Js
+} // namespace Private
+
+} // namespace stmi
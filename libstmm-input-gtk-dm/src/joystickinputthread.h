@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   joystickinputthread.h
+ */
+
+#ifndef STMI_JOYSTICK_INPUT_THREAD_H
+#define STMI_JOYSTICK_INPUT_THREAD_H
+
+#include <stmm-input-base/spscring.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+
+#include <linux/joystick.h>
+
+namespace stmi
+{
+
+namespace Private
+{
+namespace Js
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/* Reads the joystick file descriptors in a dedicated thread.
+ * The thread waits with epoll for any of the added file descriptors
+ * to become readable, reads the js_events and pushes them into a
+ * single producer single consumer lock-free ring buffer (SpscRing).
+ * The main thread is woken up through an eventfd (see getWakeupFD()),
+ * which can be polled by a Glib::Source, and pops the events with popEvent().
+ * When the ring is full the events are left in the kernel buffers and the
+ * thread sleeps until the consumer tells it, calling endPop(), that
+ * there is space again.
+ * Except for popEvent(), endPop() and clearWakeup(), which must be called by
+ * the consumer, all functions must be called by the thread that created
+ * the instance.
+ * The file descriptors are owned by the caller, who has to call removeFD()
+ * before closing them.
+ *
+ * The js_events are queued undecoded. Decoding one is just the lookup of
+ * its number in the button or axis map of the device, while everything
+ * else JoystickDevice does with it (dead zone filter, hat and button state,
+ * axis coalescing and rate limiting, conversion to the event time base)
+ * uses state owned and modified by the main thread, which would have to be
+ * locked or duplicated. What is moved off the main thread is the blocking
+ * part: waiting for and reading the file descriptors.
+ */
+class JoystickInputThread
+{
+public:
+	struct JoystickThreadEvent
+	{
+		int32_t m_nDeviceId;
+		struct ::js_event m_oEvent;
+	};
+
+	static constexpr int32_t s_nDefaultCapacity = 4096;
+	explicit JoystickInputThread(int32_t nMinCapacity = s_nDefaultCapacity) noexcept;
+	// Stops and joins the thread
+	~JoystickInputThread() noexcept;
+
+	// Returns the error string or empty if the thread was started
+	std::string start() noexcept;
+
+	// Returns false if the fd couldn't be added
+	bool addFD(int32_t nFD, int32_t nDeviceId) noexcept;
+	// When this function returns the thread doesn't read the file descriptor anymore
+	void removeFD(int32_t nFD) noexcept;
+
+	// The eventfd that becomes readable when events were pushed
+	inline int32_t getWakeupFD() const noexcept { return m_nWakeupFD; }
+	// Resets the wakeup eventfd, must be called before popping the events
+	void clearWakeup() noexcept;
+
+	inline bool popEvent(JoystickThreadEvent& oEvent) noexcept
+	{
+		return m_oRing.pop(oEvent);
+	}
+	// Must be called after popping events, wakes up the thread if it waits for space
+	void endPop() noexcept;
+private:
+	void run() noexcept;
+	// Reads as many events as fit into the ring buffer, adds them to nTotPushed,
+	// sets bFull if none did. Returns false if the device can't be read anymore.
+	bool readFD(int32_t nFD, int32_t nDeviceId, int32_t& nTotPushed, bool& bFull) noexcept;
+	void wakeup() noexcept;
+	// Returns false if the thread should stop
+	bool waitForSpace() noexcept;
+private:
+	int32_t m_nEpollFD;
+	int32_t m_nWakeupFD; // Written by the thread, read by the main thread
+	int32_t m_nStopFD; // Written by the main thread, read by the thread
+	int32_t m_nSpaceFD; // Written by the consumer, read by the thread
+	std::thread m_oThread;
+	std::atomic<bool> m_bStop;
+	std::atomic<bool> m_bWaitingForSpace; // Set by the thread while the ring is full
+	// Held by the thread while reading the ready file descriptors and by
+	// the main thread while adding or removing them
+	std::mutex m_oFDsMutex;
+	std::unordered_map<int32_t, int32_t> m_oFDs; // Key: nFD, Value: nDeviceId
+	//
+	SpscRing<JoystickThreadEvent> m_oRing; // The thread is the producer
+private:
+	JoystickInputThread(const JoystickInputThread& oSource) = delete;
+	JoystickInputThread& operator=(const JoystickInputThread& oSource) = delete;
+};
+
+} // namespace Js
+} // namespace Private
+
+} // namespace stmi
+
+#endif /* STMI_JOYSTICK_INPUT_THREAD_H */
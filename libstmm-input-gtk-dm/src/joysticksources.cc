@@ -19,6 +19,7 @@
  */
 
 #include "joysticksources.h"
+#include "joystickinputthread.h"
 
 #include <iostream>
 #include <algorithm>
@@ -31,6 +32,11 @@
 #include <sys/inotify.h>
 
 #include <linux/joystick.h>
+#include <linux/input.h>
+
+#include <sys/ioctl.h>
+
+#include <stmm-input/devicemanager.h>
 
 namespace stmi
 {
@@ -53,7 +59,9 @@ JoystickLifeSource::JoystickLifeSource(const std::string& sPath) noexcept
 	if (m_nINotifyFD == -1) {
 		return;
 	}
-	m_nWatchDevFD = inotify_add_watch(m_nINotifyFD, sPath.c_str(), IN_CREATE | IN_DELETE);
+	m_nWatchDevFD = inotify_add_watch(m_nINotifyFD, sPath.c_str(), IN_CREATE | IN_DELETE
+															// tell when a created device file becomes usable
+															| IN_ATTRIB | IN_CLOSE_WRITE);
 	if (m_nWatchDevFD == -1) {
 		::close(m_nINotifyFD);
 		m_nINotifyFD = -1;
@@ -112,7 +120,7 @@ bool JoystickLifeSource::isFileNameMine(const std::string& sFileName) const noex
 	auto itFindSingle = std::find(m_aSingleFileName.begin(), m_aSingleFileName.end(), sFileName);
 	return (itFindSingle != m_aSingleFileName.end());
 }
-sigc::connection JoystickLifeSource::connect(const sigc::slot<bool, const std::string&, const std::string&, bool >& oSlot) noexcept
+sigc::connection JoystickLifeSource::connect(const sigc::slot<bool, const std::string&, const std::string&, LIFE_EVENT>& oSlot) noexcept
 {
 	if (m_nINotifyFD == -1) {
 		// File error, return an empty connection
@@ -165,17 +173,21 @@ bool JoystickLifeSource::dispatch(sigc::slot_base* p0Slot) noexcept
 		if ((p0Event->mask & IN_ISDIR) != 0) {
 			continue; // for p0Cur --------
 		}
-		bool bAdd = true;
+		LIFE_EVENT eLifeEvent;
 		if ((p0Event->mask & IN_DELETE) != 0) {
-			bAdd = false;
+			eLifeEvent = LIFE_EVENT_REMOVED;
 		} else if ((p0Event->mask & IN_CREATE) != 0) {
-			//
+			eLifeEvent = LIFE_EVENT_ADDED;
+		} else if ((p0Event->mask & IN_ATTRIB) != 0) {
+			eLifeEvent = LIFE_EVENT_ATTRIB;
+		} else if ((p0Event->mask & IN_CLOSE_WRITE) != 0) {
+			eLifeEvent = LIFE_EVENT_CLOSE_WRITE;
 		} else {
 			continue; // for p0Cur --------
 		}
 		std::string sFileName(p0Event->name);
 		if (isFileNameMine(sFileName)) {
-			bContinue = (*static_cast<sigc::slot<bool, const std::string&, const std::string&, bool>*>(p0Slot))(m_sPath, sFileName, bAdd);
+			bContinue = (*static_cast<sigc::slot<bool, const std::string&, const std::string&, LIFE_EVENT>*>(p0Slot))(m_sPath, sFileName, eLifeEvent);
 		}
 		if (!bContinue) {
 			break; // for p0Cur --------
@@ -237,7 +249,7 @@ JoystickInputSource::~JoystickInputSource() noexcept
 {
 //std::cout << "JoystickInputSource::~JoystickInputSource()" << std::endl;
 }
-sigc::connection JoystickInputSource::connect(const sigc::slot<bool, const struct ::js_event*>& oSlot) noexcept
+sigc::connection JoystickInputSource::connect(const sigc::slot<bool, const struct ::js_event*, int32_t>& oSlot) noexcept
 {
 	return connect_generic(oSlot);
 }
@@ -276,16 +288,193 @@ bool JoystickInputSource::dispatch(sigc::slot_base* p0Slot) noexcept
 				break; // while --------------------
 			}
 			const int32_t nTotEvents = nReadLen / sizeof(aEvent[0]);
-			for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
-				struct ::js_event* p0Event = &(aEvent[nIdx]);
-				bContinue = (*static_cast<sigc::slot<bool, const struct ::js_event*>*>(p0Slot))(p0Event);
-				if (!bContinue) {
-					// interrupt dispatching
-					return bContinue; // ---------------------------------------
+			if (nTotEvents == 0) {
+				break; // while --------------------
+			}
+			bContinue = (*static_cast<sigc::slot<bool, const struct ::js_event*, int32_t>*>(p0Slot))(aEvent, nTotEvents);
+			if (!bContinue) {
+				// interrupt dispatching
+				return bContinue; // -------------------------------------------
+			}
+		}
+	}
+	return bContinue;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+EvdevInputSource::EvdevInputSource(int32_t nFD, const std::string& sPathName, int64_t nFileSysDeviceId, int32_t nDeviceId
+								, bool bMonotonic, const std::vector<int32_t>& aButtonCode, const std::vector<int32_t>& aAxisCode) noexcept
+: JoystickInputSource(nFD, sPathName, nFileSysDeviceId, nDeviceId)
+, m_bMonotonic(bMonotonic)
+, m_aButtonCode(aButtonCode)
+, m_aAxisCode(aAxisCode)
+, m_bDropping(false)
+{
+	m_aFrame.reserve(m_aButtonCode.size() + m_aAxisCode.size());
+}
+sigc::connection EvdevInputSource::connectFrame(const sigc::slot<bool, const struct ::input_event*, int32_t, int64_t>& oSlot) noexcept
+{
+	return connect_generic(oSlot);
+}
+int64_t EvdevInputSource::getFrameTimeUsec(const struct ::input_event& oSynEvent) const noexcept
+{
+	if (!m_bMonotonic) {
+		return DeviceManager::getNowTimeMicroseconds(); //----------------------
+	}
+	return static_cast<int64_t>(oSynEvent.input_event_sec) * 1000000 + oSynEvent.input_event_usec;
+}
+bool EvdevInputSource::readKeyBits(uint8_t* p0KeyBits, int32_t nSize) noexcept
+{
+	return (ioctl(getJoystickFD(), EVIOCGKEY(nSize), p0KeyBits) >= 0);
+}
+bool EvdevInputSource::readAbsInfo(int32_t nCode, struct ::input_absinfo& oAbsInfo) noexcept
+{
+	return (ioctl(getJoystickFD(), EVIOCGABS(nCode), &oAbsInfo) >= 0);
+}
+void EvdevInputSource::readDeviceState() noexcept
+{
+	m_aFrame.clear();
+	struct ::input_event oEvent{};
+	oEvent.type = EV_KEY;
+	uint8_t aKeyBits[KEY_MAX / 8 + 1] = {0};
+	if (readKeyBits(aKeyBits, sizeof aKeyBits)) {
+		for (const int32_t nCode : m_aButtonCode) {
+			oEvent.code = nCode;
+			oEvent.value = (((aKeyBits[nCode / 8] >> (nCode % 8)) & 1) != 0) ? 1 : 0;
+			m_aFrame.push_back(oEvent);
+		}
+	}
+	oEvent.type = EV_ABS;
+	for (const int32_t nCode : m_aAxisCode) {
+		struct ::input_absinfo oAbsInfo;
+		if (!readAbsInfo(nCode, oAbsInfo)) {
+			continue; // for
+		}
+		oEvent.code = nCode;
+		oEvent.value = oAbsInfo.value;
+		m_aFrame.push_back(oEvent);
+	}
+}
+bool EvdevInputSource::dispatch(sigc::slot_base* p0Slot) noexcept
+{
+	bool bContinue = true;
+
+	if (p0Slot == nullptr) {
+		return bContinue;
+	}
+	if (!isInputPending()) {
+		return bContinue;
+	}
+	auto& oSlot = *static_cast<sigc::slot<bool, const struct ::input_event*, int32_t, int64_t>*>(p0Slot);
+	struct ::input_event aEvent[64];
+	const int32_t nBufLen = sizeof aEvent;
+	while (true) {
+		const int32_t nReadLen = read(getJoystickFD(), aEvent, nBufLen);
+		if (nReadLen <= 0) {
+			break; // while --------------------
+		}
+		const int32_t nTotEvents = nReadLen / sizeof(aEvent[0]);
+		for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+			const struct ::input_event& oEvent = aEvent[nIdx];
+			if (oEvent.type != EV_SYN) {
+				if (!m_bDropping) {
+					m_aFrame.push_back(oEvent);
 				}
+				continue; // for
+			}
+			if (oEvent.code == SYN_DROPPED) {
+				m_aFrame.clear();
+				m_bDropping = true;
+				continue; // for
+			}
+			if (oEvent.code != SYN_REPORT) {
+				continue; // for
+			}
+			if (m_bDropping) {
+				m_bDropping = false;
+				readDeviceState();
+			}
+			if (m_aFrame.empty()) {
+				continue; // for
+			}
+			bContinue = oSlot(m_aFrame.data(), static_cast<int32_t>(m_aFrame.size()), getFrameTimeUsec(oEvent));
+			m_aFrame.clear();
+			if (!bContinue) {
+				// interrupt dispatching
+				return bContinue; // -------------------------------------------
+			}
+		}
+	}
+	return bContinue;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+JoystickThreadSource::JoystickThreadSource(JoystickInputThread& oThread) noexcept
+: m_oThread(oThread)
+{
+	m_oPollFD.set_fd(m_oThread.getWakeupFD());
+	m_oPollFD.set_events(Glib::IO_IN);
+	add_poll(m_oPollFD);
+	set_can_recurse(false);
+}
+sigc::connection JoystickThreadSource::connect(const sigc::slot<bool, int32_t, const struct ::js_event*, int32_t>& oSlot) noexcept
+{
+	return connect_generic(oSlot);
+}
+bool JoystickThreadSource::prepare(int& nTimeout) noexcept
+{
+	nTimeout = -1;
+
+	return false;
+}
+bool JoystickThreadSource::check() noexcept
+{
+	if ((m_oPollFD.get_revents() & G_IO_IN) != 0) {
+		return true;
+	}
+	return false;
+}
+bool JoystickThreadSource::dispatch(sigc::slot_base* p0Slot) noexcept
+{
+	const bool bContinue = true;
+
+	if (p0Slot == nullptr) {
+		return bContinue;
+	}
+	// Reset before popping so that events pushed meanwhile wake the loop up again
+	m_oThread.clearWakeup();
+
+	auto& oCallback = *static_cast<sigc::slot<bool, int32_t, const struct ::js_event*, int32_t>*>(p0Slot);
+	constexpr int32_t nMaxBatchEvents = 32;
+	struct ::js_event aBatch[nMaxBatchEvents];
+	int32_t nTotBatch = 0;
+	int32_t nBatchDeviceId = -1;
+	int32_t nDiscardDeviceId = -1;
+	auto oFlushBatch = [&]()
+	{
+		if ((nTotBatch > 0) && !oCallback(nBatchDeviceId, aBatch, nTotBatch)) {
+			nDiscardDeviceId = nBatchDeviceId;
+		}
+		nTotBatch = 0;
+	};
+	JoystickInputThread::JoystickThreadEvent oEvent;
+	while (m_oThread.popEvent(oEvent)) {
+		if (oEvent.m_nDeviceId == nDiscardDeviceId) {
+			continue; // while
+		}
+		if ((oEvent.m_nDeviceId != nBatchDeviceId) || (nTotBatch == nMaxBatchEvents)) {
+			oFlushBatch();
+			nBatchDeviceId = oEvent.m_nDeviceId;
+			if (nBatchDeviceId == nDiscardDeviceId) {
+				continue; // while
 			}
 		}
+		aBatch[nTotBatch] = oEvent.m_oEvent;
+		++nTotBatch;
 	}
+	// the thread might be waiting for space in the ring
+	m_oThread.endPop();
+	oFlushBatch();
 	return bContinue;
 }
 
@@ -29,6 +29,8 @@
 #include <cstdint>
 
 struct js_event;
+struct input_event;
+struct input_absinfo;
 
 namespace stmi
 {
@@ -38,21 +40,30 @@ namespace Private
 namespace Js
 {
 
+class JoystickInputThread;
+
 ////////////////////////////////////////////////////////////////////////////////
 /* INotify tracking of added and removed devices in a folder */
 class JoystickLifeSource : public Glib::Source
 {
 public:
+	enum LIFE_EVENT
+	{
+		LIFE_EVENT_ADDED = 0, /**< The file was created. */
+		LIFE_EVENT_REMOVED = 1, /**< The file was deleted. */
+		LIFE_EVENT_ATTRIB = 2, /**< The metadata (ex. permissions, owner, acl) of the file changed. */
+		LIFE_EVENT_CLOSE_WRITE = 3 /**< The file, opened for writing, was closed. */
+	};
 	explicit JoystickLifeSource(const std::string& sPath) noexcept;
 	~JoystickLifeSource() noexcept;
 
 	void addSingleFileName(const std::string& sName) noexcept;
 	void addNumberedFilesBaseName(const std::string& sBaseName) noexcept;
 	// A source can have only one callback type, that is the slot given as parameter.
-	// bool = m_oCallback(sPath, sName, bAdd)
-	// sPath the directory, sName the file added or removed, bAdd whether added (true) or removed (false)
+	// bool = m_oCallback(sPath, sName, eLifeEvent)
+	// sPath the directory, sName the file added, removed or changed, eLifeEvent what happened
 	// The callback's return (bool) value tells whether the source should go on listening.
-	sigc::connection connect(const sigc::slot<bool, const std::string&, const std::string&, bool>& oSlot) noexcept;
+	sigc::connection connect(const sigc::slot<bool, const std::string&, const std::string&, LIFE_EVENT>& oSlot) noexcept;
 
 	inline const std::string& getPath() const noexcept { return m_sPath; }
 	bool isFileNameMine(const std::string& sFileName) const noexcept;
@@ -120,7 +131,9 @@ public:
 	~JoystickInputSource() noexcept;
 
 	// A source can have only one callback type, that is the slot given as parameter
-	sigc::connection connect(const sigc::slot<bool, const struct ::js_event*>& oSlot) noexcept;
+	// bool = m_oCallback(p0Events, nTotEvents)
+	// The events of a read are passed all at once.
+	sigc::connection connect(const sigc::slot<bool, const struct ::js_event*, int32_t>& oSlot) noexcept;
 
 	inline const std::string& getJoystickPathName() const noexcept { return m_sPathName; }
 	inline int32_t getJoystickFD() const noexcept { return m_oPollFD.get_fd(); }
@@ -131,6 +144,7 @@ protected:
 	bool check() noexcept override;
 	bool dispatch(sigc::slot_base* oSlot) noexcept override;
 
+	inline bool isInputPending() const noexcept { return ((m_oPollFD.get_revents() & G_IO_IN) != 0); }
 private:
 	//
 	Glib::PollFD m_oPollFD; // The file descriptor is open until destructor is called
@@ -145,6 +159,80 @@ private:
 	JoystickInputSource& operator=(const JoystickInputSource& oSource) = delete;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/* For polling evdev joystick events.
+ * The events are grouped in frames terminated by SYN_REPORT. Each frame
+ * is passed to the callback as a whole together with its time stamp.
+ * When the kernel drops events (SYN_DROPPED) the incomplete frame is discarded
+ * and the state of the device is read and passed as a synthetic frame.
+ */
+class EvdevInputSource : public JoystickInputSource
+{
+public:
+	// If bMonotonic is `true` the time stamps of the events are in the same clock domain
+	// as DeviceManager::getNowTimeMicroseconds(), otherwise the latter is used.
+	// aButtonCode and aAxisCode are used for the resynchronization after dropped events.
+	EvdevInputSource(int32_t nFD, const std::string& sPathName, int64_t nFileSysDeviceId, int32_t nDeviceId
+					, bool bMonotonic, const std::vector<int32_t>& aButtonCode, const std::vector<int32_t>& aAxisCode) noexcept;
+
+	// A source can have only one callback type, that is the slot given as parameter
+	// bool = m_oCallback(p0Events, nTotEvents, nFrameTimeUsec)
+	// The events don't include the terminating SYN_REPORT.
+	sigc::connection connectFrame(const sigc::slot<bool, const struct ::input_event*, int32_t, int64_t>& oSlot) noexcept;
+protected:
+	bool dispatch(sigc::slot_base* oSlot) noexcept override;
+	// Reads the pressed state of all keys (EVIOCGKEY) into p0KeyBits (one bit per key code)
+	// Overridden by tests.
+	virtual bool readKeyBits(uint8_t* p0KeyBits, int32_t nSize) noexcept;
+	// Reads the current state of an absolute axis (EVIOCGABS)
+	// Overridden by tests.
+	virtual bool readAbsInfo(int32_t nCode, struct ::input_absinfo& oAbsInfo) noexcept;
+private:
+	int64_t getFrameTimeUsec(const struct ::input_event& oSynEvent) const noexcept;
+	// Reads the current state of the device into m_aFrame
+	void readDeviceState() noexcept;
+private:
+	const bool m_bMonotonic;
+	const std::vector<int32_t> m_aButtonCode;
+	const std::vector<int32_t> m_aAxisCode;
+	std::vector<struct ::input_event> m_aFrame; // The events of the current frame
+	bool m_bDropping; // Whether discarding events until the next SYN_REPORT
+private:
+	EvdevInputSource() = delete;
+	EvdevInputSource(const EvdevInputSource& oSource) = delete;
+	EvdevInputSource& operator=(const EvdevInputSource& oSource) = delete;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/* For receiving the joystick events read by a JoystickInputThread.
+ * The source polls the thread's wakeup eventfd and passes all the queued
+ * events to the callback.
+ */
+class JoystickThreadSource : public Glib::Source
+{
+public:
+	// The thread must outlive the source
+	explicit JoystickThreadSource(JoystickInputThread& oThread) noexcept;
+
+	// A source can have only one callback type, that is the slot given as parameter
+	// bool = m_oCallback(nDeviceId, p0JoyEvents, nTotEvents)
+	// Consecutive queued events of the same device are passed all at once.
+	// If the callback returns false the events of the same device still
+	// in the queue are discarded.
+	sigc::connection connect(const sigc::slot<bool, int32_t, const struct ::js_event*, int32_t>& oSlot) noexcept;
+protected:
+	bool prepare(int& nTimeout) noexcept override;
+	bool check() noexcept override;
+	bool dispatch(sigc::slot_base* oSlot) noexcept override;
+private:
+	JoystickInputThread& m_oThread;
+	Glib::PollFD m_oPollFD; // The wakeup eventfd, owned by m_oThread
+private:
+	JoystickThreadSource() = delete;
+	JoystickThreadSource(const JoystickThreadSource& oSource) = delete;
+	JoystickThreadSource& operator=(const JoystickThreadSource& oSource) = delete;
+};
+
 } // namespace Js
 } // namespace Private
 
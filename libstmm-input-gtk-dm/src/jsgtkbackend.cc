@@ -33,8 +33,10 @@
 #include <tuple>
 #include <type_traits>
 
+#include <time.h>
+
 #include <linux/joystick.h>
-#include <linux/input-event-codes.h>
+#include <linux/input.h>
 
 #include <sys/stat.h>
 #include <sys/ioctl.h>
@@ -51,6 +53,10 @@ namespace Js
 {
 
 const char* const GtkBackend::s_sDefaultPathBase = "/dev/input/js";
+const char* const GtkBackend::s_sDefaultEvdevPathBase = "/dev/input/event";
+constexpr int32_t GtkBackend::s_nTimeoutFirstRetryMsec;
+constexpr int32_t GtkBackend::s_nTimeoutMaxIntervalMsec;
+constexpr int32_t GtkBackend::s_nTimeoutMaxRetryMsec;
 
 std::pair<unique_ptr<GtkBackend>, std::string> GtkBackend::create(JsGtkDeviceManager* p0Owner, const JsDeviceFiles& oDeviceFiles, bool bCreateDefault) noexcept
 {
@@ -64,11 +70,32 @@ std::pair<unique_ptr<GtkBackend>, std::string> GtkBackend::create(JsGtkDeviceMan
 
 GtkBackend::GtkBackend(JsGtkDeviceManager* p0Owner) noexcept
 : m_p0Owner(p0Owner)
+, m_bEvdev(false)
+, m_bCoalesceAxes(false)
 {
 	assert(p0Owner != nullptr);
 }
+GtkBackend::~GtkBackend() noexcept
+{
+	for (auto& oPair : m_oPendingDevices) {
+		const Glib::RefPtr<DevInitTimeoutSource>& refTimeout = oPair.second.m_refTimeout;
+		if (refTimeout) {
+			refTimeout->destroy();
+		}
+	}
+	if (m_refInputThread) {
+		// make sure the thread is joined before the file descriptors are closed
+		m_refThreadSource->destroy();
+		m_refInputThread.reset();
+	}
+}
 std::string GtkBackend::init(const JsDeviceFiles& oDeviceFiles, bool bCreateDefault) noexcept
 {
+	m_bEvdev = oDeviceFiles.isEvdev();
+	m_bCoalesceAxes = oDeviceFiles.isCoalesceAxes();
+	for (int32_t nLinuxAxis = 0; nLinuxAxis < ABS_CNT; ++nLinuxAxis) {
+		m_aAxisFilter[nLinuxAxis] = oDeviceFiles.getAxisFilter(static_cast<JoystickCapability::AXIS>(nLinuxAxis));
+	}
 	const auto& aPathName = oDeviceFiles.getFiles();
 	const auto& aPathBaseName = oDeviceFiles.getBaseNrFiles();
 	// create a set (automatically avoids duplicates)
@@ -87,7 +114,7 @@ std::string GtkBackend::init(const JsDeviceFiles& oDeviceFiles, bool bCreateDefa
 	const bool bNoDevices = (aPathName.empty() && aPathBaseName.empty());
 	//
 	bCreateDefault = bCreateDefault && bNoDevices;
-	auto aDefaultPathName = std::vector<std::string>({s_sDefaultPathBase});
+	auto aDefaultPathName = std::vector<std::string>({(m_bEvdev ? s_sDefaultEvdevPathBase : s_sDefaultPathBase)});
 	const auto& aAllPaths = (bCreateDefault ? aDefaultPathName : aPathBaseName);
 	for (auto& sPathBaseName : aAllPaths) {
 		std::string sPath;
@@ -130,6 +157,17 @@ std::string GtkBackend::init(const JsDeviceFiles& oDeviceFiles, bool bCreateDefa
 			refPathSource->addSingleFileName(sBaseName);
 		}
 	}
+	if (oDeviceFiles.isInputThread() && !m_bEvdev) {
+		m_refInputThread = std::make_unique<JoystickInputThread>();
+		std::string sError = m_refInputThread->start();
+		if (! sError.empty()) {
+			m_refInputThread.reset();
+			return sError; //---------------------------------------------------
+		}
+		m_refThreadSource = Glib::RefPtr<JoystickThreadSource>(new JoystickThreadSource(*m_refInputThread));
+		m_refThreadSource->connect(sigc::mem_fun(this, &GtkBackend::doThreadJoystickEventsCallback));
+		m_refThreadSource->attach();
+	}
 	return addDevices();
 }
 std::string GtkBackend::addDevices() noexcept
@@ -153,7 +191,7 @@ std::string GtkBackend::addDevices() noexcept
 						std::string sError = "JsGtkDeviceManager::init() malformed sPath=" + sPath + "  sName=" + sName;
 						return sError; //---------------------------------------
 					}
-					const bool bNewJoystick = addIfJoystick(sPathName);
+					const bool bNewJoystick = tryAddDevice(sPathName);
 					if (bNewJoystick) {
 //std::cout << "JsGtkDeviceManager::init() joystick added: " << sPathName << '\n';
 					}
@@ -167,7 +205,7 @@ std::string GtkBackend::addDevices() noexcept
 	}
 	return "";
 }
-bool GtkBackend::doINotifyEventCallback(const std::string& sPath, const std::string& sName, bool bAdd) noexcept
+bool GtkBackend::doINotifyEventCallback(const std::string& sPath, const std::string& sName, JoystickLifeSource::LIFE_EVENT eLifeEvent) noexcept
 {
 	const bool bContinue = true;
 	//
@@ -175,53 +213,144 @@ bool GtkBackend::doINotifyEventCallback(const std::string& sPath, const std::str
 	if (!composePathName(sPath, sName, sPathName)) {
 		return bContinue;
 	}
-	if (bAdd) {
-		const Glib::RefPtr<DevInitTimeoutSource> refTimeOut(new DevInitTimeoutSource(s_nTimeoutRetryMsec, sPathName));
-		refTimeOut->connectSlot(sigc::mem_fun(this, &GtkBackend::doTimeoutSourceCallback));
-		refTimeOut->attach();
-	} else { // Remove
-		auto itFind = std::find_if(m_aInputSources.begin(), m_aInputSources.end()
-				, [&](const Glib::RefPtr<JoystickInputSource>& refSource)
-					{
-						return (sPathName == refSource->getJoystickPathName());
-					});
+	auto itFind = std::find_if(m_aInputSources.begin(), m_aInputSources.end()
+			, [&](const Glib::RefPtr<JoystickInputSource>& refSource)
+				{
+					return (sPathName == refSource->getJoystickPathName());
+				});
+	if (eLifeEvent == JoystickLifeSource::LIFE_EVENT_REMOVED) {
+		m_oNotJoystickFiles.erase(sPathName);
+		removePendingDevice(sPathName);
 		if (itFind == m_aInputSources.end()) {
 			return bContinue; // -----------------------------------------------
 		}
 		const Glib::RefPtr<JoystickInputSource>& refSource = *itFind;
+		if (m_refInputThread) {
+			m_refInputThread->removeFD(refSource->getJoystickFD());
+		}
 		//
 		onDeviceRemoved(refSource->getJoystickId());
 		//
 		m_aInputSources.erase(itFind);
 		//
+		return bContinue; // ---------------------------------------------------
+	}
+	if (itFind != m_aInputSources.end()) {
+		// already a joystick
+		return bContinue; // ---------------------------------------------------
+	}
+	if (eLifeEvent == JoystickLifeSource::LIFE_EVENT_ADDED) {
+		// The node might be for a different device now
+		m_oNotJoystickFiles.erase(sPathName);
+		// udev might not have set the permissions yet, in which case
+		// the device is retried when they change
+		tryPendingDevice(sPathName, true);
+	} else if (m_oNotJoystickFiles.find(sPathName) != m_oNotJoystickFiles.end()) {
+		// Already probed, the capabilities of a device don't change.
+		// In evdev mode this avoids opening all the other input nodes
+		// each time udev touches them.
+		return bContinue; // ---------------------------------------------------
+	} else if (eLifeEvent == JoystickLifeSource::LIFE_EVENT_ATTRIB) {
+		// The permissions changed, this also includes files that were given up
+		// (ex. the acl was set when the user logged into the seat)
+		tryPendingDevice(sPathName, false);
+	} else {
+		assert(eLifeEvent == JoystickLifeSource::LIFE_EVENT_CLOSE_WRITE);
+		// If the file could be opened the close might have been caused by
+		// the failed try itself, leave it to the fallback timeout
+		auto itPending = m_oPendingDevices.find(sPathName);
+		if ((itPending != m_oPendingDevices.end()) && !itPending->second.m_bOpened) {
+			tryPendingDevice(sPathName, false);
+		}
 	}
 	return bContinue;
 }
-bool GtkBackend::doTimeoutSourceCallback(const std::string& sPathName, int32_t nElapsedMillisec) noexcept
+void GtkBackend::tryPendingDevice(const std::string& sPathName, bool bStartPending) noexcept
 {
-	const bool bContinue = true;
+	bool bOpened;
+	const bool bNewJoystick = tryAddDevice(sPathName, bOpened);
+	auto itPending = m_oPendingDevices.find(sPathName);
+	if (bNewJoystick || (m_oNotJoystickFiles.find(sPathName) != m_oNotJoystickFiles.end())) {
+		removePendingDevice(sPathName);
+		return; //--------------------------------------------------------------
+	}
+	if (itPending != m_oPendingDevices.end()) {
+		// the fallback timeout is still running
+		itPending->second.m_bOpened = bOpened;
+		return; //--------------------------------------------------------------
+	}
+	if (!bStartPending) {
+		return; //--------------------------------------------------------------
+	}
+	m_oPendingDevices.emplace(sPathName, PendingDevice{Glib::RefPtr<DevInitTimeoutSource>{}, 0, 0, bOpened});
+	schedulePendingRetry(sPathName, s_nTimeoutFirstRetryMsec);
+}
+void GtkBackend::schedulePendingRetry(const std::string& sPathName, int32_t nIntervalMillisec) noexcept
+{
+	auto itPending = m_oPendingDevices.find(sPathName);
+	assert(itPending != m_oPendingDevices.end());
+	PendingDevice& oPending = itPending->second;
+	oPending.m_nIntervalMillisec = nIntervalMillisec;
+	oPending.m_refTimeout = Glib::RefPtr<DevInitTimeoutSource>(new DevInitTimeoutSource(nIntervalMillisec, sPathName));
+	oPending.m_refTimeout->connectSlot(sigc::mem_fun(this, &GtkBackend::doTimeoutSourceCallback));
+	oPending.m_refTimeout->attach();
+}
+void GtkBackend::removePendingDevice(const std::string& sPathName) noexcept
+{
+	auto itPending = m_oPendingDevices.find(sPathName);
+	if (itPending == m_oPendingDevices.end()) {
+		return; //--------------------------------------------------------------
+	}
+	const Glib::RefPtr<DevInitTimeoutSource>& refTimeout = itPending->second.m_refTimeout;
+	if (refTimeout) {
+		refTimeout->destroy();
+	}
+	m_oPendingDevices.erase(itPending);
+}
+bool GtkBackend::doTimeoutSourceCallback(const std::string& sPathName, int32_t /*nElapsedMillisec*/) noexcept
+{
+	// Each timeout source is used once, the next retry (if any) gets a new one
+	const bool bContinue = false;
 	//
-	auto itFind = std::find_if(m_aInputSources.begin(), m_aInputSources.end()
-			, [&](const Glib::RefPtr<JoystickInputSource>& refSource)
-				{
-					return (sPathName == refSource->getJoystickPathName());
-				});
-	if (itFind != m_aInputSources.end()) {
-		// already created, destroy timeout source
-		return !bContinue; //---------------------------------------------------
+	auto itPending = m_oPendingDevices.find(sPathName);
+	if (itPending == m_oPendingDevices.end()) {
+		return bContinue; //----------------------------------------------------
 	}
-	const bool bNewJoystick = addIfJoystick(sPathName);
-	if (!bNewJoystick) {
-		if (nElapsedMillisec <= s_nTimeoutMaxRetryMsec) {
-			// try for 4 seconds (each second)
-			return bContinue; // -----------------------------------------------
-		}
-		// Failed to create, destroy timeout source
-		return !bContinue; // --------------------------------------------------
+	bool bOpened;
+	const bool bNewJoystick = tryAddDevice(sPathName, bOpened);
+	PendingDevice& oPending = itPending->second;
+	if (bNewJoystick || (m_oNotJoystickFiles.find(sPathName) != m_oNotJoystickFiles.end())) {
+		// the source is destroyed by returning false
+		m_oPendingDevices.erase(itPending);
+		return bContinue; //----------------------------------------------------
 	}
-	// It's a joystick
+	oPending.m_bOpened = bOpened;
+	oPending.m_nElapsedMillisec += oPending.m_nIntervalMillisec;
+	const int32_t nNextIntervalMillisec = std::min(2 * oPending.m_nIntervalMillisec, s_nTimeoutMaxIntervalMsec);
+	if (oPending.m_nElapsedMillisec + nNextIntervalMillisec > s_nTimeoutMaxRetryMsec) {
+		// Give up, unless the permissions change later
+		m_oPendingDevices.erase(itPending);
+		return bContinue; //----------------------------------------------------
+	}
+	schedulePendingRetry(sPathName, nNextIntervalMillisec);
 	return bContinue;
 }
+bool GtkBackend::doThreadJoystickEventsCallback(int32_t nDeviceId, const struct ::js_event* p0JoyEvents, int32_t nTotEvents) noexcept
+{
+	const auto& aJoysticks = m_p0Owner->m_aJoysticks;
+	auto itFind = std::find_if(aJoysticks.begin(), aJoysticks.end()
+			, [&](const shared_ptr<JoystickDevice>& refJoystick)
+				{
+					return (nDeviceId == refJoystick->getDeviceId());
+				});
+	if (itFind == aJoysticks.end()) {
+		// removed while the event was queued
+		return false; //--------------------------------------------------------
+	}
+	// the device might be removed by a listener during the callback
+	const shared_ptr<JoystickDevice> refJoystick = *itFind;
+	return refJoystick->doInputJoystickEventsCallback(p0JoyEvents, nTotEvents, m_bCoalesceAxes);
+}
 bool GtkBackend::splitPathName(const std::string& sPathName, std::string& sPath, std::string& sName) noexcept
 {
 	try {
@@ -305,8 +434,19 @@ struct RAII_Fd
 	void dontClose() noexcept { m_nFD = -1; }
 	int32_t m_nFD;
 };
-bool GtkBackend::addIfJoystick(const std::string& sPathName) noexcept
+bool GtkBackend::tryAddDevice(const std::string& sPathName, bool& bOpened) noexcept
+{
+	bool bNotJoystick;
+	const bool bNewJoystick = addIfJoystick(sPathName, bOpened, bNotJoystick);
+	if (bNotJoystick) {
+		m_oNotJoystickFiles.insert(sPathName);
+	}
+	return bNewJoystick;
+}
+bool GtkBackend::addIfJoystick(const std::string& sPathName, bool& bOpened, bool& bNotJoystick) noexcept
 {
+	bOpened = false;
+	bNotJoystick = false;
 	//bool bReadOnly = false;
 	// Try Read+Write for feedback
 	int32_t nFD = open(sPathName.c_str(), O_RDWR | O_NONBLOCK, 0);
@@ -321,6 +461,7 @@ bool GtkBackend::addIfJoystick(const std::string& sPathName) noexcept
 		//bReadOnly = true;
 	}
 
+	bOpened = true;
 	RAII_Fd oRAII(nFD);
 
 	static_assert(sizeof(unsigned long) <= sizeof(int64_t), ""); // st_rdev
@@ -340,11 +481,70 @@ bool GtkBackend::addIfJoystick(const std::string& sPathName) noexcept
 		return false;
 	}
 	//
+	std::string sDeviceName;
+	std::vector<int32_t> aButtonCode;
+	std::vector<int32_t> aAxisCode;
+	std::vector<JoystickAbsInfo> aAbsInfo;
+	if (m_bEvdev) {
+		if (!getEvdevJoystickData(nFD, sDeviceName, aButtonCode, aAxisCode, aAbsInfo)) {
+			bNotJoystick = true;
+			return false; //----------------------------------------------------
+		}
+	} else {
+		if (!getJsJoystickData(nFD, sDeviceName, aButtonCode, aAxisCode)) {
+			bNotJoystick = true;
+			return false; //----------------------------------------------------
+		}
+	}
+	int32_t nTotHats;
+	if (!calcTotHats(aAxisCode, nTotHats)) {
+		bNotJoystick = true;
+		return false; //--------------------------------------------------------
+	}
+
+	const shared_ptr<Private::Js::JoystickDevice>& refNewJoystick = onDeviceAdded(sDeviceName, aButtonCode, nTotHats, aAxisCode, aAbsInfo);
+	if (!refNewJoystick) {
+		return false; //--------------------------------------------------------
+	}
+	const int32_t nDeviceId = refNewJoystick->getDeviceId();
+	for (int32_t nLinuxAxis : aAxisCode) {
+		if ((nLinuxAxis >= 0) && (nLinuxAxis < ABS_CNT) && !JoystickDevice::isHatAxis(nLinuxAxis)) {
+			refNewJoystick->setAxisFilter(static_cast<JoystickCapability::AXIS>(nLinuxAxis), m_aAxisFilter[nLinuxAxis]);
+		}
+	}
+
+	oRAII.dontClose(); // open file descriptor passed to JoystickInputSource
+
+	if (m_bEvdev) {
+		// Have the kernel time stamps in the same clock domain as DeviceManager::getNowTimeMicroseconds()
+		// (std::chrono::steady_clock is CLOCK_MONOTONIC on Linux)
+		int32_t nClockId = CLOCK_MONOTONIC;
+		const bool bMonotonic = (ioctl(nFD, EVIOCSCLOCKID, &nClockId) >= 0);
+		Glib::RefPtr<EvdevInputSource> refGlibSource(new EvdevInputSource(nFD, sPathName, nFileSysDeviceId, nDeviceId
+																		, bMonotonic, aButtonCode, aAxisCode));
+		m_aInputSources.push_back(refGlibSource);
+		refGlibSource->connectFrame(sigc::mem_fun(*refNewJoystick, &JoystickDevice::doInputEvdevFrameCallback));
+		refGlibSource->attach();
+	} else {
+		Glib::RefPtr<JoystickInputSource> refGlibSource(new JoystickInputSource(nFD, sPathName, nFileSysDeviceId, nDeviceId));
+		m_aInputSources.push_back(refGlibSource);
+		if (m_refInputThread && m_refInputThread->addFD(nFD, nDeviceId)) {
+			// read by the thread, the source just owns the file descriptor
+			return true; //-----------------------------------------------------
+		}
+		refGlibSource->connect(sigc::bind(sigc::mem_fun(*refNewJoystick, &JoystickDevice::doInputJoystickEventsCallback), m_bCoalesceAxes));
+		refGlibSource->attach();
+	}
+	return true;
+}
+bool GtkBackend::getJsJoystickData(int32_t nFD, std::string& sDeviceName
+									, std::vector<int32_t>& aButtonCode, std::vector<int32_t>& aAxisCode) noexcept
+{
 	char aDeviceName[1024] = {0};
 	if (ioctl(nFD, JSIOCGNAME(sizeof aDeviceName), aDeviceName) < 0) {
 		return false; //--------------------------------------------------------
 	}
-	const std::string sDeviceName(aDeviceName);
+	sDeviceName = aDeviceName;
 
 	uint8_t nTotAxis = 0;
 	uint8_t nTotButtons = 0;
@@ -354,14 +554,70 @@ bool GtkBackend::addIfJoystick(const std::string& sPathName) noexcept
 		return false; //--------------------------------------------------------
 	}
 
-	std::vector<int32_t> aButtonCode;
 	if (!getButtonMapping(nFD, nTotButtons, aButtonCode)) {
 		return false; //--------------------------------------------------------
 	}
-	std::vector<int32_t> aAxisCode;
 	if (!getAxisMapping(nFD, nTotAxis, aAxisCode)) {
 		return false; //--------------------------------------------------------
 	}
+	return true;
+}
+static inline bool isBitSet(const uint8_t* p0Bits, int32_t nBit) noexcept
+{
+	return ((p0Bits[nBit / 8] >> (nBit % 8)) & 1) != 0;
+}
+bool GtkBackend::getEvdevJoystickData(int32_t nFD, std::string& sDeviceName
+									, std::vector<int32_t>& aButtonCode, std::vector<int32_t>& aAxisCode
+									, std::vector<JoystickAbsInfo>& aAbsInfo) noexcept
+{
+	uint8_t aKeyBits[KEY_MAX / 8 + 1] = {0};
+	uint8_t aAbsBits[ABS_MAX / 8 + 1] = {0};
+	if ((ioctl(nFD, EVIOCGBIT(EV_KEY, sizeof aKeyBits), aKeyBits) < 0)
+			|| (ioctl(nFD, EVIOCGBIT(EV_ABS, sizeof aAbsBits), aAbsBits) < 0)) {
+		return false; //--------------------------------------------------------
+	}
+	// Like the kernel's joydev module: a joystick has buttons in the BTN_JOYSTICK
+	// or BTN_GAMEPAD ranges, but isn't a touchpad or a tablet
+	bool bHasJoystickButton = false;
+	for (int32_t nCode = BTN_JOYSTICK; nCode < BTN_DIGI; ++nCode) {
+		if (isBitSet(aKeyBits, nCode)) {
+			bHasJoystickButton = true;
+			break; // for
+		}
+	}
+	if ((!bHasJoystickButton) || isBitSet(aKeyBits, BTN_TOUCH)) {
+		return false; //--------------------------------------------------------
+	}
+	char aDeviceName[1024] = {0};
+	if (ioctl(nFD, EVIOCGNAME(sizeof aDeviceName), aDeviceName) < 0) {
+		return false; //--------------------------------------------------------
+	}
+	sDeviceName = aDeviceName;
+
+	for (int32_t nCode = BTN_MISC; nCode <= KEY_MAX; ++nCode) {
+		if (isBitSet(aKeyBits, nCode)) {
+			aButtonCode.push_back(nCode);
+		}
+	}
+	// the multi touch axes are not joystick axes
+	for (int32_t nCode = 0; nCode < ABS_MT_SLOT; ++nCode) {
+		if (!isBitSet(aAbsBits, nCode)) {
+			continue; // for
+		}
+		struct ::input_absinfo oAbsInfo;
+		if (ioctl(nFD, EVIOCGABS(nCode), &oAbsInfo) < 0) {
+			return false; //----------------------------------------------------
+		}
+		aAxisCode.push_back(nCode);
+		aAbsInfo.push_back(JoystickAbsInfo{oAbsInfo.value, oAbsInfo.minimum, oAbsInfo.maximum, oAbsInfo.flat});
+	}
+	if (aAxisCode.empty() || aButtonCode.empty()) {
+		return false; //--------------------------------------------------------
+	}
+	return true;
+}
+bool GtkBackend::calcTotHats(const std::vector<int32_t>& aAxisCode, int32_t& nTotHats) noexcept
+{
 	std::vector<int32_t> aAxisCodeHats;
 	std::copy_if(aAxisCode.begin(), aAxisCode.end(), std::back_inserter(aAxisCodeHats)
 					, [&](int32_t nAxis) { return JoystickDevice::isHatAxis(nAxis); }
@@ -380,23 +636,7 @@ bool GtkBackend::addIfJoystick(const std::string& sPathName) noexcept
 		// X without Y, probably a microsoft keyboard
 		return false; //--------------------------------------------------------
 	}
-	const int32_t nTotHats = nTotHatAxes / 2;
-
-	const shared_ptr<Private::Js::JoystickDevice>& refNewJoystick = onDeviceAdded(sDeviceName, aButtonCode, nTotHats, aAxisCode);
-	if (!refNewJoystick) {
-		return false; //--------------------------------------------------------
-	}
-	const int32_t nDeviceId = refNewJoystick->getDeviceId();
-
-	oRAII.dontClose(); // open file descriptor passed to JoystickInputSource
-
-	Glib::RefPtr<JoystickInputSource> refGlibSource(new JoystickInputSource(nFD, sPathName, nFileSysDeviceId, nDeviceId));
-
-	m_aInputSources.push_back(refGlibSource);
-
-	refGlibSource->connect(sigc::mem_fun(*refNewJoystick, &JoystickDevice::doInputJoystickEventCallback));
-	refGlibSource->attach();
-
+	nTotHats = nTotHatAxes / 2;
 	return true;
 }
 bool GtkBackend::getButtonMapping(int32_t nFD, int32_t nTotButtons, std::vector<int32_t>& aButtonCode) noexcept
@@ -22,22 +22,23 @@
 #define STMI_JS_GTK_BACKEND_H
 
 #include "jsgtkdevicemanager.h"
+#include "jsgtkjoystickdevice.h"
 #include "joysticksources.h"
+#include "joystickinputthread.h"
+#include "jsdevicefiles.h"
 
 #include <gtkmm.h>
 
+#include <array>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <stdint.h>
 
-namespace stmi { class JsDeviceFiles; }
-namespace stmi { namespace Private { namespace Js { class JoystickDevice; } } }
-
-
 namespace stmi
 {
 
@@ -55,7 +56,7 @@ class GtkBackend
 {
 public:
 	static std::pair<unique_ptr<GtkBackend>, std::string> create(JsGtkDeviceManager* p0Owner, const JsDeviceFiles& oDeviceFiles, bool bCreateDefault) noexcept;
-	virtual ~GtkBackend() = default;
+	virtual ~GtkBackend() noexcept;
 protected:
 	explicit GtkBackend(JsGtkDeviceManager* p0Owner) noexcept;
 	std::string init(const JsDeviceFiles& oDeviceFiles, bool bCreateDefault) noexcept;
@@ -68,8 +69,34 @@ protected:
 	const shared_ptr<Private::Js::JoystickDevice>& onDeviceAdded(const std::string& sName, const std::vector<int32_t>& aButtonCode
 												, int32_t nTotHats, const std::vector<int32_t>& aAxisCode) noexcept
 	{
-		return m_p0Owner->onDeviceAdded(sName, aButtonCode, nTotHats, aAxisCode);
+		return m_p0Owner->onDeviceAdded(sName, aButtonCode, nTotHats, aAxisCode, std::vector<JoystickAbsInfo>{});
+	}
+	const shared_ptr<Private::Js::JoystickDevice>& onDeviceAdded(const std::string& sName, const std::vector<int32_t>& aButtonCode
+												, int32_t nTotHats, const std::vector<int32_t>& aAxisCode
+												, const std::vector<JoystickAbsInfo>& aAbsInfo) noexcept
+	{
+		return m_p0Owner->onDeviceAdded(sName, aButtonCode, nTotHats, aAxisCode, aAbsInfo);
 	}
+	// For FakeGtkBackend
+	bool onLifeEvent(const std::string& sPath, const std::string& sName, JoystickLifeSource::LIFE_EVENT eLifeEvent) noexcept
+	{
+		return doINotifyEventCallback(sPath, sName, eLifeEvent);
+	}
+	// For FakeGtkBackend
+	bool isPendingDevice(const std::string& sPathName) const noexcept
+	{
+		return (m_oPendingDevices.find(sPathName) != m_oPendingDevices.end());
+	}
+	// For FakeGtkBackend
+	bool isNotJoystickFile(const std::string& sPathName) const noexcept
+	{
+		return (m_oNotJoystickFiles.find(sPathName) != m_oNotJoystickFiles.end());
+	}
+	// Tries to open a device file and add it as a joystick.
+	// bOpened tells whether the device file could be opened, bNotJoystick
+	// whether it could be opened and queried but isn't a joystick.
+	// Returns whether a joystick was added.
+	virtual bool addIfJoystick(const std::string& sPathName, bool& bOpened, bool& bNotJoystick) noexcept;
 private:
 	// returns error string
 	std::string addDevices() noexcept;
@@ -83,26 +110,73 @@ private:
 	// Returns false if convert error
 	static bool cleanPath(std::string& sPath) noexcept;
 
-	// bAdd==true, file added, otherwise file removed
-	bool doINotifyEventCallback(const std::string& sPath, const std::string& sName, bool bAdd) noexcept;
-	// this gives the device file time to be set up
+	bool doINotifyEventCallback(const std::string& sPath, const std::string& sName, JoystickLifeSource::LIFE_EVENT eLifeEvent) noexcept;
+	// Fallback in case the file system doesn't tell when the device file is ready
 	bool doTimeoutSourceCallback(const std::string& sPathName, int32_t nElapsedMillisec) noexcept;
-
-	bool addIfJoystick(const std::string& sPathName) noexcept;
+	// Tries to add a device file. If it fails and bStartPending is true
+	// the file becomes pending and is retried with increasing intervals.
+	void tryPendingDevice(const std::string& sPathName, bool bStartPending) noexcept;
+	void schedulePendingRetry(const std::string& sPathName, int32_t nIntervalMillisec) noexcept;
+	void removePendingDevice(const std::string& sPathName) noexcept;
+	// The events read by m_refInputThread
+	bool doThreadJoystickEventsCallback(int32_t nDeviceId, const struct ::js_event* p0JoyEvents, int32_t nTotEvents) noexcept;
+
+	bool tryAddDevice(const std::string& sPathName) noexcept
+	{
+		bool bOpened;
+		return tryAddDevice(sPathName, bOpened);
+	}
+	// Calls addIfJoystick() and remembers the files that aren't joysticks.
+	// bOpened tells whether the device file could be opened.
+	bool tryAddDevice(const std::string& sPathName, bool& bOpened) noexcept;
+	// <linux/joystick.h> interface
+	bool getJsJoystickData(int32_t nFD, std::string& sDeviceName
+							, std::vector<int32_t>& aButtonCode, std::vector<int32_t>& aAxisCode) noexcept;
 	bool getButtonMapping(int32_t nFD, int32_t nTotButtons, std::vector<int32_t>& aButtonCode) noexcept;
 	bool getAxisMapping(int32_t nFD, int32_t nTotAxes, std::vector<int32_t>& aAxisCode) noexcept;
+	// evdev interface. Returns false if the device doesn't look like a joystick or gamepad.
+	bool getEvdevJoystickData(int32_t nFD, std::string& sDeviceName
+							, std::vector<int32_t>& aButtonCode, std::vector<int32_t>& aAxisCode
+							, std::vector<JoystickAbsInfo>& aAbsInfo) noexcept;
+	// Returns false if the hat axes are not consecutive pairs starting from ABS_HAT0X
+	static bool calcTotHats(const std::vector<int32_t>& aAxisCode, int32_t& nTotHats) noexcept;
 
 private:
 	JsGtkDeviceManager* m_p0Owner;
 	// The INotify Sources, one for each distinct path in oDeviceFiles passed to init()
 	std::unordered_map<std::string, shared_ptr<Private::Js::JoystickLifeSource> > m_oPathSources; // Key: sPath
 
+	// If m_refInputThread is not null the js sources aren't attached,
+	// they just own the file descriptors read by the thread
 	std::vector< Glib::RefPtr<JoystickInputSource> > m_aInputSources;
 
+	// Device files created but not (yet) usable as joysticks
+	struct PendingDevice
+	{
+		Glib::RefPtr<DevInitTimeoutSource> m_refTimeout; // The backoff retry
+		int32_t m_nIntervalMillisec; // The interval of m_refTimeout
+		int32_t m_nElapsedMillisec; // The sum of the intervals of the previous retries
+		bool m_bOpened; // Whether the last try could open the file
+	};
+	std::unordered_map<std::string, PendingDevice> m_oPendingDevices; // Key: sPathName
+	// Device files that were opened but aren't joysticks (ex. the evdev nodes of keyboards).
+	// Their attribute changes are ignored until they are removed or created again.
+	std::unordered_set<std::string> m_oNotJoystickFiles;
+
+	unique_ptr<JoystickInputThread> m_refInputThread; // Can be null
+	Glib::RefPtr<JoystickThreadSource> m_refThreadSource; // Null if m_refInputThread is
+
+	bool m_bEvdev; // Whether the device files implement the evdev interface
+	bool m_bCoalesceAxes; // Whether only the latest of the changes of an axis read together is sent
+	std::array<JsDeviceFiles::AxisFilter, ABS_CNT> m_aAxisFilter; // Index: the linux axis code
+
 	static const char* const s_sDefaultPathBase;
+	static const char* const s_sDefaultEvdevPathBase;
 
-	constexpr static int32_t s_nTimeoutRetryMsec = 1000;
-	constexpr static int32_t s_nTimeoutMaxRetryMsec = 4 * s_nTimeoutRetryMsec;
+	// The fallback retry intervals double from the first to the max
+	constexpr static int32_t s_nTimeoutFirstRetryMsec = 25;
+	constexpr static int32_t s_nTimeoutMaxIntervalMsec = 1000;
+	constexpr static int32_t s_nTimeoutMaxRetryMsec = 4000;
 private:
 	GtkBackend(const GtkBackend& oSource) = delete;
 	GtkBackend& operator=(const GtkBackend& oSource) = delete;
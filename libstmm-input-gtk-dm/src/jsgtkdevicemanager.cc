@@ -155,13 +155,14 @@ void JsGtkDeviceManager::enableEventClass(const Event::Class& oEventClass) noexc
 	}
 }
 const shared_ptr<JoystickDevice>& JsGtkDeviceManager::onDeviceAdded(const std::string& sName, const std::vector<int32_t>& aButtonCode
-												, int32_t nTotHats, const std::vector<int32_t>& aAxisCode) noexcept
+												, int32_t nTotHats, const std::vector<int32_t>& aAxisCode
+												, const std::vector<JoystickAbsInfo>& aAbsInfo) noexcept
 {
 	shared_ptr<ChildDeviceManager> refChildThis = shared_from_this();
 	assert(std::dynamic_pointer_cast<JsGtkDeviceManager>(refChildThis));
 	auto refThis = std::static_pointer_cast<JsGtkDeviceManager>(refChildThis);
 	//
-	auto refNewJoystick = std::make_shared<JoystickDevice>(sName, refThis, aButtonCode, nTotHats, aAxisCode);
+	auto refNewJoystick = std::make_shared<JoystickDevice>(sName, refThis, aButtonCode, nTotHats, aAxisCode, aAbsInfo);
 	#ifndef NDEBUG
 	auto itFind = std::find_if(m_aJoysticks.begin(), m_aJoysticks.end()
 					, [&](const shared_ptr<Private::Js::JoystickDevice>& refJoystick)
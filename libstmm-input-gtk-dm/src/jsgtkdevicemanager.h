@@ -22,6 +22,7 @@
 #define STMI_JS_GTK_DEVICE_MANAGER_H
 
 #include <stmm-input-ev/stddevicemanager.h>
+#include <stmm-input-base/clockdomain.h>
 #include <stmm-input/event.h>
 
 #include <gtkmm.h>
@@ -48,10 +49,11 @@ namespace Js
 	class GtkWindowData;
 	class GtkWindowDataFactory;
 	class JsGtkListenerExtraData;
+	struct JoystickAbsInfo;
 } // namespace Js
 } // namespace Private
 
-/** Handles joysticks according to the <linux/joystick.h> interface.
+/** Handles joysticks according to the <linux/joystick.h> or the evdev <linux/input.h> interface.
  * An event (of type stmi::JoystickButtonEvent, JoystickHatEvent or JoystickAxisEvent)
  * sent to listeners by this device manager is tied to a Gtk::Window, which has
  * to be added with JsGtkDeviceManager::addAccessor() wrapped in a stmi::GtkAccessor.
@@ -64,7 +66,8 @@ class JsGtkDeviceManager : public StdDeviceManager , public sigc::trackable
 public:
 	/** Creates an instance of this class.
 	 * If no device file is given as parameter the default files are used,
-	 * "/dev/input/js0", "/dev/input/js1", ...
+	 * "/dev/input/js0", "/dev/input/js1", ... (or "/dev/input/event0", "/dev/input/event1", ...
+	 * if JsDeviceFiles::isEvdev()).
 	 *
 	 * If bEnableEventClasses is `true` then all event classes in aEnDisableEventClasses are enabled, all others disabled,
 	 * if `false` then all event classes supported by this instance are enabled except those in aEnDisableEventClasses.
@@ -77,7 +80,8 @@ public:
 	 *
 	 * @param bEnableEventClasses Whether to enable or disable all but aEnDisableEventClasses.
 	 * @param aEnDisableEventClasses The event classes to be enabled or disabled according to bEnableEventClasses.
-	 * @param oDeviceFiles The device files compatible with the <linux/joystick.h> interface.
+	 * @param oDeviceFiles The device files compatible with the <linux/joystick.h> interface
+	 *                     or, if JsDeviceFiles::isEvdev(), with the evdev interface.
 	 * @return The created instance and empty string or null and the error string.
 	 */
 	static std::pair<shared_ptr<JsGtkDeviceManager>, std::string> create(bool bEnableEventClasses, const std::vector<Event::Class>& aEnDisableEventClasses
@@ -115,7 +119,8 @@ protected:
 private:
 	friend class Private::Js::GtkBackend;
 	const shared_ptr<Private::Js::JoystickDevice>& onDeviceAdded(const std::string& sName, const std::vector<int32_t>& aButtonCode
-																, int32_t nTotHats, const std::vector<int32_t>& aAxisCode) noexcept;
+																, int32_t nTotHats, const std::vector<int32_t>& aAxisCode
+																, const std::vector<Private::Js::JoystickAbsInfo>& aAbsInfo) noexcept;
 	void onDeviceRemoved(int32_t nJoystickId) noexcept;
 
 	bool findWindow(Gtk::Window* p0GtkmmWindow
@@ -154,6 +159,8 @@ private:
 	const int32_t m_nClassIdxJoystickButtonEvent;
 	const int32_t m_nClassIdxJoystickHatEvent;
 	const int32_t m_nClassIdxJoystickAxisEvent;
+	// Maps js_event::time to the library's time
+	ClockDomain m_oJsClockDomain;
 	//
 private:
 	JsGtkDeviceManager(const JsGtkDeviceManager& oSource) = delete;
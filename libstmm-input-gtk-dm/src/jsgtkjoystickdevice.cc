@@ -29,10 +29,14 @@
 
 #include <cassert>
 #include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstdlib>
 #include <iterator>
 #include <limits>
 
+#include <linux/input.h>
+
 namespace stmi { class GtkAccessor; }
 
 namespace stmi
@@ -44,16 +48,67 @@ namespace Js
 {
 
 JoystickDevice::JoystickDevice(const std::string& sName, const shared_ptr<JsGtkDeviceManager>& refDeviceManager
-								, const std::vector<int32_t>& aButtonCode, int32_t nTotHats, const std::vector<int32_t>& aAxisCode) noexcept
+								, const std::vector<int32_t>& aButtonCode, int32_t nTotHats, const std::vector<int32_t>& aAxisCode
+								, const std::vector<JoystickAbsInfo>& aAbsInfo) noexcept
 : BasicDevice<JsGtkDeviceManager>(sName, refDeviceManager)
 , m_aButtonCode(aButtonCode)
 , m_aButtonPressed(aButtonCode.size(), ButtonData{false, std::numeric_limits<int64_t>::max()})
 , m_nTotHats(nTotHats)
 , m_aAxisCode(aAxisCode)
 , m_aAxisValue(aAxisCode.size(), 0)
+, m_aAbsInfo(aAbsInfo)
+, m_aAxisData(aAxisCode.size(), AxisData{0, 0, 0, 0, 0, false})
+, m_nAxisFlushTimeUsec(0)
+, m_bRemoved(false)
 {
 	assert((nTotHats >= 0) && (nTotHats <= s_nMaxHats));
+	assert(m_aAbsInfo.empty() || (m_aAbsInfo.size() == m_aAxisCode.size()));
 	m_aHatStatus.resize(m_nTotHats, HatData{std::numeric_limits<int64_t>::max(), 0, 0});
+	// The lookup tables, if a code is repeated the first wins
+	m_aButtonNrOfCode.fill(-1);
+	const int32_t nTotButtons = static_cast<int32_t>(m_aButtonCode.size());
+	for (int32_t nNr = 0; nNr < nTotButtons; ++nNr) {
+		const int32_t nIdx = m_aButtonCode[nNr] - JoystickCapability::BUTTON_TRIGGER;
+		if ((nIdx >= 0) && (nIdx < JoystickCapability::s_nButtonRange) && (m_aButtonNrOfCode[nIdx] < 0)) {
+			m_aButtonNrOfCode[nIdx] = static_cast<int16_t>(nNr);
+		}
+	}
+	m_aAxisNrOfCode.fill(-1);
+	const int32_t nTotAxes = static_cast<int32_t>(m_aAxisCode.size());
+	for (int32_t nNr = 0; nNr < nTotAxes; ++nNr) {
+		const int32_t nLinuxAxis = m_aAxisCode[nNr];
+		const int32_t nIdx = nLinuxAxis - JoystickCapability::AXIS_X;
+		if ((nIdx >= 0) && (nIdx < JoystickCapability::s_nAxisRange) && !isHatAxis(nLinuxAxis) && (m_aAxisNrOfCode[nIdx] < 0)) {
+			m_aAxisNrOfCode[nIdx] = static_cast<int16_t>(nNr);
+		}
+	}
+	// evdev devices have no init events, the values are the ones at opening time
+	const int32_t nTotAbsInfos = static_cast<int32_t>(m_aAbsInfo.size());
+	for (int32_t nNr = 0; nNr < nTotAbsInfos; ++nNr) {
+		const int32_t nLinuxAxis = m_aAxisCode[nNr];
+		if (!isHatAxis(nLinuxAxis)) {
+			m_aAxisValue[nNr] = normalizeAxisValue(nNr, m_aAbsInfo[nNr].m_nValue);
+			m_aAxisData[nNr].m_nSentValue = m_aAxisValue[nNr];
+			continue; // for
+		}
+		const int32_t nHatBase = nLinuxAxis - ABS_HAT0X;
+		const int32_t nHat = nHatBase / 2;
+		if (nHat >= m_nTotHats) {
+			continue; // for
+		}
+		const bool bY = ((nHatBase & 1) != 0);
+		auto& oHatData = m_aHatStatus[nHat];
+		if (bY) {
+			oHatData.m_nAxisY = calcHatAxis(m_aAbsInfo[nNr].m_nValue);
+		} else {
+			oHatData.m_nAxisX = calcHatAxis(m_aAbsInfo[nNr].m_nValue);
+		}
+		if (calcHatValue(oHatData.m_nAxisX, oHatData.m_nAxisY) != JoystickCapability::HAT_CENTER) {
+			// Held since before any listener was added or the hat event class was enabled:
+			// coming back to center is not sent, as for hats pressed while not enabled
+			oHatData.m_nPressedTimeStamp = 0;
+		}
+	}
 }
 JoystickDevice::~JoystickDevice() noexcept
 {
@@ -94,22 +149,28 @@ std::vector<Capability::Class> JoystickDevice::getCapabilityClasses() const noex
 }
 size_t JoystickDevice::getButtonNr(JoystickCapability::BUTTON eButton) const noexcept
 {
-	auto itFind = std::find(m_aButtonCode.begin(), m_aButtonCode.end(), static_cast<int32_t>(eButton));
-	if (itFind == m_aButtonCode.end()) {
+	const int32_t nIdx = static_cast<int32_t>(eButton) - JoystickCapability::BUTTON_TRIGGER;
+	if ((nIdx < 0) || (nIdx >= JoystickCapability::s_nButtonRange)) {
+		return std::numeric_limits<size_t>::max();
+	}
+	const int32_t nNr = m_aButtonNrOfCode[nIdx];
+	if (nNr < 0) {
 		return std::numeric_limits<size_t>::max();
 	}
-	return std::distance(m_aButtonCode.begin(), itFind);
+	return static_cast<size_t>(nNr);
 }
 size_t JoystickDevice::getAxisNr(JoystickCapability::AXIS eAxis) const noexcept
 {
-	if (isHatAxis(static_cast<int32_t>(eAxis))) {
+	// hat axes are not in the table
+	const int32_t nIdx = static_cast<int32_t>(eAxis) - JoystickCapability::AXIS_X;
+	if ((nIdx < 0) || (nIdx >= JoystickCapability::s_nAxisRange)) {
 		return std::numeric_limits<size_t>::max();
 	}
-	auto itFind = std::find(m_aAxisCode.begin(), m_aAxisCode.end(), static_cast<int32_t>(eAxis));
-	if (itFind == m_aAxisCode.end()) {
+	const int32_t nNr = m_aAxisNrOfCode[nIdx];
+	if (nNr < 0) {
 		return std::numeric_limits<size_t>::max();
 	}
-	return std::distance(m_aAxisCode.begin(), itFind);
+	return static_cast<size_t>(nNr);
 }
 bool JoystickDevice::getHasButton(JoystickCapability::BUTTON eButton) const noexcept
 {
@@ -147,26 +208,114 @@ int32_t JoystickDevice::getAxisValue(JoystickCapability::AXIS eAxis) const noexc
 	}
 	return m_aAxisValue[nNr];
 }
+void JoystickDevice::getState(State& oState) const noexcept
+{
+	oState.m_oButtonPressed.reset();
+	for (int32_t nIdx = 0; nIdx < JoystickCapability::s_nButtonRange; ++nIdx) {
+		const int32_t nNr = m_aButtonNrOfCode[nIdx];
+		if ((nNr >= 0) && m_aButtonPressed[nNr].m_bPressed) {
+			oState.m_oButtonPressed[nIdx] = true;
+		}
+	}
+	for (int32_t nIdx = 0; nIdx < JoystickCapability::s_nAxisRange; ++nIdx) {
+		const int32_t nNr = m_aAxisNrOfCode[nIdx];
+		oState.m_aAxisValue[nIdx] = ((nNr >= 0) ? m_aAxisValue[nNr] : 0);
+	}
+	oState.m_aHatValue.resize(m_nTotHats);
+	for (int32_t nHat = 0; nHat < m_nTotHats; ++nHat) {
+		const auto& oHatStatus = m_aHatStatus[nHat];
+		oState.m_aHatValue[nHat] = calcHatValue(oHatStatus.m_nAxisX, oHatStatus.m_nAxisY);
+	}
+}
 
 bool JoystickDevice::doInputJoystickEventCallback(const struct ::js_event* p0JoyEvent) noexcept
 {
-//std::cout << "JoystickDevice::doInputJoystickEventCallback" << '\n';
+	return doInputJoystickEventsCallback(p0JoyEvent, 1, false);
+}
+bool JoystickDevice::doInputJoystickEventsCallback(const struct ::js_event* p0JoyEvents, int32_t nTotEvents, bool bCoalesceAxes) noexcept
+{
+//std::cout << "JoystickDevice::doInputJoystickEventsCallback" << '\n';
 	const bool bContinue = true;
 	auto refOwner = getOwnerDeviceManager();
 	if (!refOwner) {
 		return !bContinue;
 	}
 	JsGtkDeviceManager* p0Owner = refOwner.get();
-	if (!p0Owner->m_refSelected) {
-		return bContinue; //----------------------------------------------------
+	shared_ptr<JoystickDevice> refThis = shared_from_this();
+	// Kept alive so that the pointer comparison below can't be fooled by a reused address
+	shared_ptr<GtkWindowData> refSelectedData;
+	shared_ptr<GtkAccessor> refSelectedAccessor;
+	// One pass over the events instead of searching the later events for each
+	std::array<int32_t, ABS_CNT> aLastAxisEventIdx;
+	if (bCoalesceAxes) {
+		calcLastAxisEventIdxs(p0JoyEvents, nTotEvents, aLastAxisEventIdx);
+	}
+	for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+		if (m_bRemoved) {
+			// a listener removed the device
+			return !bContinue; //-----------------------------------------------
+		}
+		// a listener might have changed the active window
+		if (p0Owner->m_refSelected != refSelectedData) {
+			refSelectedData = p0Owner->m_refSelected;
+			if (refSelectedData) {
+				refSelectedAccessor = refSelectedData->getAccessor();
+			}
+		}
+		if (!refSelectedData) {
+			return bContinue; //------------------------------------------------
+		}
+		if (bCoalesceAxes && isSupersededAxisEvent(p0JoyEvents[nIdx], nIdx, aLastAxisEventIdx)) {
+			continue; // for
+		}
+		handleJoystickEvent(p0Owner, refSelectedAccessor, refThis, p0JoyEvents[nIdx]);
 	}
-	auto refSelectedAccessor = p0Owner->m_refSelected->getAccessor();
-
-	const int32_t nType = p0JoyEvent->type;
-	const int32_t nNr = p0JoyEvent->number;
-	const int32_t nValue = p0JoyEvent->value;
+	return bContinue;
+}
+bool JoystickDevice::isCoalescableAxisEvent(const struct ::js_event& oJoyEvent) const noexcept
+{
+	if (oJoyEvent.type != JS_EVENT_AXIS) {
+		// init events are never skipped
+		return false; //--------------------------------------------------------
+	}
+	const int32_t nNr = oJoyEvent.number;
+	if ((nNr >= static_cast<int32_t>(m_aAxisCode.size())) || isHatAxis(m_aAxisCode[nNr])) {
+		// hat transitions must not be lost
+		return false; //--------------------------------------------------------
+	}
+	return true;
+}
+void JoystickDevice::calcLastAxisEventIdxs(const struct ::js_event* p0JoyEvents, int32_t nTotEvents
+											, std::array<int32_t, ABS_CNT>& aLastAxisEventIdx) const noexcept
+{
+	const int32_t nTotAxes = static_cast<int32_t>(m_aAxisCode.size());
+	assert(nTotAxes <= ABS_CNT);
+	std::fill(aLastAxisEventIdx.begin(), aLastAxisEventIdx.begin() + nTotAxes, -1);
+	// backwards: the first event found for an axis is its last
+	for (int32_t nIdx = nTotEvents - 1; nIdx >= 0; --nIdx) {
+		const struct ::js_event& oJoyEvent = p0JoyEvents[nIdx];
+		if (!isCoalescableAxisEvent(oJoyEvent)) {
+			continue; // for
+		}
+		int32_t& nLastIdx = aLastAxisEventIdx[oJoyEvent.number];
+		if (nLastIdx < 0) {
+			nLastIdx = nIdx;
+		}
+	}
+}
+bool JoystickDevice::isSupersededAxisEvent(const struct ::js_event& oJoyEvent, int32_t nIdx
+											, const std::array<int32_t, ABS_CNT>& aLastAxisEventIdx) const noexcept
+{
+	return isCoalescableAxisEvent(oJoyEvent) && (aLastAxisEventIdx[oJoyEvent.number] != nIdx);
+}
+void JoystickDevice::handleJoystickEvent(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
+										, const shared_ptr<JoystickDevice>& refThis, const struct ::js_event& oJoyEvent) noexcept
+{
+	const int32_t nType = oJoyEvent.type;
+	const int32_t nNr = oJoyEvent.number;
+	const int32_t nValue = oJoyEvent.value;
 	const bool bInit = ((nType & JS_EVENT_INIT) != 0);
-	shared_ptr<JoystickDevice> refThis = shared_from_this();
+	const int64_t nEventTimeUsec = (bInit ? 0 : p0Owner->m_oJsClockDomain.getTimeUsec(oJoyEvent.time));
 	//
 //std::cout << "---> doInputJoystickEventCallback() Device:" << refThis->getName() << "     type=" << nType << " number=" << nNr << " value=" << nValue << '\n';
 	if ((nType & JS_EVENT_BUTTON) != 0) {
@@ -181,7 +330,7 @@ bool JoystickDevice::doInputJoystickEventCallback(const struct ::js_event* p0Joy
 				oButtonStatus.m_bPressed = false; //(nValue != 0);
 				oButtonStatus.m_nPressedTimeStamp = std::numeric_limits<uint64_t>::max();
 			} else {
-				handleButton(p0Owner, refSelectedAccessor, refThis, nNr, eButton, nValue);
+				handleButton(p0Owner, refSelectedAccessor, refThis, nEventTimeUsec, nNr, eButton, nValue);
 			}
 		} else {
 			//assert(false);
@@ -205,17 +354,23 @@ bool JoystickDevice::doInputJoystickEventCallback(const struct ::js_event* p0Joy
 				}
 				oHatData.m_nPressedTimeStamp = std::numeric_limits<uint64_t>::max();
 			} else {
-				handleHat(p0Owner, refSelectedAccessor, refThis, nHat, bY, nValue);
+				const auto& oHatData = m_aHatStatus[nHat];
+				const int32_t nAxisX = (bY ? oHatData.m_nAxisX : calcHatAxis(nValue));
+				const int32_t nAxisY = (bY ? calcHatAxis(nValue) : oHatData.m_nAxisY);
+				handleHat(p0Owner, refSelectedAccessor, refThis, nEventTimeUsec, nHat, nAxisX, nAxisY);
 			}
 		} else {
 			const JoystickCapability::AXIS eAxis = static_cast<JoystickCapability::AXIS>(nLinuxAxis);
 			if (JoystickCapability::isValidAxis(eAxis)) {
 				// normal axis
+				const int32_t nFilteredValue = applyDeadZone(nNr, nValue);
 				int32_t& nAxisValue = m_aAxisValue[nNr];
-				if (nAxisValue != nValue) {
-					nAxisValue = nValue;
-					if (!bInit) {
-						handleAxis(p0Owner, refSelectedAccessor, refThis, eAxis, nValue);
+				if (nAxisValue != nFilteredValue) {
+					nAxisValue = nFilteredValue;
+					if (bInit) {
+						m_aAxisData[nNr].m_nSentValue = nFilteredValue;
+					} else {
+						handleAxisChange(p0Owner, refSelectedAccessor, refThis, nEventTimeUsec, nNr);
 					}
 				}
 			} else {
@@ -225,16 +380,120 @@ bool JoystickDevice::doInputJoystickEventCallback(const struct ::js_event* p0Joy
 	} else {
 		//assert(false);
 	}
+}
+bool JoystickDevice::doInputEvdevFrameCallback(const struct ::input_event* p0Events, int32_t nTotEvents, int64_t nFrameTimeUsec) noexcept
+{
+	const bool bContinue = true;
+	auto refOwner = getOwnerDeviceManager();
+	if (!refOwner) {
+		return !bContinue;
+	}
+	JsGtkDeviceManager* p0Owner = refOwner.get();
+	if (!p0Owner->m_refSelected) {
+		return bContinue; //----------------------------------------------------
+	}
+	auto refSelectedAccessor = p0Owner->m_refSelected->getAccessor();
+	shared_ptr<JoystickDevice> refThis = shared_from_this();
+	//
+	// The frame is one atomic state update: the new axis values are applied
+	// before any event of the frame is sent and the X and Y axes of a hat
+	// that change in the same frame produce a single JoystickHatEvent.
+	// All the events have the time stamp of the frame.
+	std::array<int32_t, s_nMaxHats> aHatAxisX;
+	std::array<int32_t, s_nMaxHats> aHatAxisY;
+	for (int32_t nHat = 0; nHat < m_nTotHats; ++nHat) {
+		aHatAxisX[nHat] = m_aHatStatus[nHat].m_nAxisX;
+		aHatAxisY[nHat] = m_aHatStatus[nHat].m_nAxisY;
+	}
+	std::array<int32_t, ABS_CNT> aChangedAxisNr;
+	int32_t nTotChangedAxes = 0;
+	for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+		const struct ::input_event& oEvent = p0Events[nIdx];
+		if (oEvent.type != EV_ABS) {
+			continue; // for
+		}
+		const int32_t nLinuxAxis = oEvent.code;
+		if (isHatAxis(nLinuxAxis)) {
+			const int32_t nHatBase = nLinuxAxis - ABS_HAT0X;
+			const int32_t nHat = nHatBase / 2;
+			if (nHat >= m_nTotHats) {
+				continue; // for
+			}
+			if ((nHatBase & 1) != 0) {
+				aHatAxisY[nHat] = calcHatAxis(oEvent.value);
+			} else {
+				aHatAxisX[nHat] = calcHatAxis(oEvent.value);
+			}
+			continue; // for
+		}
+		const JoystickCapability::AXIS eAxis = static_cast<JoystickCapability::AXIS>(nLinuxAxis);
+		const size_t nNr = getAxisNr(eAxis);
+		if ((nNr == std::numeric_limits<size_t>::max()) || !JoystickCapability::isValidAxis(eAxis)) {
+			continue; // for
+		}
+		const int32_t nValue = applyDeadZone(static_cast<int32_t>(nNr), normalizeAxisValue(static_cast<int32_t>(nNr), oEvent.value));
+		int32_t& nAxisValue = m_aAxisValue[nNr];
+		if (nAxisValue == nValue) {
+			continue; // for
+		}
+		nAxisValue = nValue;
+		if (std::find(aChangedAxisNr.begin(), aChangedAxisNr.begin() + nTotChangedAxes, static_cast<int32_t>(nNr))
+				== aChangedAxisNr.begin() + nTotChangedAxes) {
+			aChangedAxisNr[nTotChangedAxes] = static_cast<int32_t>(nNr);
+			++nTotChangedAxes;
+		}
+	}
+	for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+		const struct ::input_event& oEvent = p0Events[nIdx];
+		if (oEvent.type != EV_KEY) {
+			continue; // for
+		}
+		const JoystickCapability::BUTTON eButton = static_cast<JoystickCapability::BUTTON>(oEvent.code);
+		const size_t nNr = getButtonNr(eButton);
+		if ((nNr == std::numeric_limits<size_t>::max()) || !JoystickCapability::isValidButton(eButton)) {
+			continue; // for
+		}
+		// evdev also sends autorepeat (value 2) and, after a resynchronization, unchanged values
+		if (m_aButtonPressed[nNr].m_bPressed == (oEvent.value != 0)) {
+			continue; // for
+		}
+		handleButton(p0Owner, refSelectedAccessor, refThis, nFrameTimeUsec, static_cast<int32_t>(nNr), eButton, oEvent.value);
+	}
+	for (int32_t nHat = 0; nHat < m_nTotHats; ++nHat) {
+		handleHat(p0Owner, refSelectedAccessor, refThis, nFrameTimeUsec, nHat, aHatAxisX[nHat], aHatAxisY[nHat]);
+	}
+	for (int32_t nChanged = 0; nChanged < nTotChangedAxes; ++nChanged) {
+		handleAxisChange(p0Owner, refSelectedAccessor, refThis, nFrameTimeUsec, aChangedAxisNr[nChanged]);
+	}
 	return bContinue;
 }
+int32_t JoystickDevice::normalizeAxisValue(int32_t nNr, int32_t nValue) const noexcept
+{
+	if (m_aAbsInfo.empty()) {
+		return nValue; //-------------------------------------------------------
+	}
+	const JoystickAbsInfo& oAbsInfo = m_aAbsInfo[nNr];
+	const int64_t nRange = static_cast<int64_t>(oAbsInfo.m_nMax) - oAbsInfo.m_nMin;
+	if (nRange <= 0) {
+		return 0; //------------------------------------------------------------
+	}
+	// the center multiplied by 2 to avoid rounding
+	const int64_t nCenter2 = static_cast<int64_t>(oAbsInfo.m_nMax) + oAbsInfo.m_nMin;
+	const int64_t nDelta2 = 2 * static_cast<int64_t>(nValue) - nCenter2;
+	if (std::abs(nDelta2) <= 2 * static_cast<int64_t>(oAbsInfo.m_nFlat)) {
+		return 0; //------------------------------------------------------------
+	}
+	const int64_t nNormalized = nDelta2 * 32767 / nRange;
+	return static_cast<int32_t>(std::max<int64_t>(-32767, std::min<int64_t>(32767, nNormalized)));
+}
 void JoystickDevice::handleButton(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
-									, const shared_ptr<JoystickCapability>& refThis
+									, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec
 									, int32_t nNr, JoystickCapability::BUTTON eButton, int32_t nValue) noexcept
 {
-	if (!p0Owner->isEventClassEnabled(Event::Class{typeid(JoystickButtonEvent)})) {
+	if (!p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxJoystickButtonEvent)) {
 		return;
 	}
-	auto refListeners = p0Owner->getListeners();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxJoystickButtonEvent);
 	//
 	ButtonData& oButtonStatus = m_aButtonPressed[nNr];
 	const bool bButtonWasPressed = oButtonStatus.m_bPressed;
@@ -247,7 +506,6 @@ void JoystickDevice::handleButton(JsGtkDeviceManager* p0Owner, const shared_ptr<
 			// Send a cancel
 			oButtonStatus.m_bPressed = false;
 			shared_ptr<Event> refEvent;
-			const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 			for (auto& p0ListenerData : *refListeners) {
 				sendButtonEventToListener(*p0ListenerData, nEventTimeUsec, refSelectedAccessor, nWasPressedTimeStamp, JoystickButtonEvent::BUTTON_RELEASE_CANCEL
 											, eButton, refThis, p0Owner->m_nClassIdxJoystickButtonEvent, refEvent);
@@ -268,26 +526,18 @@ void JoystickDevice::handleButton(JsGtkDeviceManager* p0Owner, const shared_ptr<
 	}
 	//
 	shared_ptr<Event> refEvent;
-	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 	for (auto& p0ListenerData : *refListeners) {
 		sendButtonEventToListener(*p0ListenerData, nEventTimeUsec, refSelectedAccessor, nPressedTimeStamp, eInputType, eButton
 									, refThis, p0Owner->m_nClassIdxJoystickButtonEvent, refEvent);
 	}
 }
 void JoystickDevice::handleHat(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
-								, const shared_ptr<JoystickCapability>& refThis
-								, int32_t nHat, bool bY, int32_t nValue) noexcept
+								, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec
+								, int32_t nHat, int32_t nAxisX, int32_t nAxisY) noexcept
 {
 //std::cout << "JoystickDevice::handleHat" << '\n';
 	auto& oHatData = m_aHatStatus[nHat];
-	int32_t nAxisX = oHatData.m_nAxisX;
-	int32_t nAxisY = oHatData.m_nAxisY;
-	const auto eOldValue = calcHatValue(nAxisX, nAxisY);
-	if (bY) {
-		nAxisY = ((nValue == 0) ? 0 : ((nValue < 0) ? 1 : 2));
-	} else {
-		nAxisX = ((nValue == 0) ? 0 : ((nValue < 0) ? 1 : 2));
-	}
+	const auto eOldValue = calcHatValue(oHatData.m_nAxisX, oHatData.m_nAxisY);
 	// Y\X| 1 | 0 | 2
 	// ---|-----------
 	//  1 | 5   4   6
@@ -301,7 +551,6 @@ void JoystickDevice::handleHat(JsGtkDeviceManager* p0Owner, const shared_ptr<Gtk
 		// no change
 		return;
 	}
-	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 	const bool bWasPressed = (eOldValue != JoystickCapability::HAT_CENTER);
 	const bool bIsPressed = (eValue != JoystickCapability::HAT_CENTER);
 	if (bIsPressed) {
@@ -312,7 +561,7 @@ void JoystickDevice::handleHat(JsGtkDeviceManager* p0Owner, const shared_ptr<Gtk
 	oHatData.m_nAxisX = nAxisX;
 	oHatData.m_nAxisY = nAxisY;
 	//
-	if (!p0Owner->isEventClassEnabled(Event::Class{typeid(JoystickHatEvent)})) {
+	if (!p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxJoystickHatEvent)) {
 		// Unlike handleButton and handleAxis this type keeps track of the state
 		// of the hats despite the JoystickHatEvent type not being enabled.
 		// This is done because otherwise key simulation would be inconsistent.
@@ -325,7 +574,7 @@ void JoystickDevice::handleHat(JsGtkDeviceManager* p0Owner, const shared_ptr<Gtk
 		return; //--------------------------------------------------------------
 	}
 	//
-	auto refListeners = p0Owner->getListeners();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxJoystickHatEvent);
 	shared_ptr<Event> refEvent;
 	for (auto& p0ListenerData : *refListeners) {
 		sendHatEventToListener(*p0ListenerData, nEventTimeUsec, refSelectedAccessor, oHatData.m_nPressedTimeStamp
@@ -336,15 +585,114 @@ void JoystickDevice::handleHat(JsGtkDeviceManager* p0Owner, const shared_ptr<Gtk
 		oHatData.m_nPressedTimeStamp = std::numeric_limits<uint64_t>::max();
 	}
 }
+void JoystickDevice::setAxisFilter(JoystickCapability::AXIS eAxis, const JsDeviceFiles::AxisFilter& oAxisFilter) noexcept
+{
+	const size_t nNr = getAxisNr(eAxis);
+	if (nNr == std::numeric_limits<size_t>::max()) {
+		return; //--------------------------------------------------------------
+	}
+	AxisData& oAxisData = m_aAxisData[nNr];
+	oAxisData.m_nDeadZone = std::max(oAxisFilter.m_nDeadZone, 0);
+	oAxisData.m_nMinDelta = std::max(oAxisFilter.m_nMinDelta, 0);
+	oAxisData.m_nMinIntervalUsec = ((oAxisFilter.m_nMaxRate > 0) ? (1000000 / oAxisFilter.m_nMaxRate) : 0);
+}
+int32_t JoystickDevice::applyDeadZone(int32_t nNr, int32_t nValue) const noexcept
+{
+	return ((std::abs(nValue) <= m_aAxisData[nNr].m_nDeadZone) ? 0 : nValue);
+}
+void JoystickDevice::handleAxisChange(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
+									, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec, int32_t nNr) noexcept
+{
+	AxisData& oAxisData = m_aAxisData[nNr];
+	const int32_t nValue = m_aAxisValue[nNr];
+	// the return to 0 is always sent
+	if ((nValue == oAxisData.m_nSentValue)
+			|| ((nValue != 0) && (std::abs(nValue - oAxisData.m_nSentValue) < oAxisData.m_nMinDelta))) {
+		// not (or no longer) worth sending
+		oAxisData.m_bPending = false;
+		return; //--------------------------------------------------------------
+	}
+	if (nEventTimeUsec < oAxisData.m_nNextSendTimeUsec) {
+		// too soon, the latest value is sent at the end of the interval
+		oAxisData.m_bPending = true;
+		scheduleAxisFlush(nEventTimeUsec, oAxisData.m_nNextSendTimeUsec);
+		return; //--------------------------------------------------------------
+	}
+	sendAxis(p0Owner, refSelectedAccessor, refThis, nEventTimeUsec, nNr);
+}
+void JoystickDevice::sendAxis(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
+							, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec, int32_t nNr) noexcept
+{
+	AxisData& oAxisData = m_aAxisData[nNr];
+	const int32_t nValue = m_aAxisValue[nNr];
+	oAxisData.m_nSentValue = nValue;
+	oAxisData.m_nNextSendTimeUsec = nEventTimeUsec + oAxisData.m_nMinIntervalUsec;
+	oAxisData.m_bPending = false;
+	const JoystickCapability::AXIS eAxis = static_cast<JoystickCapability::AXIS>(m_aAxisCode[nNr]);
+	handleAxis(p0Owner, refSelectedAccessor, refThis, nEventTimeUsec, eAxis, nValue);
+}
+void JoystickDevice::scheduleAxisFlush(int64_t nEventTimeUsec, int64_t nFlushTimeUsec) noexcept
+{
+	if (m_oAxisFlushConn.connected()) {
+		if (m_nAxisFlushTimeUsec <= nFlushTimeUsec) {
+			// when it fires it reschedules for the values still pending
+			return; //----------------------------------------------------------
+		}
+		// an axis with a shorter interval must not wait for the scheduled one
+		m_oAxisFlushConn.disconnect();
+	}
+	m_nAxisFlushTimeUsec = nFlushTimeUsec;
+	const int64_t nDelayUsec = nFlushTimeUsec - nEventTimeUsec;
+	const int32_t nDelayMillisec = std::max<int32_t>(1, static_cast<int32_t>((nDelayUsec + 999) / 1000));
+	m_oAxisFlushConn = Glib::signal_timeout().connect(sigc::mem_fun(this, &JoystickDevice::doAxisFlushTimeout), nDelayMillisec);
+}
+bool JoystickDevice::doAxisFlushTimeout() noexcept
+{
+	// this timeout source is destroyed by returning false, a new one is created if needed
+	const bool bContinue = false;
+	m_oAxisFlushConn = sigc::connection{};
+	auto refOwner = getOwnerDeviceManager();
+	if (!refOwner) {
+		return bContinue; //----------------------------------------------------
+	}
+	JsGtkDeviceManager* p0Owner = refOwner.get();
+	shared_ptr<JoystickDevice> refThis = shared_from_this();
+	// The timeout measured the delay from the event that scheduled it,
+	// so this is the current time in the time base of the events
+	const int64_t nFlushTimeUsec = m_nAxisFlushTimeUsec;
+	int64_t nMinNextSendTimeUsec = std::numeric_limits<int64_t>::max();
+	const int32_t nTotAxes = static_cast<int32_t>(m_aAxisData.size());
+	for (int32_t nNr = 0; nNr < nTotAxes; ++nNr) {
+		AxisData& oAxisData = m_aAxisData[nNr];
+		if (!oAxisData.m_bPending) {
+			continue; // for
+		}
+		// a listener might have removed the device or changed the active window
+		if (m_bRemoved || !p0Owner->m_refSelected) {
+			oAxisData.m_bPending = false;
+			continue; // for
+		}
+		if (nFlushTimeUsec < oAxisData.m_nNextSendTimeUsec) {
+			nMinNextSendTimeUsec = std::min(nMinNextSendTimeUsec, oAxisData.m_nNextSendTimeUsec);
+			continue; // for
+		}
+		const shared_ptr<GtkAccessor> refSelectedAccessor = p0Owner->m_refSelected->getAccessor();
+		// the value is sent at the end of its interval
+		sendAxis(p0Owner, refSelectedAccessor, refThis, oAxisData.m_nNextSendTimeUsec, nNr);
+	}
+	if (nMinNextSendTimeUsec != std::numeric_limits<int64_t>::max()) {
+		scheduleAxisFlush(nFlushTimeUsec, nMinNextSendTimeUsec);
+	}
+	return bContinue;
+}
 void JoystickDevice::handleAxis(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
-								, const shared_ptr<JoystickCapability>& refThis
+								, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec
 								, JoystickCapability::AXIS eAxis, int32_t nValue) noexcept
 {
-	if (!p0Owner->isEventClassEnabled(Event::Class{typeid(JoystickAxisEvent)})) {
+	if (!p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxJoystickAxisEvent)) {
 		return; //--------------------------------------------------------------
 	}
-	auto refListeners = p0Owner->getListeners();
-	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxJoystickAxisEvent);
 	shared_ptr<Event> refEvent;
 	for (auto& p0ListenerData : *refListeners) {
 		if (!refEvent) {
@@ -367,10 +715,10 @@ void JoystickDevice::finalizeListener(JsGtkDeviceManager::ListenerData& oListene
 	}
 	auto refSelectedAccessor = refSelected->getAccessor();
 	shared_ptr<JoystickDevice> refThis = shared_from_this();
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(JoystickButtonEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxJoystickButtonEvent)) {
 		finalizeListenerButton(oListenerData, nEventTimeUsec, refThis, p0Owner->m_nClassIdxJoystickButtonEvent, refSelectedAccessor);
 	}
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(JoystickHatEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxJoystickHatEvent)) {
 		finalizeListenerHat(oListenerData, nEventTimeUsec, refThis, p0Owner->m_nClassIdxJoystickHatEvent, refSelectedAccessor);
 	}
 }
@@ -446,6 +794,7 @@ void JoystickDevice::finalizeListenerHat(JsGtkDeviceManager::ListenerData& oList
 }
 void JoystickDevice::removingDevice() noexcept
 {
+	m_bRemoved = true;
 	resetOwnerDeviceManager();
 }
 void JoystickDevice::cancelSelectedAccessorButtonsAndHats() noexcept
@@ -462,18 +811,19 @@ void JoystickDevice::cancelSelectedAccessorButtonsAndHats() noexcept
 	auto refSelectedAccessor = refSelected->getAccessor();
 	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 
-	auto refListeners = p0Owner->getListeners();
 	shared_ptr<JoystickDevice> refThis = shared_from_this();
 
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(JoystickButtonEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxJoystickButtonEvent)) {
+		auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxJoystickButtonEvent);
 		cancelSelectedAccessorButtons(refThis, refListeners, nEventTimeUsec, refSelectedAccessor, p0Owner);
 	}
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(JoystickHatEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxJoystickHatEvent)) {
+		auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxJoystickHatEvent);
 		cancelSelectedAccessorHats(refThis, refListeners, nEventTimeUsec, refSelectedAccessor, p0Owner);
 	}
 }
 void JoystickDevice::cancelSelectedAccessorButtons(const shared_ptr<JoystickCapability>& refCapability
-												, const shared_ptr< const std::list< JsGtkDeviceManager::ListenerData* > >& refListeners
+												, const shared_ptr< const std::vector< JsGtkDeviceManager::ListenerData* > >& refListeners
 												, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 												, JsGtkDeviceManager* p0Owner) noexcept
 {
@@ -508,7 +858,7 @@ void JoystickDevice::cancelSelectedAccessorButtons(const shared_ptr<JoystickCapa
 	std::fill(m_aButtonPressed.begin(), m_aButtonPressed.end(), ButtonData{false, std::numeric_limits<int64_t>::max()});
 }
 void JoystickDevice::cancelSelectedAccessorHats(const shared_ptr<JoystickCapability>& refCapability
-												, const shared_ptr< const std::list< JsGtkDeviceManager::ListenerData* > >& refListeners
+												, const shared_ptr< const std::vector< JsGtkDeviceManager::ListenerData* > >& refListeners
 												, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 												, JsGtkDeviceManager* p0Owner) noexcept
 {
@@ -24,6 +24,7 @@
 #include "jsgtkdevicemanager.h"
 
 #include "recycler.h"
+#include "jsdevicefiles.h"
 
 #include <stmm-input-ev/joystickcapability.h>
 #include <stmm-input-ev/joystickevent.h>
@@ -31,6 +32,7 @@
 #include <stmm-input/capability.h>
 #include <stmm-input/device.h>
 
+#include <array>
 #include <list>
 #include <memory>
 #include <string>
@@ -41,6 +43,8 @@
 
 #include <linux/joystick.h>
 
+struct input_event;
+
 namespace stmi { class Accessor; }
 namespace stmi { class Event; }
 namespace stmi { class GtkAccessor; }
@@ -57,12 +61,24 @@ namespace Js
 using std::shared_ptr;
 using std::weak_ptr;
 
+/* The range of an evdev absolute axis (see struct input_absinfo). */
+struct JoystickAbsInfo
+{
+	int32_t m_nValue; // The value when the device was opened
+	int32_t m_nMin;
+	int32_t m_nMax;
+	int32_t m_nFlat; // Values within this distance from the center are reported as 0
+};
+
 class JoystickDevice final : public BasicDevice<JsGtkDeviceManager>, public JoystickCapability
 						, public std::enable_shared_from_this<JoystickDevice>, public sigc::trackable
 {
 public:
+	// aAbsInfo is either empty (<linux/joystick.h> device, axis values already normalized)
+	// or has the same size as aAxisCode (evdev device)
 	JoystickDevice(const std::string& sName, const shared_ptr<JsGtkDeviceManager>& refDeviceManager
-					, const std::vector<int32_t>& aButtonCode, int32_t nTotHats, const std::vector<int32_t>& aAxisCode) noexcept;
+					, const std::vector<int32_t>& aButtonCode, int32_t nTotHats, const std::vector<int32_t>& aAxisCode
+					, const std::vector<JoystickAbsInfo>& aAbsInfo) noexcept;
 	virtual ~JoystickDevice() noexcept;
 	//
 	shared_ptr<Capability> getCapability(const Capability::Class& oClass) const noexcept override;
@@ -78,6 +94,7 @@ public:
 	bool isButtonPressed(JoystickCapability::BUTTON eButton) const noexcept override;
 	HAT_VALUE getHatValue(int32_t nHat) const noexcept override;
 	int32_t getAxisValue(JoystickCapability::AXIS eAxis) const noexcept override;
+	void getState(State& oState) const noexcept override;
 
 	inline int32_t getDeviceId() const noexcept { return Device::getId(); }
 
@@ -88,6 +105,14 @@ public:
 
 	// This is public so that there's no need to friend GtkBackend (or even FakeGtkBackend)
 	bool doInputJoystickEventCallback(const struct ::js_event* p0JoyEvent) noexcept;
+	// The events of a read. The per-read setup is done once for all events.
+	// If bCoalesceAxes, an axis event followed by another event of the same (non hat)
+	// axis is skipped: only the latest value is sent.
+	bool doInputJoystickEventsCallback(const struct ::js_event* p0JoyEvents, int32_t nTotEvents, bool bCoalesceAxes) noexcept;
+	// Must be called before the first event. Hats are not filtered.
+	void setAxisFilter(JoystickCapability::AXIS eAxis, const JsDeviceFiles::AxisFilter& oAxisFilter) noexcept;
+	// The events of an evdev SYN_REPORT frame
+	bool doInputEvdevFrameCallback(const struct ::input_event* p0Events, int32_t nTotEvents, int64_t nFrameTimeUsec) noexcept;
 private:
 	size_t getButtonNr(JoystickCapability::BUTTON eButton) const noexcept;
 	size_t getAxisNr(JoystickCapability::AXIS eAxis) const noexcept;
@@ -95,11 +120,11 @@ private:
 	friend class stmi::JsGtkDeviceManager;
 	void cancelSelectedAccessorButtonsAndHats() noexcept;
 	void cancelSelectedAccessorButtons(const shared_ptr<JoystickCapability>& refCapability
-										, const shared_ptr< const std::list< JsGtkDeviceManager::ListenerData* > >& refListeners
+										, const shared_ptr< const std::vector< JsGtkDeviceManager::ListenerData* > >& refListeners
 										, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 										, JsGtkDeviceManager* p0Owner) noexcept;
 	void cancelSelectedAccessorHats(const shared_ptr<JoystickCapability>& refCapability
-									, const shared_ptr< const std::list< JsGtkDeviceManager::ListenerData* > >& refListeners
+									, const shared_ptr< const std::vector< JsGtkDeviceManager::ListenerData* > >& refListeners
 									, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 									, JsGtkDeviceManager* p0Owner) noexcept;
 	void finalizeListener(JsGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec) noexcept;
@@ -111,15 +136,43 @@ private:
 								, const shared_ptr<GtkAccessor>& refSelectedAccessor) noexcept;
 	void removingDevice() noexcept;
 	//
+	// Whether only the latest value of the axis of the event is needed (non init, non hat axis event)
+	bool isCoalescableAxisEvent(const struct ::js_event& oJoyEvent) const noexcept;
+	// Sets the index of the last coalescable event of each axis within the events (-1 if none)
+	void calcLastAxisEventIdxs(const struct ::js_event* p0JoyEvents, int32_t nTotEvents
+								, std::array<int32_t, ABS_CNT>& aLastAxisEventIdx) const noexcept;
+	bool isSupersededAxisEvent(const struct ::js_event& oJoyEvent, int32_t nIdx
+								, const std::array<int32_t, ABS_CNT>& aLastAxisEventIdx) const noexcept;
+	void handleJoystickEvent(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
+							, const shared_ptr<JoystickDevice>& refThis, const struct ::js_event& oJoyEvent) noexcept;
 	void handleButton(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
-					, const shared_ptr<JoystickCapability>& refThis
+					, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec
 					, int32_t nNr, JoystickCapability::BUTTON eButton, int32_t nValue) noexcept;
 	void handleHat(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
-					, const shared_ptr<JoystickCapability>& refThis
-					, int32_t nHat, bool bY, int32_t nValue) noexcept;
+					, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec
+					, int32_t nHat, int32_t nAxisX, int32_t nAxisY) noexcept;
 	void handleAxis(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
-					, const shared_ptr<JoystickCapability>& refThis
+					, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec
 					, JoystickCapability::AXIS eAxis, int32_t nValue) noexcept;
+	// Applies the filter of the axis to the changed m_aAxisValue[nNr]
+	void handleAxisChange(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
+						, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec, int32_t nNr) noexcept;
+	void sendAxis(JsGtkDeviceManager* p0Owner, const shared_ptr<GtkAccessor>& refSelectedAccessor
+					, const shared_ptr<JoystickCapability>& refThis, int64_t nEventTimeUsec, int32_t nNr) noexcept;
+	// Both times are in the time base of the events (see ClockDomain)
+	void scheduleAxisFlush(int64_t nEventTimeUsec, int64_t nFlushTimeUsec) noexcept;
+	// Sends the rate limited axis values whose interval has ended.
+	// They get the time stamp of the end of the interval, not the current time,
+	// so that they are in the same time base as the events sent directly.
+	bool doAxisFlushTimeout() noexcept;
+	int32_t applyDeadZone(int32_t nNr, int32_t nValue) const noexcept;
+	// Maps an evdev axis value to [-32767, 32767]
+	int32_t normalizeAxisValue(int32_t nNr, int32_t nValue) const noexcept;
+	// The hat axis position (see calcHatValue) from the value of the axis
+	static inline int32_t calcHatAxis(int32_t nValue) noexcept
+	{
+		return ((nValue == 0) ? 0 : ((nValue < 0) ? 1 : 2));
+	}
 	//
 	void sendButtonEventToListener(const JsGtkDeviceManager::ListenerData& oListenerData
 									, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refAccessor
@@ -150,6 +203,8 @@ private:
 	};
 	const std::vector<int32_t> m_aButtonCode; // Size: tot buttons provided by ioctl, Value: the enum JoystickCapability::BUTTON
 	std::vector< ButtonData > m_aButtonPressed; // Size: m_aButtonCode.size()
+	// Index: eButton - JoystickCapability::BUTTON_TRIGGER, Value: index into m_aButtonCode or -1 if not present
+	std::array<int16_t, JoystickCapability::s_nButtonRange> m_aButtonNrOfCode;
 	struct HatData
 	{
 		uint64_t m_nPressedTimeStamp; // last transition from JoystickCapability::HAT_CENTER (0,0) to anything else
@@ -162,6 +217,22 @@ private:
 	//
 	const std::vector<int32_t> m_aAxisCode; // Size: tot axes provided by ioctl, Value: the enum JoystickCapability::AXIS
 	std::vector< int32_t > m_aAxisValue; // Size: m_aAxisCode.size(), Value: current axis value [-32767, 32767]
+	// Index: eAxis - JoystickCapability::AXIS_X, Value: index into m_aAxisCode or -1 if not present or a hat axis
+	std::array<int16_t, JoystickCapability::s_nAxisRange> m_aAxisNrOfCode;
+	const std::vector<JoystickAbsInfo> m_aAbsInfo; // Size: m_aAxisCode.size() if evdev device, 0 otherwise
+	struct AxisData
+	{
+		int32_t m_nDeadZone;
+		int32_t m_nMinDelta;
+		int64_t m_nMinIntervalUsec; // 0 if the rate isn't limited
+		int32_t m_nSentValue; // The last value sent to the listeners
+		int64_t m_nNextSendTimeUsec; // The rate limit allows sending from this time
+		bool m_bPending; // Whether m_aAxisValue has a value that will be sent when the interval ends
+	};
+	std::vector< AxisData > m_aAxisData; // Size: m_aAxisCode.size()
+	sigc::connection m_oAxisFlushConn; // The timeout for the pending values
+	int64_t m_nAxisFlushTimeUsec; // The event time corresponding to when m_oAxisFlushConn fires
+	bool m_bRemoved; // Whether removingDevice() was called
 	//
 	class ReJoystickHatEvent :public JoystickHatEvent
 	{
@@ -56,10 +56,11 @@ using Private::Mas::MasGtkListenerExtraData;
 
 std::pair<shared_ptr<MasGtkDeviceManager>, std::string> MasGtkDeviceManager::create(bool bEnableEventClasses, const std::vector<Event::Class>& aEnDisableEventClasses
 																					, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter
-																					, const Glib::RefPtr<Gdk::DeviceManager>& refGdkDeviceManager) noexcept
+																					, const Glib::RefPtr<Gdk::DeviceManager>& refGdkDeviceManager
+																					, bool bCoalescePointerMotion) noexcept
 {
 	shared_ptr<MasGtkDeviceManager> refInstance(new MasGtkDeviceManager(bEnableEventClasses, aEnDisableEventClasses
-																		, eKeyRepeatMode, refGdkConverter));
+																		, eKeyRepeatMode, refGdkConverter, bCoalescePointerMotion));
 	auto refBackend = std::make_unique<GtkBackend>(refInstance.operator->(), refGdkDeviceManager);
 	auto refFactory = std::make_unique<GtkWindowDataFactory>();
 	refInstance->init(refFactory, refBackend);
@@ -67,20 +68,24 @@ std::pair<shared_ptr<MasGtkDeviceManager>, std::string> MasGtkDeviceManager::cre
 }
 
 MasGtkDeviceManager::MasGtkDeviceManager(bool bEnableEventClasses, const std::vector<Event::Class>& aEnDisableEventClasses
-										, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter) noexcept
+										, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter
+										, bool bCoalescePointerMotion) noexcept
 : StdDeviceManager({Capability::Class{typeid(KeyCapability)}, Capability::Class{typeid(PointerCapability)}
 						, Capability::Class{typeid(TouchCapability)}}
 					, {Event::Class{typeid(DeviceMgmtEvent)}, Event::Class{typeid(KeyEvent)}, Event::Class{typeid(PointerEvent)}
-						, Event::Class{typeid(PointerScrollEvent)}, Event::Class{typeid(TouchEvent)}}
+						, Event::Class{typeid(PointerScrollEvent)}, Event::Class{typeid(TouchEvent)}
+						, Event::Class{typeid(TouchFrameEvent)}}
 					, bEnableEventClasses, aEnDisableEventClasses)
 , m_nCancelingNestedDepth(0)
 , m_eKeyRepeatMode((eKeyRepeatMode == KeyRepeat::MODE_NOT_SET) ? KeyRepeat::getMode() : eKeyRepeatMode)
+, m_bCoalescePointerMotion(bCoalescePointerMotion)
 , m_refGdkConverter(refGdkConverter ? refGdkConverter : GdkKeyConverter::getConverter())
 , m_oConverter(*m_refGdkConverter)
 , m_nClassIdxKeyEvent(getEventClassIndex(Event::Class{typeid(KeyEvent)}))
 , m_nClassIdxPointerEvent(getEventClassIndex(Event::Class{typeid(PointerEvent)}))
 , m_nClassIdxPointerScrollEvent(getEventClassIndex(Event::Class{typeid(PointerScrollEvent)}))
 , m_nClassIdxTouchEvent(getEventClassIndex(Event::Class{typeid(TouchEvent)}))
+, m_nClassIdxTouchFrameEvent(getEventClassIndex(Event::Class{typeid(TouchFrameEvent)}))
 {
 	assert(m_refGdkConverter);
 	assert((m_eKeyRepeatMode >= KeyRepeat::MODE_SUPPRESS) && (m_eKeyRepeatMode <= KeyRepeat::MODE_ADD_RELEASE_CANCEL));
@@ -394,12 +399,25 @@ void MasGtkDeviceManager::onIsActiveChanged(const shared_ptr<GtkWindowData>& ref
 		}
 	}
 }
+bool MasGtkDeviceManager::flushPendingPointerMotion(const shared_ptr<GtkWindowData>& refWindowData) noexcept
+{
+	if (!m_refPointerDevice) {
+		return true;
+	}
+	// The coalesced motion received before the event has to be sent first
+	m_refPointerDevice->flushPendingMotion();
+	// A listener might have removed the accessor
+	return refWindowData->isEnabled();
+}
 bool MasGtkDeviceManager::onKeyPress(GdkEventKey* p0KeyEv, const shared_ptr<GtkWindowData>& refWindowData) noexcept
 {
 //std::cout << "MasGtkDeviceManager::onKeyPress 0 " << p0KeyEv->keyval << '\n';
 	if (!m_refKeyboardDevice) {
 		return false;
 	}
+	if (!flushPendingPointerMotion(refWindowData)) {
+		return false;
+	}
 	assert(refWindowData->getAccessor());
 	m_refKeyboardDevice->handleGdkEventKey(p0KeyEv, refWindowData);
 	return false; // propagate
@@ -410,6 +428,9 @@ bool MasGtkDeviceManager::onKeyRelease(GdkEventKey* p0KeyEv, const shared_ptr<Gt
 	if (!m_refKeyboardDevice) {
 		return false;
 	}
+	if (!flushPendingPointerMotion(refWindowData)) {
+		return false;
+	}
 	assert(refWindowData->getAccessor());
 	m_refKeyboardDevice->handleGdkEventKey(p0KeyEv, refWindowData);
 	return false;
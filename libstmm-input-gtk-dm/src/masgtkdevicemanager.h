@@ -24,7 +24,7 @@
 #include <stmm-input-gtk/keyrepeatmode.h>
 
 #include <stmm-input-ev/stddevicemanager.h>
-
+#include <stmm-input-base/clockdomain.h>
 
 #include <stmm-input/event.h>
 
@@ -63,7 +63,7 @@ namespace Mas
  * An instance only handles the devices of one Gdk::Display's device manager.
  *
  * An event (of type stmi::KeyEvent, stmi::PointerEvent, stmi::PointerScrollEvent,
- * or stmi::TouchEvent) sent to listeners by this device manager is tied
+ * stmi::TouchEvent or stmi::TouchFrameEvent) sent to listeners by this device manager is tied
  * to a Gtk::Window, which has to be added with MasGtkDeviceManager::addAccessor()
  * wrapped in a stmi::GtkAccessor.
  * Events are only sent to the currently active window. When the active window changes
@@ -82,21 +82,27 @@ public:
 	 * MasGtkDeviceManager doesn't allow disabling event classes once constructed, only enabling.
 	 *
 	 * Example: To enable all the event classes supported by this instance (currently stmi::KeyEvent, stmi::PointerEvent,
-	 * stmi::PointerScrollEvent, stmi::TouchEvent and stmi::DeviceMgmtEvent) pass
+	 * stmi::PointerScrollEvent, stmi::TouchEvent, stmi::TouchFrameEvent and stmi::DeviceMgmtEvent) pass
 	 *
 	 *     bEnableEventClasses = false,  aEnDisableEventClasses = {}
 	 *
+	 * stmi::TouchFrameEvent repeats the contacts already sent with stmi::TouchEvent:
+	 * listeners that only want one of the two should be added with a stmi::CallIf
+	 * (ex. stmi::CallIfEventClass) selecting it.
+	 *
 	 * @param bEnableEventClasses Whether to enable or disable all but aEnDisableEventClasses.
 	 * @param aEnDisableEventClasses The event classes to be enabled or disabled according to bEnableEventClasses.
 	 * @param eKeyRepeatMode Key repeat translation type.
 	 * @param refGdkConverter refGdkConverter The gdk key event to hardware key converter. Cannot be null.
 	 * @param refGdkDeviceManager The backend gdk device manager. Can be null.
+	 * @param bCoalescePointerMotion Whether the pointer motions of a main loop iteration are sent as one event.
 	 * @return The created device manager and an empty string or null and an error if creation failed.
 	 */
 	static std::pair<shared_ptr<MasGtkDeviceManager>, std::string> create(bool bEnableEventClasses
 											, const std::vector<Event::Class>& aEnDisableEventClasses
 											, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter
-											, const Glib::RefPtr<Gdk::DeviceManager>& refGdkDeviceManager) noexcept;
+											, const Glib::RefPtr<Gdk::DeviceManager>& refGdkDeviceManager
+											, bool bCoalescePointerMotion) noexcept;
 
 	virtual ~MasGtkDeviceManager() noexcept;
 
@@ -131,7 +137,8 @@ protected:
 	void finalizeListener(ListenerData& oListenerData) noexcept override;
 	/** Constructor. */
 	MasGtkDeviceManager(bool bEnableEventClasses, const std::vector<Event::Class>& aEnDisableEventClasses
-						, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter) noexcept;
+						, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter
+						, bool bCoalescePointerMotion) noexcept;
 	/** Initializes the device manager. */
 	void init(std::unique_ptr<Private::Mas::GtkWindowDataFactory>& refFactory
 			, std::unique_ptr<Private::Mas::GtkBackend>& refBackend) noexcept;
@@ -141,6 +148,9 @@ private:
 	void onDevicePairAdded() noexcept;
 	void onDevicePairRemoved() noexcept;
 
+	// Sends the coalesced pointer motion, if any, before an event of another device.
+	// Returns false if the accessor of refWindowData was removed by a listener.
+	bool flushPendingPointerMotion(const shared_ptr<Private::Mas::GtkWindowData>& refWindowData) noexcept;
 	bool onKeyPress(GdkEventKey* p0KeyEv, const shared_ptr<Private::Mas::GtkWindowData>& refWindowData) noexcept;
 	bool onKeyRelease(GdkEventKey* p0KeyEv, const shared_ptr<Private::Mas::GtkWindowData>& refWindowData) noexcept;
 
@@ -190,6 +200,8 @@ private:
 	shared_ptr<Private::Mas::GtkKeyboardDevice> m_refKeyboardDevice;
 	shared_ptr<Private::Mas::GtkPointerDevice> m_refPointerDevice;
 	KeyRepeat::MODE m_eKeyRepeatMode;
+	// Whether the pointer motions are sent once per main loop iteration
+	const bool m_bCoalescePointerMotion;
 
 	const shared_ptr<GdkKeyConverter> m_refGdkConverter;
 	// Fast access reference to converter
@@ -199,6 +211,9 @@ private:
 	const int32_t m_nClassIdxPointerEvent;
 	const int32_t m_nClassIdxPointerScrollEvent;
 	const int32_t m_nClassIdxTouchEvent;
+	const int32_t m_nClassIdxTouchFrameEvent;
+	// Maps GdkEvent::time to the library's time
+	ClockDomain m_oGdkClockDomain;
 private:
 	MasGtkDeviceManager(const MasGtkDeviceManager& oSource) = delete;
 	MasGtkDeviceManager& operator=(const MasGtkDeviceManager& oSource) = delete;
@@ -102,7 +102,8 @@ bool GtkKeyboardDevice::handleGdkEventKey(GdkEventKey* p0KeyEv, const shared_ptr
 	if (!p0Owner->m_oConverter.convertEventKeyToHardwareKey(p0KeyEv, eHardwareKey)) {
 		return bContinue; //----------------------------------------------------
 	}
-	auto refListeners = p0Owner->getListeners();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxKeyEvent);
+	const int64_t nEventTimeUsec = p0Owner->m_oGdkClockDomain.getTimeUsec(p0KeyEv->time);
 
 	const GdkEventType eGdkType = p0KeyEv->type;
 	uint64_t nTimePressedStamp = std::numeric_limits<uint64_t>::max();
@@ -128,7 +129,6 @@ bool GtkKeyboardDevice::handleGdkEventKey(GdkEventKey* p0KeyEv, const shared_ptr
 			auto nOldTimePressedStamp = oKeyData.m_nPressedTimeStamp;
 			m_oPressedKeys.erase(itFind);
 			shared_ptr<Event> refEvent;
-			const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 			for (auto& p0ListenerData : *refListeners) {
 				sendKeyEventToListener(*p0ListenerData, nEventTimeUsec, nOldTimePressedStamp, eAddInputType, eHardwareKey
 										, refWindowAccessor, p0Owner, refEvent);
@@ -159,7 +159,6 @@ bool GtkKeyboardDevice::handleGdkEventKey(GdkEventKey* p0KeyEv, const shared_ptr
 		m_oPressedKeys.erase(itFind);
 	}
 	shared_ptr<Event> refEvent;
-	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 	for (auto& p0ListenerData : *refListeners) {
 		sendKeyEventToListener(*p0ListenerData, nEventTimeUsec, nTimePressedStamp
 								, eInputType, eHardwareKey, refWindowAccessor, p0Owner, refEvent);
@@ -178,7 +177,7 @@ void GtkKeyboardDevice::finalizeListener(MasGtkDeviceManager::ListenerData& oLis
 		return;
 	}
 	MasGtkDeviceManager* p0Owner = refOwner.get();
-	if (!p0Owner->isEventClassEnabled(Event::Class{typeid(KeyEvent)})) {
+	if (!p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxKeyEvent)) {
 		return; //--------------------------------------------------------------
 	}
 	auto& refSelected = p0Owner->m_refSelected;
@@ -225,7 +224,7 @@ void GtkKeyboardDevice::cancelSelectedAccessorKeys() noexcept
 		return;
 	}
 	MasGtkDeviceManager* p0Owner = refOwner.get();
-	if (!p0Owner->isEventClassEnabled(Event::Class{typeid(KeyEvent)})) {
+	if (!p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxKeyEvent)) {
 		return; // -------------------------------------------------------------
 	}
 	auto& refSelected = p0Owner->m_refSelected;
@@ -235,7 +234,7 @@ void GtkKeyboardDevice::cancelSelectedAccessorKeys() noexcept
 	auto refSelectedAccessor = p0Owner->m_refSelected->getAccessor();
 	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 
-	auto refListeners = p0Owner->getListeners();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxKeyEvent);
 	// Cancel all keys generated by the selected accessor (window)
 	// work on copy
 	auto oPressedKeys = m_oPressedKeys;
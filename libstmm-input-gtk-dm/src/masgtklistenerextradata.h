@@ -39,6 +39,7 @@ public:
 		m_aCanceledKeys.clear();
 		m_aCanceledButtons.clear();
 		m_aCanceledSequences.clear();
+		m_bTouchFrameCanceled = false;
 	}
 	inline bool isKeyCanceled(int32_t nKey) const noexcept
 	{
@@ -64,10 +65,19 @@ public:
 	{
 		m_aCanceledSequences.push_back(p0Sequence);
 	}
+	inline bool isTouchFrameCanceled() const noexcept
+	{
+		return m_bTouchFrameCanceled;
+	}
+	inline void setTouchFrameCanceled() noexcept
+	{
+		m_bTouchFrameCanceled = true;
+	}
 private:
 	std::vector<int32_t> m_aCanceledKeys;
 	std::vector<int32_t> m_aCanceledButtons;
 	std::vector<const GdkEventSequence*> m_aCanceledSequences;
+	bool m_bTouchFrameCanceled = false;
 };
 
 } // namespace Mas
@@ -46,6 +46,8 @@ namespace Mas
 GtkPointerDevice::~GtkPointerDevice() noexcept
 {
 //std::cout << "GtkPointerDevice::~GtkPointerDevice() " << getId() << std::endl;
+	m_oMotionFlushConn.disconnect();
+	m_oTouchFrameConn.disconnect();
 }
 shared_ptr<Device> GtkPointerDevice::getDevice() const noexcept
 {
@@ -112,7 +114,7 @@ bool GtkPointerDevice::handleGdkEventMotion(GdkEventMotion* p0MotionEv, const sh
 		// (ex. the parent of a modal dialog)
 		return bContinue; //----------------------------------------------------
 	}
-	auto refListeners = p0Owner->getListeners();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxPointerEvent);
 	#ifndef NDEBUG
 	const GdkEventType eGdkType = p0MotionEv->type;
 	#endif //NDEBUG
@@ -121,13 +123,17 @@ bool GtkPointerDevice::handleGdkEventMotion(GdkEventMotion* p0MotionEv, const sh
 	const double fY = p0MotionEv->y;
 	m_fLastPointerX = fX;
 	m_fLastPointerY = fY;
+	const int64_t nEventTimeUsec = p0Owner->m_oGdkClockDomain.getTimeUsec(p0MotionEv->time);
+	if (p0Owner->m_bCoalescePointerMotion) {
+		queueMotion(nEventTimeUsec, fX, fY, refWindowData);
+		return bContinue; //----------------------------------------------------
+	}
 	const int32_t nButton = PointerEvent::s_nNoButton;
 	const bool bWasAnyButtonPressed = !m_aButtons.empty();
 	const bool bAnyButtonPressed = bWasAnyButtonPressed; // GdkEventMotion doesn't change the button state
 	const PointerEvent::POINTER_INPUT_TYPE eInputType = (bAnyButtonPressed ? PointerEvent::POINTER_MOVE : PointerEvent::POINTER_HOVER);
 	//
 	auto refSaveAccessor = refWindowData->getAccessor(); // might be removed in callbacks
-	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 	shared_ptr<Event> refEvent;
 	for (auto& p0ListenerData : *refListeners) {
 		sendPointerEventToListener(*p0ListenerData, nEventTimeUsec, fX, fY, eInputType, nButton
@@ -142,9 +148,83 @@ bool GtkPointerDevice::handleGdkEventMotion(GdkEventMotion* p0MotionEv, const sh
 	}
 	return bContinue;
 }
+void GtkPointerDevice::queueMotion(int64_t nEventTimeUsec, double fX, double fY, const shared_ptr<GtkWindowData>& refWindowData) noexcept
+{
+	if ((!m_aPendingMotion.empty()) && (m_refPendingMotionWindowData != refWindowData)) {
+		flushPendingMotion();
+	}
+	if (static_cast<int32_t>(m_aPendingMotion.size()) == s_nMaxMotionHistory) {
+		// Keep the buffer from growing, the latest samples matter most
+		m_aPendingMotion.erase(m_aPendingMotion.begin());
+	}
+	m_aPendingMotion.push_back(PointerEvent::MotionSample{nEventTimeUsec, fX, fY});
+	m_refPendingMotionWindowData = refWindowData;
+	if (m_oMotionFlushConn.connected()) {
+		return; //--------------------------------------------------------------
+	}
+	// Gdk events are dispatched with a higher priority, the redraw with a lower one
+	// so the idle is called once all pending events have been handled, before painting.
+	m_oMotionFlushConn = Glib::signal_idle().connect(sigc::mem_fun(this, &GtkPointerDevice::doMotionFlushIdle)
+													, Glib::PRIORITY_HIGH_IDLE);
+}
+bool GtkPointerDevice::doMotionFlushIdle() noexcept
+{
+	// this idle source is destroyed by returning false, a new one is created for the next motion
+	const bool bContinue = false;
+	m_oMotionFlushConn = sigc::connection{};
+	flushPendingMotion();
+	return bContinue;
+}
+void GtkPointerDevice::flushPendingMotion() noexcept
+{
+	if (m_aPendingMotion.empty()) {
+		return; //--------------------------------------------------------------
+	}
+	m_oMotionFlushConn.disconnect();
+	// Motion received during the callbacks is queued in the other buffer
+	m_aSendingMotion.swap(m_aPendingMotion);
+	m_aPendingMotion.clear();
+	auto refWindowData = std::move(m_refPendingMotionWindowData);
+	m_refPendingMotionWindowData.reset();
+	auto refOwner = getOwnerDeviceManager();
+	if (!refOwner) {
+		return; //--------------------------------------------------------------
+	}
+	MasGtkDeviceManager* p0Owner = refOwner.get();
+	if ((p0Owner->m_refSelected != refWindowData) || !refWindowData->isEnabled()) {
+		// The window was deactivated or removed since the motion was received
+		return; //--------------------------------------------------------------
+	}
+	const PointerEvent::MotionSample oLast = m_aSendingMotion.back();
+	const int32_t nButton = PointerEvent::s_nNoButton;
+	const bool bWasAnyButtonPressed = !m_aButtons.empty();
+	const bool bAnyButtonPressed = bWasAnyButtonPressed; // Motion doesn't change the button state
+	const PointerEvent::POINTER_INPUT_TYPE eInputType = (bAnyButtonPressed ? PointerEvent::POINTER_MOVE : PointerEvent::POINTER_HOVER);
+	//
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxPointerEvent);
+	auto refSaveAccessor = refWindowData->getAccessor(); // might be removed in callbacks
+	shared_ptr<Event> refEvent;
+	for (auto& p0ListenerData : *refListeners) {
+		sendPointerEventToListener(*p0ListenerData, oLast.m_nTimeUsec, oLast.m_fX, oLast.m_fY, eInputType, nButton
+									, bWasAnyButtonPressed, bAnyButtonPressed, refSaveAccessor, p0Owner
+									, m_aSendingMotion, refEvent);
+		if (!refWindowData->isEnabled()) {
+			// The accessor was removed during the callbacks
+			break; // for --------
+		}
+	}
+}
+void GtkPointerDevice::clearPendingMotion() noexcept
+{
+	m_oMotionFlushConn.disconnect();
+	m_aPendingMotion.clear();
+	m_refPendingMotionWindowData.reset();
+}
 bool GtkPointerDevice::handleGdkEventButton(GdkEventButton* p0ButtonEv, const shared_ptr<GtkWindowData>& refWindowData) noexcept
 {
 	const bool bContinue = true;
+	// Send the motion that preceded the button
+	flushPendingMotion();
 	auto refOwner = getOwnerDeviceManager();
 	if (!refOwner) {
 		return !bContinue; //---------------------------------------------------
@@ -215,8 +295,8 @@ bool GtkPointerDevice::handleGdkEventButton(GdkEventButton* p0ButtonEv, const sh
 	}
 	//
 	shared_ptr<Event> refEvent;
-	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
-	auto refListeners = p0Owner->getListeners();
+	const int64_t nEventTimeUsec = p0Owner->m_oGdkClockDomain.getTimeUsec(p0ButtonEv->time);
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxPointerEvent);
 	for (auto& p0ListenerData : *refListeners) {
 		sendPointerEventToListener(*p0ListenerData, nEventTimeUsec, fX, fY, eInputType, nButton
 									, bWasAnyButtonPressed, bAnyButtonPressed, refWindowAccessor, p0Owner
@@ -236,6 +316,7 @@ bool GtkPointerDevice::handleGdkEventButton(GdkEventButton* p0ButtonEv, const sh
 bool GtkPointerDevice::handleGdkEventScroll(GdkEventScroll* p0ScrollEv, const shared_ptr<GtkWindowData>& refWindowData) noexcept
 {
 	const bool bContinue = true;
+	flushPendingMotion();
 	auto refOwner = getOwnerDeviceManager();
 	if (!refOwner) {
 		return !bContinue;
@@ -251,7 +332,7 @@ bool GtkPointerDevice::handleGdkEventScroll(GdkEventScroll* p0ScrollEv, const sh
 		//TODO There probably should be an assert(false) here
 		return bContinue; //----------------------------------------------------
 	}
-	const int64_t nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+	const int64_t nTimeUsec = p0Owner->m_oGdkClockDomain.getTimeUsec(p0ScrollEv->time);
 	#ifndef NDEBUG
 	const GdkEventType eGdkType = p0ScrollEv->type;
 	#endif //NDEBUG
@@ -273,7 +354,7 @@ bool GtkPointerDevice::handleGdkEventScroll(GdkEventScroll* p0ScrollEv, const sh
 	}
 	shared_ptr<Event> refEvent;
 	auto refSaveAccessor = refWindowData->getAccessor();
-	auto refListeners = p0Owner->getListeners();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxPointerScrollEvent);
 	const bool bAnyButtonPressed = !m_aButtons.empty();
 	for (auto& p0ListenerData : *refListeners) {
 		const auto nAddTimeStamp = p0ListenerData->getAddedTimeStamp();
@@ -295,7 +376,7 @@ bool GtkPointerDevice::handleGdkEventScroll(GdkEventScroll* p0ScrollEv, const sh
 				// for all buttons
 				return bContinue; //--------------------------------------------
 			}
-			if ((refEvent.use_count() > 2) || static_cast<RePointerScrollEvent*>(refEvent.get())->getIsModified()) {
+			if ((refEvent.use_count() > 1) || static_cast<RePointerScrollEvent*>(refEvent.get())->getIsModified()) {
 				// If the event is referenced by another shared_ptr (ex. an event queue), can't reuse, it might change later.
 				// If the event was modified can't reuse it for the next listener.
 				refEvent.reset();
@@ -307,6 +388,7 @@ bool GtkPointerDevice::handleGdkEventScroll(GdkEventScroll* p0ScrollEv, const sh
 bool GtkPointerDevice::handleGdkEventTouch(GdkEventTouch* p0TouchEv, const shared_ptr<GtkWindowData>& refWindowData) noexcept
 {
 	const bool bContinue = true;
+	flushPendingMotion();
 	auto refOwner = getOwnerDeviceManager();
 	if (!refOwner) {
 		return !bContinue; //---------------------------------------------------
@@ -322,8 +404,10 @@ bool GtkPointerDevice::handleGdkEventTouch(GdkEventTouch* p0TouchEv, const share
 		//TODO There probably should be an assert(false) here
 		return bContinue; //----------------------------------------------------
 	}
-	auto refListeners = p0Owner->getListeners();
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxTouchEvent);
+	const bool bTouchFrame = p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxTouchFrameEvent);
 	const GdkEventType eGdkType = p0TouchEv->type;
+	const int64_t nEventTimeUsec = p0Owner->m_oGdkClockDomain.getTimeUsec(p0TouchEv->time);
 
 	const auto fLastX = p0TouchEv->x;
 	const auto fLastY = p0TouchEv->y;
@@ -337,20 +421,22 @@ bool GtkPointerDevice::handleGdkEventTouch(GdkEventTouch* p0TouchEv, const share
 		default: return bContinue; //-------------------------------------------
 	}
 	uint64_t nSequenceStartTimeStamp = std::numeric_limits<uint64_t>::max();
-	auto itFind = m_oSequences.find(p0Sequence);
-	const bool bSequenceExists = (itFind != m_oSequences.end());
+	auto itFind = findSequence(p0Sequence);
+	const bool bSequenceExists = (itFind != m_aSequences.end());
 	if (eType == TouchEvent::TOUCH_BEGIN) {
 		if (bSequenceExists) {
-			SequenceData& oSequenceData = itFind->second;
+			SequenceData& oSequenceData = *itFind;
 			// TOUCH_END missing + the sequence was probably recycled or GTK weirdness
 			// Send TOUCH_CANCEL for old accessor before sending TOUCH_BEGIN for new one
 			const auto nSequenceStartTimeStamp = oSequenceData.m_nTouchStartTimeStamp;
 			const auto fLastX = oSequenceData.m_fLastX;
 			const auto fLastY = oSequenceData.m_fLastY;
 			auto refSaveAccessor = refWindowData->getAccessor();
-			m_oSequences.erase(itFind);
+			m_aSequences.erase(itFind);
+			if (bTouchFrame) {
+				m_aEndedContacts.push_back(EndedContact{reinterpret_cast<int64_t>(p0Sequence), fLastX, fLastY, TouchEvent::TOUCH_CANCEL});
+			}
 			shared_ptr<Event> refEvent;
-			const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 			for (auto& p0ListenerData : *refListeners) {
 				sendTouchEventToListener(*p0ListenerData, nEventTimeUsec, nSequenceStartTimeStamp
 										, fLastX, fLastY, TouchEvent::TOUCH_CANCEL
@@ -364,35 +450,167 @@ bool GtkPointerDevice::handleGdkEventTouch(GdkEventTouch* p0TouchEv, const share
 		}
 		nSequenceStartTimeStamp = MasGtkDeviceManager::getUniqueTimeStamp();
 		SequenceData oSequenceData;
+		oSequenceData.m_p0Sequence = p0Sequence;
 		oSequenceData.m_nTouchStartTimeStamp = nSequenceStartTimeStamp;
 		oSequenceData.m_fLastX = fLastX;
 		oSequenceData.m_fLastY = fLastY;
-		m_oSequences.emplace(p0Sequence, oSequenceData);
+		oSequenceData.m_eFrameType = TouchEvent::TOUCH_BEGIN;
+		m_aSequences.push_back(oSequenceData);
 	} else {
 		if (!bSequenceExists) {
 			// Missing TOUCH_BEGIN, ignore!
 			return bContinue; //------------------------------------------------
 		}
-		SequenceData& oSequenceData = itFind->second;
+		SequenceData& oSequenceData = *itFind;
 		nSequenceStartTimeStamp = oSequenceData.m_nTouchStartTimeStamp;
 		if (eType != TouchEvent::TOUCH_UPDATE) {
-			m_oSequences.erase(itFind);
+			if (bTouchFrame) {
+				m_aEndedContacts.push_back(EndedContact{reinterpret_cast<int64_t>(p0Sequence), fLastX, fLastY, eType});
+			}
+			m_aSequences.erase(itFind);
+		} else {
+			oSequenceData.m_fLastX = fLastX;
+			oSequenceData.m_fLastY = fLastY;
 		}
 	}
+	if (bTouchFrame) {
+		queueTouchFrame(nEventTimeUsec, refWindowData);
+	}
 	auto refSaveAccessor = refWindowData->getAccessor();
 	shared_ptr<Event> refEvent;
-	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 	for (auto& p0ListenerData : *refListeners) {
 		sendTouchEventToListener(*p0ListenerData, nEventTimeUsec, nSequenceStartTimeStamp, fLastX, fLastY, eType, reinterpret_cast<int64_t>(p0Sequence)
 								, refSaveAccessor, p0Owner, refEvent);
 		if ( ((eType == TouchEvent::TOUCH_UPDATE) || (eType == TouchEvent::TOUCH_BEGIN))
-					&& (m_oSequences.find(p0Sequence) == m_oSequences.end())) {
+					&& (findSequence(p0Sequence) == m_aSequences.end())) {
 			// The sequence was canceled by the callback
 			break; // for -------
 		}
 	}
 	return bContinue;
 }
+std::vector<GtkPointerDevice::SequenceData>::iterator GtkPointerDevice::findSequence(GdkEventSequence* p0Sequence) noexcept
+{
+	return std::find_if(m_aSequences.begin(), m_aSequences.end(), [&](const SequenceData& oSequenceData)
+	{
+		return (oSequenceData.m_p0Sequence == p0Sequence);
+	});
+}
+void GtkPointerDevice::queueTouchFrame(int64_t nEventTimeUsec, const shared_ptr<GtkWindowData>& refWindowData) noexcept
+{
+	if (m_bTouchFramePending && (m_refTouchFrameWindowData != refWindowData)) {
+		flushTouchFrame();
+	}
+	m_bTouchFramePending = true;
+	m_nTouchFrameTimeUsec = nEventTimeUsec;
+	m_refTouchFrameWindowData = refWindowData;
+	if (m_oTouchFrameConn.connected()) {
+		return; //--------------------------------------------------------------
+	}
+	// As for the coalesced motion, sent once all pending gdk events have been handled
+	m_oTouchFrameConn = Glib::signal_idle().connect(sigc::mem_fun(this, &GtkPointerDevice::doTouchFrameIdle)
+													, Glib::PRIORITY_HIGH_IDLE);
+}
+bool GtkPointerDevice::doTouchFrameIdle() noexcept
+{
+	// this idle source is destroyed by returning false, a new one is created for the next frame
+	const bool bContinue = false;
+	m_oTouchFrameConn = sigc::connection{};
+	flushTouchFrame();
+	return bContinue;
+}
+void GtkPointerDevice::flushTouchFrame() noexcept
+{
+	if (!m_bTouchFramePending) {
+		return; //--------------------------------------------------------------
+	}
+	m_bTouchFramePending = false;
+	m_oTouchFrameConn.disconnect();
+	const int64_t nFrameTimeUsec = m_nTouchFrameTimeUsec;
+	auto refWindowData = std::move(m_refTouchFrameWindowData);
+	m_refTouchFrameWindowData.reset();
+	m_aFrameFingerIds.clear();
+	m_aFrameXs.clear();
+	m_aFrameYs.clear();
+	m_aFrameTypes.clear();
+	for (auto& oSequenceData : m_aSequences) {
+		m_aFrameFingerIds.push_back(reinterpret_cast<int64_t>(oSequenceData.m_p0Sequence));
+		m_aFrameXs.push_back(oSequenceData.m_fLastX);
+		m_aFrameYs.push_back(oSequenceData.m_fLastY);
+		m_aFrameTypes.push_back(oSequenceData.m_eFrameType);
+		oSequenceData.m_eFrameType = TouchEvent::TOUCH_UPDATE;
+	}
+	for (auto& oEnded : m_aEndedContacts) {
+		m_aFrameFingerIds.push_back(oEnded.m_nFingerId);
+		m_aFrameXs.push_back(oEnded.m_fX);
+		m_aFrameYs.push_back(oEnded.m_fY);
+		m_aFrameTypes.push_back(oEnded.m_eType);
+	}
+	m_aEndedContacts.clear();
+	auto refOwner = getOwnerDeviceManager();
+	if (!refOwner) {
+		return; //--------------------------------------------------------------
+	}
+	MasGtkDeviceManager* p0Owner = refOwner.get();
+	if ((p0Owner->m_refSelected != refWindowData) || !refWindowData->isEnabled()) {
+		// The window was deactivated or removed since the touches were received
+		return; //--------------------------------------------------------------
+	}
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxTouchFrameEvent);
+	auto refSaveAccessor = refWindowData->getAccessor(); // might be removed in callbacks
+	shared_ptr<Event> refEvent;
+	for (auto& p0ListenerData : *refListeners) {
+		sendTouchFrameEventToListener(*p0ListenerData, nFrameTimeUsec, refSaveAccessor, p0Owner, refEvent);
+		if (!refWindowData->isEnabled()) {
+			// The accessor was removed during the callbacks
+			break; // for --------
+		}
+	}
+}
+void GtkPointerDevice::fillTouchFrameCanceled() noexcept
+{
+	// All the open contacts as canceled
+	m_aFrameFingerIds.clear();
+	m_aFrameXs.clear();
+	m_aFrameYs.clear();
+	m_aFrameTypes.clear();
+	for (const auto& oSequenceData : m_aSequences) {
+		m_aFrameFingerIds.push_back(reinterpret_cast<int64_t>(oSequenceData.m_p0Sequence));
+		m_aFrameXs.push_back(oSequenceData.m_fLastX);
+		m_aFrameYs.push_back(oSequenceData.m_fLastY);
+		m_aFrameTypes.push_back(TouchEvent::TOUCH_CANCEL);
+	}
+}
+void GtkPointerDevice::cancelTouchFrame(int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
+										, MasGtkDeviceManager* p0Owner) noexcept
+{
+	// The pending frame is replaced by one canceling all the contacts
+	m_bTouchFramePending = false;
+	m_oTouchFrameConn.disconnect();
+	m_refTouchFrameWindowData.reset();
+	fillTouchFrameCanceled();
+	for (auto& oEnded : m_aEndedContacts) {
+		m_aFrameFingerIds.push_back(oEnded.m_nFingerId);
+		m_aFrameXs.push_back(oEnded.m_fX);
+		m_aFrameYs.push_back(oEnded.m_fY);
+		m_aFrameTypes.push_back(oEnded.m_eType);
+	}
+	m_aEndedContacts.clear();
+	if (m_aFrameFingerIds.empty()) {
+		return; //--------------------------------------------------------------
+	}
+	auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxTouchFrameEvent);
+	shared_ptr<Event> refEvent;
+	for (auto& p0ListenerData : *refListeners) {
+		MasGtkListenerExtraData* p0ExtraData = nullptr;
+		p0ListenerData->getExtraData(p0ExtraData);
+		if (p0ExtraData->isTouchFrameCanceled()) {
+			continue; // for ------------
+		}
+		p0ExtraData->setTouchFrameCanceled();
+		sendTouchFrameEventToListener(*p0ListenerData, nEventTimeUsec, refSelectedAccessor, p0Owner, refEvent);
+	}
+}
 void GtkPointerDevice::finalizeListener(MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec) noexcept
 {
 //std::cout << "GtkPointerDevice::finalizeListener" << std::endl;
@@ -406,12 +624,15 @@ void GtkPointerDevice::finalizeListener(MasGtkDeviceManager::ListenerData& oList
 		return; //--------------------------------------------------------------
 	}
 	// Send XXX_CANCEL for the currently pressed buttons and open touch sequences to the listener
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(PointerEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxPointerEvent)) {
 		finalizeListenerButton(oListenerData, nEventTimeUsec, p0Owner);
 	}
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(TouchEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxTouchEvent)) {
 		finalizeListenerTouch(oListenerData, nEventTimeUsec, p0Owner);
 	}
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxTouchFrameEvent)) {
+		finalizeListenerTouchFrame(oListenerData, nEventTimeUsec, p0Owner);
+	}
 }
 void GtkPointerDevice::finalizeListenerButton(MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec, MasGtkDeviceManager* p0Owner) noexcept
 {
@@ -461,10 +682,9 @@ void GtkPointerDevice::finalizeListenerTouch(MasGtkDeviceManager::ListenerData&
 	MasGtkListenerExtraData* p0ExtraData = nullptr;
 	oListenerData.getExtraData(p0ExtraData);
 	// work on copy
-	auto oSequences = m_oSequences;
-	for (auto& oPair : oSequences) {
-		const GdkEventSequence* p0Sequence = oPair.first;
-		const SequenceData& oSequenceData = oPair.second;
+	auto aSequences = m_aSequences;
+	for (const auto& oSequenceData : aSequences) {
+		const GdkEventSequence* p0Sequence = oSequenceData.m_p0Sequence;
 		//
 		const auto& fLastX = oSequenceData.m_fLastX;
 		const auto& fLastY = oSequenceData.m_fLastY;
@@ -479,12 +699,35 @@ void GtkPointerDevice::finalizeListenerTouch(MasGtkDeviceManager::ListenerData&
 								, refSelectedAccessor, p0Owner, refEvent);
 	}
 }
+void GtkPointerDevice::finalizeListenerTouchFrame(MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
+												, MasGtkDeviceManager* p0Owner) noexcept
+{
+	if (m_aSequences.empty()) {
+		return; //--------------------------------------------------------------
+	}
+	MasGtkListenerExtraData* p0ExtraData = nullptr;
+	oListenerData.getExtraData(p0ExtraData);
+	if (p0ExtraData->isTouchFrameCanceled()) {
+		return; //--------------------------------------------------------------
+	}
+	p0ExtraData->setTouchFrameCanceled();
+	auto refSelectedAccessor = p0Owner->m_refSelected->getAccessor();
+	fillTouchFrameCanceled();
+	shared_ptr<Event> refEvent;
+	sendTouchFrameEventToListener(oListenerData, nEventTimeUsec, refSelectedAccessor, p0Owner, refEvent);
+}
 void GtkPointerDevice::removingDevice() noexcept
 {
+	clearPendingMotion();
+	m_oTouchFrameConn.disconnect();
+	m_bTouchFramePending = false;
+	m_refTouchFrameWindowData.reset();
 	resetOwnerDeviceManager();
 }
 void GtkPointerDevice::cancelSelectedAccessorButtonsAndSequences() noexcept
 {
+	// The motion of the window being deselected is dropped
+	clearPendingMotion();
 	auto refOwner = getOwnerDeviceManager();
 	if (!refOwner) {
 		return;
@@ -497,16 +740,23 @@ void GtkPointerDevice::cancelSelectedAccessorButtonsAndSequences() noexcept
 	auto refSelectedAccessor = refSelected->getAccessor();
 	const int64_t nEventTimeUsec = DeviceManager::getNowTimeMicroseconds();
 
-	auto refListeners = p0Owner->getListeners();
 	//
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(PointerEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxPointerEvent)) {
+		auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxPointerEvent);
 		cancelSelectedAccessorButtons(refListeners, nEventTimeUsec, refSelectedAccessor, p0Owner);
 	}
-	if (p0Owner->isEventClassEnabled(Event::Class{typeid(TouchEvent)})) {
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxTouchFrameEvent)) {
+		cancelTouchFrame(nEventTimeUsec, refSelectedAccessor, p0Owner);
+	}
+	if (p0Owner->isEventClassIndexEnabled(p0Owner->m_nClassIdxTouchEvent)) {
+		auto refListeners = p0Owner->getListeners(p0Owner->m_nClassIdxTouchEvent);
 		cancelSelectedAccessorSequences(refListeners, nEventTimeUsec, refSelectedAccessor, p0Owner);
 	}
+	// remove sequences (also if only tracked for the frames)
+	m_aSequences.clear();
+	m_aEndedContacts.clear();
 }
-void GtkPointerDevice::cancelSelectedAccessorButtons(const shared_ptr< const std::list< MasGtkDeviceManager::ListenerData* > >& refListeners
+void GtkPointerDevice::cancelSelectedAccessorButtons(const shared_ptr< const std::vector< MasGtkDeviceManager::ListenerData* > >& refListeners
 													, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 													, MasGtkDeviceManager* p0Owner) noexcept
 {
@@ -544,16 +794,15 @@ void GtkPointerDevice::cancelSelectedAccessorButtons(const shared_ptr< const std
 	m_aButtons.clear();
 	m_nAnyButtonPressTimeStamp = std::numeric_limits<uint64_t>::max();
 }
-void GtkPointerDevice::cancelSelectedAccessorSequences(const shared_ptr< const std::list< MasGtkDeviceManager::ListenerData* > >& refListeners
+void GtkPointerDevice::cancelSelectedAccessorSequences(const shared_ptr< const std::vector< MasGtkDeviceManager::ListenerData* > >& refListeners
 														, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 														, MasGtkDeviceManager* p0Owner) noexcept
 {
 	// Cancel the touch sequences generated with the to be removed accessor.
 	// work on copy
-	auto oSequences = m_oSequences;
-	for (auto& oPair : oSequences) {
-		const GdkEventSequence* p0Sequence = oPair.first;
-		const SequenceData& oSeqData = oPair.second;
+	auto aSequences = m_aSequences;
+	for (const auto& oSeqData : aSequences) {
+		const GdkEventSequence* p0Sequence = oSeqData.m_p0Sequence;
 		shared_ptr<Event> refEvent;
 		for (auto& p0ListenerData : *refListeners) {
 			MasGtkListenerExtraData* p0ExtraData = nullptr;
@@ -568,7 +817,7 @@ void GtkPointerDevice::cancelSelectedAccessorSequences(const shared_ptr< const s
 		}
 	}
 	// remove sequences
-	m_oSequences.clear();
+	m_aSequences.clear();
 }
 void GtkPointerDevice::sendPointerEventToListener(
 											const MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
@@ -578,6 +827,20 @@ void GtkPointerDevice::sendPointerEventToListener(
 											, const shared_ptr<GtkAccessor>& refAccessor
 											, MasGtkDeviceManager* p0Owner
 											, shared_ptr<Event>& refEvent) noexcept
+{
+	sendPointerEventToListener(oListenerData, nEventTimeUsec, fX, fY, eInputType, nButton
+								, bWasAnyButtonPressed, bAnyButtonPressed, refAccessor, p0Owner
+								, std::vector<PointerEvent::MotionSample>{}, refEvent);
+}
+void GtkPointerDevice::sendPointerEventToListener(
+											const MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
+											, double fX, double fY
+											, PointerEvent::POINTER_INPUT_TYPE eInputType, int32_t nButton
+											, bool bWasAnyButtonPressed, bool bAnyButtonPressed
+											, const shared_ptr<GtkAccessor>& refAccessor
+											, MasGtkDeviceManager* p0Owner
+											, const std::vector<PointerEvent::MotionSample>& aMotionHistory
+											, shared_ptr<Event>& refEvent) noexcept
 {
 	const auto nAddTimeStamp = oListenerData.getAddedTimeStamp();
 	if (m_nAnyButtonPressTimeStamp < nAddTimeStamp) {
@@ -587,10 +850,14 @@ void GtkPointerDevice::sendPointerEventToListener(
 	if (!refEvent) {
 		m_oPointerEventRecycler.create(refEvent, nEventTimeUsec, refAccessor, p0Owner->m_refPointerDevice, fX, fY
 										, eInputType, nButton, bAnyButtonPressed, bWasAnyButtonPressed);
+		if (!aMotionHistory.empty()) {
+			// The recycled event's buffer is reused
+			static_cast<RePointerEvent*>(refEvent.get())->setMotionHistory(aMotionHistory);
+		}
 	}
 	const bool bSent = oListenerData.handleEventCallIf(p0Owner->m_nClassIdxPointerEvent, refEvent);
 	if (bSent) {
-		if ((refEvent.use_count() > 2) || static_cast<RePointerEvent*>(refEvent.get())->getIsModified()) {
+		if ((refEvent.use_count() > 1) || static_cast<RePointerEvent*>(refEvent.get())->getIsModified()) {
 			// If the event is referenced by another shared_ptr (ex. an event queue), can't reuse, it might change later.
 			// If the event was modified can't reuse it for the next listener.
 			refEvent.reset();
@@ -617,7 +884,27 @@ void GtkPointerDevice::sendTouchEventToListener(
 	}
 	const bool bSent = oListenerData.handleEventCallIf(p0Owner->m_nClassIdxTouchEvent, refEvent);
 	if (bSent) {
-		if ((refEvent.use_count() > 2) || static_cast<ReTouchEvent*>(refEvent.get())->getIsModified()) {
+		if ((refEvent.use_count() > 1) || static_cast<ReTouchEvent*>(refEvent.get())->getIsModified()) {
+			// If the event is referenced by another shared_ptr (ex. an event queue), can't reuse, it might change later.
+			// If the event was modified can't reuse it for the next listener.
+			refEvent.reset();
+		}
+	}
+}
+
+void GtkPointerDevice::sendTouchFrameEventToListener(
+											const MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
+											, const shared_ptr<GtkAccessor>& refAccessor
+											, MasGtkDeviceManager* p0Owner
+											, shared_ptr<Event>& refEvent) noexcept
+{
+	if (!refEvent) {
+		m_oTouchFrameEventRecycler.create(refEvent, nEventTimeUsec, refAccessor, p0Owner->m_refPointerDevice
+										, m_aFrameFingerIds, m_aFrameXs, m_aFrameYs, m_aFrameTypes);
+	}
+	const bool bSent = oListenerData.handleEventCallIf(p0Owner->m_nClassIdxTouchFrameEvent, refEvent);
+	if (bSent) {
+		if ((refEvent.use_count() > 1) || static_cast<ReTouchFrameEvent*>(refEvent.get())->getIsModified()) {
 			// If the event is referenced by another shared_ptr (ex. an event queue), can't reuse, it might change later.
 			// If the event was modified can't reuse it for the next listener.
 			refEvent.reset();
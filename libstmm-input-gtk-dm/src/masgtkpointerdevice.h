@@ -38,7 +38,6 @@
 #include <list>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <stdint.h>
@@ -71,7 +70,11 @@ public:
 	, m_nAnyButtonPressTimeStamp(std::numeric_limits<uint64_t>::max())
 	, m_fLastPointerX(-1)
 	, m_fLastPointerY(-1)
+	, m_bTouchFramePending(false)
+	, m_nTouchFrameTimeUsec(0)
 	{
+		m_aPendingMotion.reserve(s_nMaxMotionHistory);
+		m_aSendingMotion.reserve(s_nMaxMotionHistory);
 	}
 	virtual ~GtkPointerDevice() noexcept;
 	//
@@ -90,11 +93,28 @@ private:
 	bool handleGdkEventScroll(GdkEventScroll* p0ScrollEv, const shared_ptr<GtkWindowData>& refWindowData) noexcept;
 	bool handleGdkEventTouch(GdkEventTouch* p0TouchEv, const shared_ptr<GtkWindowData>& refWindowData) noexcept;
 
+	void queueMotion(int64_t nEventTimeUsec, double fX, double fY, const shared_ptr<GtkWindowData>& refWindowData) noexcept;
+	bool doMotionFlushIdle() noexcept;
+	void flushPendingMotion() noexcept;
+	void clearPendingMotion() noexcept;
+
+	std::vector<SequenceData>::iterator findSequence(GdkEventSequence* p0Sequence) noexcept;
+	void queueTouchFrame(int64_t nEventTimeUsec, const shared_ptr<GtkWindowData>& refWindowData) noexcept;
+	bool doTouchFrameIdle() noexcept;
+	void flushTouchFrame() noexcept;
+	void cancelTouchFrame(int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
+						, MasGtkDeviceManager* p0Owner) noexcept;
+	void fillTouchFrameCanceled() noexcept;
+	void sendTouchFrameEventToListener(const MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
+										, const shared_ptr<GtkAccessor>& refAccessor
+										, MasGtkDeviceManager* p0Owner
+										, shared_ptr<Event>& refEvent) noexcept;
+
 	void cancelSelectedAccessorButtonsAndSequences() noexcept;
-	void cancelSelectedAccessorButtons(const shared_ptr< const std::list< MasGtkDeviceManager::ListenerData* > >& refListeners
+	void cancelSelectedAccessorButtons(const shared_ptr< const std::vector< MasGtkDeviceManager::ListenerData* > >& refListeners
 										, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 										, MasGtkDeviceManager* p0Owner) noexcept;
-	void cancelSelectedAccessorSequences(const shared_ptr< const std::list< MasGtkDeviceManager::ListenerData* > >& refListeners
+	void cancelSelectedAccessorSequences(const shared_ptr< const std::vector< MasGtkDeviceManager::ListenerData* > >& refListeners
 										, int64_t nEventTimeUsec, const shared_ptr<GtkAccessor>& refSelectedAccessor
 										, MasGtkDeviceManager* p0Owner) noexcept;
 	void finalizeListener(MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec) noexcept;
@@ -102,6 +122,8 @@ private:
 									, MasGtkDeviceManager* p0Owner) noexcept;
 		void finalizeListenerTouch(MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
 									, MasGtkDeviceManager* p0Owner) noexcept;
+		void finalizeListenerTouchFrame(MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
+										, MasGtkDeviceManager* p0Owner) noexcept;
 
 	void removingDevice() noexcept;
 	void sendPointerEventToListener(const MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
@@ -111,6 +133,14 @@ private:
 									, const shared_ptr<GtkAccessor>& refAccessor
 									, MasGtkDeviceManager* p0Owner
 									, shared_ptr<Event>& refEvent) noexcept;
+	void sendPointerEventToListener(const MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
+									, double fX, double fY
+									, PointerEvent::POINTER_INPUT_TYPE eInputType, int32_t nButton
+									, bool bWasAnyButtonPressed, bool bAnyButtonPressed
+									, const shared_ptr<GtkAccessor>& refAccessor
+									, MasGtkDeviceManager* p0Owner
+									, const std::vector<PointerEvent::MotionSample>& aMotionHistory
+									, shared_ptr<Event>& refEvent) noexcept;
 	void sendTouchEventToListener(const MasGtkDeviceManager::ListenerData& oListenerData, int64_t nEventTimeUsec
 									, uint64_t nSequenceStartTimeStamp, double fX, double fY
 									, TouchEvent::TOUCH_INPUT_TYPE eInputType, int64_t nSequence
@@ -148,11 +178,47 @@ private:
 	//
 	struct SequenceData
 	{
+		GdkEventSequence* m_p0Sequence;
 		uint64_t m_nTouchStartTimeStamp;
 		double m_fLastX;
 		double m_fLastY;
+		TouchEvent::TOUCH_INPUT_TYPE m_eFrameType; // TOUCH_BEGIN or TOUCH_UPDATE in the next TouchFrameEvent
 	};
-	std::unordered_map<GdkEventSequence*, SequenceData> m_oSequences; // Key: gdk touch sequence
+	// The open touch sequences in the order they began. A vector because there are
+	// only a few, and so that the contacts of a TouchFrameEvent have a stable order.
+	std::vector<SequenceData> m_aSequences;
+	//
+	// Touch frame (TouchFrameEvent)
+	struct EndedContact
+	{
+		int64_t m_nFingerId;
+		double m_fX;
+		double m_fY;
+		TouchEvent::TOUCH_INPUT_TYPE m_eType; // TOUCH_END or TOUCH_CANCEL
+	};
+	// The contacts ended since the last frame was sent
+	std::vector<EndedContact> m_aEndedContacts;
+	bool m_bTouchFramePending;
+	int64_t m_nTouchFrameTimeUsec;
+	// The window the touches of the pending frame were received from
+	shared_ptr<GtkWindowData> m_refTouchFrameWindowData;
+	sigc::connection m_oTouchFrameConn; // The idle that sends the pending frame
+	// The contacts of the frame being sent (kept allocated)
+	std::vector<int64_t> m_aFrameFingerIds;
+	std::vector<double> m_aFrameXs;
+	std::vector<double> m_aFrameYs;
+	std::vector<TouchEvent::TOUCH_INPUT_TYPE> m_aFrameTypes;
+	//
+	// Coalesced motion (MasGtkDeviceManager::m_bCoalescePointerMotion)
+	// The motion samples not sent yet, the last is the position of the event
+	// Size: <= s_nMaxMotionHistory, the oldest samples are dropped
+	std::vector<PointerEvent::MotionSample> m_aPendingMotion;
+	// The samples being sent (swapped with m_aPendingMotion to keep both buffers allocated)
+	std::vector<PointerEvent::MotionSample> m_aSendingMotion;
+	// The window the pending motion was received from
+	shared_ptr<GtkWindowData> m_refPendingMotionWindowData;
+	sigc::connection m_oMotionFlushConn; // The idle that sends the pending motion
+	static constexpr int32_t s_nMaxMotionHistory = 64;
 	//
 	class RePointerEvent :public PointerEvent
 	{
@@ -162,6 +228,8 @@ private:
 						, POINTER_INPUT_TYPE eType, int32_t nButton, bool bAnyButtonPressed, bool bWasAnyButtonPressed) noexcept
 		: PointerEvent(nTimeUsec, refAccessor, refPointerCapability, fX, fY, eType, nButton, bAnyButtonPressed, bWasAnyButtonPressed)
 		{
+			// Allocated once, the history can't get bigger
+			reserveMotionHistory(s_nMaxMotionHistory);
 		}
 		void reInit(int64_t nTimeUsec, const shared_ptr<Accessor>& refAccessor
 					, const shared_ptr<PointerCapability>& refPointerCapability, double fX, double fY
@@ -173,8 +241,10 @@ private:
 			setPointerCapability(refPointerCapability);
 			setX(fX);
 			setY(fY);
+			clearMotionHistory();
 			setIsModified(false);
 		}
+		using PointerEvent::setMotionHistory;
 	};
 	Private::Recycler<RePointerEvent, Event> m_oPointerEventRecycler;
 	//
@@ -225,6 +295,30 @@ private:
 		}
 	};
 	Private::Recycler<ReTouchEvent, Event> m_oTouchEventRecycler;
+	//
+	class ReTouchFrameEvent :public TouchFrameEvent
+	{
+	public:
+		ReTouchFrameEvent(int64_t nTimeUsec, const shared_ptr<Accessor>& refAccessor
+						, const shared_ptr<TouchCapability>& refTouchCapability
+						, const std::vector<int64_t>& aFingerIds, const std::vector<double>& aXs
+						, const std::vector<double>& aYs, const std::vector<TouchEvent::TOUCH_INPUT_TYPE>& aTypes) noexcept
+		: TouchFrameEvent(nTimeUsec, refAccessor, refTouchCapability, aFingerIds, aXs, aYs, aTypes)
+		{
+		}
+		void reInit(int64_t nTimeUsec, const shared_ptr<Accessor>& refAccessor
+					, const shared_ptr<TouchCapability>& refTouchCapability
+					, const std::vector<int64_t>& aFingerIds, const std::vector<double>& aXs
+					, const std::vector<double>& aYs, const std::vector<TouchEvent::TOUCH_INPUT_TYPE>& aTypes) noexcept
+		{
+			setTimeUsec(nTimeUsec);
+			setAccessor(refAccessor);
+			setTouchCapability(refTouchCapability);
+			setContacts(aFingerIds, aXs, aYs, aTypes);
+			setIsModified(false);
+		}
+	};
+	Private::Recycler<ReTouchFrameEvent, Event> m_oTouchFrameEventRecycler;
 private:
 	GtkPointerDevice(const GtkPointerDevice& oSource) = delete;
 	GtkPointerDevice& operator=(const GtkPointerDevice& oSource) = delete;
@@ -84,7 +84,8 @@ void GtkWindowData::connect() noexcept
 		m_oAddEvMask |= Gdk::SCROLL_MASK;
 		m_oScrollConn = p0GtkmmWindow->signal_scroll_event().connect(sigc::mem_fun(this, &GtkWindowData::onSigScroll));
 	}
-	if (isEventClassEnabled(Event::Class{typeid(TouchEvent)}) && !m_oTouchConn.connected()) {
+	if ((isEventClassEnabled(Event::Class{typeid(TouchEvent)}) || isEventClassEnabled(Event::Class{typeid(TouchFrameEvent)}))
+				&& !m_oTouchConn.connected()) {
 		m_oAddEvMask |= Gdk::TOUCH_MASK;
 		m_oTouchConn = p0GtkmmWindow->signal_touch_event().connect(sigc::mem_fun(this, &GtkWindowData::onSigTouch));
 	}
@@ -23,4 +23,25 @@
 namespace stmi
 {
 
+namespace Private
+{
+
+constexpr int32_t RecyclerPool::s_nDefaultMaxFree;
+
+RecyclerPool::RecyclerPool(int32_t nMaxFree) noexcept
+: m_nMaxFree(nMaxFree)
+, m_nFree(0)
+, m_nHits(0)
+, m_nMisses(0)
+{
+	assert(nMaxFree >= 0);
+}
+const std::shared_ptr<RecyclerPool>& RecyclerPool::getShared() noexcept
+{
+	static const std::shared_ptr<RecyclerPool> s_refSharedPool = std::make_shared<RecyclerPool>();
+	return s_refSharedPool;
+}
+
+} // namespace Private
+
 } // namespace stmi
@@ -22,9 +22,14 @@
 #define STMI_RECYCLER_H
 
 #include <cassert>
-#include <iostream>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
 
 
 namespace stmi
@@ -33,14 +38,138 @@ namespace stmi
 namespace Private
 {
 
+template <class T, class B> class Recycler;
+
+////////////////////////////////////////////////////////////////////////////////
+/** Limit and statistics shared by recyclers.
+ * The free instances of all the recyclers using the same pool are counted together.
+ * When the maximum is reached, released instances are deleted instead of
+ * being kept for reuse.
+ *
+ * The counters are relaxed atomics: they can be read from any thread
+ * but are only meant for statistics and tuning.
+ */
+class RecyclerPool final
+{
+public:
+	/** Constructor.
+	 * @param nMaxFree The high-water mark of free instances. Must be &gt;= 0.
+	 */
+	explicit RecyclerPool(int32_t nMaxFree = s_nDefaultMaxFree) noexcept;
+	/** The pool shared by all the devices of this library.
+	 * @return The pool. Not null.
+	 */
+	static const std::shared_ptr<RecyclerPool>& getShared() noexcept;
+
+	/** Sets the high-water mark of free instances.
+	 * Instances that are already free are kept until reused.
+	 * @param nMaxFree The maximum number of free instances. Must be &gt;= 0.
+	 */
+	void setMaxFree(int32_t nMaxFree) noexcept
+	{
+		assert(nMaxFree >= 0);
+		m_nMaxFree.store(nMaxFree, std::memory_order_relaxed);
+	}
+	/** The high-water mark of free instances.
+	 * @return The maximum number of free instances.
+	 */
+	int32_t getMaxFree() const noexcept
+	{
+		return m_nMaxFree.load(std::memory_order_relaxed);
+	}
+	/** The number of free instances currently kept by the recyclers of this pool.
+	 * @return The number of free instances.
+	 */
+	int32_t getFree() const noexcept
+	{
+		return m_nFree.load(std::memory_order_relaxed);
+	}
+	/** The number of creates that reused a free instance.
+	 * @return The hits.
+	 */
+	int64_t getHits() const noexcept
+	{
+		return m_nHits.load(std::memory_order_relaxed);
+	}
+	/** The number of creates that had to construct a new instance.
+	 * @return The misses.
+	 */
+	int64_t getMisses() const noexcept
+	{
+		return m_nMisses.load(std::memory_order_relaxed);
+	}
+	/** Sets hits and misses to 0.
+	 */
+	void resetStats() noexcept
+	{
+		m_nHits.store(0, std::memory_order_relaxed);
+		m_nMisses.store(0, std::memory_order_relaxed);
+	}
+
+	static constexpr int32_t s_nDefaultMaxFree = 256;
+private:
+	template <class T, class B> friend class Recycler;
+
+	bool acquireFree() noexcept
+	{
+		if (m_nFree.fetch_add(1, std::memory_order_relaxed) < getMaxFree()) {
+			return true; //----------------------------------------------------
+		}
+		m_nFree.fetch_sub(1, std::memory_order_relaxed);
+		return false;
+	}
+	void releaseFree(int32_t nTot) noexcept
+	{
+		m_nFree.fetch_sub(nTot, std::memory_order_relaxed);
+	}
+	void countCreate(bool bHit) noexcept
+	{
+		if (bHit) {
+			m_nHits.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			m_nMisses.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+private:
+	std::atomic<int32_t> m_nMaxFree;
+	std::atomic<int32_t> m_nFree;
+	std::atomic<int64_t> m_nHits;
+	std::atomic<int64_t> m_nMisses;
+private:
+	RecyclerPool(const RecyclerPool& oSource) = delete;
+	RecyclerPool& operator=(const RecyclerPool& oSource) = delete;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /** Recycling factory for shared_ptr wrapped classes.
+ * The shared_ptrs returned by create() have a deleter that gives the instance
+ * back to the recycler's free list, and an allocator that reuses the
+ * control blocks. Both create and release are O(1).
+ *
+ * The free lists belong to the thread that constructed the recycler (the
+ * main thread): create() and releases in that thread don't lock.
+ * Instances released from other threads are put in a mutex protected list
+ * that the owner thread takes over when its own list is empty.
+ * create() called from other threads always constructs new instances.
+ *
+ * Instances still referenced when the recycler is destroyed are deleted
+ * rather than recycled when released.
  */
 template <class T, class B = T>
 class Recycler final
 {
 public:
-	Recycler() noexcept = default;
+	/** Constructor.
+	 * @param refPool The pool. Cannot be null. Default is the shared pool.
+	 */
+	explicit Recycler(const std::shared_ptr<RecyclerPool>& refPool = RecyclerPool::getShared()) noexcept
+	: m_refFreeList(std::make_shared<FreeList>(refPool))
+	{
+	}
+	~Recycler() noexcept
+	{
+		m_refFreeList->close();
+	}
 
 	/** Construct or recycle the shared_ptr wrapped instance of T.
 	 * T must be same or subclass of B.
@@ -51,29 +180,227 @@ public:
 	void create(std::shared_ptr<B>& refOutB, const P& ... oParam)
 	{
 		static_assert(std::is_base_of<B,T>::value, "Wrong type.");
-		for (auto& refB : m_oAll) {
-			if (refB.use_count() == 1) {
-//#ifndef NDEBUG
-//static int32_t nCount = 0;
-//std::cout << "recycled " << nCount << '\n';
-//++nCount;
-//#endif //NDEBUG
-				T* p0T = static_cast<T*>(refB.get());
-				p0T->reInit(oParam...);
-				refOutB = refB;
-				return; //------------------------------------------------------
-			}
-		}
-		// not found: create new instance
-		if (std::is_same<B,T>::value) {
-			m_oAll.emplace_back(std::make_shared<T>(oParam...));
+		T* p0T = m_refFreeList->popInstance();
+		if (p0T != nullptr) {
+			p0T->reInit(oParam...);
 		} else {
-			m_oAll.emplace_back(std::shared_ptr<B>(new T(oParam...)));
+			p0T = new T(oParam...);
 		}
-		refOutB = m_oAll.back();
+		refOutB = std::shared_ptr<B>(p0T, Deleter(m_refFreeList), Allocator<T>(m_refFreeList));
 	}
 private:
-	std::vector< std::shared_ptr<B> > m_oAll;
+	class FreeList final
+	{
+	public:
+		explicit FreeList(const std::shared_ptr<RecyclerPool>& refPool) noexcept
+		: m_refPool(refPool)
+		, m_oOwnerThreadId(std::this_thread::get_id())
+		, m_nBlockSize(0)
+		, m_bClosed(false)
+		, m_bRemotePending(false)
+		{
+			assert(m_refPool);
+		}
+		~FreeList() noexcept
+		{
+			assert(m_aInstances.empty() && m_aRemoteInstances.empty());
+			for (void* p0Block : m_aBlocks) {
+				::operator delete(p0Block);
+			}
+			for (void* p0Block : m_aRemoteBlocks) {
+				::operator delete(p0Block);
+			}
+		}
+		// Deletes the free instances and stops recycling. Called by the owner thread.
+		// The free instances must be deleted before the free list can be,
+		// because they might hold a weak_ptr (ex. std::enable_shared_from_this)
+		// to a control block that references the free list.
+		void close() noexcept
+		{
+			assert(isOwnerThread());
+			std::vector<T*> aInstances;
+			{
+				std::lock_guard<std::mutex> oLock(m_oRemoteMutex);
+				m_bClosed = true;
+				aInstances.swap(m_aRemoteInstances);
+			}
+			aInstances.insert(aInstances.end(), m_aInstances.begin(), m_aInstances.end());
+			m_aInstances.clear();
+			m_refPool->releaseFree(static_cast<int32_t>(aInstances.size()));
+			for (T* p0T : aInstances) {
+				delete p0T;
+			}
+		}
+		T* popInstance() noexcept
+		{
+			if (!isOwnerThread()) {
+				m_refPool->countCreate(false);
+				return nullptr; //---------------------------------------------
+			}
+			if (m_aInstances.empty()) {
+				takeRemote();
+				if (m_aInstances.empty()) {
+					m_refPool->countCreate(false);
+					return nullptr; //-----------------------------------------
+				}
+			}
+			m_refPool->countCreate(true);
+			m_refPool->releaseFree(1);
+			T* p0T = m_aInstances.back();
+			m_aInstances.pop_back();
+			return p0T;
+		}
+		void pushInstance(T* p0T) noexcept
+		{
+			if (isOwnerThread()) {
+				if ((!m_bClosed) && m_refPool->acquireFree()) {
+					m_aInstances.push_back(p0T);
+					return; //-------------------------------------------------
+				}
+			} else {
+				std::lock_guard<std::mutex> oLock(m_oRemoteMutex);
+				if ((!m_bClosed) && m_refPool->acquireFree()) {
+					m_aRemoteInstances.push_back(p0T);
+					m_bRemotePending.store(true, std::memory_order_release);
+					return; //-------------------------------------------------
+				}
+			}
+			delete p0T;
+		}
+		void* allocBlock(std::size_t nSize)
+		{
+			if (isOwnerThread()) {
+				if (m_nBlockSize == 0) {
+					// all the control blocks of a recycler have the same type
+					std::lock_guard<std::mutex> oLock(m_oRemoteMutex);
+					m_nBlockSize = nSize;
+				}
+				assert(nSize == m_nBlockSize);
+				if (m_aBlocks.empty()) {
+					takeRemote();
+				}
+				if (!m_aBlocks.empty()) {
+					void* p0Block = m_aBlocks.back();
+					m_aBlocks.pop_back();
+					return p0Block; //-----------------------------------------
+				}
+			}
+			return ::operator new(nSize);
+		}
+		void freeBlock(void* p0Block, std::size_t nSize) noexcept
+		{
+			if (isOwnerThread()) {
+				if ((!m_bClosed) && (nSize == m_nBlockSize)
+						&& (static_cast<int32_t>(m_aBlocks.size()) < m_refPool->getMaxFree())) {
+					m_aBlocks.push_back(p0Block);
+					return; //-------------------------------------------------
+				}
+			} else {
+				std::lock_guard<std::mutex> oLock(m_oRemoteMutex);
+				if ((!m_bClosed) && (nSize == m_nBlockSize)
+						&& (static_cast<int32_t>(m_aRemoteBlocks.size()) < m_refPool->getMaxFree())) {
+					m_aRemoteBlocks.push_back(p0Block);
+					m_bRemotePending.store(true, std::memory_order_release);
+					return; //-------------------------------------------------
+				}
+			}
+			::operator delete(p0Block);
+		}
+	private:
+		bool isOwnerThread() const noexcept
+		{
+			return (std::this_thread::get_id() == m_oOwnerThreadId);
+		}
+		void takeRemote() noexcept
+		{
+			if (!m_bRemotePending.load(std::memory_order_acquire)) {
+				return; //-----------------------------------------------------
+			}
+			std::lock_guard<std::mutex> oLock(m_oRemoteMutex);
+			m_aInstances.insert(m_aInstances.end(), m_aRemoteInstances.begin(), m_aRemoteInstances.end());
+			m_aRemoteInstances.clear();
+			m_aBlocks.insert(m_aBlocks.end(), m_aRemoteBlocks.begin(), m_aRemoteBlocks.end());
+			m_aRemoteBlocks.clear();
+			m_bRemotePending.store(false, std::memory_order_relaxed);
+		}
+	private:
+		const std::shared_ptr<RecyclerPool> m_refPool;
+		const std::thread::id m_oOwnerThreadId;
+		// Owner thread only
+		std::vector<T*> m_aInstances;
+		std::vector<void*> m_aBlocks;
+		// Written by the owner thread with m_oRemoteMutex locked
+		std::size_t m_nBlockSize;
+		bool m_bClosed;
+		// Protected by m_oRemoteMutex
+		std::mutex m_oRemoteMutex;
+		std::vector<T*> m_aRemoteInstances;
+		std::vector<void*> m_aRemoteBlocks;
+		std::atomic<bool> m_bRemotePending;
+	private:
+		FreeList(const FreeList& oSource) = delete;
+		FreeList& operator=(const FreeList& oSource) = delete;
+	};
+	class Deleter final
+	{
+	public:
+		explicit Deleter(const std::shared_ptr<FreeList>& refFreeList) noexcept
+		: m_refFreeList(refFreeList)
+		{
+		}
+		void operator()(T* p0T) const noexcept
+		{
+			m_refFreeList->pushInstance(p0T);
+		}
+	private:
+		std::shared_ptr<FreeList> m_refFreeList;
+	};
+	template <class U>
+	class Allocator final
+	{
+	public:
+		using value_type = U;
+		template <class V>
+		struct rebind
+		{
+			using other = Allocator<V>;
+		};
+		explicit Allocator(const std::shared_ptr<FreeList>& refFreeList) noexcept
+		: m_refFreeList(refFreeList)
+		{
+		}
+		template <class V>
+		Allocator(const Allocator<V>& oOther) noexcept
+		: m_refFreeList(oOther.getFreeList())
+		{
+		}
+		U* allocate(std::size_t nTot)
+		{
+			return static_cast<U*>(m_refFreeList->allocBlock(nTot * sizeof(U)));
+		}
+		void deallocate(U* p0U, std::size_t nTot) noexcept
+		{
+			m_refFreeList->freeBlock(p0U, nTot * sizeof(U));
+		}
+		const std::shared_ptr<FreeList>& getFreeList() const noexcept
+		{
+			return m_refFreeList;
+		}
+		template <class V>
+		bool operator==(const Allocator<V>& oOther) const noexcept
+		{
+			return (m_refFreeList == oOther.getFreeList());
+		}
+		template <class V>
+		bool operator!=(const Allocator<V>& oOther) const noexcept
+		{
+			return (m_refFreeList != oOther.getFreeList());
+		}
+	private:
+		std::shared_ptr<FreeList> m_refFreeList;
+	};
+private:
+	std::shared_ptr<FreeList> m_refFreeList;
 private:
 	Recycler(const Recycler& oSource) = delete;
 	Recycler& operator=(const Recycler& oSource) = delete;
@@ -84,4 +411,3 @@ private:
 } // namespace stmi
 
 #endif /* STMI_RECYCLER_H */
-
@@ -19,19 +19,19 @@
 #   MAJOR is CURRENT interface
 #   MINOR is REVISION (implementation of interface)
 #   AGE is always 0
-set(STMM_INPUT_GTK_DM_MAJOR_VERSION 0)
-set(STMM_INPUT_GTK_DM_MINOR_VERSION 16) # !-U-!
+set(STMM_INPUT_GTK_DM_MAJOR_VERSION 1)
+set(STMM_INPUT_GTK_DM_MINOR_VERSION 0) # !-U-!
 set(STMM_INPUT_GTK_DM_VERSION "${STMM_INPUT_GTK_DM_MAJOR_VERSION}.${STMM_INPUT_GTK_DM_MINOR_VERSION}.0")
 
 # required stmm-input-gtk version
-set(STMM_INPUT_GTK_DM_REQ_STMM_INPUT_GTK_VERSION "0.16") # !-U-!
+set(STMM_INPUT_GTK_DM_REQ_STMM_INPUT_GTK_VERSION "1.0") # !-U-!
 
 # required stmm-input-ev version
-set(STMM_INPUT_GTK_DM_REQ_STMM_INPUT_EV_VERSION "0.16") # !-U-!
+set(STMM_INPUT_GTK_DM_REQ_STMM_INPUT_EV_VERSION "1.0") # !-U-!
 
 if (NOT OMIT_PLUGINS)
     # required stmm-input-dl version
-    set(STMM_INPUT_GTK_DM_REQ_STMM_INPUT_DL_VERSION "0.16") # !-U-!
+    set(STMM_INPUT_GTK_DM_REQ_STMM_INPUT_DL_VERSION "1.0") # !-U-!
 endif()
 
 include("${PROJECT_SOURCE_DIR}/../libstmm-input-gtk/stmm-input-gtk-defs.cmake")
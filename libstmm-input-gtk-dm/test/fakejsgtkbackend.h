@@ -26,6 +26,10 @@
 
 #include "jsdevicefiles.h"
 
+#include <unordered_map>
+
+#include <linux/input.h>
+
 namespace stmi
 {
 
@@ -53,6 +57,14 @@ public:
 	int32_t simulateNewDevice(const std::string& sName, const std::vector<int32_t>& aButtonCode
 												, int32_t nTotHats, const std::vector<int32_t>& aAxisCode) noexcept
 	{
+		return simulateNewDevice(sName, aButtonCode, nTotHats, aAxisCode, std::vector<Private::Js::JoystickAbsInfo>{});
+	}
+	// Simulates an evdev device if aAbsInfo is not empty (same size as aAxisCode)
+	int32_t simulateNewDevice(const std::string& sName, const std::vector<int32_t>& aButtonCode
+												, int32_t nTotHats, const std::vector<int32_t>& aAxisCode
+												, const std::vector<Private::Js::JoystickAbsInfo>& aAbsInfo) noexcept
+	{
+		assert(aAbsInfo.empty() || (aAbsInfo.size() == aAxisCode.size()));
 		assert(nTotHats >= 0);
 		#ifndef NDEBUG
 		for (auto nIdx = 0u; nIdx < aButtonCode.size(); ++nIdx) {
@@ -74,7 +86,7 @@ public:
 			}
 		}
 		#endif //NDEBUG
-		auto& refJoystick = onDeviceAdded(sName, aButtonCode, nTotHats, aAxisCode);
+		auto& refJoystick = onDeviceAdded(sName, aButtonCode, nTotHats, aAxisCode, aAbsInfo);
 		m_aJoysticks.push_back(refJoystick);
 		return refJoystick->getDeviceId();
 	}
@@ -89,6 +101,12 @@ public:
 		m_aJoysticks.pop_back();
 		onDeviceRemoved(nDeviceId);
 	}
+	void setAxisFilter(int32_t nDeviceId, JoystickCapability::AXIS eAxis, const JsDeviceFiles::AxisFilter& oAxisFilter) noexcept
+	{
+		const int32_t nIdx = findDeviceId(nDeviceId);
+		assert(nIdx >= 0);
+		m_aJoysticks[nIdx]->setAxisFilter(eAxis, oAxisFilter);
+	}
 	bool simulateJsEvent(int32_t nDeviceId, const struct js_event* p0JsEvent) noexcept
 	{
 		const int32_t nIdx = findDeviceId(nDeviceId);
@@ -96,6 +114,61 @@ public:
 		assert(nIdx >= 0);
 		return m_aJoysticks[nIdx]->doInputJoystickEventCallback(p0JsEvent);
 	}
+	bool simulateJsEvents(int32_t nDeviceId, const std::vector<struct js_event>& aJsEvents, bool bCoalesceAxes) noexcept
+	{
+		const int32_t nIdx = findDeviceId(nDeviceId);
+		assert(nIdx >= 0);
+		return m_aJoysticks[nIdx]->doInputJoystickEventsCallback(aJsEvents.data(), static_cast<int32_t>(aJsEvents.size()), bCoalesceAxes);
+	}
+	// The result of addIfJoystick() for a device file, by default PROBE_NOT_OPENED
+	enum PROBE_RESULT
+	{
+		PROBE_NOT_OPENED = 0
+		, PROBE_NOT_JOYSTICK = 1
+		, PROBE_JOYSTICK = 2
+	};
+	void setProbeResult(const std::string& sPathName, PROBE_RESULT eResult) noexcept
+	{
+		m_oProbeResults[sPathName] = eResult;
+	}
+	int32_t getTotProbes(const std::string& sPathName) const noexcept
+	{
+		auto itFind = m_oTotProbes.find(sPathName);
+		return ((itFind == m_oTotProbes.end()) ? 0 : itFind->second);
+	}
+	// Returns the device id of the joystick added by the device file or -1
+	int32_t getFileDeviceId(const std::string& sPathName) const noexcept
+	{
+		auto itFind = m_oFileDeviceIds.find(sPathName);
+		return ((itFind == m_oFileDeviceIds.end()) ? -1 : itFind->second);
+	}
+	bool simulateLifeEvent(const std::string& sPath, const std::string& sName, Private::Js::JoystickLifeSource::LIFE_EVENT eLifeEvent) noexcept
+	{
+		return onLifeEvent(sPath, sName, eLifeEvent);
+	}
+	using Private::Js::GtkBackend::isPendingDevice;
+	using Private::Js::GtkBackend::isNotJoystickFile;
+	bool simulateEvdevFrame(int32_t nDeviceId, const std::vector<struct input_event>& aEvents, int64_t nFrameTimeUsec) noexcept
+	{
+		const int32_t nIdx = findDeviceId(nDeviceId);
+		assert(nIdx >= 0);
+		return m_aJoysticks[nIdx]->doInputEvdevFrameCallback(aEvents.data(), static_cast<int32_t>(aEvents.size()), nFrameTimeUsec);
+	}
+protected:
+	bool addIfJoystick(const std::string& sPathName, bool& bOpened, bool& bNotJoystick) noexcept override
+	{
+		++m_oTotProbes[sPathName];
+		auto itFind = m_oProbeResults.find(sPathName);
+		const PROBE_RESULT eResult = ((itFind == m_oProbeResults.end()) ? PROBE_NOT_OPENED : itFind->second);
+		bOpened = (eResult != PROBE_NOT_OPENED);
+		bNotJoystick = (eResult == PROBE_NOT_JOYSTICK);
+		if ((eResult != PROBE_JOYSTICK) || (m_oFileDeviceIds.find(sPathName) != m_oFileDeviceIds.end())) {
+			return false; //----------------------------------------------------
+		}
+		const int32_t nDeviceId = simulateNewDevice(sPathName, {BTN_A}, 0, {ABS_X});
+		m_oFileDeviceIds.emplace(sPathName, nDeviceId);
+		return true;
+	}
 private:
 	int32_t findDeviceId(int32_t nDeviceId) const
 	{
@@ -111,6 +184,9 @@ private:
 	}
 private:
 	std::vector< shared_ptr<Private::Js::JoystickDevice> > m_aJoysticks;
+	std::unordered_map<std::string, PROBE_RESULT> m_oProbeResults; // Key: sPathName
+	std::unordered_map<std::string, int32_t> m_oTotProbes; // Key: sPathName, Value: number of addIfJoystick() calls
+	std::unordered_map<std::string, int32_t> m_oFileDeviceIds; // Key: sPathName, Value: device id
 };
 
 } // namespace Js
@@ -42,12 +42,14 @@ class FakeMasGtkDeviceManager : public MasGtkDeviceManager
 public:
 	static shared_ptr<FakeMasGtkDeviceManager> create(bool bEnableEventClasses, const std::vector<Event::Class>& aEnDisableEventClasses
 												, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter
-												, const Glib::RefPtr<Gdk::DeviceManager>& refGdkDeviceManager) noexcept
+												, const Glib::RefPtr<Gdk::DeviceManager>& refGdkDeviceManager
+												, bool bCoalescePointerMotion = false) noexcept
 	{
 		shared_ptr<FakeMasGtkDeviceManager> refInstance(
 				new FakeMasGtkDeviceManager(bEnableEventClasses, aEnDisableEventClasses
 											, eKeyRepeatMode
-											, (refGdkConverter ? refGdkConverter : GdkKeyConverterEvDev::getConverter())));
+											, (refGdkConverter ? refGdkConverter : GdkKeyConverterEvDev::getConverter())
+											, bCoalescePointerMotion));
 //std::cout << "FakeMasGtkDeviceManager::create 1" << '\n';
 		auto refBackend = std::make_unique<Mas::FakeGtkBackend>(refInstance.operator->()
 				, (refGdkDeviceManager ? refGdkDeviceManager : Gdk::Display::get_default()->get_device_manager()));
@@ -56,8 +58,9 @@ public:
 		return refInstance;
 	}
 	FakeMasGtkDeviceManager(bool bEnableEventClasses, const std::vector<Event::Class>& aEnDisableEventClasses
-						, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter) noexcept
-	: MasGtkDeviceManager(bEnableEventClasses, aEnDisableEventClasses, eKeyRepeatMode, refGdkConverter)
+						, KeyRepeat::MODE eKeyRepeatMode, const shared_ptr<GdkKeyConverter>& refGdkConverter
+						, bool bCoalescePointerMotion = false) noexcept
+	: MasGtkDeviceManager(bEnableEventClasses, aEnDisableEventClasses, eKeyRepeatMode, refGdkConverter, bCoalescePointerMotion)
 	, m_p0Factory(nullptr)
 	, m_p0Backend(nullptr)
 	{
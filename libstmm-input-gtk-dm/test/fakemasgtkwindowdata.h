@@ -83,7 +83,8 @@ public:
 		if (isEventClassEnabled(Event::Class{typeid(PointerScrollEvent)}) && !m_bScrollConn) {
 			m_bScrollConn = true;
 		}
-		if (isEventClassEnabled(Event::Class{typeid(TouchEvent)}) && !m_bTouchConn) {
+		if ((isEventClassEnabled(Event::Class{typeid(TouchEvent)}) || isEventClassEnabled(Event::Class{typeid(TouchFrameEvent)}))
+					&& !m_bTouchConn) {
 			m_bTouchConn = true;
 		}
 	}
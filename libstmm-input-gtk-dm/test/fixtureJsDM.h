@@ -135,6 +135,46 @@ protected:
 	shared_ptr<stmi::EventListener> m_refListener1;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// An evdev device: the axis values are normalized according to the abs info
+class JsDMOneWinOneAccOneEvdevDevOneListenerFixture : public JsDMOneWinOneAccFixture
+{
+protected:
+	void setup() override
+	{
+		JsDMOneWinOneAccFixture::setup();
+		//
+		m_p0FakeBackend = m_refAllEvDM->getBackend();
+		assert(m_p0FakeBackend != nullptr);
+		m_nDeviceId = m_p0FakeBackend->simulateNewDevice("TestEvdevJoystick"
+							, {BTN_A, BTN_B}
+							, 1
+							, {ABS_X, ABS_Y, ABS_RX, ABS_HAT0X, ABS_HAT0Y}
+							, {Private::Js::JoystickAbsInfo{130, 0, 255, 15} // within the flat zone
+							, Private::Js::JoystickAbsInfo{50, -100, 100, 0}
+							, Private::Js::JoystickAbsInfo{0, 0, 0, 0} // empty range
+							, Private::Js::JoystickAbsInfo{0, -1, 1, 0}
+							, Private::Js::JoystickAbsInfo{0, -1, 1, 0}});
+		assert(m_nDeviceId >= 0);
+		//
+		m_refListener1 = std::make_shared<stmi::EventListener>(
+				[&](const shared_ptr<stmi::Event>& refEvent)
+				{
+					m_aReceivedEvents1.emplace_back(refEvent);
+				});
+		#ifndef NDEBUG
+		const bool bListenerAdded =
+		#endif
+		m_refAllEvDM->addEventListener(m_refListener1, std::shared_ptr<stmi::CallIf>{});
+		assert(bListenerAdded);
+	}
+
+	Js::FakeGtkBackend* m_p0FakeBackend;
+	int32_t m_nDeviceId;
+	std::vector< shared_ptr<stmi::Event> > m_aReceivedEvents1;
+	shared_ptr<stmi::EventListener> m_refListener1;
+};
+
 } // namespace testing
 
 } // namespace stmi
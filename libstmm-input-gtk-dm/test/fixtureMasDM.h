@@ -25,6 +25,7 @@
 
 #include "fixturevariantKeyRepeatMode.h"
 #include "fixturevariantEventClasses.h"
+#include "fixturevariantCoalescePointerMotion.h"
 
 #include "fakemasgtkdevicemanager.h"
 #include <stmm-input/devicemanager.h>
@@ -43,6 +44,7 @@ class MasDMFixture : public GlibAppFixture
 					, public FixtureVariantKeyRepeatMode
 					, public FixtureVariantEventClassesEnable
 					, public FixtureVariantEventClasses
+					, public FixtureVariantCoalescePointerMotion
 {
 protected:
 	void setup() override
@@ -56,9 +58,11 @@ protected:
 //for (const auto& oClass : aClasses) {
 //std::cout << "---------->--------< " << oClass.getId() << '\n';
 //}
+		const bool bCoalescePointerMotion = FixtureVariantCoalescePointerMotion::getCoalescePointerMotion();
 		//
 		m_refAllEvDM = FakeMasGtkDeviceManager::create(bEventClassesEnable, aClasses, eKeyRepeatMode
-													, shared_ptr<GdkKeyConverter>{}, Glib::RefPtr<Gdk::DeviceManager>{});
+													, shared_ptr<GdkKeyConverter>{}, Glib::RefPtr<Gdk::DeviceManager>{}
+													, bCoalescePointerMotion);
 		assert(m_refAllEvDM.operator bool());
 	}
 
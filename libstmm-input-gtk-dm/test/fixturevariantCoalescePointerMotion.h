@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   fixturevariantCoalescePointerMotion.h
+ */
+
+#ifndef STMI_TESTING_FIXTURE_VARIANT_COALESCE_POINTER_MOTION_H
+#define STMI_TESTING_FIXTURE_VARIANT_COALESCE_POINTER_MOTION_H
+
+namespace stmi
+{
+
+namespace testing
+{
+
+class FixtureVariantCoalescePointerMotion_True
+{
+};
+class FixtureVariantCoalescePointerMotion
+{
+public:
+	virtual ~FixtureVariantCoalescePointerMotion() = default;
+protected:
+	bool getCoalescePointerMotion()
+	{
+		return (dynamic_cast<FixtureVariantCoalescePointerMotion_True*>(this) != nullptr);
+	}
+};
+
+} // namespace testing
+
+} // namespace stmi
+
+#endif /* STMI_TESTING_FIXTURE_VARIANT_COALESCE_POINTER_MOTION_H */
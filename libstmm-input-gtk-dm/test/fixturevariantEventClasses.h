@@ -65,6 +65,9 @@ class FixtureVariantEventClasses_PointerScrollEvent
 class FixtureVariantEventClasses_TouchEvent
 {
 };
+class FixtureVariantEventClasses_TouchFrameEvent
+{
+};
 class FixtureVariantEventClasses_JoystickButtonEvent
 {
 };
@@ -97,6 +100,9 @@ protected:
 		if (dynamic_cast<FixtureVariantEventClasses_TouchEvent*>(this) != nullptr) {
 			aClasses.push_back(TouchEvent::getClass());
 		}
+		if (dynamic_cast<FixtureVariantEventClasses_TouchFrameEvent*>(this) != nullptr) {
+			aClasses.push_back(TouchFrameEvent::getClass());
+		}
 		if (dynamic_cast<FixtureVariantEventClasses_JoystickButtonEvent*>(this) != nullptr) {
 			aClasses.push_back(JoystickButtonEvent::getClass());
 		}
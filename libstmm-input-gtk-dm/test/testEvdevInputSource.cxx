@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testEvdevInputSource.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "fixtureGlibApp.h"
+
+#include "joysticksources.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <linux/input.h>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+using Private::Js::EvdevInputSource;
+
+// The device is simulated by a pipe, the state read after dropped events is set by the test
+class FakeEvdevInputSource : public EvdevInputSource
+{
+public:
+	using EvdevInputSource::EvdevInputSource;
+
+	std::vector<int32_t> m_aPressedKeys;
+	std::vector<std::pair<int32_t, int32_t>> m_aAbsValues; // Value: (code, value)
+	int32_t m_nTotStateReads = 0;
+protected:
+	bool readKeyBits(uint8_t* p0KeyBits, int32_t nSize) noexcept override
+	{
+		++m_nTotStateReads;
+		std::memset(p0KeyBits, 0, nSize);
+		for (const int32_t nCode : m_aPressedKeys) {
+			p0KeyBits[nCode / 8] |= static_cast<uint8_t>(1 << (nCode % 8));
+		}
+		return true;
+	}
+	bool readAbsInfo(int32_t nCode, struct ::input_absinfo& oAbsInfo) noexcept override
+	{
+		for (const auto& oPair : m_aAbsValues) {
+			if (oPair.first == nCode) {
+				oAbsInfo = {};
+				oAbsInfo.value = oPair.second;
+				return true; //-------------------------------------------------
+			}
+		}
+		return false;
+	}
+};
+
+class EvdevInputSourceFixture : public GlibAppFixture
+{
+protected:
+	void setup() override
+	{
+		GlibAppFixture::setup();
+		const auto nRet = ::pipe2(m_aPipeFDs, O_NONBLOCK | O_CLOEXEC);
+		REQUIRE(nRet == 0);
+		m_refSource = Glib::RefPtr<FakeEvdevInputSource>(new FakeEvdevInputSource(m_aPipeFDs[0], "/dev/input/event77", 77, 1
+																			, true, {BTN_A, BTN_B}, {ABS_X, ABS_Y}));
+		m_refSource->connectFrame(sigc::mem_fun(this, &EvdevInputSourceFixture::onFrame));
+		m_refSource->attach();
+	}
+	void teardown() override
+	{
+		m_refSource->destroy();
+		m_refSource.reset();
+		::close(m_aPipeFDs[0]);
+		::close(m_aPipeFDs[1]);
+		GlibAppFixture::teardown();
+	}
+	void writeEvent(int32_t nType, int32_t nCode, int32_t nValue, int64_t nTimeUsec = 0)
+	{
+		struct ::input_event oEvent{};
+		oEvent.input_event_sec = nTimeUsec / 1000000;
+		oEvent.input_event_usec = nTimeUsec % 1000000;
+		oEvent.type = nType;
+		oEvent.code = nCode;
+		oEvent.value = nValue;
+		const auto nWritten = ::write(m_aPipeFDs[1], &oEvent, sizeof oEvent);
+		REQUIRE(nWritten == static_cast<ssize_t>(sizeof oEvent));
+	}
+	// Iterates the main loop until nTotFrames were received (or timeout)
+	void iterateUntil(int32_t nTotFrames)
+	{
+		auto refContext = Glib::MainContext::get_default();
+		const auto oStart = std::chrono::steady_clock::now();
+		while ((static_cast<int32_t>(m_aFrames.size()) < nTotFrames)
+				&& (std::chrono::steady_clock::now() - oStart < std::chrono::seconds(10))) {
+			refContext->iteration(false);
+		}
+	}
+	// Processes what is currently pending
+	void iteratePending()
+	{
+		auto refContext = Glib::MainContext::get_default();
+		int32_t nIterations = 0;
+		while (refContext->pending() && (nIterations < 100)) {
+			refContext->iteration(false);
+			++nIterations;
+		}
+	}
+	bool onFrame(const struct ::input_event* p0Events, int32_t nTotEvents, int64_t nFrameTimeUsec)
+	{
+		m_aFrames.emplace_back(p0Events, p0Events + nTotEvents);
+		m_aFrameTimes.push_back(nFrameTimeUsec);
+		return true;
+	}
+protected:
+	int m_aPipeFDs[2];
+	Glib::RefPtr<FakeEvdevInputSource> m_refSource;
+	std::vector<std::vector<struct ::input_event>> m_aFrames;
+	std::vector<int64_t> m_aFrameTimes;
+};
+
+TEST_CASE_METHOD(STFX<EvdevInputSourceFixture>, "FramesEndWithSynReport")
+{
+	writeEvent(EV_KEY, BTN_A, 1);
+	writeEvent(EV_ABS, ABS_X, 300);
+	iteratePending();
+	// incomplete frame
+	REQUIRE(m_aFrames.empty());
+
+	writeEvent(EV_SYN, SYN_REPORT, 0, 3000500);
+	iterateUntil(1);
+	REQUIRE(m_aFrames.size() == 1);
+	REQUIRE(m_aFrameTimes[0] == 3000500);
+	const auto& aFrame = m_aFrames[0];
+	REQUIRE(aFrame.size() == 2);
+	REQUIRE(aFrame[0].type == EV_KEY);
+	REQUIRE(aFrame[0].code == BTN_A);
+	REQUIRE(aFrame[0].value == 1);
+	REQUIRE(aFrame[1].type == EV_ABS);
+	REQUIRE(aFrame[1].code == ABS_X);
+	REQUIRE(aFrame[1].value == 300);
+	REQUIRE(m_refSource->m_nTotStateReads == 0);
+}
+
+TEST_CASE_METHOD(STFX<EvdevInputSourceFixture>, "SynDroppedResyncs")
+{
+	m_refSource->m_aPressedKeys = {BTN_B};
+	m_refSource->m_aAbsValues = {{ABS_X, 42}, {ABS_Y, -7}};
+
+	writeEvent(EV_KEY, BTN_A, 1);
+	writeEvent(EV_SYN, SYN_DROPPED, 0);
+	// discarded until the next SYN_REPORT
+	writeEvent(EV_ABS, ABS_X, 99);
+	writeEvent(EV_KEY, BTN_A, 0);
+	writeEvent(EV_SYN, SYN_REPORT, 0, 5000000);
+	// back to normal
+	writeEvent(EV_ABS, ABS_Y, 11);
+	writeEvent(EV_SYN, SYN_REPORT, 0, 5001000);
+	iterateUntil(2);
+
+	REQUIRE(m_refSource->m_nTotStateReads == 1);
+	REQUIRE(m_aFrames.size() == 2);
+	// the synthetic frame has the state of all the buttons and axes
+	const auto& aResync = m_aFrames[0];
+	REQUIRE(m_aFrameTimes[0] == 5000000);
+	REQUIRE(aResync.size() == 4);
+	REQUIRE(aResync[0].type == EV_KEY);
+	REQUIRE(aResync[0].code == BTN_A);
+	REQUIRE(aResync[0].value == 0);
+	REQUIRE(aResync[1].type == EV_KEY);
+	REQUIRE(aResync[1].code == BTN_B);
+	REQUIRE(aResync[1].value == 1);
+	REQUIRE(aResync[2].type == EV_ABS);
+	REQUIRE(aResync[2].code == ABS_X);
+	REQUIRE(aResync[2].value == 42);
+	REQUIRE(aResync[3].type == EV_ABS);
+	REQUIRE(aResync[3].code == ABS_Y);
+	REQUIRE(aResync[3].value == -7);
+
+	const auto& aFrame = m_aFrames[1];
+	REQUIRE(m_aFrameTimes[1] == 5001000);
+	REQUIRE(aFrame.size() == 1);
+	REQUIRE(aFrame[0].code == ABS_Y);
+	REQUIRE(aFrame[0].value == 11);
+}
+
+} // namespace testing
+
+} // namespace stmi
@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testGtkEventBatcher.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "fixtureGlibApp.h"
+
+#include "gtkeventbatcher.h"
+
+#include <stmm-input-ev/keycapability.h>
+#include <stmm-input-ev/keyevent.h>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace testing
+{
+
+class TestKeyCapability : public KeyCapability
+{
+public:
+	bool isKeyboard() const noexcept override { return true; }
+	shared_ptr<Device> getDevice() const noexcept override { return shared_ptr<Device>{}; }
+};
+
+class GtkEventBatcherFixture : public GlibAppFixture
+{
+protected:
+	void setup() override
+	{
+		GlibAppFixture::setup();
+		m_refKeyCapability = std::make_shared<TestKeyCapability>();
+		m_p0Batcher = nullptr;
+		m_refBatchListener = std::make_shared<BatchEventListener>(
+				[&](const shared_ptr<Event>* p0Events, int32_t nTotEvents)
+				{
+					m_aBatchSizes.push_back(nTotEvents);
+					for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+						m_aReceivedEvents.push_back(p0Events[nIdx]);
+					}
+					if (m_oOnBatch) {
+						m_oOnBatch();
+					}
+				});
+	}
+	shared_ptr<Event> createKeyEvent(HARDWARE_KEY eKey)
+	{
+		const auto nTimeUsec = DeviceManager::getNowTimeMicroseconds();
+		return std::make_shared<KeyEvent>(nTimeUsec, Accessor::s_refEmptyAccessor, m_refKeyCapability, KeyEvent::KEY_PRESS, eKey);
+	}
+	// Returns the number of iterations
+	int32_t iterateMainLoop()
+	{
+		auto refContext = Glib::MainContext::get_default();
+		int32_t nIterations = 0;
+		// bounded in case an idle source is never removed
+		while (refContext->pending() && (nIterations < 100)) {
+			refContext->iteration(false);
+			++nIterations;
+		}
+		return nIterations;
+	}
+protected:
+	shared_ptr<KeyCapability> m_refKeyCapability;
+	shared_ptr<BatchEventListener> m_refBatchListener;
+	GtkEventBatcher* m_p0Batcher;
+	std::function<void()> m_oOnBatch;
+	std::vector<int32_t> m_aBatchSizes;
+	std::vector< shared_ptr<Event> > m_aReceivedEvents;
+};
+
+TEST_CASE_METHOD(STFX<GtkEventBatcherFixture>, "IdleFlushesOncePerIteration")
+{
+	GtkEventBatcher oBatcher(m_refBatchListener);
+	const EventListener& oListener = *oBatcher.getEventListener();
+	auto refEvent1 = createKeyEvent(HK_A);
+	auto refEvent2 = createKeyEvent(HK_B);
+	oListener(refEvent1);
+	oListener(refEvent2);
+	REQUIRE(m_aReceivedEvents.empty());
+
+	iterateMainLoop();
+	REQUIRE(m_aBatchSizes == std::vector<int32_t>{2});
+	REQUIRE(m_aReceivedEvents.size() == 2);
+	REQUIRE(m_aReceivedEvents[0] == refEvent1);
+	REQUIRE(m_aReceivedEvents[1] == refEvent2);
+	REQUIRE(oBatcher.getTotPendingEvents() == 0);
+	// the idle source was removed
+	REQUIRE(iterateMainLoop() == 0);
+
+	auto refEvent3 = createKeyEvent(HK_C);
+	oListener(refEvent3);
+	iterateMainLoop();
+	REQUIRE(m_aBatchSizes == (std::vector<int32_t>{2, 1}));
+	REQUIRE(m_aReceivedEvents.back() == refEvent3);
+}
+
+TEST_CASE_METHOD(STFX<GtkEventBatcherFixture>, "IdleDeliversEventsReceivedWhileFlushing")
+{
+	GtkEventBatcher oBatcher(m_refBatchListener);
+	m_p0Batcher = &oBatcher;
+	const EventListener& oListener = *oBatcher.getEventListener();
+	auto refEvent1 = createKeyEvent(HK_A);
+	auto refEvent2 = createKeyEvent(HK_B);
+	m_oOnBatch = [&]()
+	{
+		if (m_aBatchSizes.size() == 1) {
+			// ex. a listener of another device manager sends an event from within the batch listener
+			(*m_p0Batcher->getEventListener())(refEvent2);
+		}
+	};
+	oListener(refEvent1);
+
+	iterateMainLoop();
+	REQUIRE(m_aBatchSizes == (std::vector<int32_t>{1, 1}));
+	REQUIRE(m_aReceivedEvents.size() == 2);
+	REQUIRE(m_aReceivedEvents[0] == refEvent1);
+	REQUIRE(m_aReceivedEvents[1] == refEvent2);
+	REQUIRE(oBatcher.getTotPendingEvents() == 0);
+	REQUIRE(iterateMainLoop() == 0);
+}
+
+} // namespace testing
+
+} // namespace stmi
@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testJoystickInputThread.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "joystickinputthread.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+using Private::Js::JoystickInputThread;
+
+// The write end of a pipe simulates the joystick device
+class JoystickPipe
+{
+public:
+	JoystickPipe()
+	{
+		m_aFDs[0] = -1;
+		m_aFDs[1] = -1;
+		const auto nRet = ::pipe2(m_aFDs, O_NONBLOCK | O_CLOEXEC);
+		(void)nRet;
+	}
+	~JoystickPipe()
+	{
+		for (int32_t nFD : m_aFDs) {
+			if (nFD >= 0) {
+				::close(nFD);
+			}
+		}
+	}
+	int32_t getReadFD() const { return m_aFDs[0]; }
+	bool write(const std::vector<struct ::js_event>& aEvents)
+	{
+		const auto nSize = static_cast<ssize_t>(sizeof(struct ::js_event) * aEvents.size());
+		return (::write(m_aFDs[1], aEvents.data(), nSize) == nSize);
+	}
+	void closeWriteEnd()
+	{
+		::close(m_aFDs[1]);
+		m_aFDs[1] = -1;
+	}
+private:
+	int m_aFDs[2];
+};
+
+static struct ::js_event makeAxisEvent(uint32_t nTimeMsec, int16_t nValue)
+{
+	struct ::js_event oEvent;
+	oEvent.time = nTimeMsec;
+	oEvent.value = nValue;
+	oEvent.type = JS_EVENT_AXIS;
+	oEvent.number = 0;
+	return oEvent;
+}
+
+// Waits for the wakeup eventfd and pops all the events
+static int32_t waitAndPop(JoystickInputThread& oThread, std::vector<JoystickInputThread::JoystickThreadEvent>& aEvents
+						, int32_t nTimeoutMillisec)
+{
+	struct ::pollfd oPollFD;
+	oPollFD.fd = oThread.getWakeupFD();
+	oPollFD.events = POLLIN;
+	if (::poll(&oPollFD, 1, nTimeoutMillisec) <= 0) {
+		return 0;
+	}
+	oThread.clearWakeup();
+	int32_t nTotPopped = 0;
+	JoystickInputThread::JoystickThreadEvent oEvent;
+	while (oThread.popEvent(oEvent)) {
+		aEvents.push_back(oEvent);
+		++nTotPopped;
+	}
+	oThread.endPop();
+	return nTotPopped;
+}
+
+TEST_CASE("testJoystickInputThread, ReadsAndWakesUp")
+{
+	JoystickPipe oPipe1;
+	JoystickPipe oPipe2;
+	JoystickInputThread oThread;
+	REQUIRE(oThread.start().empty());
+	REQUIRE(oThread.addFD(oPipe1.getReadFD(), 1));
+	REQUIRE(oThread.addFD(oPipe2.getReadFD(), 2));
+
+	REQUIRE(oPipe1.write({makeAxisEvent(10, 100), makeAxisEvent(11, 101)}));
+	std::vector<JoystickInputThread::JoystickThreadEvent> aEvents;
+	while (aEvents.size() < 2) {
+		REQUIRE(waitAndPop(oThread, aEvents, 5000) > 0);
+	}
+	REQUIRE(aEvents.size() == 2);
+	REQUIRE(aEvents[0].m_nDeviceId == 1);
+	REQUIRE(aEvents[0].m_oEvent.value == 100);
+	REQUIRE(aEvents[1].m_oEvent.value == 101);
+
+	aEvents.clear();
+	REQUIRE(oPipe2.write({makeAxisEvent(12, -5)}));
+	REQUIRE(waitAndPop(oThread, aEvents, 5000) == 1);
+	REQUIRE(aEvents[0].m_nDeviceId == 2);
+	REQUIRE(aEvents[0].m_oEvent.value == -5);
+
+	// after removeFD returns the file descriptor isn't read anymore
+	oThread.removeFD(oPipe2.getReadFD());
+	aEvents.clear();
+	REQUIRE(oPipe2.write({makeAxisEvent(13, 7)}));
+	REQUIRE(waitAndPop(oThread, aEvents, 100) == 0);
+}
+
+TEST_CASE("testJoystickInputThread, FullRingWaitsForConsumer")
+{
+	JoystickPipe oPipe;
+	// the kernel pipe buffer holds more than the ring
+	JoystickInputThread oThread(16);
+	REQUIRE(oThread.start().empty());
+	REQUIRE(oThread.addFD(oPipe.getReadFD(), 3));
+
+	constexpr int32_t nTotEvents = 1000;
+	std::vector<struct ::js_event> aWritten;
+	for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+		aWritten.push_back(makeAxisEvent(static_cast<uint32_t>(nIdx), static_cast<int16_t>(nIdx)));
+	}
+	REQUIRE(oPipe.write(aWritten));
+
+	// let the thread fill the ring
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	std::vector<JoystickInputThread::JoystickThreadEvent> aEvents;
+	const auto oStart = std::chrono::steady_clock::now();
+	while ((static_cast<int32_t>(aEvents.size()) < nTotEvents)
+			&& (std::chrono::steady_clock::now() - oStart < std::chrono::seconds(10))) {
+		waitAndPop(oThread, aEvents, 1000);
+	}
+	REQUIRE(static_cast<int32_t>(aEvents.size()) == nTotEvents);
+	bool bInOrder = true;
+	for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+		if ((aEvents[nIdx].m_nDeviceId != 3) || (aEvents[nIdx].m_oEvent.value != nIdx)) {
+			bInOrder = false;
+		}
+	}
+	REQUIRE(bInOrder);
+}
+
+TEST_CASE("testJoystickInputThread, DeviceGone")
+{
+	JoystickPipe oPipe;
+	JoystickInputThread oThread;
+	REQUIRE(oThread.start().empty());
+	REQUIRE(oThread.addFD(oPipe.getReadFD(), 4));
+	REQUIRE(oPipe.write({makeAxisEvent(1, 1)}));
+	oPipe.closeWriteEnd();
+	std::vector<JoystickInputThread::JoystickThreadEvent> aEvents;
+	REQUIRE(waitAndPop(oThread, aEvents, 5000) == 1);
+	// the thread stopped polling the file descriptor (removeFD does nothing)
+	oThread.removeFD(oPipe.getReadFD());
+}
+
+} // namespace testing
+
+} // namespace stmi
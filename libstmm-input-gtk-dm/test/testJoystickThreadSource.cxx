@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2016-2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testJoystickThreadSource.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "fixtureGlibApp.h"
+
+#include "joysticksources.h"
+#include "joystickinputthread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace stmi
+{
+
+namespace testing
+{
+
+using Private::Js::JoystickInputThread;
+using Private::Js::JoystickThreadSource;
+
+class JoystickThreadSourceFixture : public GlibAppFixture
+{
+protected:
+	void setup() override
+	{
+		GlibAppFixture::setup();
+		for (auto& aFDs : m_aPipeFDs) {
+			const auto nRet = ::pipe2(aFDs, O_NONBLOCK | O_CLOEXEC);
+			REQUIRE(nRet == 0);
+		}
+		m_refThread = std::make_unique<JoystickInputThread>(16);
+		REQUIRE(m_refThread->start().empty());
+		REQUIRE(m_refThread->addFD(m_aPipeFDs[0][0], 1));
+		REQUIRE(m_refThread->addFD(m_aPipeFDs[1][0], 2));
+		m_refSource = Glib::RefPtr<JoystickThreadSource>(new JoystickThreadSource(*m_refThread));
+		m_refSource->connect(sigc::mem_fun(this, &JoystickThreadSourceFixture::onEvents));
+		m_refSource->attach();
+	}
+	void teardown() override
+	{
+		m_refSource->destroy();
+		m_refSource.reset();
+		m_refThread.reset();
+		for (auto& aFDs : m_aPipeFDs) {
+			::close(aFDs[0]);
+			::close(aFDs[1]);
+		}
+		GlibAppFixture::teardown();
+	}
+	void writeAxisEvents(int32_t nDevice, int32_t nFirstValue, int32_t nTotEvents)
+	{
+		std::vector<struct ::js_event> aEvents;
+		for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+			struct ::js_event oEvent;
+			oEvent.time = static_cast<uint32_t>(nFirstValue + nIdx);
+			oEvent.value = static_cast<int16_t>(nFirstValue + nIdx);
+			oEvent.type = JS_EVENT_AXIS;
+			oEvent.number = 0;
+			aEvents.push_back(oEvent);
+		}
+		const auto nSize = static_cast<ssize_t>(sizeof(struct ::js_event) * aEvents.size());
+		const auto nWritten = ::write(m_aPipeFDs[nDevice - 1][1], aEvents.data(), nSize);
+		REQUIRE(nWritten == nSize);
+	}
+	int32_t getTotReceived(int32_t nDeviceId) const
+	{
+		return static_cast<int32_t>(std::count_if(m_aReceived.begin(), m_aReceived.end()
+				, [&](const std::pair<int32_t, int32_t>& oPair) { return (oPair.first == nDeviceId); }));
+	}
+	// Iterates the main loop until nTotEvents of device nDeviceId were received (or timeout)
+	void iterateUntil(int32_t nDeviceId, int32_t nTotEvents)
+	{
+		auto refContext = Glib::MainContext::get_default();
+		const auto oStart = std::chrono::steady_clock::now();
+		while ((getTotReceived(nDeviceId) < nTotEvents)
+				&& (std::chrono::steady_clock::now() - oStart < std::chrono::seconds(10))) {
+			refContext->iteration(false);
+		}
+	}
+	bool onEvents(int32_t nDeviceId, const struct ::js_event* p0JoyEvents, int32_t nTotEvents)
+	{
+		REQUIRE(nTotEvents > 0);
+		m_aBatchSizes.push_back(nTotEvents);
+		for (int32_t nIdx = 0; nIdx < nTotEvents; ++nIdx) {
+			m_aReceived.emplace_back(nDeviceId, p0JoyEvents[nIdx].value);
+		}
+		return (nDeviceId != m_nRejectDeviceId);
+	}
+protected:
+	int m_aPipeFDs[2][2];
+	std::unique_ptr<JoystickInputThread> m_refThread;
+	Glib::RefPtr<JoystickThreadSource> m_refSource;
+	int32_t m_nRejectDeviceId = -1;
+	std::vector<int32_t> m_aBatchSizes;
+	std::vector<std::pair<int32_t, int32_t>> m_aReceived; // Value: (device id, value)
+};
+
+TEST_CASE_METHOD(STFX<JoystickThreadSourceFixture>, "DeliversAllEventsInOrder")
+{
+	// more than the ring can hold
+	writeAxisEvents(1, 0, 500);
+	iterateUntil(1, 500);
+	REQUIRE(m_aReceived.size() == 500);
+	bool bInOrder = true;
+	for (int32_t nIdx = 0; nIdx < 500; ++nIdx) {
+		if ((m_aReceived[nIdx].first != 1) || (m_aReceived[nIdx].second != nIdx)) {
+			bInOrder = false;
+		}
+	}
+	REQUIRE(bInOrder);
+	// batches are limited in size
+	for (const int32_t nBatchSize : m_aBatchSizes) {
+		REQUIRE(nBatchSize <= 32);
+	}
+}
+
+TEST_CASE_METHOD(STFX<JoystickThreadSourceFixture>, "RejectingDeviceDiscardsItsQueuedEvents")
+{
+	m_nRejectDeviceId = 1;
+	writeAxisEvents(1, 0, 10);
+	writeAxisEvents(2, 100, 10);
+	iterateUntil(2, 10);
+	// device 2 got all its events in order
+	int32_t nTotDevice1 = 0;
+	int32_t nTotDevice2 = 0;
+	for (const auto& oPair : m_aReceived) {
+		if (oPair.first == 1) {
+			++nTotDevice1;
+		} else {
+			REQUIRE(oPair.second == 100 + nTotDevice2);
+			++nTotDevice2;
+		}
+	}
+	REQUIRE(nTotDevice1 >= 1);
+	REQUIRE(nTotDevice2 == 10);
+}
+
+} // namespace testing
+
+} // namespace stmi
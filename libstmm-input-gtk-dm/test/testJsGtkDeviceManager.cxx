@@ -25,6 +25,9 @@
 
 #include <stmm-input/callifs.h>
 
+#include <chrono>
+#include <functional>
+
 namespace stmi
 {
 
@@ -441,6 +444,235 @@ TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "AxisEvents")
 	REQUIRE(refJCapa1->getAxisValue(JoystickCapability::AXIS_RX) == 9999);
 }
 
+TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "CoalescedAxisEvents")
+{
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	REQUIRE(m_aReceivedEvents1.size() == 0);
+
+	std::vector<struct js_event> aJsEvents(5);
+	for (auto& oEv : aJsEvents) {
+		oEv.time = 0;
+		oEv.type = JS_EVENT_AXIS;
+	}
+	aJsEvents[0].number = 2; // ABS_RX
+	aJsEvents[0].value = 100;
+	aJsEvents[1].number = 2;
+	aJsEvents[1].value = 200;
+	aJsEvents[2].type = JS_EVENT_BUTTON;
+	aJsEvents[2].number = 0; // BTN_A
+	aJsEvents[2].value = 1;
+	aJsEvents[3].number = 3; // ABS_RY
+	aJsEvents[3].value = -50;
+	aJsEvents[4].number = 2;
+	aJsEvents[4].value = 300;
+	m_p0FakeBackend->simulateJsEvents(m_nDeviceId, aJsEvents, true);
+
+	// only the latest ABS_RX value is sent
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	REQUIRE(m_aReceivedEvents1[0]->getEventClass() == typeid(JoystickButtonEvent));
+	REQUIRE(m_aReceivedEvents1[1]->getEventClass() == typeid(JoystickAxisEvent));
+	auto p0AxisEvent1 = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[1].get());
+	REQUIRE(p0AxisEvent1->getAxis() == JoystickCapability::AXIS_RY);
+	REQUIRE(p0AxisEvent1->getValue() == -50);
+	REQUIRE(m_aReceivedEvents1[2]->getEventClass() == typeid(JoystickAxisEvent));
+	auto p0AxisEvent2 = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[2].get());
+	REQUIRE(p0AxisEvent2->getAxis() == JoystickCapability::AXIS_RX);
+	REQUIRE(p0AxisEvent2->getValue() == 300);
+
+	// without coalescing every change is sent
+	aJsEvents[2].value = 0;
+	aJsEvents[3].value = 50;
+	m_p0FakeBackend->simulateJsEvents(m_nDeviceId, aJsEvents, false);
+
+	REQUIRE(m_aReceivedEvents1.size() == 3 + 5);
+}
+
+TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "AxisFilter")
+{
+	JsDeviceFiles::AxisFilter oAxisFilter;
+	oAxisFilter.m_nDeadZone = 1000;
+	oAxisFilter.m_nMinDelta = 500;
+	m_p0FakeBackend->setAxisFilter(m_nDeviceId, JoystickCapability::AXIS_RX, oAxisFilter);
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	REQUIRE(m_aReceivedEvents1.size() == 0);
+
+	auto oSimulateRX = [&](int32_t nValue)
+	{
+		js_event oEv;
+		oEv.time = 0;
+		oEv.type = JS_EVENT_AXIS;
+		oEv.number = 2; // ABS_RX
+		oEv.value = nValue;
+		m_p0FakeBackend->simulateJsEvent(m_nDeviceId, &oEv);
+	};
+	// within the dead zone
+	oSimulateRX(900);
+	REQUIRE(m_aReceivedEvents1.size() == 0);
+	oSimulateRX(2000);
+	REQUIRE(m_aReceivedEvents1.size() == 1);
+	// less than the minimum delta
+	oSimulateRX(2300);
+	REQUIRE(m_aReceivedEvents1.size() == 1);
+	oSimulateRX(2600);
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+	// back to the center
+	oSimulateRX(-400);
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+
+	auto p0AxisEvent = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[1].get());
+	REQUIRE(p0AxisEvent->getValue() == 2600);
+	p0AxisEvent = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[2].get());
+	REQUIRE(p0AxisEvent->getValue() == 0);
+}
+
+TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "EvdevFrame")
+{
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	REQUIRE(m_aReceivedEvents1.size() == 0);
+
+	const int64_t nFrameTimeUsec = 1234567;
+	std::vector<struct input_event> aFrame(4);
+	aFrame[0].type = EV_KEY;
+	aFrame[0].code = BTN_A;
+	aFrame[0].value = 1;
+	aFrame[1].type = EV_ABS;
+	aFrame[1].code = ABS_HAT0X;
+	aFrame[1].value = 1;
+	aFrame[2].type = EV_ABS;
+	aFrame[2].code = ABS_HAT0Y;
+	aFrame[2].value = 1;
+	aFrame[3].type = EV_ABS;
+	aFrame[3].code = ABS_RX;
+	aFrame[3].value = 9999;
+	m_p0FakeBackend->simulateEvdevFrame(m_nDeviceId, aFrame, nFrameTimeUsec);
+
+	// both hat axes changed within the frame: only one hat event
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	for (auto& refEvent : m_aReceivedEvents1) {
+		REQUIRE(refEvent->getTimeUsec() == nFrameTimeUsec);
+	}
+	REQUIRE(m_aReceivedEvents1[0]->getEventClass() == typeid(JoystickButtonEvent));
+	auto p0ButtonEvent = static_cast<JoystickButtonEvent*>(m_aReceivedEvents1[0].get());
+	REQUIRE(p0ButtonEvent->getButton() == JoystickCapability::BUTTON_A);
+	REQUIRE(p0ButtonEvent->getType() == JoystickButtonEvent::BUTTON_PRESS);
+	REQUIRE(m_aReceivedEvents1[1]->getEventClass() == typeid(JoystickHatEvent));
+	auto p0HatEvent = static_cast<JoystickHatEvent*>(m_aReceivedEvents1[1].get());
+	REQUIRE(p0HatEvent->getValue() == JoystickCapability::HAT_RIGHTDOWN);
+	REQUIRE(p0HatEvent->getPreviousValue() == JoystickCapability::HAT_CENTER);
+	REQUIRE(m_aReceivedEvents1[2]->getEventClass() == typeid(JoystickAxisEvent));
+	auto p0AxisEvent = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[2].get());
+	REQUIRE(p0AxisEvent->getAxis() == JoystickCapability::AXIS_RX);
+	REQUIRE(p0AxisEvent->getValue() == 9999);
+
+	// autorepeat of a pressed button is ignored
+	std::vector<struct input_event> aFrame2(1);
+	aFrame2[0].type = EV_KEY;
+	aFrame2[0].code = BTN_A;
+	aFrame2[0].value = 2;
+	m_p0FakeBackend->simulateEvdevFrame(m_nDeviceId, aFrame2, nFrameTimeUsec + 1000);
+
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+}
+
+TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneEvdevDevOneListenerFixture>, "EvdevAbsInfo")
+{
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	auto refDevice = m_refAllEvDM->getDevice(m_nDeviceId);
+	REQUIRE(refDevice.operator bool());
+	auto refJCapa = std::static_pointer_cast<JoystickCapability>(refDevice->getCapability(JoystickCapability::getClass()));
+	REQUIRE(refJCapa.operator bool());
+	// the values at opening time are normalized
+	REQUIRE(refJCapa->getAxisValue(JoystickCapability::AXIS_X) == 0); // within the flat zone
+	REQUIRE(refJCapa->getAxisValue(JoystickCapability::AXIS_Y) == 16383);
+	REQUIRE(refJCapa->getAxisValue(JoystickCapability::AXIS_RX) == 0);
+
+	REQUIRE(m_aReceivedEvents1.size() == 0);
+
+	int64_t nFrameTimeUsec = 1000000;
+	auto simulateAbsFrame = [&](const std::vector<std::pair<int32_t, int32_t>>& aCodeValues)
+	{
+		std::vector<struct input_event> aFrame(aCodeValues.size());
+		for (std::size_t nIdx = 0; nIdx < aCodeValues.size(); ++nIdx) {
+			aFrame[nIdx].type = EV_ABS;
+			aFrame[nIdx].code = aCodeValues[nIdx].first;
+			aFrame[nIdx].value = aCodeValues[nIdx].second;
+		}
+		nFrameTimeUsec += 1000;
+		m_p0FakeBackend->simulateEvdevFrame(m_nDeviceId, aFrame, nFrameTimeUsec);
+	};
+	auto getAxisEvent = [&](std::size_t nIdx) -> JoystickAxisEvent*
+	{
+		REQUIRE(m_aReceivedEvents1[nIdx]->getEventClass() == typeid(JoystickAxisEvent));
+		return static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[nIdx].get());
+	};
+
+	// the range limits map to the normalized limits, an empty range to 0
+	simulateAbsFrame({{ABS_X, 255}, {ABS_Y, -100}, {ABS_RX, 77}});
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+	REQUIRE(getAxisEvent(0)->getAxis() == JoystickCapability::AXIS_X);
+	REQUIRE(getAxisEvent(0)->getValue() == 32767);
+	REQUIRE(getAxisEvent(1)->getAxis() == JoystickCapability::AXIS_Y);
+	REQUIRE(getAxisEvent(1)->getValue() == -32767);
+
+	// outside the range is clamped
+	simulateAbsFrame({{ABS_X, 0}, {ABS_Y, 1000}});
+	REQUIRE(m_aReceivedEvents1.size() == 4);
+	REQUIRE(getAxisEvent(2)->getValue() == -32767);
+	REQUIRE(getAxisEvent(3)->getValue() == 32767);
+
+	// the flat zone is within 15 of the center 127.5
+	simulateAbsFrame({{ABS_X, 143}});
+	REQUIRE(m_aReceivedEvents1.size() == 5);
+	REQUIRE(getAxisEvent(4)->getValue() == 31 * 32767 / 255);
+	simulateAbsFrame({{ABS_X, 142}});
+	REQUIRE(m_aReceivedEvents1.size() == 6);
+	REQUIRE(getAxisEvent(5)->getValue() == 0);
+	simulateAbsFrame({{ABS_X, 113}});
+	REQUIRE(m_aReceivedEvents1.size() == 6);
+	REQUIRE(refJCapa->getAxisValue(JoystickCapability::AXIS_X) == 0);
+	simulateAbsFrame({{ABS_X, 112}});
+	REQUIRE(m_aReceivedEvents1.size() == 7);
+	REQUIRE(getAxisEvent(6)->getValue() == -31 * 32767 / 255);
+
+	// a resynchronization after dropped events (all buttons and axes)
+	// only sends what changed
+	std::vector<struct input_event> aResync(7);
+	aResync[0].type = EV_KEY;
+	aResync[0].code = BTN_A;
+	aResync[0].value = 0;
+	aResync[1].type = EV_KEY;
+	aResync[1].code = BTN_B;
+	aResync[1].value = 1;
+	aResync[2].type = EV_ABS;
+	aResync[2].code = ABS_X;
+	aResync[2].value = 112;
+	aResync[3].type = EV_ABS;
+	aResync[3].code = ABS_Y;
+	aResync[3].value = 0;
+	aResync[4].type = EV_ABS;
+	aResync[4].code = ABS_RX;
+	aResync[4].value = 0;
+	aResync[5].type = EV_ABS;
+	aResync[5].code = ABS_HAT0X;
+	aResync[5].value = 0;
+	aResync[6].type = EV_ABS;
+	aResync[6].code = ABS_HAT0Y;
+	aResync[6].value = 0;
+	m_p0FakeBackend->simulateEvdevFrame(m_nDeviceId, aResync, nFrameTimeUsec + 1000);
+	REQUIRE(m_aReceivedEvents1.size() == 9);
+	REQUIRE(m_aReceivedEvents1[7]->getEventClass() == typeid(JoystickButtonEvent));
+	auto p0ButtonEvent = static_cast<JoystickButtonEvent*>(m_aReceivedEvents1[7].get());
+	REQUIRE(p0ButtonEvent->getButton() == JoystickCapability::BUTTON_B);
+	REQUIRE(p0ButtonEvent->getType() == JoystickButtonEvent::BUTTON_PRESS);
+	REQUIRE(getAxisEvent(8)->getAxis() == JoystickCapability::AXIS_Y);
+	REQUIRE(getAxisEvent(8)->getValue() == 0);
+}
+
 TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "ThreeListeners")
 {
 	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
@@ -593,6 +825,180 @@ TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "ThreeListeners
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Iterates the main loop until oDone returns true or nTimeoutMillisec elapsed.
+// Returns oDone().
+static bool iterateMainLoopUntil(const std::function<bool()>& oDone, int32_t nTimeoutMillisec)
+{
+	auto refContext = Glib::MainContext::get_default();
+	const auto oStart = std::chrono::steady_clock::now();
+	while (!oDone() && (std::chrono::steady_clock::now() - oStart < std::chrono::milliseconds(nTimeoutMillisec))) {
+		refContext->iteration(false);
+	}
+	return oDone();
+}
+
+TEST_CASE_METHOD(STFX<JsDMFixture>, "PendingDeviceRetry")
+{
+	using LIFE_EVENT = Private::Js::JoystickLifeSource::LIFE_EVENT;
+	auto p0FakeBackend = m_refAllEvDM->getBackend();
+	const std::string sPathName = "/dev/input/js7";
+
+	// created but not accessible yet
+	p0FakeBackend->simulateLifeEvent("/dev/input", "js7", LIFE_EVENT::LIFE_EVENT_ADDED);
+	REQUIRE(p0FakeBackend->getTotProbes(sPathName) == 1);
+	REQUIRE(p0FakeBackend->isPendingDevice(sPathName));
+
+	// the fallback timeout retries with increasing intervals
+	REQUIRE(iterateMainLoopUntil([&]() { return (p0FakeBackend->getTotProbes(sPathName) >= 3); }, 1000));
+	REQUIRE(p0FakeBackend->isPendingDevice(sPathName));
+
+	// the permissions change
+	p0FakeBackend->setProbeResult(sPathName, Js::FakeGtkBackend::PROBE_JOYSTICK);
+	p0FakeBackend->simulateLifeEvent("/dev/input", "js7", LIFE_EVENT::LIFE_EVENT_ATTRIB);
+	REQUIRE_FALSE(p0FakeBackend->isPendingDevice(sPathName));
+	const int32_t nDeviceId = p0FakeBackend->getFileDeviceId(sPathName);
+	REQUIRE(nDeviceId >= 0);
+	REQUIRE(m_refAllEvDM->getDevice(nDeviceId).operator bool());
+
+	// no more retries
+	const int32_t nTotProbes = p0FakeBackend->getTotProbes(sPathName);
+	iterateMainLoopUntil([&]() { return false; }, 100);
+	REQUIRE(p0FakeBackend->getTotProbes(sPathName) == nTotProbes);
+}
+
+TEST_CASE_METHOD(STFX<JsDMFixture>, "PendingDeviceGiveUp")
+{
+	using LIFE_EVENT = Private::Js::JoystickLifeSource::LIFE_EVENT;
+	auto p0FakeBackend = m_refAllEvDM->getBackend();
+	const std::string sPathName = "/dev/input/js8";
+
+	p0FakeBackend->simulateLifeEvent("/dev/input", "js8", LIFE_EVENT::LIFE_EVENT_ADDED);
+	REQUIRE(p0FakeBackend->isPendingDevice(sPathName));
+	REQUIRE(iterateMainLoopUntil([&]() { return !p0FakeBackend->isPendingDevice(sPathName); }, 10000));
+	const int32_t nTotProbes = p0FakeBackend->getTotProbes(sPathName);
+	REQUIRE(nTotProbes > 3);
+
+	// a later change of the permissions is still tried
+	p0FakeBackend->setProbeResult(sPathName, Js::FakeGtkBackend::PROBE_JOYSTICK);
+	p0FakeBackend->simulateLifeEvent("/dev/input", "js8", LIFE_EVENT::LIFE_EVENT_ATTRIB);
+	REQUIRE(p0FakeBackend->getTotProbes(sPathName) == nTotProbes + 1);
+	REQUIRE(p0FakeBackend->getFileDeviceId(sPathName) >= 0);
+}
+
+TEST_CASE_METHOD(STFX<JsDMFixture>, "NotJoystickFileIsProbedOnce")
+{
+	using LIFE_EVENT = Private::Js::JoystickLifeSource::LIFE_EVENT;
+	auto p0FakeBackend = m_refAllEvDM->getBackend();
+	const std::string sPathName = "/dev/input/event3";
+
+	// ex. a keyboard
+	p0FakeBackend->setProbeResult(sPathName, Js::FakeGtkBackend::PROBE_NOT_JOYSTICK);
+	p0FakeBackend->simulateLifeEvent("/dev/input", "event3", LIFE_EVENT::LIFE_EVENT_ADDED);
+	REQUIRE(p0FakeBackend->getTotProbes(sPathName) == 1);
+	REQUIRE_FALSE(p0FakeBackend->isPendingDevice(sPathName));
+	REQUIRE(p0FakeBackend->isNotJoystickFile(sPathName));
+
+	p0FakeBackend->simulateLifeEvent("/dev/input", "event3", LIFE_EVENT::LIFE_EVENT_ATTRIB);
+	p0FakeBackend->simulateLifeEvent("/dev/input", "event3", LIFE_EVENT::LIFE_EVENT_CLOSE_WRITE);
+	p0FakeBackend->simulateLifeEvent("/dev/input", "event3", LIFE_EVENT::LIFE_EVENT_ATTRIB);
+	REQUIRE(p0FakeBackend->getTotProbes(sPathName) == 1);
+
+	// the node is reused by a joystick
+	p0FakeBackend->simulateLifeEvent("/dev/input", "event3", LIFE_EVENT::LIFE_EVENT_REMOVED);
+	REQUIRE_FALSE(p0FakeBackend->isNotJoystickFile(sPathName));
+	p0FakeBackend->setProbeResult(sPathName, Js::FakeGtkBackend::PROBE_JOYSTICK);
+	p0FakeBackend->simulateLifeEvent("/dev/input", "event3", LIFE_EVENT::LIFE_EVENT_ADDED);
+	REQUIRE(p0FakeBackend->getTotProbes(sPathName) == 2);
+	REQUIRE(p0FakeBackend->getFileDeviceId(sPathName) >= 0);
+}
+
+TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "AxisRateLimit")
+{
+	JsDeviceFiles::AxisFilter oAxisFilter;
+	oAxisFilter.m_nMaxRate = 10; // one event every 100 milliseconds
+	m_p0FakeBackend->setAxisFilter(m_nDeviceId, JoystickCapability::AXIS_RX, oAxisFilter);
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	auto oSimulateRX = [&](int32_t nValue, int64_t nFrameTimeUsec)
+	{
+		std::vector<struct input_event> aFrame(1);
+		aFrame[0].type = EV_ABS;
+		aFrame[0].code = ABS_RX;
+		aFrame[0].value = nValue;
+		m_p0FakeBackend->simulateEvdevFrame(m_nDeviceId, aFrame, nFrameTimeUsec);
+	};
+	// the time base of the device doesn't need to be the current time
+	const int64_t nStartUsec = 1000000;
+	oSimulateRX(1000, nStartUsec);
+	REQUIRE(m_aReceivedEvents1.size() == 1);
+	// too soon, only the latest is sent at the end of the interval
+	oSimulateRX(2000, nStartUsec + 10000);
+	oSimulateRX(3000, nStartUsec + 20000);
+	REQUIRE(m_aReceivedEvents1.size() == 1);
+
+	REQUIRE(iterateMainLoopUntil([&]() { return (m_aReceivedEvents1.size() >= 2); }, 2000));
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+	auto p0AxisEvent = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[1].get());
+	REQUIRE(p0AxisEvent->getValue() == 3000);
+	// same time base as the events sent directly
+	REQUIRE(p0AxisEvent->getTimeUsec() == nStartUsec + 100000);
+
+	// pending, but a later change arrives after the end of the interval
+	oSimulateRX(4000, nStartUsec + 150000);
+	oSimulateRX(5000, nStartUsec + 250000);
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	iterateMainLoopUntil([&]() { return false; }, 200);
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	p0AxisEvent = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[2].get());
+	REQUIRE(p0AxisEvent->getValue() == 5000);
+	REQUIRE(p0AxisEvent->getTimeUsec() == nStartUsec + 250000);
+}
+
+TEST_CASE_METHOD(STFX<JsDMOneWinOneAccOneDevOneListenerFixture>, "AxisRateLimitEarlierDeadline")
+{
+	JsDeviceFiles::AxisFilter oAxisFilter;
+	oAxisFilter.m_nMaxRate = 1; // one event every second
+	m_p0FakeBackend->setAxisFilter(m_nDeviceId, JoystickCapability::AXIS_RX, oAxisFilter);
+	oAxisFilter.m_nMaxRate = 20; // one event every 50 milliseconds
+	m_p0FakeBackend->setAxisFilter(m_nDeviceId, JoystickCapability::AXIS_RY, oAxisFilter);
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	auto oSimulateAxis = [&](int32_t nCode, int32_t nValue, int64_t nFrameTimeUsec)
+	{
+		std::vector<struct input_event> aFrame(1);
+		aFrame[0].type = EV_ABS;
+		aFrame[0].code = nCode;
+		aFrame[0].value = nValue;
+		m_p0FakeBackend->simulateEvdevFrame(m_nDeviceId, aFrame, nFrameTimeUsec);
+	};
+	const int64_t nStartUsec = 1000000;
+	oSimulateAxis(ABS_RX, 1000, nStartUsec);
+	// pending until nStartUsec + 1000000
+	oSimulateAxis(ABS_RX, 2000, nStartUsec + 10000);
+	oSimulateAxis(ABS_RY, 1000, nStartUsec + 10000);
+	// pending until nStartUsec + 60000, must not wait for RX
+	oSimulateAxis(ABS_RY, 2000, nStartUsec + 20000);
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+
+	REQUIRE(iterateMainLoopUntil([&]() { return (m_aReceivedEvents1.size() >= 3); }, 500));
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	auto p0AxisEvent = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[2].get());
+	REQUIRE(p0AxisEvent->getAxis() == JoystickCapability::AXIS_RY);
+	REQUIRE(p0AxisEvent->getValue() == 2000);
+	REQUIRE(p0AxisEvent->getTimeUsec() == nStartUsec + 60000);
+
+	// RX is still sent at the end of its own interval
+	REQUIRE(iterateMainLoopUntil([&]() { return (m_aReceivedEvents1.size() >= 4); }, 2000));
+	REQUIRE(m_aReceivedEvents1.size() == 4);
+	p0AxisEvent = static_cast<JoystickAxisEvent*>(m_aReceivedEvents1[3].get());
+	REQUIRE(p0AxisEvent->getAxis() == JoystickCapability::AXIS_RX);
+	REQUIRE(p0AxisEvent->getValue() == 2000);
+	REQUIRE(p0AxisEvent->getTimeUsec() == nStartUsec + 1000000);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 class JsDMDelayedEventEnablingFixture : public JsDMOneWinOneAccOneDevOneListenerFixture
 										, public FixtureVariantEventClassesEnable_True
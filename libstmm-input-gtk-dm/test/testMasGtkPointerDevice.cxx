@@ -308,6 +308,208 @@ TEST_CASE_METHOD(STFX<MasDMOneWinOneAccOneListenerFixture>, "TouchSequence")
 	REQUIRE(m_aReceivedEvents1.size() == 3);
 }
 
+static void iterateMainLoopPending()
+{
+	auto refContext = Glib::MainContext::get_default();
+	int32_t nIterations = 0;
+	while (refContext->pending() && (nIterations < 100)) {
+		refContext->iteration(false);
+		++nIterations;
+	}
+}
+
+TEST_CASE_METHOD(STFX<MasDMOneWinOneAccOneListenerFixture>, "TouchFrameEnabledByDefault")
+{
+	REQUIRE(m_refAllEvDM->isEventClassEnabled(TouchEvent::getClass()));
+	REQUIRE(m_refAllEvDM->isEventClassEnabled(TouchFrameEvent::getClass()));
+
+	// A listener only interested in the single touches
+	std::vector< shared_ptr<Event> > aReceivedEvents2;
+	auto refListener2 = std::make_shared<EventListener>([&](const shared_ptr<Event>& refEvent)
+	{
+		aReceivedEvents2.push_back(refEvent);
+	});
+	const bool bListenerAdded2 = m_refAllEvDM->addEventListener(refListener2, std::make_shared<stmi::CallIfEventClass>(TouchEvent::getClass()));
+	REQUIRE(bListenerAdded2);
+
+	auto refFakeBackend = m_refAllEvDM->getBackend();
+	auto p0PointerDevice = refFakeBackend->getPointerBackendDevice();
+	assert(p0PointerDevice != nullptr);
+
+	auto refFakeFactory = m_refAllEvDM->getFactory();
+	const std::shared_ptr<Mas::FakeGtkWindowData>& refWinData1 = refFakeFactory->getFakeWindowData(m_refWin1.operator->());
+	REQUIRE(refWinData1.operator bool());
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	int64_t nDontKnow = 12121212;
+	auto p0Seq = reinterpret_cast<GdkEventSequence*>(&nDontKnow);
+	refWinData1->simulateTouch(GDK_TOUCH_BEGIN, 777.77, 888.88, p0Seq, p0PointerDevice);
+	iterateMainLoopPending();
+
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+	REQUIRE(m_aReceivedEvents1[0]->getEventClass() == typeid(stmi::TouchEvent));
+	REQUIRE(m_aReceivedEvents1[1]->getEventClass() == typeid(stmi::TouchFrameEvent));
+	REQUIRE(aReceivedEvents2.size() == 1);
+	REQUIRE(aReceivedEvents2[0]->getEventClass() == typeid(stmi::TouchEvent));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+class MasDMTouchFrameFixture : public MasDMOneWinOneAccOneListenerFixture
+								, public FixtureVariantEventClassesEnable_True
+								, public FixtureVariantEventClasses_TouchEvent
+								, public FixtureVariantEventClasses_TouchFrameEvent
+{
+};
+TEST_CASE_METHOD(STFX<MasDMTouchFrameFixture>, "TouchFrameExplicitlyEnabled")
+{
+	REQUIRE(m_refAllEvDM->isEventClassEnabled(TouchEvent::getClass()));
+	REQUIRE(m_refAllEvDM->isEventClassEnabled(TouchFrameEvent::getClass()));
+
+	auto refFakeBackend = m_refAllEvDM->getBackend();
+	auto p0PointerDevice = refFakeBackend->getPointerBackendDevice();
+	assert(p0PointerDevice != nullptr);
+
+	auto refFakeFactory = m_refAllEvDM->getFactory();
+	const std::shared_ptr<Mas::FakeGtkWindowData>& refWinData1 = refFakeFactory->getFakeWindowData(m_refWin1.operator->());
+	REQUIRE(refWinData1.operator bool());
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	int64_t aDontKnow[3] = {12121212, 34343434, 56565656};
+	auto p0Seq1 = reinterpret_cast<GdkEventSequence*>(&aDontKnow[0]);
+	auto p0Seq2 = reinterpret_cast<GdkEventSequence*>(&aDontKnow[1]);
+	auto p0Seq3 = reinterpret_cast<GdkEventSequence*>(&aDontKnow[2]);
+	refWinData1->simulateTouch(GDK_TOUCH_BEGIN, 100.0, 200.0, p0Seq1, p0PointerDevice);
+	refWinData1->simulateTouch(GDK_TOUCH_BEGIN, 300.0, 400.0, p0Seq2, p0PointerDevice);
+	// the frame is sent once the pending gdk events are handled
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+	iterateMainLoopPending();
+
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	REQUIRE(m_aReceivedEvents1[0]->getEventClass() == typeid(stmi::TouchEvent));
+	REQUIRE(m_aReceivedEvents1[1]->getEventClass() == typeid(stmi::TouchEvent));
+	REQUIRE(m_aReceivedEvents1[2]->getEventClass() == typeid(stmi::TouchFrameEvent));
+	auto p0FrameEvent = static_cast<TouchFrameEvent*>(m_aReceivedEvents1[2].get());
+	REQUIRE(p0FrameEvent->getTotContacts() == 2);
+	REQUIRE(p0FrameEvent->getAccessor() == m_refGtkAccessor1);
+
+	// the contacts are in the order the sequences began, also after one ended
+	refWinData1->simulateTouch(GDK_TOUCH_BEGIN, 500.0, 600.0, p0Seq3, p0PointerDevice);
+	refWinData1->simulateTouch(GDK_TOUCH_END, 100.0, 200.0, p0Seq1, p0PointerDevice);
+	refWinData1->simulateTouch(GDK_TOUCH_UPDATE, 310.0, 410.0, p0Seq2, p0PointerDevice);
+	iterateMainLoopPending();
+	REQUIRE(m_aReceivedEvents1.size() == 7);
+	REQUIRE(m_aReceivedEvents1[6]->getEventClass() == typeid(stmi::TouchFrameEvent));
+	p0FrameEvent = static_cast<TouchFrameEvent*>(m_aReceivedEvents1[6].get());
+	REQUIRE(p0FrameEvent->getTotContacts() == 3);
+	REQUIRE(p0FrameEvent->getFingerIds()[0] == reinterpret_cast<int64_t>(p0Seq2));
+	REQUIRE(p0FrameEvent->getTypes()[0] == TouchEvent::TOUCH_UPDATE);
+	REQUIRE(p0FrameEvent->getFingerIds()[1] == reinterpret_cast<int64_t>(p0Seq3));
+	REQUIRE(p0FrameEvent->getTypes()[1] == TouchEvent::TOUCH_BEGIN);
+	REQUIRE(p0FrameEvent->getFingerIds()[2] == reinterpret_cast<int64_t>(p0Seq1));
+	REQUIRE(p0FrameEvent->getTypes()[2] == TouchEvent::TOUCH_END);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+class MasDMCoalescePointerMotionFixture : public MasDMOneWinOneAccOneListenerFixture
+										, public FixtureVariantCoalescePointerMotion_True
+{
+};
+TEST_CASE_METHOD(STFX<MasDMCoalescePointerMotionFixture>, "CoalescedMotionBeforeKey")
+{
+	auto refFakeBackend = m_refAllEvDM->getBackend();
+	auto p0PointerDevice = refFakeBackend->getPointerBackendDevice();
+	assert(p0PointerDevice != nullptr);
+
+	auto refFakeFactory = m_refAllEvDM->getFactory();
+	const std::shared_ptr<Mas::FakeGtkWindowData>& refWinData1 = refFakeFactory->getFakeWindowData(m_refWin1.operator->());
+	REQUIRE(refWinData1.operator bool());
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	refWinData1->simulateMotionNotify(10.0, 20.0, p0PointerDevice);
+	refWinData1->simulateMotionNotify(30.0, 40.0, p0PointerDevice);
+	// queued until the main loop is idle
+	REQUIRE(m_aReceivedEvents1.size() == 0);
+
+	refWinData1->simulateKeyPress(GDK_KEY_F1, 67);
+
+	// the motion that preceded the key is sent first
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+	REQUIRE(m_aReceivedEvents1[0]->getEventClass() == typeid(stmi::PointerEvent));
+	auto p0PointerEvent = static_cast<stmi::PointerEvent*>(m_aReceivedEvents1[0].get());
+	REQUIRE(p0PointerEvent->getType() == stmi::PointerEvent::POINTER_HOVER);
+	REQUIRE(p0PointerEvent->getX() == 30.0);
+	REQUIRE(p0PointerEvent->getY() == 40.0);
+	REQUIRE(p0PointerEvent->getMotionHistory().size() == 2);
+	REQUIRE(m_aReceivedEvents1[1]->getEventClass() == typeid(stmi::KeyEvent));
+
+	// nothing left for the idle
+	iterateMainLoopPending();
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+
+	refWinData1->simulateMotionNotify(50.0, 60.0, p0PointerDevice);
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+	iterateMainLoopPending();
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	REQUIRE(m_aReceivedEvents1[2]->getEventClass() == typeid(stmi::PointerEvent));
+}
+TEST_CASE_METHOD(STFX<MasDMCoalescePointerMotionFixture>, "CoalescedMotionHistoryIsCapped")
+{
+	auto refFakeBackend = m_refAllEvDM->getBackend();
+	auto p0PointerDevice = refFakeBackend->getPointerBackendDevice();
+	assert(p0PointerDevice != nullptr);
+
+	auto refFakeFactory = m_refAllEvDM->getFactory();
+	const std::shared_ptr<Mas::FakeGtkWindowData>& refWinData1 = refFakeFactory->getFakeWindowData(m_refWin1.operator->());
+	REQUIRE(refWinData1.operator bool());
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	const int32_t nTotMotions = 100;
+	for (int32_t nMotion = 0; nMotion < nTotMotions; ++nMotion) {
+		refWinData1->simulateMotionNotify(nMotion, 2 * nMotion, p0PointerDevice);
+	}
+	REQUIRE(m_aReceivedEvents1.size() == 0);
+	iterateMainLoopPending();
+
+	REQUIRE(m_aReceivedEvents1.size() == 1);
+	REQUIRE(m_aReceivedEvents1[0]->getEventClass() == typeid(stmi::PointerEvent));
+	auto p0PointerEvent = static_cast<stmi::PointerEvent*>(m_aReceivedEvents1[0].get());
+	REQUIRE(p0PointerEvent->getX() == nTotMotions - 1);
+	// only the latest samples are kept
+	const auto& aHistory = p0PointerEvent->getMotionHistory();
+	REQUIRE(aHistory.size() == 64);
+	REQUIRE(aHistory.front().m_fX == nTotMotions - 64);
+	REQUIRE(aHistory.back().m_fX == nTotMotions - 1);
+	REQUIRE(aHistory.back().m_fY == 2 * (nTotMotions - 1));
+}
+
+TEST_CASE_METHOD(STFX<MasDMOneWinOneAccOneListenerFixture>, "UncoalescedMotionBeforeKey")
+{
+	auto refFakeBackend = m_refAllEvDM->getBackend();
+	auto p0PointerDevice = refFakeBackend->getPointerBackendDevice();
+	assert(p0PointerDevice != nullptr);
+
+	auto refFakeFactory = m_refAllEvDM->getFactory();
+	const std::shared_ptr<Mas::FakeGtkWindowData>& refWinData1 = refFakeFactory->getFakeWindowData(m_refWin1.operator->());
+	REQUIRE(refWinData1.operator bool());
+
+	m_refAllEvDM->makeWindowActive(m_refGtkAccessor1);
+
+	refWinData1->simulateMotionNotify(10.0, 20.0, p0PointerDevice);
+	refWinData1->simulateMotionNotify(30.0, 40.0, p0PointerDevice);
+	REQUIRE(m_aReceivedEvents1.size() == 2);
+
+	refWinData1->simulateKeyPress(GDK_KEY_F1, 67);
+
+	REQUIRE(m_aReceivedEvents1.size() == 3);
+	REQUIRE(m_aReceivedEvents1[0]->getEventClass() == typeid(stmi::PointerEvent));
+	REQUIRE(m_aReceivedEvents1[1]->getEventClass() == typeid(stmi::PointerEvent));
+	REQUIRE(m_aReceivedEvents1[2]->getEventClass() == typeid(stmi::KeyEvent));
+}
+
 } // namespace testing
 
 } // namespace stmi
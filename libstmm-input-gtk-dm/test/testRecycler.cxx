@@ -0,0 +1,148 @@
+/*
+ * Copyright © 2020  Stefano Marsili, <stemars@gmx.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+/*
+ * File:   testRecycler.cxx
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "recycler.h"
+
+#include <thread>
+
+namespace stmi
+{
+
+using std::shared_ptr;
+
+namespace testing
+{
+
+class TestValue
+{
+public:
+	explicit TestValue(int32_t nValue) noexcept
+	: m_nValue(nValue)
+	{
+	}
+	void reInit(int32_t nValue) noexcept
+	{
+		m_nValue = nValue;
+	}
+	int32_t m_nValue;
+};
+
+TEST_CASE("Recycler, HitsAndMisses")
+{
+	auto refPool = std::make_shared<Private::RecyclerPool>();
+	REQUIRE(refPool->getMaxFree() == Private::RecyclerPool::s_nDefaultMaxFree);
+	Private::Recycler<TestValue> oRecycler(refPool);
+	shared_ptr<TestValue> refValue;
+	oRecycler.create(refValue, 1);
+	REQUIRE(refValue->m_nValue == 1);
+	REQUIRE(refPool->getMisses() == 1);
+	REQUIRE(refPool->getHits() == 0);
+	TestValue* p0Value = refValue.get();
+	refValue.reset();
+	REQUIRE(refPool->getFree() == 1);
+
+	oRecycler.create(refValue, 2);
+	REQUIRE(refValue.get() == p0Value);
+	REQUIRE(refValue->m_nValue == 2);
+	REQUIRE(refPool->getHits() == 1);
+	REQUIRE(refPool->getFree() == 0);
+
+	refPool->resetStats();
+	REQUIRE(refPool->getHits() == 0);
+	REQUIRE(refPool->getMisses() == 0);
+}
+
+TEST_CASE("Recycler, MaxFree")
+{
+	auto refPool = std::make_shared<Private::RecyclerPool>(1);
+	Private::Recycler<TestValue> oRecycler(refPool);
+	shared_ptr<TestValue> refValue1;
+	shared_ptr<TestValue> refValue2;
+	oRecycler.create(refValue1, 1);
+	oRecycler.create(refValue2, 2);
+	refValue1.reset();
+	refValue2.reset();
+	// the second release is deleted
+	REQUIRE(refPool->getFree() == 1);
+
+	refPool->setMaxFree(2);
+	REQUIRE(refPool->getMaxFree() == 2);
+	oRecycler.create(refValue1, 1);
+	oRecycler.create(refValue2, 2);
+	REQUIRE(refPool->getHits() == 1);
+	REQUIRE(refPool->getMisses() == 3);
+	refValue1.reset();
+	refValue2.reset();
+	REQUIRE(refPool->getFree() == 2);
+
+	// already free instances are kept
+	refPool->setMaxFree(0);
+	REQUIRE(refPool->getFree() == 2);
+	oRecycler.create(refValue1, 1);
+	REQUIRE(refPool->getHits() == 2);
+	refValue1.reset();
+	REQUIRE(refPool->getFree() == 1);
+}
+
+TEST_CASE("Recycler, ReleasedInOtherThread")
+{
+	auto refPool = std::make_shared<Private::RecyclerPool>();
+	Private::Recycler<TestValue> oRecycler(refPool);
+	shared_ptr<TestValue> refValue;
+	oRecycler.create(refValue, 1);
+	TestValue* p0Value = refValue.get();
+	std::thread oThread([&]()
+	{
+		refValue.reset();
+	});
+	oThread.join();
+	REQUIRE(refPool->getFree() == 1);
+	oRecycler.create(refValue, 2);
+	REQUIRE(refValue.get() == p0Value);
+	REQUIRE(refPool->getHits() == 1);
+	refValue.reset();
+}
+
+TEST_CASE("Recycler, ClosedWithLiveInstances")
+{
+	auto refPool = std::make_shared<Private::RecyclerPool>();
+	shared_ptr<TestValue> refValue;
+	{
+		Private::Recycler<TestValue> oRecycler(refPool);
+		shared_ptr<TestValue> refFree;
+		oRecycler.create(refFree, 1);
+		refFree.reset();
+		oRecycler.create(refValue, 2);
+		oRecycler.create(refFree, 3);
+		refFree.reset();
+		REQUIRE(refPool->getFree() == 1);
+	}
+	REQUIRE(refPool->getFree() == 0);
+	// deleted, not recycled
+	refValue.reset();
+	REQUIRE(refPool->getFree() == 0);
+}
+
+} // namespace testing
+
+} // namespace stmi
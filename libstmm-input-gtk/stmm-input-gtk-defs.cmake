@@ -19,11 +19,11 @@
 #   MAJOR is CURRENT interface
 #   MINOR is REVISION (implementation of interface)
 #   AGE is always 0
-set(STMM_INPUT_GTK_MAJOR_VERSION 0)
-set(STMM_INPUT_GTK_MINOR_VERSION 16) # !-U-!
+set(STMM_INPUT_GTK_MAJOR_VERSION 1)
+set(STMM_INPUT_GTK_MINOR_VERSION 0) # !-U-!
 set(STMM_INPUT_GTK_VERSION "${STMM_INPUT_GTK_MAJOR_VERSION}.${STMM_INPUT_GTK_MINOR_VERSION}.0")
 
-set(STMM_INPUT_GTK_REQ_STMM_INPUT_VERSION "0.16") # !-U-!
+set(STMM_INPUT_GTK_REQ_STMM_INPUT_VERSION "1.0") # !-U-!
 
 set(STMM_INPUT_GTK_REQ_GTKMM_VERSION "3.22")
 
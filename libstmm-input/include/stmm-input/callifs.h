@@ -173,14 +173,15 @@ public:
 	bool operator()(const shared_ptr<const Event>& refEvent) const noexcept override
 	{
 		const bool bMemberNull = (!m_refAccessor);
-		const shared_ptr<const Accessor>& refAccessor = refEvent->getAccessor();
-		const bool bOtherNull = (!refAccessor);
+		// avoid creating a temporary shared_ptr<const Accessor>
+		const Accessor* p0Accessor = refEvent->getAccessor().get();
+		const bool bOtherNull = (p0Accessor == nullptr);
 		if (bOtherNull || bMemberNull) {
 			// if both null, it's a match!
 			return (bMemberNull == bOtherNull);
 		}
 		// compare objects
-		return ((*m_refAccessor) == (*refAccessor));
+		return ((*m_refAccessor) == (*p0Accessor));
 	}
 	/** The accessor to be selected.
 	 * @return The accessor. Can be null.
@@ -209,6 +210,14 @@ public:
 	bool operator()(const shared_ptr<const Event>& refEvent) const noexcept override
 	{
 		assert(refEvent);
+		if (refEvent->hasCapabilityData()) {
+			// use the device id cached when the event was created
+			const int32_t nEventDeviceId = refEvent->getDeviceId();
+			if (m_nDeviceId < 0) {
+				return (nEventDeviceId < 0); //---------------------------------
+			}
+			return (nEventDeviceId == m_nDeviceId); //--------------------------
+		}
 		const shared_ptr<Capability> refCapability = refEvent->getCapability();
 		if (!refCapability) {
 			// capability was deleted
@@ -285,10 +294,14 @@ public:
 	bool operator()(const shared_ptr<const Event>& refEvent) const noexcept override
 	{
 		assert(refEvent);
-		if (! (refEvent->getCapability()) ) {
+		if (refEvent->hasCapabilityData()) {
+			return (m_oClass == refEvent->getCapabilityClass()); //-------------
+		}
+		const shared_ptr<Capability> refCapability = refEvent->getCapability();
+		if (!refCapability) {
 			return false;
 		}
-		return (m_oClass == refEvent->getCapability()->getCapabilityClass());
+		return (m_oClass == refCapability->getCapabilityClass());
 	}
 	/** The registered capability class to be selected.
 	 */
@@ -311,10 +324,14 @@ public:
 	bool operator()(const shared_ptr<const Event>& refEvent) const noexcept override
 	{
 		assert(refEvent);
-		if (! (refEvent->getCapability())) {
+		if (refEvent->hasCapabilityData()) {
+			return refEvent->getCapabilityClass().isDeviceManagerCapability(); //-
+		}
+		const shared_ptr<Capability> refCapability = refEvent->getCapability();
+		if (!refCapability) {
 			return false;
 		}
-		return refEvent->getCapability()->getCapabilityClass().isDeviceManagerCapability();
+		return refCapability->getCapabilityClass().isDeviceManagerCapability();
 	}
 };
 
@@ -24,6 +24,7 @@
 #include "hardwarekey.h"
 #include "private-namedtypes.h"
 #include "accessor.h"
+#include "capability.h"
 
 #include <typeinfo>
 #include <type_traits>
@@ -36,8 +37,6 @@
 #include <functional>
 #include <utility>
 
-namespace stmi { class Capability; }
-
 namespace stmi
 {
 
@@ -91,6 +90,23 @@ public:
 	 * @return The accessor. Can be null.
 	 */
 	inline const shared_ptr<Accessor>& getAccessor() const noexcept { return m_refAccessor; }
+	/** Whether the capability data was cached when the event was (re)initialized.
+	 * If `true`, getDeviceId() and getCapabilityClass() can be used instead of
+	 * getCapability() and Capability::getDevice(), which need to lock weak pointers.
+	 * @return Whether the data is available.
+	 */
+	inline bool hasCapabilityData() const noexcept { return m_bHasCapabilityData; }
+	/** The id of the device of the capability that generated this event.
+	 * The value is the one at the time the event was (re)initialized.
+	 * Only valid if hasCapabilityData() returns `true`.
+	 * @return The device id or -1 if the capability has no device (ex. a device manager capability).
+	 */
+	inline int32_t getDeviceId() const noexcept { return m_nDeviceId; }
+	/** The class of the capability that generated this event.
+	 * Only valid if hasCapabilityData() returns `true`.
+	 * @return The capability class.
+	 */
+	inline const Capability::Class& getCapabilityClass() const noexcept { return m_oCapabilityClass; }
 
 	/** Key simulation type.
 	 */
@@ -99,11 +115,65 @@ public:
 		, AS_KEY_RELEASE = 2
 		, AS_KEY_RELEASE_CANCEL = 3
 	};
+	/** Fixed capacity array of simulated keys.
+	 * Filled by fillAsKeys() without allocating memory.
+	 *
+	 * Example:
+	 *
+	 *     stmi::Event::AsKeys oAsKeys;
+	 *     refEvent->fillAsKeys(oAsKeys);
+	 *     for (const auto& oPair : oAsKeys) {
+	 *         handleKey(oPair.first, oPair.second);
+	 *     }
+	 */
+	class AsKeys final
+	{
+	public:
+		/** The maximum number of keys an event can simulate. */
+		static constexpr int32_t s_nMaxKeys = 8;
+		AsKeys() noexcept
+		: m_nSize(0)
+		{
+		}
+		/** The number of keys. */
+		inline int32_t size() const noexcept { return m_nSize; }
+		/** Whether there are no keys. */
+		inline bool empty() const noexcept { return (m_nSize == 0); }
+		/** The key and its type at an index.
+		 * @param nIdx The index. Must be `>= 0` and `< size()`.
+		 * @return The key and type.
+		 */
+		inline const std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE>& operator[](int32_t nIdx) const noexcept
+		{
+			assert((nIdx >= 0) && (nIdx < m_nSize));
+			return m_aKeys[nIdx];
+		}
+		inline const std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE>* begin() const noexcept { return m_aKeys; }
+		inline const std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE>* end() const noexcept { return m_aKeys + m_nSize; }
+		/** Removes all keys. */
+		inline void clear() noexcept { m_nSize = 0; }
+		/** Adds a key.
+		 * If the capacity is exceeded the key is ignored.
+		 * @param eKey The key.
+		 * @param eType The type.
+		 */
+		inline void add(HARDWARE_KEY eKey, AS_KEY_INPUT_TYPE eType) noexcept
+		{
+			assert(m_nSize < s_nMaxKeys);
+			if (m_nSize < s_nMaxKeys) {
+				m_aKeys[m_nSize] = std::make_pair(eKey, eType);
+				++m_nSize;
+			}
+		}
+	private:
+		std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE> m_aKeys[s_nMaxKeys];
+		int32_t m_nSize;
+	};
 	/** Tells whether the event can simulate hardware keys.
 	 * If it can the parameters nKey and eType will
 	 * contain the first of the simulated keys, bMoreThanOne whether there are more.
-	 * If it's the case (`bMoreThanOne == true`) then getAsKeys() should be called,
-	 * which returns all the simulated keys (the first included).
+	 * If it's the case (`bMoreThanOne == true`) then fillAsKeys() or getAsKeys() should be called,
+	 * which return all the simulated keys (the first included).
 	 * If the function returns `false` the parameters are left unchanged. The default implementation
 	 * returns `false`.
 	 *
@@ -120,30 +190,44 @@ public:
 		// To avoid warnings about unused parameters.
 		return false && (0 != (bMoreThanOne ? 0 * static_cast<int32_t>(eKey) + 0 * static_cast<int32_t>(eType) : 0));
 	}
-	/** All the keys this event simulates.
-	 * The default implementation calls getAsKey() and returns an empty set if no keys are simulated,
-	 * otherwise a set containing the first (nKey, eType) pair.
+	/** All the keys this event simulates, without allocating memory.
+	 * The default implementation calls getAsKey() and leaves oAsKeys empty if no keys are simulated,
+	 * otherwise it contains the first (nKey, eType) pair.
 	 * Therefore subclass implementations have to override this function only if
 	 * more than one key is simulated.
 	 *
-	 * Ex.: a subclass PointerScrollEvent may return {(KEY_SCROLLUP,AS_KEY_PRESS), (KEY_SCROLLUP,AS_KEY_RELEASE)},
+	 * Ex.: a subclass PointerScrollEvent may fill {(KEY_SCROLLUP,AS_KEY_PRESS), (KEY_SCROLLUP,AS_KEY_RELEASE)},
 	 *  if mouse's wheel was scrolled up.
-	 * @return Vector of (HARDWARE_KEY,AS_KEY_INPUT_TYPE) pairs that simulate the event. Empty if no key simulated.
+	 * @param oAsKeys Is cleared and filled with the (HARDWARE_KEY,AS_KEY_INPUT_TYPE) pairs that simulate the event.
 	 */
-	virtual std::vector< std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE> > getAsKeys() const noexcept
+	virtual void fillAsKeys(AsKeys& oAsKeys) const noexcept
 	{
+		oAsKeys.clear();
 		HARDWARE_KEY eKey;
 		AS_KEY_INPUT_TYPE eType;
 		bool bMoreThanOne = false;
 		const bool bHasKeys = getAsKey(eKey, eType, bMoreThanOne);
 		//assert(bMoreThanOne == false);
 		if (bHasKeys) {
-			return { std::make_pair(eKey, eType) };
-		} else  {
-			return {};
+			oAsKeys.add(eKey, eType);
 		}
 	}
+	/** All the keys this event simulates.
+	 * The default implementation returns the keys filled by fillAsKeys().
+	 * Subclasses overriding this function should also override fillAsKeys()
+	 * so that the two return the same keys.
+	 * Prefer fillAsKeys() which doesn't allocate memory.
+	 * @return Vector of (HARDWARE_KEY,AS_KEY_INPUT_TYPE) pairs that simulate the event. Empty if no key simulated.
+	 */
+	virtual std::vector< std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE> > getAsKeys() const noexcept
+	{
+		AsKeys oAsKeys;
+		fillAsKeys(oAsKeys);
+		return std::vector< std::pair<HARDWARE_KEY, AS_KEY_INPUT_TYPE> >(oAsKeys.begin(), oAsKeys.end());
+	}
 	/** The representation of a registered event class.
+	 * Each registered class is assigned a small unique index when registered
+	 * (see Event::RegisterClass) that is used for fast comparisons and hashing.
 	 */
 	class Class final
 	{
@@ -152,16 +236,20 @@ public:
 		 */
 		Class() noexcept
 		: m_p0EventType(nullptr)
+		, m_nIndex(-1)
 		, m_bIsXYEvent(false)
 		{
 		}
 		/** Constructs an event class instance.
 		 * If the passed c++ typeid is not of a registered class an empty
 		 * class is constructed.
+		 *
+		 * This involves a lookup of the type, if possible use the static getClass()
+		 * function of the registered class instead (ex. KeyEvent::getClass()).
 		 * @param oEventType underlying c++ typeid of the class.
 		 */
 		explicit Class(const std::type_info& oEventType) noexcept
-		: Class(oEventType, false)
+		: Class(oEventType, -1, false)
 		{
 		}
 		/** Compares a registered event class instance with a c++ typeid.
@@ -190,10 +278,7 @@ public:
 		 */
 		inline bool operator==(const Class& oOther) const noexcept
 		{
-			if (m_p0EventType == nullptr) {
-				return (oOther.m_p0EventType == nullptr);
-			}
-			return ((*m_p0EventType) == (*oOther.m_p0EventType));
+			return (m_nIndex == oOther.m_nIndex);
 		}
 		/**
 		 * @see operator==(const Class&)
@@ -228,6 +313,16 @@ public:
 			}
 			return getEventTypeClassId(*m_p0EventType);
 		}
+		/** The index of the registered class.
+		 * Indexes are assigned in registration order starting from 0 and are
+		 * never reused. They can be used to index arrays.
+		 * @return The index or -1 if the class is empty.
+		 * @see Event::getTotRegisteredClassIndexes()
+		 */
+		inline int32_t getIndex() const noexcept
+		{
+			return m_nIndex;
+		}
 		/** Tells whether you can statically cast an instance of this Class to XYEvent.
 		 * @see class XYEvent
 		 * @return Whether this registered class is subclass of XYEvent.
@@ -237,8 +332,9 @@ public:
 			return m_bIsXYEvent;
 		}
 	private:
-		Class(const std::type_info& oEventType, bool bIsXYEvent) noexcept
-		: m_p0EventType((nullptr != getNamedTypes().getDataFromType(oEventType, bIsXYEvent)) ? &oEventType : nullptr)
+		Class(const std::type_info& oEventType, int32_t nIndex, bool bIsXYEvent) noexcept
+		: m_p0EventType((nullptr != getNamedTypes().getDataFromType(oEventType, bIsXYEvent, nIndex)) ? &oEventType : nullptr)
+		, m_nIndex(nIndex)
 		, m_bIsXYEvent(bIsXYEvent)
 		{
 			if (m_p0EventType == nullptr) {
@@ -247,6 +343,7 @@ public:
 		}
 	private:
 		const std::type_info* m_p0EventType;
+		int32_t m_nIndex;
 		bool m_bIsXYEvent;
 	};
 	/** Get the registered class of the event instance.
@@ -266,6 +363,13 @@ public:
 	 * @return The class. Might be empty if sEventClassId is not registered.
 	 */
 	static Class getEventClassIdClass(const std::string& sEventClassId) noexcept;
+	/** The number of indexes assigned to registered event classes so far.
+	 * All registered classes have Class::getIndex() smaller than the returned value.
+	 * Since classes can be registered at any time (ex. by loaded plugins) the value
+	 * can grow.
+	 * @return The number of indexes.
+	 */
+	static int32_t getTotRegisteredClassIndexes() noexcept;
 
 protected:
 	/** Constructor to be called from subclasses.
@@ -293,9 +397,22 @@ protected:
 	 */
 	inline void setTimeUsec(int64_t nTimeUsec) noexcept { m_nTimeUsec = nTimeUsec; }
 	/** Set the capability id.
+	 * Invalidates the cached capability data.
 	 * @param nCapabilityId The id of the capability that generated this event. Must be >= 0.
 	 */
-	inline void setCapabilityId(int32_t nCapabilityId) noexcept { assert(nCapabilityId >= 0); m_nCapabilityId = nCapabilityId; }
+	inline void setCapabilityId(int32_t nCapabilityId) noexcept
+	{
+		assert(nCapabilityId >= 0);
+		m_nCapabilityId = nCapabilityId;
+		m_bHasCapabilityData = false;
+	}
+	/** Set the capability id and cache the capability data.
+	 * Subclasses should call this from their constructors and capability setters
+	 * so that callifs can filter the event without locking the capability.
+	 * @param oCapability The capability that generated this event.
+	 * @see hasCapabilityData()
+	 */
+	void setCapability(const Capability& oCapability) noexcept;
 	/** Set the accessor.
 	 * @param refAccessor Can be null.
 	 */
@@ -399,6 +516,9 @@ private:
 	int64_t m_nTimeUsec;
 	int32_t m_nCapabilityId;
 	shared_ptr<Accessor> m_refAccessor;
+	bool m_bHasCapabilityData;
+	int32_t m_nDeviceId;
+	Capability::Class m_oCapabilityClass;
 	//
 	const Event::Class m_oClass;
 
@@ -414,10 +534,7 @@ namespace std {
 	{
 		std::size_t operator()(const stmi::Event::Class& oClass) const
 		{
-			if (!oClass) {
-				return 0;
-			}
-			return oClass.getTypeInfo().hash_code();
+			return static_cast<std::size_t>(oClass.getIndex() + 1);
 		}
 	};
 } // namespace std
@@ -39,7 +39,7 @@ namespace Private
 {
 
 /* * Helper class to store and access unique types with their associated data.
- * Each type has a unique string id.
+ * Each type has a unique string id and a unique dense index assigned when added.
  */
 template<class T>
 class NamedTypes
@@ -47,6 +47,7 @@ class NamedTypes
 public:
 	/* * Construct empty instance. */
 	NamedTypes() noexcept
+	: m_nNextIndex(0)
 	{
 //std::cout << "NamedTypes: adr: " << reinterpret_cast<int64_t>(this) << '\n';
 	}
@@ -65,6 +66,31 @@ public:
 		oData = oTypeData.m_oData;
 		return oTypeData.m_p0StringId;
 	}
+	/* *
+	 * @param oType The type
+	 * @param oData [out] The data associated with the type.
+	 * @param nIndex [out] The index assigned to the type when it was added. Unchanged if not found.
+	 * @return The StringId for the type. nullptr if type not found.
+	 */
+	const char* getDataFromType(const std::type_info& oType, T& oData, int32_t& nIndex) const noexcept
+	{
+		auto itFind = m_oTypeData.find(std::type_index(oType));
+		if (itFind == m_oTypeData.end()) {
+			return nullptr;
+		}
+		const TypeData& oTypeData = itFind->second;
+		oData = oTypeData.m_oData;
+		nIndex = oTypeData.m_nIndex;
+		return oTypeData.m_p0StringId;
+	}
+	/* * The number of indexes assigned so far.
+	 * All the indexes of added types are smaller than the returned value.
+	 * @return The number of indexes.
+	 */
+	int32_t getTotIndexes() const noexcept
+	{
+		return m_nNextIndex;
+	}
 	/* *
 	 * @param p0StringId type id
 	 * @param bFound Tells whether the type was found
@@ -96,6 +122,7 @@ public:
 	}
 	/* * Adds a type, its string representation and associated data.
 	 * Duplicates are not allowed.
+	 * The type is assigned the next free index. Indexes are never reused.
 	 * @param oType The C++ type.
 	 * @param p0StringId Must be PERSISTENT (static) for the lifetime of this class! Can't be null.
 	 * @param oData The data associated with the type.
@@ -112,7 +139,8 @@ public:
 		#ifndef NDEBUG
 		auto oPair2 =
 		#endif //NDEBUG
-		m_oTypeData.emplace(std::type_index(oType), TypeData{p0StringId, oData});
+		m_oTypeData.emplace(std::type_index(oType), TypeData{p0StringId, oData, m_nNextIndex});
+		++m_nNextIndex;
 		assert(oPair2.second); // C++ type already exists!
 		//assert(m_oTypeData.find(&oType) != m_oTypeData.end());
 	}
@@ -139,7 +167,7 @@ public:
 		}
 		for (auto& oPair : m_oTypeData) {
 			std::cout << "  typeid().name=" << (*oPair.first).name() << " addr=" << reinterpret_cast<int64_t>(oPair.first)
-						<< "   stringId=" << oPair.second.m_p0StringId << "   size(m_oData)=" << sizeof(oPair.second.m_oData) << std::endl;
+						<< "   stringId=" << oPair.second.m_p0StringId << "   index=" << oPair.second.m_nIndex << "   size(m_oData)=" << sizeof(oPair.second.m_oData) << std::endl;
 		}
 	}
 	#endif //NDEBUG
@@ -148,6 +176,7 @@ private:
 	{
 		const char* const m_p0StringId;
 		T m_oData;
+		int32_t m_nIndex;
 	};
 	struct HasherStr
 	{
@@ -176,6 +205,7 @@ private:
 	};
 	std::unordered_map<std::type_index, TypeData> m_oTypeData;
 	std::unordered_map<const char*, const std::type_info&, HasherStr, EqualStr > m_oStringIdType;
+	int32_t m_nNextIndex;
 };
 
 } // namespace Private
@@ -57,7 +57,8 @@ std::atomic<int32_t> Capability::s_nNewIdCounter(0);
 int32_t Capability::getNewCapabilityId() noexcept
 {
 //std::cout << "Capability::getNewCapabilityId adr " << reinterpret_cast<int64_t>(&s_nNewIdCounter) << " = " << s_nNewIdCounter << '\n';
-	const int32_t nNewId = ++s_nNewIdCounter;
+	// Thread safe: only uniqueness is needed
+	const int32_t nNewId = s_nNewIdCounter.fetch_add(1, std::memory_order_relaxed) + 1;
 	return nNewId;
 }
 
@@ -27,7 +27,8 @@ std::atomic<int32_t> Device::s_nNewIdCounter(0);
 
 int32_t Device::getNewDeviceId() noexcept
 {
-	const int32_t nNewId = ++s_nNewIdCounter;
+	// Thread safe: only uniqueness is needed
+	const int32_t nNewId = s_nNewIdCounter.fetch_add(1, std::memory_order_relaxed) + 1;
 	return nNewId;
 }
 Device::Device() noexcept
@@ -19,6 +19,7 @@
  */
 
 #include "event.h"
+#include "device.h"
 
 namespace stmi
 {
@@ -34,6 +35,10 @@ Event::Class Event::getEventClassIdClass(const std::string& sEventClassId) noexc
 	bool bFound;
 	return Class(getNamedTypes().getTypeFromStringId(sEventClassId.c_str(), bFound));
 }
+int32_t Event::getTotRegisteredClassIndexes() noexcept
+{
+	return getNamedTypes().getTotIndexes();
+}
 bool Event::isEventTypeRegistered(const std::type_info& oEventType) noexcept
 {
 	return getNamedTypes().hasType(oEventType);
@@ -57,12 +62,22 @@ Event::Event(const Class& oClass, int64_t nTimeUsec, int32_t nCapabilityId, cons
 : m_nTimeUsec(nTimeUsec)
 , m_nCapabilityId(nCapabilityId)
 , m_refAccessor(refAccessor)
+, m_bHasCapabilityData(false)
+, m_nDeviceId(-1)
 , m_oClass(oClass)
 {
 	assert((nTimeUsec >= 0) || (nTimeUsec == -1));
 	assert(nCapabilityId >= 0);
 	assert(oClass); // Class has to be registered
 }
+void Event::setCapability(const Capability& oCapability) noexcept
+{
+	m_nCapabilityId = oCapability.getId();
+	const shared_ptr<Device> refDevice = oCapability.getDevice();
+	m_nDeviceId = (refDevice ? refDevice->getId() : -1);
+	m_oCapabilityClass = oCapability.getCapabilityClass();
+	m_bHasCapabilityData = true;
+}
 
 } // namespace stmi
 
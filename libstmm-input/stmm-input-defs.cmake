@@ -19,8 +19,8 @@
 #   MAJOR is CURRENT interface
 #   MINOR is REVISION (implementation of interface)
 #   AGE is always 0
-set(STMM_INPUT_MAJOR_VERSION 0)
-set(STMM_INPUT_MINOR_VERSION 16) # !-U-!
+set(STMM_INPUT_MAJOR_VERSION 1)
+set(STMM_INPUT_MINOR_VERSION 0) # !-U-!
 set(STMM_INPUT_VERSION "${STMM_INPUT_MAJOR_VERSION}.${STMM_INPUT_MINOR_VERSION}.0")
 
 # include dirs
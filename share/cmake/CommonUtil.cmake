@@ -53,6 +53,8 @@ endfunction(DefineSharedLibOption)
 function(DefineCommonOptions)
     option(BUILD_WITH_SANITIZE "Build with sanitize=address (Debug only!)" OFF)
     mark_as_advanced(BUILD_WITH_SANITIZE)
+    option(BUILD_WITH_SANITIZE_THREAD "Build with sanitize=thread (Debug only!)" OFF)
+    mark_as_advanced(BUILD_WITH_SANITIZE_THREAD)
 endfunction(DefineCommonOptions)
 
 
@@ -68,6 +70,8 @@ function(DefineCommonCompileOptions STMMI_CPP_STD)
         if ("${CMAKE_BUILD_TYPE}" STREQUAL "Debug")
             if (BUILD_WITH_SANITIZE)
                 set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fsanitize=address" PARENT_SCOPE)
+            elseif (BUILD_WITH_SANITIZE_THREAD)
+                set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fsanitize=thread" PARENT_SCOPE)
             endif()
         endif()
     endif()